@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @brief Validación y tiempos del solver de diferencias finitas.
+ *
+ * Valúa contratos con strikes, plazos y volatilidades variadas y compara:
+ * las opciones europeas de compra con blackScholesCall y las de venta por
+ * paridad put-call; las de venta americanas con un árbol binomial (CRR) de
+ * muchos pasos; y la ruta de volatilidad local (con una sigma(S, t)
+ * constante) con la de volatilidad constante. Se reporta el error máximo
+ * relativo al strike y los contratos por segundo.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/fd_pricing.cpp blackscholes/fd_pricing.cpp \
+ *       blackscholes/pricing.cpp -o fd_pricing
+ * Uso:
+ *   ./fd_pricing [contratos] [nodos] [pasos] [hilos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "blackscholes/fd_pricing.hpp"
+#include "blackscholes/pricing.hpp"
+
+namespace {
+
+/**
+ * @brief Opción de venta americana con un árbol binomial de Cox-Ross-Rubinstein.
+ */
+double binomialAmericanPut(double S, double K, double T, double r, double sigma, size_t pasos) {
+    double dt = T / static_cast<double>(pasos);
+    double u = std::exp(sigma * std::sqrt(dt));
+    double d = 1.0 / u;
+    double p = (std::exp(r * dt) - d) / (u - d);
+    double descuento = std::exp(-r * dt);
+
+    std::vector<double> valores(pasos + 1);
+    for (size_t j = 0; j <= pasos; j++) {
+        double precio = S * std::pow(u, static_cast<double>(j)) *
+                        std::pow(d, static_cast<double>(pasos - j));
+        valores[j] = std::max(K - precio, 0.0);
+    }
+    for (size_t n = pasos; n-- > 0;) {
+        for (size_t j = 0; j <= n; j++) {
+            double precio = S * std::pow(u, static_cast<double>(j)) *
+                            std::pow(d, static_cast<double>(n - j));
+            double continuar = descuento * (p * valores[j + 1] + (1 - p) * valores[j]);
+            valores[j] = std::max(continuar, K - precio);
+        }
+    }
+    return valores[0];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t cantidad = argc > 1 ? std::max(1, std::atoi(argv[1])) : 4096;
+    FdConfig config = defaultFdConfig();
+    config.nodos = argc > 2 ? std::max(4, std::atoi(argv[2])) : config.nodos;
+    config.pasos = argc > 3 ? std::max(1, std::atoi(argv[3])) : config.pasos;
+    size_t hilos = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+    const double S = 1182.0;
+    const double r = std::log(2.0);
+
+    // Contratos con parámetros pseudoaleatorios (LCG, reproducible)
+    uint64_t semilla = 2023;
+    auto uniforme = [&semilla]() {
+        semilla = semilla * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(semilla >> 11) / 9007199254740992.0;
+    };
+    std::vector<FdContract> contratos(cantidad);
+    for (size_t i = 0; i < cantidad; i++) {
+        FdContract& contrato = contratos[i];
+        contrato.S = S;
+        contrato.K = S * (0.7 + 0.6 * uniforme());
+        contrato.T = 0.05 + 0.95 * uniforme();
+        contrato.r = r;
+        contrato.sigma = 0.2 + 0.6 * uniforme();
+        contrato.call = i % 3 != 2;
+        contrato.american = i % 3 == 2;  // Un tercio de ventas americanas
+        contrato.local = nullptr;
+    }
+
+    Scheduler scheduler(hilos);
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<double> precios = priceFiniteDifferences(contratos, config, scheduler);
+    double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    double error_europeo = 0.0;
+    double error_americano = 0.0;
+    size_t americanos = 0;
+    for (size_t i = 0; i < cantidad; i++) {
+        const FdContract& c = contratos[i];
+        double error;
+        if (c.american) {
+            // El árbol es lento: se comparan los primeros 50
+            if (americanos++ >= 50) {
+                continue;
+            }
+            double referencia = binomialAmericanPut(c.S, c.K, c.T, c.r, c.sigma, 4000);
+            error = std::fabs(precios[i] - referencia) / c.K;
+            error_americano = std::isnan(error) ? INFINITY : std::max(error_americano, error);
+        } else {
+            double referencia = blackScholesCall(c.S, c.K, c.T, c.r, c.sigma);
+            error = std::fabs(precios[i] - referencia) / c.K;
+            error_europeo = std::isnan(error) ? INFINITY : std::max(error_europeo, error);
+        }
+    }
+
+    // Volatilidad local constante: tiene que dar lo mismo que sigma constante
+    std::vector<LocalVolatility> superficies(cantidad);
+    std::vector<FdContract> locales = contratos;
+    for (size_t i = 0; i < cantidad; i++) {
+        double sigma = contratos[i].sigma;
+        superficies[i] = [sigma](double, double) { return sigma; };
+        locales[i].local = &superficies[i];
+    }
+    inicio = std::chrono::steady_clock::now();
+    std::vector<double> precios_locales = priceFiniteDifferences(locales, config, scheduler);
+    double segundos_local =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    double diferencia_local = 0.0;
+    for (size_t i = 0; i < cantidad; i++) {
+        diferencia_local = std::max(diferencia_local,
+                                    std::fabs(precios_locales[i] - precios[i]) / contratos[i].K);
+    }
+
+    std::cout << "Contratos: " << cantidad << ", grilla de " << config.nodos << " nodos y "
+              << config.pasos << " pasos (" << config.pasos_rannacher << " de Rannacher), "
+              << FD_LANES << " carriles, " << hilos << " hilos\n";
+    std::cout << "Error máximo / K: europeas " << error_europeo << ", americanas (contra CRR) "
+              << error_americano << ", volatilidad local " << diferencia_local << "\n";
+    std::cout << "Tiempo: " << segundos * 1e3 << " ms (" << cantidad / segundos
+              << " contratos/s), con volatilidad local " << segundos_local * 1e3 << " ms\n";
+    return error_europeo < 1e-3 && error_americano < 1e-3 && diferencia_local < 1e-12 ? 0 : 1;
+}
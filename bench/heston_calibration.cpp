@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief Validación y tiempos de la calibración de Heston.
+ *
+ * Genera cadenas sintéticas valuadas con el pricer de Carr–Madan y la función
+ * característica de Heston (un método independiente del de HestonPricer),
+ * compara los dos precios y calibra cada cadena desde initialHestonGuess. Se
+ * reporta el error de pricing, el error de los parámetros recuperados y el
+ * tiempo por cadena (el objetivo es menos de 10 ms).
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/heston_calibration.cpp blackscholes/heston.cpp \
+ *       blackscholes/fft_pricing.cpp blackscholes/pricing.cpp -o heston_calibration
+ * Uso:
+ *   ./heston_calibration [cadenas] [strikes por vencimiento] [vencimientos] [hilos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "blackscholes/fft_pricing.hpp"
+#include "blackscholes/heston.hpp"
+#include "blackscholes/pricing.hpp"
+
+int main(int argc, char* argv[]) {
+    size_t cantidad_cadenas = argc > 1 ? std::max(1, std::atoi(argv[1])) : 64;
+    size_t cantidad_strikes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 21;
+    size_t vencimientos = argc > 3 ? std::max(1, std::atoi(argv[3])) : 4;
+    size_t hilos = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+    const double S = 1182.0;
+    const double r = std::log(2.0);  // TNA 100%, como el programa
+
+    Scheduler scheduler(hilos);
+    CarrMadanPricer fft;
+
+    // Cada cadena con parámetros algo distintos, como minutos sucesivos
+    std::vector<HestonChain> cadenas(cantidad_cadenas);
+    std::vector<HestonParams> verdaderos(cantidad_cadenas);
+    double error_precio = 0.0;
+
+    for (size_t c = 0; c < cantidad_cadenas; c++) {
+        double desvio = static_cast<double>(c) / cantidad_cadenas;
+        HestonParams p{0.16 + 0.04 * desvio, 1.5 + desvio, 0.20, 0.8 - 0.2 * desvio,
+                       -0.6 + 0.2 * desvio};
+        verdaderos[c] = p;
+        HestonChain& cadena = cadenas[c];
+        cadena.S = S;
+
+        for (size_t v = 0; v < vencimientos; v++) {
+            double T = 0.05 + 0.25 * static_cast<double>(v);
+            std::vector<double> strikes;
+            for (size_t k = 0; k < cantidad_strikes; k++) {
+                double fraccion = cantidad_strikes > 1
+                                      ? static_cast<double>(k) / (cantidad_strikes - 1)
+                                      : 0.5;
+                strikes.push_back(S * (0.7 + 0.6 * fraccion));
+            }
+            std::vector<double> precios = fft.priceStrikes(
+                [&](std::complex<double> u) { return hestonCharacteristic(u, S, T, r, p); }, S,
+                T, r, strikes);
+            for (size_t k = 0; k < strikes.size(); k++) {
+                HestonQuote q;
+                q.K = strikes[k];
+                q.T = T;
+                q.r = r;
+                q.precio = precios[k];
+                q.iv = findImpliedVolatility(S, q.K, T, r, q.precio, 1e-4, 5.0, 1e-10, 500);
+                cadena.cotizaciones.push_back(q);
+            }
+        }
+
+        // Pricing de Lewis con los parámetros verdaderos contra Carr–Madan
+        HestonPricer pricer(S, cadena.cotizaciones);
+        std::vector<double> lewis;
+        pricer.price(p, lewis);
+        for (size_t k = 0; k < lewis.size(); k++) {
+            double error = std::fabs(lewis[k] - cadena.cotizaciones[k].precio);
+            error_precio = std::isnan(error) ? INFINITY : std::max(error_precio, error);
+        }
+    }
+
+    HestonCalibrationConfig config = defaultHestonCalibration();
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<HestonFit> ajustes = calibrateChains(cadenas, config, scheduler);
+    double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    double rmse_maximo = 0.0;
+    double error_parametros = 0.0;
+    size_t convergidas = 0;
+    int iteraciones = 0;
+    for (size_t c = 0; c < cantidad_cadenas; c++) {
+        const HestonParams& a = ajustes[c].parametros;
+        const HestonParams& v = verdaderos[c];
+        rmse_maximo = std::max(rmse_maximo, ajustes[c].rmse);
+        error_parametros = std::max(
+            {error_parametros, std::fabs(a.v0 - v.v0), std::fabs(a.kappa - v.kappa) / v.kappa,
+             std::fabs(a.theta - v.theta), std::fabs(a.xi - v.xi), std::fabs(a.rho - v.rho)});
+        convergidas += ajustes[c].convergio ? 1 : 0;
+        iteraciones += ajustes[c].iteraciones;
+    }
+
+    double ms_por_cadena = segundos * 1e3 * static_cast<double>(hilos) / cantidad_cadenas;
+    std::cout << "Cadenas: " << cantidad_cadenas << " x " << vencimientos << " vencimientos x "
+              << cantidad_strikes << " strikes, " << hilos << " hilos\n";
+    std::cout << "Pricing contra Carr–Madan: error máximo " << error_precio << " ("
+              << error_precio / S << " del subyacente)\n";
+    std::cout << "Calibración: " << convergidas << " convergidas, "
+              << iteraciones / cantidad_cadenas << " iteraciones en promedio, RMSE máximo " << rmse_maximo
+              << ", error máximo de parámetros " << error_parametros << "\n";
+    std::cout << "Tiempo: " << segundos * 1e3 << " ms, " << ms_por_cadena
+              << " ms por cadena e hilo\n";
+    return error_precio / S < 1e-6 && ms_por_cadena < 10.0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @brief Validación y tiempos de la densidad neutral al riesgo.
+ *
+ * Con una sonrisa plana (SSVI con eta casi nula) la densidad tiene que ser la
+ * lognormal de Black-Scholes: se compara punto a punto y en momentos y colas.
+ * Con una superficie con pendiente y curvatura se verifica que la densidad no
+ * sea negativa, que integre 1, que la media sea el forward y que las colas
+ * analíticas coincidan con las que salen de integrar la grilla. Después arma
+ * cadenas por minuto desde esa superficie y mide computeDensities (ajuste SSVI
+ * y densidad de cada vencimiento).
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O3 -pthread -I. bench/implied_density.cpp blackscholes/density.cpp \
+ *       blackscholes/ssvi.cpp blackscholes/pricing.cpp -o implied_density
+ * Uso:
+ *   ./implied_density [minutos] [vencimientos] [strikes] [hilos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "blackscholes/density.hpp"
+#include "blackscholes/pricing.hpp"
+
+namespace {
+
+/**
+ * @brief Probabilidad de la grilla por debajo de K (trapecios en K; la última
+ *        celda se corta en K con la densidad interpolada).
+ */
+double gridProbabilityBelow(const ImpliedDensity& densidad, double K) {
+    double suma = 0.0;
+    for (size_t i = 0; i + 1 < densidad.k.size(); i++) {
+        double K0 = densidad.F * std::exp(densidad.k[i]);
+        double K1 = densidad.F * std::exp(densidad.k[i + 1]);
+        if (K0 >= K) {
+            break;
+        }
+        double q0 = densidad.densidad[i];
+        double q1 = densidad.densidad[i + 1];
+        if (K1 > K) {
+            q1 = q0 + (q1 - q0) * (K - K0) / (K1 - K0);
+            K1 = K;
+        }
+        suma += 0.5 * (q0 + q1) * (K1 - K0);
+    }
+    return suma;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t minutos = argc > 1 ? std::max(1, std::atoi(argv[1])) : 390;
+    size_t vencimientos = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    size_t cantidad_strikes = argc > 3 ? std::max(3, std::atoi(argv[3])) : 15;
+    size_t hilos = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+    const double S = 1182.0;
+    const double r = std::log(2.0);
+    const DensityConfig config = defaultDensityConfig();
+
+    // Sonrisa plana: lognormal con varianza total theta
+    SsviSurface plana;
+    plana.parametros.rho = 0.0;
+    plana.parametros.eta = 1e-12;
+    plana.parametros.gamma = 0.5;
+    plana.plazos.push_back(0.25);
+    plana.thetas.push_back(0.3 * 0.3 * 0.25);
+    const double F_plana = S * std::exp(r * 0.25);
+    ImpliedDensity lognormal;
+    computeDensity(plana, 0.25, F_plana, config, lognormal);
+    const double raiz = std::sqrt(plana.thetas[0]);
+    double error_densidad = 0.0;
+    double maximo = 0.0;
+    for (size_t i = 0; i < lognormal.k.size(); i++) {
+        double K = F_plana * std::exp(lognormal.k[i]);
+        double d2 = -lognormal.k[i] / raiz - 0.5 * raiz;
+        double exacta = std::exp(-0.5 * d2 * d2) / (K * raiz * std::sqrt(2.0 * M_PI));
+        error_densidad = std::max(error_densidad, std::fabs(lognormal.densidad[i] - exacta));
+        maximo = std::max(maximo, exacta);
+    }
+    error_densidad /= maximo;
+    double d2_izquierda = -std::log(1.0 - config.cola) / raiz - 0.5 * raiz;
+    double d2_derecha = -std::log(1.0 + config.cola) / raiz - 0.5 * raiz;
+    double error_plana = std::max({std::fabs(lognormal.masa - 1.0),
+                                   std::fabs(lognormal.media / F_plana - 1.0),
+                                   std::fabs(lognormal.desvio - raiz),
+                                   std::fabs(lognormal.asimetria),
+                                   std::fabs(lognormal.curtosis),
+                                   std::fabs(lognormal.cola_izquierda - cdf(-d2_izquierda)),
+                                   std::fabs(lognormal.cola_derecha - cdf(d2_derecha))});
+
+    // Superficie con pendiente y curvatura, sin arbitraje
+    SsviSurface superficie;
+    superficie.parametros.rho = -0.4;
+    superficie.parametros.eta = 1.2;
+    superficie.parametros.gamma = 0.5;
+    for (size_t v = 0; v < vencimientos; v++) {
+        double T = 0.05 * std::pow(2.0, static_cast<double>(v));
+        double atm = 0.35 + 0.05 * T;
+        superficie.plazos.push_back(T);
+        superficie.thetas.push_back(atm * atm * T);
+    }
+    double error_sesgo = 0.0;
+    double densidad_minima = 0.0;
+    ImpliedDensity sesgada;
+    for (size_t v = 0; v < vencimientos; v++) {
+        double T = superficie.plazos[v];
+        double F = S * std::exp(r * T);
+        computeDensity(superficie, T, F, config, sesgada);
+        for (double q : sesgada.densidad) {
+            densidad_minima = std::min(densidad_minima, q);
+        }
+        double izquierda = gridProbabilityBelow(sesgada, (1.0 - config.cola) * F);
+        double derecha = sesgada.masa - gridProbabilityBelow(sesgada, (1.0 + config.cola) * F);
+        error_sesgo = std::max({error_sesgo, std::fabs(sesgada.masa - 1.0),
+                                std::fabs(sesgada.media / F - 1.0),
+                                std::fabs(sesgada.cola_izquierda - izquierda),
+                                std::fabs(sesgada.cola_derecha - derecha)});
+    }
+
+    // Cadenas por minuto con volatilidades de la superficie
+    std::vector<SsviChain> cadenas(minutos);
+    for (size_t m = 0; m < minutos; m++) {
+        SsviChain& cadena = cadenas[m];
+        cadena.created_at = "10/18/2023 " + std::to_string(10 + m / 60) + ":" +
+                            (m % 60 < 10 ? "0" : "") + std::to_string(m % 60);
+        cadena.S = S;
+        cadena.r = r;
+        for (size_t v = 0; v < vencimientos; v++) {
+            SsviSlice sonrisa;
+            sonrisa.expiration_date = std::to_string(v + 1) + "/01/2024";
+            sonrisa.T = superficie.plazos[v];
+            sonrisa.F = S * std::exp(r * sonrisa.T);
+            double ancho = 2.0 * std::sqrt(superficie.thetas[v]);
+            for (size_t i = 0; i < cantidad_strikes; i++) {
+                double k = -ancho + 2.0 * ancho * static_cast<double>(i) /
+                                        static_cast<double>(cantidad_strikes - 1);
+                sonrisa.strikes.push_back(sonrisa.F * std::exp(k));
+                sonrisa.iv.push_back(superficie.impliedVolatility(k, sonrisa.T));
+            }
+            cadena.vencimientos.push_back(sonrisa);
+        }
+    }
+    Scheduler scheduler(hilos);
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<ImpliedDensity> densidades = computeDensities(cadenas, config, scheduler);
+    double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    double error_cadenas = 0.0;
+    for (const ImpliedDensity& densidad : densidades) {
+        error_cadenas = densidad.k.empty()
+                            ? 1.0
+                            : std::max({error_cadenas, std::fabs(densidad.masa - 1.0),
+                                        std::fabs(densidad.media / densidad.F - 1.0)});
+    }
+
+    std::cout << "Lognormal: error de la densidad " << error_densidad
+              << " (relativo al máximo), de masa, momentos y colas " << error_plana << "\n";
+    std::cout << "Con sesgo: densidad mínima " << densidad_minima
+              << ", error de masa, media y colas " << error_sesgo << "\n";
+    std::cout << "Cadenas: " << minutos << " minutos, " << vencimientos << " vencimientos, "
+              << config.nodos << " nodos, " << hilos << " hilos: " << segundos * 1e3 << " ms ("
+              << segundos / static_cast<double>(minutos) * 1e6
+              << " us por minuto), error de masa y media " << error_cadenas << "\n";
+    bool correcto = error_densidad < 1e-9 && error_plana < 1e-5 && densidad_minima >= 0.0 &&
+                    error_sesgo < 1e-3 && error_cadenas < 1e-3;
+    return correcto ? 0 : 1;
+}
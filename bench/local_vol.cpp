@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Validación y tiempos de la volatilidad local de Dupire.
+ *
+ * Genera una cadena por minuto a partir de una superficie SSVI conocida cuyos
+ * parámetros se mueven de a poco, y la procesa minuto a minuto con
+ * LocalVolBuilder (latencia por minuto e iteraciones del ajuste) y en
+ * paralelo con buildLocalVolSurfaces. Con la grilla del primer minuto valúa
+ * opciones de compra europeas con FdSolver y volatilidad local, y las compara
+ * con Black-Scholes a la volatilidad implícita de la superficie: si Dupire y
+ * la grilla están bien, los precios coinciden salvo por la discretización.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/local_vol.cpp blackscholes/local_vol.cpp \
+ *       blackscholes/ssvi.cpp blackscholes/fd_pricing.cpp blackscholes/pricing.cpp -o local_vol
+ * Uso:
+ *   ./local_vol [minutos] [vencimientos] [strikes] [hilos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "blackscholes/fd_pricing.hpp"
+#include "blackscholes/local_vol.hpp"
+#include "blackscholes/pricing.hpp"
+
+int main(int argc, char* argv[]) {
+    size_t minutos = argc > 1 ? std::max(1, std::atoi(argv[1])) : 390;
+    size_t vencimientos = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    size_t cantidad_strikes = argc > 3 ? std::max(3, std::atoi(argv[3])) : 15;
+    size_t hilos = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+    const double S = 1182.0;
+    const double r = std::log(2.0);
+    LocalVolConfig config = defaultLocalVolConfig();
+
+    // Superficie de cada minuto: theta con volatilidad en el dinero creciente
+    // con el plazo, y rho y eta que oscilan suavemente
+    std::vector<SsviSurface> verdaderas(minutos);
+    std::vector<SsviChain> cadenas(minutos);
+    for (size_t m = 0; m < minutos; m++) {
+        double fase = static_cast<double>(m) / 60.0;
+        SsviSurface& superficie = verdaderas[m];
+        superficie.parametros.rho = -0.5 + 0.1 * std::sin(fase);
+        superficie.parametros.eta = 1.0 + 0.2 * std::cos(fase);
+        superficie.parametros.gamma = config.ssvi.gamma;
+
+        SsviChain& cadena = cadenas[m];
+        cadena.S = S;
+        cadena.r = r;
+        for (size_t v = 0; v < vencimientos; v++) {
+            double T = 0.1 * std::pow(2.0, static_cast<double>(v));
+            double atm = 0.35 + 0.05 * T;
+            superficie.plazos.push_back(T);
+            superficie.thetas.push_back(atm * atm * T);
+        }
+        for (size_t v = 0; v < vencimientos; v++) {
+            SsviSlice sonrisa;
+            sonrisa.T = superficie.plazos[v];
+            sonrisa.F = S * std::exp(r * sonrisa.T);
+            double ancho = 2.0 * std::sqrt(superficie.thetas[v]);
+            for (size_t j = 0; j < cantidad_strikes; j++) {
+                double k = -ancho + 2.0 * ancho * static_cast<double>(j) /
+                                        static_cast<double>(cantidad_strikes - 1);
+                sonrisa.strikes.push_back(sonrisa.F * std::exp(k));
+                sonrisa.iv.push_back(superficie.impliedVolatility(k, sonrisa.T));
+            }
+            cadena.vencimientos.push_back(sonrisa);
+        }
+    }
+
+    // Minuto a minuto, como llegan
+    LocalVolBuilder constructor(config);
+    std::vector<double> latencias(minutos);
+    double error_rho = 0.0, error_eta = 0.0;
+    int iteraciones = 0;
+    LocalVolGrid primera;
+    for (size_t m = 0; m < minutos; m++) {
+        auto inicio = std::chrono::steady_clock::now();
+        const LocalVolGrid& grilla = constructor.update(cadenas[m]);
+        latencias[m] =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        if (m == 0) {
+            primera = grilla;
+        }
+        const SsviParams& p = constructor.fit().superficie.parametros;
+        error_rho = std::max(error_rho, std::fabs(p.rho - verdaderas[m].parametros.rho));
+        error_eta = std::max(error_eta, std::fabs(p.eta - verdaderas[m].parametros.eta));
+        iteraciones += constructor.fit().iteraciones;
+    }
+    std::vector<double> ordenadas = latencias;
+    std::sort(ordenadas.begin(), ordenadas.end());
+
+    Scheduler scheduler(hilos);
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<LocalVolGrid> grillas = buildLocalVolSurfaces(cadenas, config, scheduler);
+    double segundos_lote =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    // Consultas a la grilla
+    const size_t consultas = 10000000;
+    double suma = 0.0;
+    inicio = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < consultas; q++) {
+        double x = static_cast<double>(q % 1000) / 1000.0;
+        suma += primera.volatility(S * (0.6 + 0.8 * x), 0.05 + 0.5 * x);
+    }
+    double segundos_consulta =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    // Precios con volatilidad local contra Black-Scholes con la implícita
+    const SsviSurface& superficie = verdaderas[0];
+    LocalVolatility local = localVolatilityFunction(primera);
+    std::vector<FdContract> contratos;
+    std::vector<double> implicitas;
+    for (size_t v = 0; v < vencimientos; v++) {
+        double T = superficie.plazos[v];
+        for (double k = -0.3; k <= 0.31; k += 0.1) {
+            FdContract contrato;
+            contrato.S = S;
+            contrato.K = S * std::exp(r * T + k);
+            contrato.T = T;
+            contrato.r = r;
+            contrato.sigma = superficie.impliedVolatility(k, T);
+            contrato.call = true;
+            contrato.american = false;
+            contrato.local = &local;
+            contratos.push_back(contrato);
+            implicitas.push_back(contrato.sigma);
+        }
+    }
+    FdConfig config_fd = defaultFdConfig();
+    config_fd.nodos = 400;
+    config_fd.pasos = 400;
+    std::vector<double> precios = priceFiniteDifferences(contratos, config_fd, scheduler);
+    double error_precio = 0.0;
+    double error_vol = 0.0;  // Error del precio en puntos de volatilidad (por vega)
+    for (size_t c = 0; c < contratos.size(); c++) {
+        const FdContract& contrato = contratos[c];
+        double referencia = blackScholesCall(S, contrato.K, contrato.T, r, implicitas[c]);
+        double vega = (blackScholesCall(S, contrato.K, contrato.T, r, implicitas[c] + 1e-4) -
+                       referencia) / 1e-4;
+        error_precio = std::max(error_precio, std::fabs(precios[c] - referencia) / S);
+        error_vol = std::max(error_vol, std::fabs(precios[c] - referencia) / vega);
+    }
+
+    std::cout << "Minutos: " << minutos << ", " << vencimientos << " vencimientos de "
+              << cantidad_strikes << " strikes, grilla de " << config.nodos_k << " x "
+              << config.nodos_t << ", " << hilos << " hilos\n";
+    std::cout << "Minuto a minuto: mediana " << ordenadas[minutos / 2] * 1e6 << " us, p99 "
+              << ordenadas[std::min(minutos - 1, minutos * 99 / 100)] * 1e6 << " us, "
+              << static_cast<double>(iteraciones) / static_cast<double>(minutos)
+              << " iteraciones por minuto\n";
+    std::cout << "Error de parámetros: rho " << error_rho << ", eta " << error_eta << "\n";
+    std::cout << "En paralelo: " << segundos_lote * 1e3 << " ms (" << grillas.size()
+              << " grillas)\n";
+    std::cout << "Consulta: " << segundos_consulta / static_cast<double>(consultas) * 1e9
+              << " ns (suma " << suma << ")\n";
+    std::cout << "Diferencias finitas con volatilidad local contra Black-Scholes: error / S "
+              << error_precio << ", " << error_vol * 100 << " puntos de volatilidad\n";
+    return error_rho < 1e-6 && error_eta < 1e-6 && error_vol < 2.5e-3 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Benchmark de latencia del ring de resultados entre dos procesos.
+ *
+ * El proceso padre publica registros a un ritmo fijo y un proceso hijo los lee
+ * con espera activa; se reportan los percentiles de la latencia entre la
+ * publicación y la lectura, y los registros perdidos por vueltas del ring.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/ring_latency.cpp blackscholes/result_ring.cpp \
+ *       blackscholes/latency.cpp -o ring_latency
+ * Uso:
+ *   ./ring_latency [registros] [intervalo_ns]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "blackscholes/latency.hpp"
+#include "blackscholes/result_ring.hpp"
+
+int main(int argc, char* argv[]) {
+    uint64_t cantidad = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    int64_t intervalo = argc > 2 ? std::atoll(argv[2]) : 1000;
+    const std::string nombre = "/blackscholes_bench_" + std::to_string(getpid());
+
+    ResultRingWriter escritor(nombre, 4096);
+    if (!escritor.ok()) {
+        std::cerr << "No se pudo crear el ring " << nombre << std::endl;
+        return 1;
+    }
+
+    pid_t hijo = fork();
+    if (hijo == 0) {
+        ResultRingReader lector(nombre);
+        if (!lector.ok()) {
+            _exit(1);
+        }
+
+        LatencyHistogram histograma;
+        uint64_t perdidos = 0;
+        uint64_t siguiente = 0;
+        ResultRecord registro;
+
+        while (siguiente < cantidad) {
+            ResultRingReader::Estado estado = lector.read(siguiente, registro);
+            if (estado == ResultRingReader::LEIDO) {
+                histograma.record(std::chrono::nanoseconds(monotonicNanos() -
+                                                           registro.publicado_ns));
+                siguiente++;
+            } else if (estado == ResultRingReader::PERDIDO) {
+                uint64_t viejo = lector.oldest();
+                perdidos += viejo - siguiente;
+                siguiente = viejo;
+            }
+        }
+
+        std::cout << "perdidos=" << perdidos << " ";
+        printLatency(std::cout, histograma);
+        std::cout.flush();
+        _exit(0);
+    }
+
+    // Da tiempo a que el hijo se enganche antes de empezar a publicar
+    usleep(100000);
+
+    ResultRecord registro;
+    std::memset(&registro, 0, sizeof(registro));
+    std::strcpy(registro.description, "GFGC1033OC");
+    std::strcpy(registro.kind, "CALL");
+
+    int64_t proximo = monotonicNanos();
+    for (uint64_t i = 0; i < cantidad; i++) {
+        while (monotonicNanos() < proximo) {
+        }
+        proximo += intervalo;
+
+        registro.strike = 1033;
+        registro.implied_volatility = 0.5 + 1e-6 * static_cast<double>(i % 1000);
+        escritor.publish(registro);
+    }
+
+    int estado = 0;
+    waitpid(hijo, &estado, 0);
+    return WIFEXITED(estado) ? WEXITSTATUS(estado) : 1;
+}
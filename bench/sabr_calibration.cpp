@@ -0,0 +1,97 @@
+/**
+ * @file
+ * @brief Tiempos de la calibración de SABR con y sin warm start.
+ *
+ * Genera una serie de sonrisas por vencimiento, un minuto cada una, con
+ * parámetros que se mueven de a poco y un ruido determinístico de 0,1 punto
+ * de volatilidad. Las calibra dos veces con calibrateSabrSlices: en bloques
+ * de minutos seguidos (cada ajuste parte del anterior) y con bloques de un
+ * minuto (todos parten de initialSabrGuess). Se reporta el tiempo, las
+ * iteraciones y el error de los parámetros recuperados.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/sabr_calibration.cpp blackscholes/sabr.cpp \
+ *       -o sabr_calibration
+ * Uso:
+ *   ./sabr_calibration [minutos] [vencimientos] [strikes] [hilos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "blackscholes/sabr.hpp"
+
+int main(int argc, char* argv[]) {
+    size_t minutos = argc > 1 ? std::max(1, std::atoi(argv[1])) : 390;
+    size_t vencimientos = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    size_t cantidad_strikes = argc > 3 ? std::max(3, std::atoi(argv[3])) : 15;
+    size_t hilos = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+    const double S = 1182.0;
+    const double r = std::log(2.0);
+    SabrCalibrationConfig config = defaultSabrCalibration();
+
+    std::vector<SabrSlice> sonrisas;
+    std::vector<SabrParams> verdaderos;
+    uint64_t semilla = 12345;
+    for (size_t v = 0; v < vencimientos; v++) {
+        double T = 0.05 + 0.2 * static_cast<double>(v);
+        for (size_t m = 0; m < minutos; m++) {
+            double fase = static_cast<double>(m) / minutos;
+            SabrParams p{0.45 + 0.05 * std::sin(6.0 * fase), config.beta,
+                         -0.4 + 0.1 * std::cos(4.0 * fase), 1.2 - 0.3 * fase};
+            SabrSlice sonrisa;
+            sonrisa.created_at = std::to_string(m);
+            sonrisa.expiration_date = std::to_string(v + 1) + "/10/2023";
+            sonrisa.T = T;
+            sonrisa.F = S * std::exp(r * T) * (1.0 + 0.01 * std::sin(10.0 * fase));
+            for (size_t k = 0; k < cantidad_strikes; k++) {
+                double fraccion = static_cast<double>(k) / (cantidad_strikes - 1);
+                double K = sonrisa.F * std::exp((fraccion - 0.5) * 0.6);
+                semilla = semilla * 6364136223846793005ULL + 1442695040888963407ULL;
+                double ruido = (static_cast<double>(semilla >> 11) / 9007199254740992.0 - 0.5) *
+                               0.002;
+                sonrisa.strikes.push_back(K);
+                sonrisa.iv.push_back(sabrVolatility(sonrisa.F, K, T, p) + ruido);
+            }
+            sonrisas.push_back(sonrisa);
+            verdaderos.push_back(p);
+        }
+    }
+
+    Scheduler scheduler(hilos);
+    for (size_t bloque : {config.bloque, size_t(1)}) {
+        config.bloque = bloque;
+        auto inicio = std::chrono::steady_clock::now();
+        std::vector<SabrFit> ajustes = calibrateSabrSlices(sonrisas, config, scheduler);
+        double segundos =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+        double rmse_maximo = 0.0;
+        double error_parametros = 0.0;
+        size_t iteraciones = 0;
+        for (size_t s = 0; s < sonrisas.size(); s++) {
+            const SabrParams& a = ajustes[s].parametros;
+            const SabrParams& p = verdaderos[s];
+            rmse_maximo = std::max(rmse_maximo, ajustes[s].rmse);
+            error_parametros = std::max({error_parametros, std::fabs(a.alpha - p.alpha),
+                                         std::fabs(a.rho - p.rho), std::fabs(a.nu - p.nu)});
+            iteraciones += ajustes[s].iteraciones;
+        }
+        std::cout << (bloque > 1 ? "Warm start (bloques de " + std::to_string(bloque) + ")"
+                                 : std::string("Sin warm start"))
+                  << ": " << segundos * 1e3 << " ms, "
+                  << segundos * 1e6 * static_cast<double>(hilos) / sonrisas.size()
+                  << " us por sonrisa e hilo, "
+                  << static_cast<double>(iteraciones) / sonrisas.size()
+                  << " iteraciones en promedio, RMSE máximo " << rmse_maximo
+                  << ", error máximo de parámetros " << error_parametros << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief Validación y tiempos del chequeo de arbitraje estático.
+ *
+ * Genera filas de opciones de compra y de venta con precios de una
+ * superficie SSVI sin arbitraje (varios minutos, vencimientos y strikes
+ * enteros) y les invierte la volatilidad con el pricer de su tipo, como el
+ * pipeline. Agrega filas de un tipo desconocido, que no se tienen que
+ * chequear, y chequea todo: no tiene que marcar ninguna. Después sube la
+ * volatilidad de algunas filas (mariposa) y baja la de otras por debajo de la
+ * varianza total del vencimiento anterior (calendario), y reporta cuántas de
+ * esas filas se marcan, de compra y de venta. También mide las filas por
+ * segundo.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O3 -pthread -I. bench/static_arbitrage.cpp blackscholes/arbitrage.cpp \
+ *       blackscholes/ssvi.cpp blackscholes/pricing.cpp -o static_arbitrage
+ * Uso:
+ *   ./static_arbitrage [minutos] [vencimientos] [hilos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "blackscholes/arbitrage.hpp"
+#include "blackscholes/pricing.hpp"
+#include "blackscholes/ssvi.hpp"
+
+int main(int argc, char* argv[]) {
+    size_t minutos = argc > 1 ? std::max(1, std::atoi(argv[1])) : 390;
+    size_t vencimientos = argc > 2 ? std::max(2, std::atoi(argv[2])) : 4;
+    size_t hilos = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
+
+    const double S = 1182.0;
+    const RateCurve curva(1.0);
+
+    SsviSurface superficie;
+    superficie.parametros.rho = -0.4;
+    superficie.parametros.eta = 1.2;
+    superficie.parametros.gamma = 0.5;
+    for (size_t v = 0; v < vencimientos; v++) {
+        double T = 0.05 * std::pow(2.0, static_cast<double>(v));
+        double atm = 0.35 + 0.05 * T;
+        superficie.plazos.push_back(T);
+        superficie.thetas.push_back(atm * atm * T);
+    }
+
+    // Strikes enteros de 10 en 10 entre el 70% y el 130% del subyacente
+    std::vector<OptionData> dataframe;
+    for (size_t m = 0; m < minutos; m++) {
+        std::string created_at = "10/18/2023 " + std::to_string(10 + m / 60) + ":" +
+                                 (m % 60 < 10 ? "0" : "") + std::to_string(m % 60);
+        for (const char* tipo : {"CALL", "PUT"}) {
+            for (size_t v = 0; v < vencimientos; v++) {
+                double T = superficie.plazos[v];
+                double F = S * std::exp(curva.continuous(T) * T);
+                const double r = curva.continuous(T);
+                const bool call = tipo[0] == 'C';
+                for (int K = 830; K <= 1540; K += 10) {
+                    OptionData fila{};
+                    fila.description = std::string(tipo) + std::to_string(K);
+                    fila.strike = K;
+                    fila.kind = tipo;
+                    fila.created_at = created_at;
+                    fila.expiration_date = std::to_string(v + 1) + "/01/2024";
+                    fila.under_price = S;
+                    fila.expiration = T;
+                    double sigma = superficie.impliedVolatility(std::log(K / F), T);
+                    fila.price = call ? blackScholesCall(S, K, T, r, sigma)
+                                      : blackScholesPut(S, K, T, r, sigma);
+                    auto invertir = call ? findImpliedVolatility : findImpliedVolatilityPut;
+                    fila.implied_volatility =
+                        invertir(S, K, T, r, fila.price, 0.00001, 5, 1e-10, 200);
+                    fila.validez = csv::ALL_VALID;
+                    if (fila.implied_volatility < 0) {
+                        fila.validez &= ~(1u << csv::IMPLIED_VOLATILITY);
+                    }
+                    dataframe.push_back(fila);
+                }
+            }
+        }
+    }
+
+    // Tipo desconocido con la volatilidad de la opción de compra: queda sin chequear
+    const size_t conocidas = dataframe.size();
+    for (size_t i = 0; i < conocidas; i++) {
+        if (dataframe[i].kind == "CALL") {
+            OptionData fila = dataframe[i];
+            fila.kind = "FUT";
+            dataframe.push_back(fila);
+        }
+    }
+
+    Scheduler scheduler(hilos);
+    ArbitrageConfig config = defaultArbitrageConfig();
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<ArbitrageCheck> limpios = checkStaticArbitrage(dataframe, curva, config,
+                                                               scheduler);
+    double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    size_t falsos = 0;
+    size_t chequeadas = 0;
+    size_t desconocidas = 0;
+    for (size_t i = 0; i < limpios.size(); i++) {
+        const ArbitrageCheck& chequeo = limpios[i];
+        falsos += (chequeo.banderas & (arbitrage::BUTTERFLY | arbitrage::CALENDAR)) ? 1 : 0;
+        chequeadas += (chequeo.banderas & arbitrage::CHECKED) ? 1 : 0;
+        desconocidas += (i >= conocidas && (chequeo.banderas & arbitrage::CHECKED)) ? 1 : 0;
+    }
+
+    // Violaciones en filas interiores elegidas con un LCG (reproducible)
+    const size_t por_sonrisa = 72;
+    uint64_t semilla = 2023;
+    std::vector<size_t> mariposas;
+    std::vector<size_t> calendarios;
+    for (size_t s = 0; s < conocidas / por_sonrisa; s++) {
+        semilla = semilla * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t v = s % vencimientos;  // Sonrisas en orden minuto, tipo, vencimiento
+        bool mariposa = s % 2 == 0 || v == 0;
+        // El calendario solo se chequea dentro de los k del vencimiento anterior,
+        // cuyo forward es menor: se eligen strikes de la mitad de arriba
+        size_t desde = mariposa ? 5 : por_sonrisa / 2;
+        size_t i = s * por_sonrisa + desde + (semilla >> 33) % (por_sonrisa - 5 - desde);
+        OptionData& fila = dataframe[i];
+        if (mariposa) {
+            fila.implied_volatility *= 1.3;
+            mariposas.push_back(i);
+        } else {
+            // 80% de la varianza total del vencimiento anterior en el mismo k
+            double T = superficie.plazos[v];
+            double F = S * std::exp(curva.continuous(T) * T);
+            double k = std::log(fila.strike / F);
+            double anterior = superficie.totalVariance(k, superficie.plazos[v - 1]);
+            fila.implied_volatility = std::sqrt(0.8 * anterior / T);
+            calendarios.push_back(i);
+        }
+    }
+    std::vector<ArbitrageCheck> sucios = checkStaticArbitrage(dataframe, curva, config,
+                                                              scheduler);
+    size_t mariposas_marcadas = 0;
+    size_t calendarios_marcados = 0;
+    size_t puts = 0;
+    size_t puts_marcados = 0;
+    for (size_t i : mariposas) {
+        bool marcada = sucios[i].banderas & arbitrage::BUTTERFLY;
+        mariposas_marcadas += marcada ? 1 : 0;
+        puts += dataframe[i].kind == "PUT" ? 1 : 0;
+        puts_marcados += (marcada && dataframe[i].kind == "PUT") ? 1 : 0;
+    }
+    for (size_t i : calendarios) {
+        bool marcado = sucios[i].banderas & arbitrage::CALENDAR;
+        calendarios_marcados += marcado ? 1 : 0;
+        puts += dataframe[i].kind == "PUT" ? 1 : 0;
+        puts_marcados += (marcado && dataframe[i].kind == "PUT") ? 1 : 0;
+    }
+
+    std::cout << "Filas: " << dataframe.size() << " (" << minutos << " minutos, "
+              << vencimientos << " vencimientos, " << hilos << " hilos)\n";
+    std::cout << "Superficie sin arbitraje: " << falsos << " filas marcadas, " << chequeadas
+              << " chequeadas (" << desconocidas << " de tipo desconocido)\n";
+    std::cout << "Mariposas detectadas: " << mariposas_marcadas << " de " << mariposas.size()
+              << ", calendarios: " << calendarios_marcados << " de " << calendarios.size()
+              << " (de venta: " << puts_marcados << " de " << puts << ")\n";
+    std::cout << "Tiempo: " << segundos * 1e3 << " ms ("
+              << static_cast<double>(dataframe.size()) / segundos / 1e6 << " M filas/s)\n";
+    bool completo = falsos == 0 && desconocidas == 0 && puts > 0 &&
+                    mariposas_marcadas == mariposas.size() &&
+                    calendarios_marcados == calendarios.size();
+    return completo ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * @brief Validación y latencia del índice de varianza estilo VIX.
+ *
+ * Genera cadenas de opciones de compra y de venta con precios de
+ * Black-Scholes (una volatilidad plana por vencimiento y el subyacente que se
+ * mueve minuto a minuto) y las pasa fila por fila a VarianceIndexBuilder, en
+ * orden de llegada. Con volatilidad plana la varianza de cada vencimiento es
+ * sigma^2, así que el índice tiene que dar la interpolación de esas varianzas
+ * salvo por la discretización de los strikes. En las alas hay cotizaciones
+ * con bid nulo y, más afuera, algunas con precios absurdos que la regla de
+ * los dos bids nulos tiene que dejar afuera. Reporta el error del índice y
+ * del forward y la latencia de cada minuto.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/variance_index.cpp blackscholes/variance_index.cpp \
+ *       blackscholes/parsing.cpp blackscholes/ticks.cpp blackscholes/pricing.cpp -o variance_index
+ * Uso:
+ *   ./variance_index [minutos] [vencimientos]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "blackscholes/pricing.hpp"
+#include "blackscholes/variance_index.hpp"
+
+int main(int argc, char* argv[]) {
+    size_t minutos = argc > 1 ? std::max(1, std::atoi(argv[1])) : 390;
+    size_t vencimientos = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+
+    const RateCurve curva(1.0);
+    const VarianceIndexConfig config = defaultVarianceIndexConfig();
+    std::vector<double> plazos;
+    std::vector<double> volatilidades;
+    for (size_t v = 0; v < vencimientos; v++) {
+        plazos.push_back(static_cast<double>(14 + 14 * v) / 365.0);
+        volatilidades.push_back(0.20 + 0.02 * static_cast<double>(v));
+    }
+
+    // Índice exacto: varianza total lineal en el plazo, como en el índice
+    double varianza_exacta;
+    size_t siguiente = 0;
+    while (siguiente < vencimientos && plazos[siguiente] <= config.plazo) {
+        siguiente++;
+    }
+    if (siguiente == vencimientos) {
+        varianza_exacta = volatilidades.back() * volatilidades.back();
+    } else if (siguiente == 0) {
+        varianza_exacta = volatilidades.front() * volatilidades.front();
+    } else {
+        double T1 = plazos[siguiente - 1];
+        double T2 = plazos[siguiente];
+        double peso = (config.plazo - T1) / (T2 - T1);
+        double s1 = volatilidades[siguiente - 1];
+        double s2 = volatilidades[siguiente];
+        varianza_exacta = ((1.0 - peso) * T1 * s1 * s1 + peso * T2 * s2 * s2) / config.plazo;
+    }
+    const double indice_exacto = 100.0 * std::sqrt(varianza_exacta);
+
+    VarianceIndexBuilder constructor(curva, config);
+    std::vector<OptionData> cadena;
+    double error_forward = 0.0;
+    double error_indice = 0.0;
+    size_t filas = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (size_t m = 0; m < minutos; m++) {
+        const double S = 1182.0 * (1.0 + 0.02 * std::sin(0.05 * static_cast<double>(m)));
+        std::string created_at = "10/18/2023 " + std::to_string(10 + m / 60) + ":" +
+                                 (m % 60 < 10 ? "0" : "") + std::to_string(m % 60);
+        cadena.clear();
+        for (size_t v = 0; v < vencimientos; v++) {
+            const double T = plazos[v];
+            const double r = curva.continuous(T);
+            for (int K = 100; K <= 3000; K += 5) {
+                double call = blackScholesCall(S, K, T, r, volatilidades[v]);
+                double put = call - S + K * std::exp(-r * T);
+                for (const char* tipo : {"CALL", "PUT"}) {
+                    bool es_call = tipo[0] == 'C';
+                    double medio = es_call ? call : put;
+                    OptionData fila{};
+                    fila.strike = K;
+                    fila.kind = tipo;
+                    fila.created_at = created_at;
+                    fila.expiration_date = std::to_string(v + 1) + "/11/2023";
+                    fila.expiration = T;
+                    fila.under_price = S;
+                    fila.validez = csv::ALL_VALID;
+                    // Con menos de medio tick no hay bid; en las puntas, precios absurdos
+                    bool absurdo = (es_call && K >= 2900) || (!es_call && K <= 150);
+                    if (absurdo) {
+                        fila.bid = 50.0;
+                        fila.ask = 51.0;
+                    } else if (medio < 0.05) {
+                        fila.bid = 0.0;
+                        fila.ask = 0.1;
+                    } else {
+                        fila.bid = medio - 0.05;
+                        fila.ask = medio + 0.05;
+                    }
+                    cadena.push_back(fila);
+                }
+            }
+        }
+        for (const OptionData& fila : cadena) {
+            constructor.add(fila);
+        }
+        filas += cadena.size();
+    }
+    constructor.flush();
+    double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    const std::vector<VarianceIndex>& indices = constructor.results();
+    std::vector<double> latencias;
+    for (size_t m = 0; m < indices.size(); m++) {
+        const VarianceIndex& indice = indices[m];
+        latencias.push_back(indice.latencia * 1e6);
+        error_indice = std::max(error_indice, std::fabs(indice.indice - indice_exacto));
+        const double S = 1182.0 * (1.0 + 0.02 * std::sin(0.05 * static_cast<double>(m)));
+        for (size_t v = 0; v < indice.vencimientos.size(); v++) {
+            double F = S * std::exp(curva.continuous(plazos[v]) * plazos[v]);
+            error_forward = std::max(error_forward, std::fabs(indice.vencimientos[v].F / F - 1.0));
+        }
+    }
+    bool completos = indices.size() == minutos;
+    for (const VarianceIndex& indice : indices) {
+        completos = completos && indice.vencimientos.size() == vencimientos;
+    }
+    std::sort(latencias.begin(), latencias.end());
+    auto percentil = [&latencias](double p) {
+        return latencias.empty() ? 0.0
+                                 : latencias[static_cast<size_t>(p * (latencias.size() - 1))];
+    };
+
+    std::cout << "Minutos: " << indices.size() << " de " << minutos << ", " << vencimientos
+              << " vencimientos, " << filas << " filas\n";
+    std::cout << "Índice exacto " << indice_exacto << ", error máximo " << error_indice
+              << " puntos; error relativo del forward " << error_forward << "\n";
+    std::cout << "Latencia por minuto: p50 " << percentil(0.5) << " us, p99 " << percentil(0.99)
+              << " us, máximo " << percentil(1.0) << " us\n";
+    std::cout << "Total: " << segundos * 1e3 << " ms ("
+              << static_cast<double>(filas) / segundos / 1e6 << " M filas/s)\n";
+    bool correcto = completos && error_indice < 0.05 && error_forward < 1e-9;
+    return correcto ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file
+ * @brief Prueba de estrés y throughput del snapshot de la superficie de volatilidad.
+ *
+ * Un escritor publica superficies en las que todas las celdas valen el número
+ * de versión, mientras varios lectores las copian y verifican que ninguna copia
+ * mezcle dos versiones (lectura rota). Se reportan lecturas y escrituras por
+ * segundo, y como referencia las mismas cifras protegiendo la superficie con un mutex.
+ * Antes verifica que CALL y PUT del mismo strike ocupen celdas distintas y que
+ * las celdas sin cotización queden sin valor al insertar strikes y vencimientos.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -pthread -I. bench/vol_surface_stress.cpp -o vol_surface_stress
+ * Uso:
+ *   ./vol_surface_stress [lectores] [segundos]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "blackscholes/vol_surface.hpp"
+
+namespace {
+
+const size_t VENCIMIENTOS = 4;
+const size_t STRIKES = 64;
+
+/**
+ * @brief Arma la grilla de prueba con todas las celdas iguales a valor.
+ */
+void llenar(VolSurface& superficie, double valor) {
+    for (size_t t = 0; t < VolSurface::TIPOS; t++) {
+        for (size_t i = 0; i < VENCIMIENTOS; i++) {
+            for (size_t j = 0; j < STRIKES; j++) {
+                superficie.iv[t][i][j] = valor;
+                superficie.expiration[t][i][j] = valor;
+            }
+        }
+    }
+}
+
+/**
+ * @return true si todas las celdas de la copia corresponden a su versión.
+ */
+bool consistente(const VolSurface& superficie) {
+    double esperado = static_cast<double>(superficie.version);
+    for (size_t t = 0; t < VolSurface::TIPOS; t++) {
+        for (size_t i = 0; i < VENCIMIENTOS; i++) {
+            for (size_t j = 0; j < STRIKES; j++) {
+                if (superficie.iv[t][i][j] != esperado ||
+                    superficie.expiration[t][i][j] != esperado) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @return true si las celdas de cada tipo se guardan por separado y las
+ *         celdas sin cotización no tienen valor, también después de correr
+ *         filas y columnas (strikes a ambos lados de la palabra de validez).
+ */
+bool celdasCorrectas() {
+    std::unique_ptr<VolSurface> superficie(new VolSurface());
+    superficie->clear();
+    bool correcto = true;
+    for (int k = 127; k >= 0; k -= 2) {
+        correcto = correcto && superficie->set(0, 20231020, 1000.0 + k, 0.2, 0.1);
+    }
+    correcto = correcto && superficie->set(1, 20231020, 1063.0, 0.3, 0.1) &&
+               superficie->set(0, 20231117, 1000.0, 0.25, 0.2) &&
+               superficie->set(1, 20230915, 1001.0, 0.35, 0.05);
+
+    double volatilidad = 0.0;
+    for (int k = 0; k < 128; k++) {
+        bool call = superficie->volatility(0, 20231020, 1000.0 + k, volatilidad);
+        correcto = correcto && call == (k % 2 == 1) && (!call || volatilidad == 0.2);
+    }
+    correcto = correcto && superficie->volatility(1, 20231020, 1063.0, volatilidad) &&
+               volatilidad == 0.3 && !superficie->volatility(1, 20231020, 1061.0, volatilidad) &&
+               superficie->volatility(0, 20231117, 1000.0, volatilidad) && volatilidad == 0.25 &&
+               !superficie->volatility(0, 20231117, 1001.0, volatilidad) &&
+               superficie->volatility(1, 20230915, 1001.0, volatilidad) && volatilidad == 0.35 &&
+               !superficie->volatility(0, 20230915, 1001.0, volatilidad);
+    return correcto;
+}
+
+struct Resultado {
+    uint64_t escrituras;
+    uint64_t lecturas;
+    uint64_t rotas;
+};
+
+/**
+ * @brief Corre un escritor y varios lectores durante la duración pedida.
+ *
+ * @param publicar Publica una superficie con la versión indicada.
+ * @param leer Copia la última superficie publicada; devuelve su versión.
+ */
+template <typename Publicar, typename Leer>
+Resultado correr(size_t lectores, std::chrono::milliseconds duracion, Publicar publicar,
+                 Leer leer) {
+    std::atomic<bool> detener(false);
+    std::atomic<uint64_t> lecturas(0);
+    std::atomic<uint64_t> rotas(0);
+    uint64_t escrituras = 0;
+
+    std::vector<std::thread> hilos;
+    for (size_t i = 0; i < lectores; i++) {
+        hilos.emplace_back([&]() {
+            // La superficie es grande para la pila de un hilo, mejor en el heap
+            std::unique_ptr<VolSurface> copia(new VolSurface());
+            uint64_t propias = 0;
+            uint64_t propias_rotas = 0;
+            while (!detener.load(std::memory_order_relaxed)) {
+                if (leer(*copia) == 0) {
+                    continue;
+                }
+                propias++;
+                if (!consistente(*copia)) {
+                    propias_rotas++;
+                }
+            }
+            lecturas += propias;
+            rotas += propias_rotas;
+        });
+    }
+
+    std::unique_ptr<VolSurface> trabajo(new VolSurface());
+    trabajo->clear();
+    for (size_t i = 0; i < VENCIMIENTOS; i++) {
+        for (size_t j = 0; j < STRIKES; j++) {
+            for (size_t t = 0; t < VolSurface::TIPOS; t++) {
+                trabajo->set(t, 20231020 + static_cast<int>(i), 900.0 + 10.0 * j, 0, 0);
+            }
+        }
+    }
+
+    auto fin = std::chrono::steady_clock::now() + duracion;
+    while (std::chrono::steady_clock::now() < fin) {
+        llenar(*trabajo, static_cast<double>(escrituras + 1));
+        publicar(*trabajo, escrituras + 1);
+        escrituras++;
+    }
+
+    detener = true;
+    for (std::thread& hilo : hilos) {
+        hilo.join();
+    }
+
+    Resultado resultado = {escrituras, lecturas.load(), rotas.load()};
+    return resultado;
+}
+
+void reportar(const char* nombre, const Resultado& resultado, double segundos) {
+    std::cout << nombre << ": escrituras/s=" << resultado.escrituras / segundos
+              << " lecturas/s=" << resultado.lecturas / segundos
+              << " lecturas rotas=" << resultado.rotas << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t lectores = argc > 1 ? static_cast<size_t>(std::max(1, std::atoi(argv[1]))) : 3;
+    double segundos = argc > 2 ? std::atof(argv[2]) : 2.0;
+    std::chrono::milliseconds duracion(static_cast<long>(segundos * 1000));
+
+    bool celdas = celdasCorrectas();
+    std::cout << "Celdas por tipo y validez: " << (celdas ? "bien" : "MAL") << "\n";
+
+    VolSurfaceSnapshot snapshot;
+    Resultado seqlock = correr(
+        lectores, duracion,
+        [&](const VolSurface& superficie, uint64_t) { snapshot.publish(superficie); },
+        [&](VolSurface& copia) { return snapshot.read(copia); });
+    reportar("seqlock", seqlock, segundos);
+
+    // Referencia: la misma superficie protegida con un mutex
+    std::mutex mutex;
+    std::unique_ptr<VolSurface> compartida(new VolSurface());
+    compartida->clear();
+    Resultado con_mutex = correr(
+        lectores, duracion,
+        [&](const VolSurface& superficie, uint64_t version) {
+            std::lock_guard<std::mutex> lock(mutex);
+            *compartida = superficie;
+            compartida->version = version;
+        },
+        [&](VolSurface& copia) {
+            std::lock_guard<std::mutex> lock(mutex);
+            copia = *compartida;
+            return copia.version;
+        });
+    reportar("mutex", con_mutex, segundos);
+
+    return celdas && seqlock.rotas == 0 ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+#include "arbitrage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+
+#include "pricing.hpp"
+
+namespace {
+
+/**
+ * @brief Buffers de una tarea, que se reusan entre minutos.
+ */
+struct Workspace {
+    std::vector<double> strikes;
+    std::vector<double> precios;
+    std::vector<double> k;
+    std::vector<double> w;
+    std::vector<double> mariposa;
+    std::vector<double> calendario;
+    std::vector<double> k_anterior;  // Vencimiento anterior del mismo tipo
+    std::vector<double> w_anterior;
+};
+
+/**
+ * @brief Exceso de cada precio sobre la cuerda de sus vecinos (strikes ordenados).
+ *
+ * Los extremos y los strikes repetidos quedan en 0.
+ */
+void butterflyExcess(const double* K, const double* C, size_t n, double* exceso) {
+    if (n == 0) {
+        return;
+    }
+    exceso[0] = 0.0;
+    exceso[n - 1] = 0.0;
+    // C_i - cuerda = (ancho C_i - derecha C_{i-1} - izquierda C_{i+1}) / ancho. Sin
+    // comparaciones ni divisiones condicionales, para que con -O3 se vectorice
+    for (size_t i = 1; i + 1 < n; i++) {
+        double izquierda = K[i] - K[i - 1];
+        double derecha = K[i + 1] - K[i];
+        double ancho = izquierda + derecha;
+        double escalado = ancho * C[i] - derecha * C[i - 1] - izquierda * C[i + 1];
+        exceso[i] = std::max(escalado, 0.0) / std::max(ancho, 1e-300);
+    }
+    // Con un strike repetido la "mariposa" compara dos cotizaciones del mismo contrato
+    for (size_t i = 1; i < n; i++) {
+        if (K[i] == K[i - 1]) {
+            exceso[i] = 0.0;
+            exceso[i - 1] = 0.0;
+        }
+    }
+}
+
+/**
+ * @brief Exceso de la varianza total del vencimiento anterior, interpolada en
+ *        el k de cada fila; 0 fuera del rango de k del anterior.
+ *
+ * Los dos arreglos de k están ordenados, así que se recorren juntos.
+ */
+void calendarExcess(const double* k, const double* w, size_t n, const double* k_anterior,
+                    const double* w_anterior, size_t m, double* exceso) {
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++) {
+        exceso[i] = 0.0;
+        if (m == 0 || k[i] < k_anterior[0] || k[i] > k_anterior[m - 1]) {
+            continue;
+        }
+        while (j + 2 < m && k_anterior[j + 1] < k[i]) {
+            j++;
+        }
+        double anterior = w_anterior[j];
+        if (j + 1 < m && k_anterior[j + 1] > k_anterior[j]) {
+            double peso = (k[i] - k_anterior[j]) / (k_anterior[j + 1] - k_anterior[j]);
+            anterior += peso * (w_anterior[j + 1] - w_anterior[j]);
+        }
+        exceso[i] = std::max(anterior - w[i], 0.0);
+    }
+}
+
+/**
+ * @brief Chequea las filas de un minuto.
+ */
+void checkMinute(const std::vector<OptionData>& dataframe, std::vector<size_t>& filas,
+                 const RateCurve& curva, const ArbitrageConfig& config, Workspace& espacio,
+                 std::vector<ArbitrageCheck>& chequeos) {
+    std::sort(filas.begin(), filas.end(), [&dataframe](size_t a, size_t b) {
+        const OptionData& x = dataframe[a];
+        const OptionData& y = dataframe[b];
+        if (x.kind != y.kind) {
+            return x.kind < y.kind;
+        }
+        if (x.expiration != y.expiration) {
+            return x.expiration < y.expiration;
+        }
+        if (x.expiration_date != y.expiration_date) {
+            return x.expiration_date < y.expiration_date;
+        }
+        return x.strike < y.strike;
+    });
+
+    size_t inicio = 0;
+    while (inicio < filas.size()) {
+        // Sonrisa: mismo tipo y vencimiento
+        const OptionData& primera = dataframe[filas[inicio]];
+        size_t fin = inicio + 1;
+        while (fin < filas.size() && dataframe[filas[fin]].kind == primera.kind &&
+               dataframe[filas[fin]].expiration_date == primera.expiration_date) {
+            fin++;
+        }
+        bool nuevo_tipo = inicio == 0 || dataframe[filas[inicio - 1]].kind != primera.kind;
+        if (nuevo_tipo) {
+            espacio.k_anterior.clear();
+            espacio.w_anterior.clear();
+        }
+
+        const size_t n = fin - inicio;
+        const double S = primera.under_price;
+        const double T = primera.expiration;
+        const double r = curva.continuous(T);
+        const double F = S * std::exp(r * T);
+        const bool call = primera.kind == "CALL";
+        espacio.strikes.resize(n);
+        espacio.precios.resize(n);
+        espacio.k.resize(n);
+        espacio.w.resize(n);
+        espacio.mariposa.resize(n);
+        espacio.calendario.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            const OptionData& fila = dataframe[filas[inicio + i]];
+            double K = fila.strike;
+            double iv = fila.implied_volatility;
+            espacio.strikes[i] = K;
+            espacio.precios[i] = call ? blackScholesCall(S, K, T, r, iv)
+                                      : blackScholesPut(S, K, T, r, iv);
+            espacio.k[i] = std::log(K / F);
+            espacio.w[i] = iv * iv * T;
+        }
+
+        butterflyExcess(espacio.strikes.data(), espacio.precios.data(), n,
+                        espacio.mariposa.data());
+        calendarExcess(espacio.k.data(), espacio.w.data(), n, espacio.k_anterior.data(),
+                       espacio.w_anterior.data(), espacio.k_anterior.size(),
+                       espacio.calendario.data());
+
+        const double tolerancia_precio = config.tolerancia_precio * S;
+        for (size_t i = 0; i < n; i++) {
+            ArbitrageCheck& chequeo = chequeos[filas[inicio + i]];
+            chequeo.banderas = arbitrage::CHECKED;
+            chequeo.mariposa = espacio.mariposa[i];
+            chequeo.calendario = espacio.calendario[i];
+            if (chequeo.mariposa > tolerancia_precio) {
+                chequeo.banderas |= arbitrage::BUTTERFLY;
+            }
+            if (chequeo.calendario > config.tolerancia_varianza) {
+                chequeo.banderas |= arbitrage::CALENDAR;
+            }
+        }
+
+        espacio.k_anterior.swap(espacio.k);
+        espacio.w_anterior.swap(espacio.w);
+        inicio = fin;
+    }
+}
+
+}  // namespace
+
+ArbitrageConfig defaultArbitrageConfig() {
+    ArbitrageConfig config;
+    config.tolerancia_precio = 1e-6;
+    config.tolerancia_varianza = 1e-6;
+    config.bloque = 8;
+    return config;
+}
+
+std::vector<ArbitrageCheck> checkStaticArbitrage(const std::vector<OptionData>& dataframe,
+                                                 const RateCurve& curva,
+                                                 const ArbitrageConfig& config,
+                                                 Scheduler& scheduler) {
+    std::vector<ArbitrageCheck> chequeos(dataframe.size(), ArbitrageCheck{0, 0.0, 0.0});
+
+    // Filas de cada minuto, en el orden de aparición
+    std::vector<std::vector<size_t>> minutos;
+    std::unordered_map<std::string, size_t> posiciones;
+    for (size_t i = 0; i < dataframe.size(); i++) {
+        // Solo los tipos cuya volatilidad sale del pricer que corresponde
+        const OptionData& fila = dataframe[i];
+        if (!usableForSmile(fila) || !(fila.kind == "CALL" || fila.kind == "PUT")) {
+            continue;
+        }
+        auto it = posiciones.emplace(fila.created_at, minutos.size()).first;
+        if (it->second == minutos.size()) {
+            minutos.emplace_back();
+        }
+        minutos[it->second].push_back(i);
+    }
+
+    // Cada minuto escribe solo sus filas
+    scheduler.parallelFor(minutos.size(), std::max<size_t>(1, config.bloque),
+                          [&](size_t desde, size_t hasta) {
+                              Workspace espacio;
+                              for (size_t m = desde; m < hasta; m++) {
+                                  checkMinute(dataframe, minutos[m], curva, config, espacio,
+                                              chequeos);
+                              }
+                          });
+    return chequeos;
+}
+
+bool saveArbitrageChecks(const std::vector<OptionData>& dataframe,
+                         const std::vector<ArbitrageCheck>& chequeos, const std::string& archivo) {
+    std::ofstream salida(archivo);
+    if (!salida) {
+        return false;
+    }
+    salida << "Description,Created At,Expiration,Strike,Kind,Butterfly,Butterfly Excess,"
+              "Calendar,Calendar Excess\n";
+    for (size_t i = 0; i < dataframe.size() && i < chequeos.size(); i++) {
+        const ArbitrageCheck& chequeo = chequeos[i];
+        if (!(chequeo.banderas & arbitrage::CHECKED)) {
+            continue;
+        }
+        const OptionData& fila = dataframe[i];
+        salida << fila.description << ',' << fila.created_at << ',' << fila.expiration_date
+               << ',' << fila.strike << ',' << fila.kind << ','
+               << ((chequeo.banderas & arbitrage::BUTTERFLY) ? 1 : 0) << ',' << chequeo.mariposa
+               << ',' << ((chequeo.banderas & arbitrage::CALENDAR) ? 1 : 0) << ','
+               << chequeo.calendario << '\n';
+    }
+    return static_cast<bool>(salida);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ * @brief Chequeo de arbitraje estático sobre las volatilidades calculadas.
+ *
+ * Para cada minuto, tipo de opción (CALL o PUT) y vencimiento, las
+ * volatilidades se pasan a precios con la fórmula de Black-Scholes del tipo
+ * de la fila, la misma con la que se invirtieron, y se verifica:
+ *
+ * - Mariposa: el precio (de compra o de venta) es convexo en el strike. Con
+ *   tres strikes seguidos el del medio no puede quedar por encima de la
+ *   cuerda entre los otros dos.
+ * - Calendario: la varianza total iv^2 T no baja con el plazo a log-moneyness
+ *   k = ln(K / F) fija. Cada fila se compara con el vencimiento anterior,
+ *   interpolado linealmente en k (solo dentro de sus strikes).
+ *
+ * Los minutos se reparten en el scheduler. Cada sonrisa se copia a arreglos
+ * contiguos (strike, precio, k, varianza total): el chequeo de mariposa es un
+ * lazo sin ramas que el compilador vectoriza (con -O3) y el de calendario
+ * recorre los dos vencimientos ordenados a la vez.
+ */
+
+#ifndef BLACKSCHOLES_ARBITRAGE_HPP
+#define BLACKSCHOLES_ARBITRAGE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "scheduler.hpp"
+
+namespace arbitrage {
+
+/**
+ * @brief Bits de ArbitrageCheck::banderas.
+ */
+const uint8_t CHECKED = 1;    // La fila tiene volatilidad y entró en el chequeo
+const uint8_t BUTTERFLY = 2;  // Centro de una mariposa con precio negativo
+const uint8_t CALENDAR = 4;   // Varianza total menor que la del vencimiento anterior
+
+}  // namespace arbitrage
+
+/**
+ * @brief Resultado del chequeo de una fila.
+ */
+struct ArbitrageCheck {
+    uint8_t banderas;
+    double mariposa;    // Exceso del precio sobre la cuerda de los strikes vecinos (o 0)
+    double calendario;  // Exceso de la varianza total del vencimiento anterior (o 0)
+};
+
+/**
+ * @brief Tolerancias por debajo de las cuales un exceso no se marca.
+ */
+struct ArbitrageConfig {
+    double tolerancia_precio;    // Fracción del subyacente
+    double tolerancia_varianza;  // Varianza total
+    size_t bloque;               // Minutos por tarea del scheduler
+};
+
+ArbitrageConfig defaultArbitrageConfig();
+
+/**
+ * @brief Chequea las filas CALL y PUT que usableForSmile acepta.
+ *
+ * @return Un resultado por fila del dataframe; las filas que no se chequean
+ *         quedan sin banderas.
+ */
+std::vector<ArbitrageCheck> checkStaticArbitrage(const std::vector<OptionData>& dataframe,
+                                                 const RateCurve& curva,
+                                                 const ArbitrageConfig& config,
+                                                 Scheduler& scheduler);
+
+/**
+ * @brief Escribe un CSV con el resultado de cada fila chequeada.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveArbitrageChecks(const std::vector<OptionData>& dataframe,
+                         const std::vector<ArbitrageCheck>& chequeos, const std::string& archivo);
+
+#endif // BLACKSCHOLES_ARBITRAGE_HPP
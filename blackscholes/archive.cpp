@@ -0,0 +1,929 @@
+#include "archive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "async_io.hpp"
+#include "parsing.hpp"
+#include "ticks.hpp"
+
+namespace {
+
+const size_t kEncabezado = 16;
+const size_t kFinal = 16;
+
+void appendU32(std::string& salida, uint32_t valor) {
+    for (int i = 0; i < 4; i++) {
+        salida.push_back(static_cast<char>(valor >> (8 * i)));
+    }
+}
+
+void appendU64(std::string& salida, uint64_t valor) {
+    for (int i = 0; i < 8; i++) {
+        salida.push_back(static_cast<char>(valor >> (8 * i)));
+    }
+}
+
+uint32_t loadU32(const uint8_t* datos) {
+    uint32_t valor = 0;
+    for (int i = 3; i >= 0; i--) {
+        valor = (valor << 8) | datos[i];
+    }
+    return valor;
+}
+
+uint64_t loadU64(const uint8_t* datos) {
+    uint64_t valor = 0;
+    for (int i = 7; i >= 0; i--) {
+        valor = (valor << 8) | datos[i];
+    }
+    return valor;
+}
+
+uint64_t mascara(int bits) {
+    return bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+}
+
+/**
+ * @brief Escribe valores de cualquier cantidad de bits, del más significativo al menos.
+ */
+class BitWriter {
+public:
+    BitWriter() : acumulador_(0), usados_(0) {}
+
+    void write(uint64_t valor, int bits) {
+        while (bits > 0) {
+            int tomar = std::min(bits, 64 - usados_);
+            uint64_t parte = (valor >> (bits - tomar)) & mascara(tomar);
+            acumulador_ = tomar == 64 ? parte : (acumulador_ << tomar) | parte;
+            usados_ += tomar;
+            bits -= tomar;
+
+            if (usados_ == 64) {
+                for (int i = 7; i >= 0; i--) {
+                    bytes_.push_back(static_cast<char>(acumulador_ >> (8 * i)));
+                }
+                acumulador_ = 0;
+                usados_ = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Completa el último byte con ceros y devuelve los bytes escritos.
+     */
+    std::string finish() {
+        if (usados_ > 0) {
+            uint64_t resto = acumulador_ << (64 - usados_);
+            for (int i = 0; i < (usados_ + 7) / 8; i++) {
+                bytes_.push_back(static_cast<char>(resto >> (56 - 8 * i)));
+            }
+            acumulador_ = 0;
+            usados_ = 0;
+        }
+        return std::move(bytes_);
+    }
+
+private:
+    std::string bytes_;
+    uint64_t acumulador_;
+    int usados_;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* datos, size_t bytes)
+        : datos_(datos), bits_(bytes * 8), posicion_(0), error_(false) {}
+
+    uint64_t read(int bits) {
+        if (posicion_ + static_cast<size_t>(bits) > bits_) {
+            error_ = true;
+            return 0;
+        }
+
+        uint64_t valor = 0;
+        while (bits > 0) {
+            int desplazamiento = static_cast<int>(posicion_ & 7);
+            int disponibles = 8 - desplazamiento;
+            int tomar = std::min(bits, disponibles);
+            uint64_t parte = (datos_[posicion_ >> 3] >> (disponibles - tomar)) & mascara(tomar);
+            valor = (valor << tomar) | parte;
+            posicion_ += static_cast<size_t>(tomar);
+            bits -= tomar;
+        }
+        return valor;
+    }
+
+    bool error() const {
+        return error_;
+    }
+
+private:
+    const uint8_t* datos_;
+    size_t bits_;
+    size_t posicion_;
+    bool error_;
+};
+
+/**
+ * @brief Enteros con delta-of-delta: 1 bit si la diferencia es constante,
+ *        y pocos bits si cambia poco (como las cotizaciones de a un minuto).
+ */
+std::string encodeIntegers(const std::vector<int64_t>& valores) {
+    BitWriter escritor;
+    if (valores.empty()) {
+        return escritor.finish();
+    }
+
+    escritor.write(static_cast<uint64_t>(valores[0]), 64);
+    uint64_t delta_anterior = 0;
+    for (size_t i = 1; i < valores.size(); i++) {
+        // Aritmética sin signo: las restas que desbordan dan la vuelta sin comportamiento indefinido
+        uint64_t delta = static_cast<uint64_t>(valores[i]) - static_cast<uint64_t>(valores[i - 1]);
+        int64_t dod = static_cast<int64_t>(delta - delta_anterior);
+        delta_anterior = delta;
+
+        if (dod == 0) {
+            escritor.write(0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            escritor.write(0b10, 2);
+            escritor.write(static_cast<uint64_t>(dod + 63), 7);
+        } else if (dod >= -255 && dod <= 256) {
+            escritor.write(0b110, 3);
+            escritor.write(static_cast<uint64_t>(dod + 255), 9);
+        } else if (dod >= -2047 && dod <= 2048) {
+            escritor.write(0b1110, 4);
+            escritor.write(static_cast<uint64_t>(dod + 2047), 12);
+        } else {
+            escritor.write(0b1111, 4);
+            escritor.write(static_cast<uint64_t>(dod), 64);
+        }
+    }
+    return escritor.finish();
+}
+
+bool decodeIntegers(const uint8_t* datos, size_t bytes, size_t cantidad,
+                    std::vector<int64_t>& valores) {
+    valores.resize(cantidad);
+    if (cantidad == 0) {
+        return true;
+    }
+
+    BitReader lector(datos, bytes);
+    valores[0] = static_cast<int64_t>(lector.read(64));
+    uint64_t delta = 0;
+    for (size_t i = 1; i < cantidad; i++) {
+        int64_t dod;
+        if (lector.read(1) == 0) {
+            dod = 0;
+        } else if (lector.read(1) == 0) {
+            dod = static_cast<int64_t>(lector.read(7)) - 63;
+        } else if (lector.read(1) == 0) {
+            dod = static_cast<int64_t>(lector.read(9)) - 255;
+        } else if (lector.read(1) == 0) {
+            dod = static_cast<int64_t>(lector.read(12)) - 2047;
+        } else {
+            dod = static_cast<int64_t>(lector.read(64));
+        }
+        delta += static_cast<uint64_t>(dod);
+        valores[i] = static_cast<int64_t>(static_cast<uint64_t>(valores[i - 1]) + delta);
+    }
+    return !lector.error();
+}
+
+/**
+ * @brief Doubles con XOR contra el valor anterior (Gorilla): los valores que
+ *        cambian poco comparten el exponente y los bits altos de la mantisa.
+ */
+std::string encodeDoubles(const std::vector<double>& valores) {
+    BitWriter escritor;
+    if (valores.empty()) {
+        return escritor.finish();
+    }
+
+    uint64_t anterior;
+    std::memcpy(&anterior, &valores[0], sizeof(anterior));
+    escritor.write(anterior, 64);
+
+    int ceros_izquierda = -1;  // Ventana de bits significativos del último XOR
+    int ceros_derecha = 0;
+    for (size_t i = 1; i < valores.size(); i++) {
+        uint64_t actual;
+        std::memcpy(&actual, &valores[i], sizeof(actual));
+        uint64_t x = actual ^ anterior;
+        anterior = actual;
+
+        if (x == 0) {
+            escritor.write(0, 1);
+            continue;
+        }
+
+        int izquierda = std::min(__builtin_clzll(x), 31);
+        int derecha = __builtin_ctzll(x);
+
+        if (ceros_izquierda >= 0 && izquierda >= ceros_izquierda && derecha >= ceros_derecha) {
+            // Entra en la ventana anterior: no hace falta repetirla
+            escritor.write(0b10, 2);
+            escritor.write(x >> ceros_derecha, 64 - ceros_izquierda - ceros_derecha);
+        } else {
+            int significativos = 64 - izquierda - derecha;
+            escritor.write(0b11, 2);
+            escritor.write(static_cast<uint64_t>(izquierda), 5);
+            escritor.write(static_cast<uint64_t>(significativos - 1), 6);
+            escritor.write(x >> derecha, significativos);
+            ceros_izquierda = izquierda;
+            ceros_derecha = derecha;
+        }
+    }
+    return escritor.finish();
+}
+
+bool decodeDoubles(const uint8_t* datos, size_t bytes, size_t cantidad,
+                   std::vector<double>& valores) {
+    valores.resize(cantidad);
+    if (cantidad == 0) {
+        return true;
+    }
+
+    BitReader lector(datos, bytes);
+    uint64_t anterior = lector.read(64);
+    std::memcpy(&valores[0], &anterior, sizeof(double));
+
+    int ceros_izquierda = 0;
+    int ceros_derecha = 0;
+    for (size_t i = 1; i < cantidad; i++) {
+        if (lector.read(1) == 1) {
+            uint64_t x;
+            if (lector.read(1) == 0) {
+                x = lector.read(64 - ceros_izquierda - ceros_derecha) << ceros_derecha;
+            } else {
+                ceros_izquierda = static_cast<int>(lector.read(5));
+                int significativos = static_cast<int>(lector.read(6)) + 1;
+                ceros_derecha = 64 - ceros_izquierda - significativos;
+                if (ceros_derecha < 0) {
+                    return false;
+                }
+                x = lector.read(significativos) << ceros_derecha;
+            }
+            anterior ^= x;
+        }
+        std::memcpy(&valores[i], &anterior, sizeof(double));
+    }
+    return !lector.error();
+}
+
+const uint8_t kSinPuntoFijo = 0xff;
+
+/**
+ * @brief Precios: como están en una grilla de ticks, casi siempre son decimales
+ *        cortos y se guardan como enteros en punto fijo con delta-of-delta.
+ *
+ * Formato: decimales u8 y los enteros, o kSinPuntoFijo y los doubles con XOR
+ * si algún valor no se recupera exacto con a lo sumo ticks::MAX_DECIMALES
+ * decimales (por ejemplo, un promedio interpolado).
+ */
+std::string encodePrices(const std::vector<double>& valores) {
+    std::vector<int64_t> enteros(valores.size());
+    for (int decimales = 0; decimales <= ticks::MAX_DECIMALES; decimales++) {
+        const TickSize unidad = {1, decimales};
+        const double escala = static_cast<double>(ticks::POTENCIAS[decimales]);
+        bool exacto = true;
+        for (size_t i = 0; exacto && i < valores.size(); i++) {
+            double escalado = valores[i] * escala;
+            // Enteros que un double representa exactamente
+            exacto = std::fabs(escalado) < 9.0e15;
+            if (exacto) {
+                enteros[i] = std::llround(escalado);
+                double recuperado = ticksToDouble(enteros[i], unidad);
+                exacto = std::memcmp(&recuperado, &valores[i], sizeof(double)) == 0;
+            }
+        }
+
+        if (exacto) {
+            std::string salida(1, static_cast<char>(decimales));
+            return salida + encodeIntegers(enteros);
+        }
+    }
+
+    std::string salida(1, static_cast<char>(kSinPuntoFijo));
+    return salida + encodeDoubles(valores);
+}
+
+bool decodePrices(const uint8_t* datos, size_t bytes, size_t cantidad,
+                  std::vector<double>& valores) {
+    if (bytes == 0) {
+        valores.clear();
+        return cantidad == 0;
+    }
+    if (datos[0] == kSinPuntoFijo) {
+        return decodeDoubles(datos + 1, bytes - 1, cantidad, valores);
+    }
+    if (datos[0] > ticks::MAX_DECIMALES) {
+        return false;
+    }
+
+    const TickSize unidad = {1, datos[0]};
+    std::vector<int64_t> enteros;
+    if (!decodeIntegers(datos + 1, bytes - 1, cantidad, enteros)) {
+        return false;
+    }
+    valores.resize(cantidad);
+    for (size_t i = 0; i < cantidad; i++) {
+        valores[i] = ticksToDouble(enteros[i], unidad);
+    }
+    return true;
+}
+
+int bitsPara(size_t cantidad) {
+    int bits = 0;
+    while ((size_t(1) << bits) < cantidad) {
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * @brief Textos con un diccionario por bloque: cantidad u32, textos (largo u32
+ *        y bytes) e índices empaquetados con los bits justos.
+ */
+std::string encodeStrings(const std::vector<const std::string*>& valores) {
+    std::map<std::string, uint32_t> posiciones;
+    std::vector<const std::string*> diccionario;
+    std::vector<uint32_t> indices(valores.size());
+
+    for (size_t i = 0; i < valores.size(); i++) {
+        auto it = posiciones.find(*valores[i]);
+        if (it == posiciones.end()) {
+            it = posiciones.emplace(*valores[i], static_cast<uint32_t>(diccionario.size())).first;
+            diccionario.push_back(valores[i]);
+        }
+        indices[i] = it->second;
+    }
+
+    std::string salida;
+    appendU32(salida, static_cast<uint32_t>(diccionario.size()));
+    for (const std::string* texto : diccionario) {
+        appendU32(salida, static_cast<uint32_t>(texto->size()));
+        salida += *texto;
+    }
+
+    int bits = bitsPara(diccionario.size());
+    BitWriter escritor;
+    for (uint32_t indice : indices) {
+        escritor.write(indice, bits);
+    }
+    salida += escritor.finish();
+    return salida;
+}
+
+bool decodeStrings(const uint8_t* datos, size_t bytes, size_t cantidad,
+                   std::vector<std::string>& valores) {
+    if (bytes < 4) {
+        return cantidad == 0;
+    }
+
+    uint32_t entradas = loadU32(datos);
+    size_t posicion = 4;
+    std::vector<std::string> diccionario;
+    diccionario.reserve(entradas);
+    for (uint32_t i = 0; i < entradas; i++) {
+        if (posicion + 4 > bytes) {
+            return false;
+        }
+        uint32_t largo = loadU32(datos + posicion);
+        posicion += 4;
+        if (posicion + largo > bytes) {
+            return false;
+        }
+        diccionario.emplace_back(reinterpret_cast<const char*>(datos + posicion), largo);
+        posicion += largo;
+    }
+
+    int bits = bitsPara(entradas);
+    BitReader lector(datos + posicion, bytes - posicion);
+    valores.resize(cantidad);
+    for (size_t i = 0; i < cantidad; i++) {
+        uint64_t indice = lector.read(bits);
+        if (indice >= entradas) {
+            return false;
+        }
+        valores[i] = diccionario[indice];
+    }
+    return !lector.error();
+}
+
+std::string encodeBits(const std::vector<bool>& valores) {
+    BitWriter escritor;
+    for (bool valor : valores) {
+        escritor.write(valor ? 1 : 0, 1);
+    }
+    return escritor.finish();
+}
+
+bool decodeBits(const uint8_t* datos, size_t bytes, size_t cantidad, std::vector<bool>& valores) {
+    BitReader lector(datos, bytes);
+    valores.resize(cantidad);
+    for (size_t i = 0; i < cantidad; i++) {
+        valores[i] = lector.read(1) != 0;
+    }
+    return !lector.error();
+}
+
+/**
+ * @brief Codifica las filas [desde, hasta) como un bloque.
+ */
+std::string encodeBlock(const std::vector<OptionData>& df, size_t desde, size_t hasta,
+                        int64_t& minimo, int64_t& maximo) {
+    size_t filas = hasta - desde;
+    std::vector<std::string> columnas(archive::COLUMN_COUNT);
+
+    std::vector<const std::string*> textos(filas);
+    auto codificarTextos = [&](std::string OptionData::*campo) {
+        for (size_t i = 0; i < filas; i++) {
+            textos[i] = &(df[desde + i].*campo);
+        }
+        return encodeStrings(textos);
+    };
+    columnas[archive::DESCRIPTION] = codificarTextos(&OptionData::description);
+    columnas[archive::KIND] = codificarTextos(&OptionData::kind);
+    columnas[archive::EXPIRATION_DATE] = codificarTextos(&OptionData::expiration_date);
+
+    std::vector<double> numeros(filas);
+    auto codificarDoubles = [&](double OptionData::*campo) {
+        for (size_t i = 0; i < filas; i++) {
+            numeros[i] = df[desde + i].*campo;
+        }
+        return encodeDoubles(numeros);
+    };
+    auto codificarPrecios = [&](double OptionData::*campo) {
+        for (size_t i = 0; i < filas; i++) {
+            numeros[i] = df[desde + i].*campo;
+        }
+        return encodePrices(numeros);
+    };
+    columnas[archive::BID] = codificarPrecios(&OptionData::bid);
+    columnas[archive::ASK] = codificarPrecios(&OptionData::ask);
+    columnas[archive::UNDER_BID] = codificarPrecios(&OptionData::under_bid);
+    columnas[archive::UNDER_ASK] = codificarPrecios(&OptionData::under_ask);
+    columnas[archive::PRICE] = codificarDoubles(&OptionData::price);
+    columnas[archive::INTRINSIC_VALUE] = codificarDoubles(&OptionData::intrinsic_value);
+    columnas[archive::EXTRINSIC_VALUE] = codificarDoubles(&OptionData::extrinsic_value);
+    columnas[archive::UNDER_PRICE] = codificarDoubles(&OptionData::under_price);
+    columnas[archive::IMPLIED_VOLATILITY] = codificarDoubles(&OptionData::implied_volatility);
+    columnas[archive::UNDER_VOLATILITY] = codificarDoubles(&OptionData::under_volatility);
+    columnas[archive::EXPIRATION] = codificarDoubles(&OptionData::expiration);
+
+    std::vector<int64_t> enteros(filas);
+    for (size_t i = 0; i < filas; i++) {
+        enteros[i] = df[desde + i].strike;
+    }
+    columnas[archive::STRIKE] = encodeIntegers(enteros);
+
+    for (size_t i = 0; i < filas; i++) {
+        enteros[i] = static_cast<int64_t>(df[desde + i].error);
+    }
+    columnas[archive::ERROR_CODE] = encodeIntegers(enteros);
+
+    for (size_t i = 0; i < filas; i++) {
+        enteros[i] = static_cast<int64_t>(df[desde + i].validez);
+    }
+    columnas[archive::VALIDITY] = encodeIntegers(enteros);
+
+    // Fechas: la columna numérica repite la fecha anterior en las filas cuya
+    // fecha no se puede reconstruir, que se guardan tal cual aparte
+    std::string excepciones;
+    uint32_t cantidad_excepciones = 0;
+    int64_t anterior = 0;
+    minimo = std::numeric_limits<int64_t>::max();
+    maximo = std::numeric_limits<int64_t>::min();
+    for (size_t i = 0; i < filas; i++) {
+        const std::string& created_at = df[desde + i].created_at;
+        int64_t segundos;
+        if (parseTimestamp(created_at, segundos) && formatTimestamp(segundos) == created_at) {
+            enteros[i] = anterior = segundos;
+            minimo = std::min(minimo, segundos);
+            maximo = std::max(maximo, segundos);
+        } else {
+            enteros[i] = anterior;
+            appendU32(excepciones, static_cast<uint32_t>(i));
+            appendU32(excepciones, static_cast<uint32_t>(created_at.size()));
+            excepciones += created_at;
+            cantidad_excepciones++;
+        }
+    }
+    columnas[archive::CREATED_AT] = encodeIntegers(enteros);
+    appendU32(columnas[archive::CREATED_AT_RAW], cantidad_excepciones);
+    columnas[archive::CREATED_AT_RAW] += excepciones;
+
+    std::vector<bool> marcas(filas);
+    for (size_t i = 0; i < filas; i++) {
+        marcas[i] = df[desde + i].iv_outlier;
+    }
+    columnas[archive::IV_OUTLIER] = encodeBits(marcas);
+    for (size_t i = 0; i < filas; i++) {
+        marcas[i] = df[desde + i].under_vol_outlier;
+    }
+    columnas[archive::UNDER_VOL_OUTLIER] = encodeBits(marcas);
+
+    std::string bloque;
+    appendU32(bloque, static_cast<uint32_t>(filas));
+    appendU32(bloque, archive::COLUMN_COUNT);
+    for (const std::string& columna : columnas) {
+        appendU32(bloque, static_cast<uint32_t>(columna.size()));
+    }
+    for (const std::string& columna : columnas) {
+        bloque += columna;
+    }
+    return bloque;
+}
+
+}  // namespace
+
+namespace archive {
+
+std::string encodeIndex(const std::vector<BlockInfo>& bloques) {
+    std::string salida;
+    for (const BlockInfo& entrada : bloques) {
+        appendU64(salida, entrada.offset);
+        appendU64(salida, entrada.bytes);
+        appendU32(salida, entrada.filas);
+        appendU32(salida, 0);
+        appendU64(salida, static_cast<uint64_t>(entrada.desde));
+        appendU64(salida, static_cast<uint64_t>(entrada.hasta));
+    }
+    return salida;
+}
+
+void decodeIndex(const uint8_t* datos, size_t cantidad, std::vector<BlockInfo>& bloques) {
+    bloques.resize(cantidad);
+    for (size_t b = 0; b < cantidad; b++) {
+        const uint8_t* entrada = datos + b * INDEX_ENTRY_BYTES;
+        bloques[b].offset = loadU64(entrada);
+        bloques[b].bytes = loadU64(entrada + 8);
+        bloques[b].filas = loadU32(entrada + 16);
+        bloques[b].desde = static_cast<int64_t>(loadU64(entrada + 24));
+        bloques[b].hasta = static_cast<int64_t>(loadU64(entrada + 32));
+    }
+}
+
+bool sortedByTime(const std::vector<BlockInfo>& bloques) {
+    for (size_t b = 0; b < bloques.size(); b++) {
+        // Un bloque sin fechas válidas (desde > hasta) también impide la bisección
+        if (bloques[b].desde > bloques[b].hasta ||
+            (b > 0 && bloques[b].desde < bloques[b - 1].hasta)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<size_t> blocksInRange(const std::vector<BlockInfo>& bloques, bool ordenado,
+                                  int64_t desde, int64_t hasta) {
+    std::vector<size_t> resultado;
+
+    if (ordenado) {
+        // Primer bloque que termina en o después de desde
+        auto it = std::lower_bound(bloques.begin(), bloques.end(), desde,
+                                   [](const BlockInfo& bloque, int64_t valor) {
+                                       return bloque.hasta < valor;
+                                   });
+        for (; it != bloques.end() && it->desde <= hasta; ++it) {
+            resultado.push_back(static_cast<size_t>(it - bloques.begin()));
+        }
+        return resultado;
+    }
+
+    for (size_t b = 0; b < bloques.size(); b++) {
+        if (bloques[b].desde <= hasta && bloques[b].hasta >= desde) {
+            resultado.push_back(b);
+        }
+    }
+    return resultado;
+}
+
+}  // namespace archive
+
+bool writeArchive(const std::vector<OptionData>& dataframe, const std::filesystem::path& archivo,
+                  Scheduler* scheduler, size_t filas_por_bloque) {
+    AsyncFileWriter salida(archivo);
+    if (!salida.ok()) {
+        return false;
+    }
+
+    filas_por_bloque = std::max<size_t>(1, filas_por_bloque);
+    size_t cantidad = (dataframe.size() + filas_por_bloque - 1) / filas_por_bloque;
+    std::vector<std::string> bloques(cantidad);
+    std::vector<archive::BlockInfo> indice(cantidad);
+
+    auto codificar = [&](size_t desde, size_t hasta) {
+        for (size_t b = desde; b < hasta; b++) {
+            size_t primera = b * filas_por_bloque;
+            size_t ultima = std::min(dataframe.size(), primera + filas_por_bloque);
+            bloques[b] = encodeBlock(dataframe, primera, ultima, indice[b].desde, indice[b].hasta);
+            indice[b].filas = static_cast<uint32_t>(ultima - primera);
+            indice[b].bytes = bloques[b].size();
+        }
+    };
+    if (scheduler == nullptr) {
+        codificar(0, cantidad);
+    } else {
+        scheduler->parallelFor(cantidad, 1, codificar);
+    }
+
+    std::string encabezado;
+    appendU32(encabezado, archive::MAGIC);
+    encabezado.push_back(static_cast<char>(archive::VERSION & 0xff));
+    encabezado.push_back(static_cast<char>(archive::VERSION >> 8));
+    encabezado.push_back(static_cast<char>(archive::COLUMN_COUNT & 0xff));
+    encabezado.push_back(static_cast<char>(archive::COLUMN_COUNT >> 8));
+    appendU32(encabezado, static_cast<uint32_t>(filas_por_bloque));
+    appendU32(encabezado, 0);
+    salida.write(encabezado.data(), encabezado.size());
+
+    uint64_t offset = encabezado.size();
+    for (size_t b = 0; b < cantidad; b++) {
+        indice[b].offset = offset;
+        offset += bloques[b].size();
+        salida.write(bloques[b].data(), bloques[b].size());
+        std::string().swap(bloques[b]);
+    }
+
+    std::string final = archive::encodeIndex(indice);
+    appendU64(final, offset);
+    appendU32(final, static_cast<uint32_t>(cantidad));
+    appendU32(final, archive::MAGIC);
+    salida.write(final.data(), final.size());
+
+    return salida.close();
+}
+
+ArchiveReader::ArchiveReader(const std::filesystem::path& archivo)
+    : fd_(open(archivo.c_str(), O_RDONLY | O_CLOEXEC)), tamanio_(0), version_(0),
+      filas_por_bloque_(0), ordenado_(true) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    struct stat estado;
+    uint8_t encabezado[kEncabezado];
+    uint8_t final[kFinal];
+    bool valido = fstat(fd_, &estado) == 0 &&
+                  static_cast<uint64_t>(estado.st_size) >= kEncabezado + kFinal;
+    if (valido) {
+        tamanio_ = static_cast<uint64_t>(estado.st_size);
+        valido = pread(fd_, encabezado, kEncabezado, 0) == static_cast<ssize_t>(kEncabezado) &&
+                 pread(fd_, final, kFinal, static_cast<off_t>(tamanio_ - kFinal)) ==
+                     static_cast<ssize_t>(kFinal) &&
+                 loadU32(encabezado) == archive::MAGIC && loadU32(final + 12) == archive::MAGIC &&
+                 (encabezado[4] | (encabezado[5] << 8)) >= 1 &&
+                 (encabezado[4] | (encabezado[5] << 8)) <= archive::VERSION;
+    }
+
+    uint64_t offset_indice = valido ? loadU64(final) : 0;
+    uint32_t cantidad = valido ? loadU32(final + 8) : 0;
+    valido = valido && offset_indice + uint64_t(cantidad) * archive::INDEX_ENTRY_BYTES + kFinal == tamanio_;
+
+    std::vector<uint8_t> indice(uint64_t(cantidad) * archive::INDEX_ENTRY_BYTES);
+    valido = valido && (indice.empty() ||
+                        pread(fd_, indice.data(), indice.size(), static_cast<off_t>(offset_indice)) ==
+                            static_cast<ssize_t>(indice.size()));
+
+    if (!valido) {
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+
+    version_ = static_cast<uint16_t>(encabezado[4] | (encabezado[5] << 8));
+    filas_por_bloque_ = loadU32(encabezado + 8);
+    archive::decodeIndex(indice.data(), cantidad, bloques_);
+    ordenado_ = archive::sortedByTime(bloques_);
+}
+
+ArchiveReader::~ArchiveReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::vector<size_t> ArchiveReader::blocksInRange(int64_t desde, int64_t hasta) const {
+    return archive::blocksInRange(bloques_, ordenado_, desde, hasta);
+}
+
+bool ArchiveReader::decodeBlock(size_t bloque, std::vector<OptionData>& filas,
+                                uint32_t columnas) const {
+    const archive::BlockInfo& info = bloques_[bloque];
+    if (info.offset + info.bytes > tamanio_ || info.bytes < 8) {
+        return false;
+    }
+
+    // Se mapea solo el bloque, desde el comienzo de su página
+    const uint64_t pagina = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t inicio = info.offset / pagina * pagina;
+    size_t largo = static_cast<size_t>(info.offset + info.bytes - inicio);
+    void* memoria = mmap(nullptr, largo, PROT_READ, MAP_PRIVATE, fd_, static_cast<off_t>(inicio));
+    if (memoria == MAP_FAILED) {
+        return false;
+    }
+    const uint8_t* datos = static_cast<const uint8_t*>(memoria) + (info.offset - inicio);
+
+    size_t cantidad = loadU32(datos);
+    uint32_t cantidad_columnas = loadU32(datos + 4);
+    size_t posicion = 8 + size_t(cantidad_columnas) * 4;
+    // Los bloques de la versión 1 terminan antes de ERROR_CODE
+    bool valido = cantidad == info.filas && cantidad_columnas >= archive::ERROR_CODE &&
+                  cantidad_columnas <= archive::COLUMN_COUNT && posicion <= info.bytes;
+
+    std::vector<size_t> desde(archive::COLUMN_COUNT);
+    std::vector<size_t> bytes(archive::COLUMN_COUNT);
+    for (uint32_t c = 0; valido && c < cantidad_columnas; c++) {
+        bytes[c] = loadU32(datos + 8 + 4 * c);
+        desde[c] = posicion;
+        posicion += bytes[c];
+        valido = posicion <= info.bytes;
+    }
+
+    filas.assign(cantidad, OptionData());
+    auto pedida = [&](archive::Column c) {
+        return ((columnas >> c) & 1) && c < cantidad_columnas;
+    };
+
+    std::vector<std::string> textos;
+    auto decodificarTextos = [&](archive::Column c, std::string OptionData::*campo) {
+        if (!valido || !pedida(c)) {
+            return;
+        }
+        valido = decodeStrings(datos + desde[c], bytes[c], cantidad, textos);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].*campo = std::move(textos[i]);
+        }
+    };
+    decodificarTextos(archive::DESCRIPTION, &OptionData::description);
+    decodificarTextos(archive::KIND, &OptionData::kind);
+    decodificarTextos(archive::EXPIRATION_DATE, &OptionData::expiration_date);
+
+    std::vector<double> numeros;
+    auto decodificarDoubles = [&](archive::Column c, double OptionData::*campo,
+                                  bool precio = false) {
+        if (!valido || !pedida(c)) {
+            return;
+        }
+        // Hasta la versión 3 los precios se guardaban como los demás doubles
+        valido = precio && version_ >= 4
+                     ? decodePrices(datos + desde[c], bytes[c], cantidad, numeros)
+                     : decodeDoubles(datos + desde[c], bytes[c], cantidad, numeros);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].*campo = numeros[i];
+        }
+    };
+    decodificarDoubles(archive::BID, &OptionData::bid, true);
+    decodificarDoubles(archive::ASK, &OptionData::ask, true);
+    decodificarDoubles(archive::UNDER_BID, &OptionData::under_bid, true);
+    decodificarDoubles(archive::UNDER_ASK, &OptionData::under_ask, true);
+    decodificarDoubles(archive::PRICE, &OptionData::price);
+    decodificarDoubles(archive::INTRINSIC_VALUE, &OptionData::intrinsic_value);
+    decodificarDoubles(archive::EXTRINSIC_VALUE, &OptionData::extrinsic_value);
+    decodificarDoubles(archive::UNDER_PRICE, &OptionData::under_price);
+    decodificarDoubles(archive::IMPLIED_VOLATILITY, &OptionData::implied_volatility);
+    decodificarDoubles(archive::UNDER_VOLATILITY, &OptionData::under_volatility);
+    decodificarDoubles(archive::EXPIRATION, &OptionData::expiration);
+
+    std::vector<int64_t> enteros;
+    if (valido && pedida(archive::STRIKE)) {
+        valido = decodeIntegers(datos + desde[archive::STRIKE], bytes[archive::STRIKE], cantidad,
+                                enteros);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].strike = static_cast<int>(enteros[i]);
+        }
+    }
+
+    if (valido && pedida(archive::ERROR_CODE)) {
+        valido = decodeIntegers(datos + desde[archive::ERROR_CODE], bytes[archive::ERROR_CODE],
+                                cantidad, enteros);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            valido = enteros[i] >= 0 && enteros[i] < static_cast<int64_t>(RowError::COUNT);
+            filas[i].error = static_cast<RowError>(enteros[i]);
+        }
+    }
+
+    if (valido && cantidad_columnas > archive::VALIDITY) {
+        valido = decodeIntegers(datos + desde[archive::VALIDITY], bytes[archive::VALIDITY],
+                                cantidad, enteros);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].validez = static_cast<uint32_t>(enteros[i]) & csv::ALL_VALID;
+        }
+    } else {
+        // Antes de la versión 3 faltaba un valor cuando tenía -1
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].validez = csv::ALL_VALID;
+            if (pedida(archive::IMPLIED_VOLATILITY) && filas[i].implied_volatility < 0) {
+                filas[i].validez &= ~(1u << csv::IMPLIED_VOLATILITY);
+            }
+            if (pedida(archive::UNDER_VOLATILITY) && filas[i].under_volatility < 0) {
+                filas[i].validez &= ~(1u << csv::UNDER_VOLATILITY);
+            }
+        }
+    }
+
+    if (valido && pedida(archive::CREATED_AT)) {
+        valido = decodeIntegers(datos + desde[archive::CREATED_AT], bytes[archive::CREATED_AT],
+                                cantidad, enteros);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].created_at = formatTimestamp(enteros[i]);
+        }
+
+        // Las fechas que no se podían reconstruir reemplazan a las calculadas
+        const uint8_t* excepciones = datos + desde[archive::CREATED_AT_RAW];
+        size_t disponibles = bytes[archive::CREATED_AT_RAW];
+        valido = valido && disponibles >= 4;
+        uint32_t total = valido ? loadU32(excepciones) : 0;
+        size_t p = 4;
+        for (uint32_t e = 0; valido && e < total; e++) {
+            valido = p + 8 <= disponibles;
+            if (!valido) {
+                break;
+            }
+            uint32_t fila = loadU32(excepciones + p);
+            uint32_t largo_texto = loadU32(excepciones + p + 4);
+            p += 8;
+            valido = fila < cantidad && p + largo_texto <= disponibles;
+            if (valido) {
+                filas[fila].created_at.assign(reinterpret_cast<const char*>(excepciones + p),
+                                              largo_texto);
+                p += largo_texto;
+            }
+        }
+    }
+
+    std::vector<bool> marcas;
+    if (valido && pedida(archive::IV_OUTLIER)) {
+        valido = decodeBits(datos + desde[archive::IV_OUTLIER], bytes[archive::IV_OUTLIER],
+                            cantidad, marcas);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].iv_outlier = marcas[i];
+        }
+    }
+    if (valido && pedida(archive::UNDER_VOL_OUTLIER)) {
+        valido = decodeBits(datos + desde[archive::UNDER_VOL_OUTLIER],
+                            bytes[archive::UNDER_VOL_OUTLIER], cantidad, marcas);
+        for (size_t i = 0; valido && i < cantidad; i++) {
+            filas[i].under_vol_outlier = marcas[i];
+        }
+    }
+
+    munmap(memoria, largo);
+    return valido;
+}
+
+bool ArchiveReader::read(std::vector<OptionData>& filas, Scheduler& scheduler, int64_t desde,
+                         int64_t hasta, uint32_t columnas) const {
+    bool con_rango = desde != std::numeric_limits<int64_t>::min() ||
+                     hasta != std::numeric_limits<int64_t>::max();
+
+    std::vector<size_t> seleccion;
+    if (con_rango) {
+        seleccion = blocksInRange(desde, hasta);
+        // Para filtrar por fecha hace falta la fecha
+        columnas |= 1u << archive::CREATED_AT;
+    } else {
+        for (size_t b = 0; b < bloques_.size(); b++) {
+            seleccion.push_back(b);
+        }
+    }
+
+    std::vector<std::vector<OptionData>> parciales(seleccion.size());
+    std::vector<char> correctos(seleccion.size(), 0);
+    scheduler.parallelFor(seleccion.size(), 1, [&](size_t primero, size_t ultimo) {
+        for (size_t i = primero; i < ultimo; i++) {
+            correctos[i] = decodeBlock(seleccion[i], parciales[i], columnas);
+            if (!con_rango) {
+                continue;
+            }
+
+            // Solo las filas del rango (y con fecha válida)
+            std::vector<OptionData>& parcial = parciales[i];
+            parcial.erase(std::remove_if(parcial.begin(), parcial.end(),
+                                         [&](const OptionData& fila) {
+                                             int64_t segundos;
+                                             return !parseTimestamp(fila.created_at, segundos) ||
+                                                    segundos < desde || segundos > hasta;
+                                         }),
+                          parcial.end());
+        }
+    });
+
+    for (size_t i = 0; i < seleccion.size(); i++) {
+        if (!correctos[i]) {
+            return false;
+        }
+        filas.insert(filas.end(), std::make_move_iterator(parciales[i].begin()),
+                     std::make_move_iterator(parciales[i].end()));
+    }
+    return true;
+}
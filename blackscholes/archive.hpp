@@ -0,0 +1,186 @@
+/**
+ * @file
+ * @brief Formato de archivo columnar comprimido (.bsc) para guardar resultados.
+ *
+ * Las filas se agrupan en bloques independientes y, dentro de cada bloque,
+ * cada columna se codifica por separado según su tipo:
+ *
+ *   - Fechas de cotización: segundos con delta-of-delta (Gorilla).
+ *   - Bid y ask (de la opción y del subyacente): enteros en punto fijo con
+ *     delta-of-delta, si todos los valores del bloque son decimales exactos
+ *     (ver ticks.hpp); si no, como los demás doubles.
+ *   - Doubles: XOR con el valor anterior (Gorilla).
+ *   - Textos: diccionario por bloque e índices empaquetados en bits.
+ *   - Strike, código de error y validez: enteros con delta-of-delta. Marcas de
+ *     outliers: un bit por fila.
+ *
+ * Al final del archivo hay un índice con la posición, la cantidad de filas y
+ * las fechas mínima y máxima de cada bloque, así que los bloques se
+ * decodifican en paralelo y una consulta por rango de fechas solo lee los
+ * bloques que se solapan con el rango.
+ *
+ * Estructura (enteros little-endian):
+ *
+ *   Encabezado: magic u32, versión u16, columnas u16, filas por bloque u32, reservado u32
+ *   Bloques:    filas u32, columnas u32, bytes de cada columna u32 x columnas, columnas
+ *   Índice:     por bloque offset u64, bytes u64, filas u32, reservado u32, desde i64, hasta i64
+ *   Final:      offset del índice u64, cantidad de bloques u32, magic u32
+ */
+
+#ifndef BLACKSCHOLES_ARCHIVE_HPP
+#define BLACKSCHOLES_ARCHIVE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "scheduler.hpp"
+
+namespace archive {
+
+const uint32_t MAGIC = 0x41435342;  // "BSCA"
+// La versión 1 no tiene ERROR_CODE, la 2 no tiene VALIDITY y hasta la 3 los
+// precios se guardan como doubles
+const uint16_t VERSION = 4;
+
+/**
+ * @brief Columnas del archivo, en el orden en que se guardan en cada bloque.
+ */
+enum Column : uint32_t {
+    DESCRIPTION,
+    STRIKE,
+    KIND,
+    BID,
+    ASK,
+    UNDER_BID,
+    UNDER_ASK,
+    CREATED_AT,
+    CREATED_AT_RAW,  // Fechas que no se pueden reconstruir desde los segundos
+    EXPIRATION_DATE,
+    PRICE,
+    INTRINSIC_VALUE,
+    EXTRINSIC_VALUE,
+    UNDER_PRICE,
+    IMPLIED_VOLATILITY,
+    UNDER_VOLATILITY,
+    EXPIRATION,
+    IV_OUTLIER,
+    UNDER_VOL_OUTLIER,
+    ERROR_CODE,
+    VALIDITY,        // Máscara de columnas con valor de cada fila (OptionData::validez)
+    COLUMN_COUNT
+};
+
+/**
+ * @brief Entrada del índice de bloques.
+ */
+struct BlockInfo {
+    uint64_t offset;  // Posición del bloque en el archivo
+    uint64_t bytes;
+    uint32_t filas;
+    int64_t desde;    // Fecha mínima del bloque (segundos, ver parseTimestamp)
+    int64_t hasta;    // Fecha máxima del bloque
+};
+
+/**
+ * @brief Máscara con todas las columnas.
+ */
+const uint32_t ALL_COLUMNS = (1u << COLUMN_COUNT) - 1;
+
+const size_t INDEX_ENTRY_BYTES = 40;
+
+/**
+ * @brief Serializa el índice de bloques (también lo usa el índice de los CSV).
+ */
+std::string encodeIndex(const std::vector<BlockInfo>& bloques);
+
+/**
+ * @brief Lee cantidad entradas de índice serializadas con encodeIndex.
+ */
+void decodeIndex(const uint8_t* datos, size_t cantidad, std::vector<BlockInfo>& bloques);
+
+/**
+ * @brief Indica si los bloques están ordenados por fecha y todos tienen fechas.
+ */
+bool sortedByTime(const std::vector<BlockInfo>& bloques);
+
+/**
+ * @brief Bloques que pueden tener filas con fecha en [desde, hasta].
+ *
+ * Si los bloques están ordenados por fecha (un solo archivo de cotizaciones)
+ * se buscan por bisección; si no (por ejemplo varios archivos con --merge),
+ * se recorre el índice.
+ */
+std::vector<size_t> blocksInRange(const std::vector<BlockInfo>& bloques, bool ordenado,
+                                  int64_t desde, int64_t hasta);
+
+}  // namespace archive
+
+/**
+ * @brief Guarda el DataFrame en formato columnar.
+ *
+ * Los bloques se codifican en paralelo si hay un scheduler.
+ *
+ * @param filas_por_bloque Filas de cada bloque del archivo.
+ * @return true si se pudo escribir el archivo.
+ */
+bool writeArchive(const std::vector<OptionData>& dataframe, const std::filesystem::path& archivo,
+                  Scheduler* scheduler, size_t filas_por_bloque = 4096);
+
+/**
+ * @brief Lector de archivos columnares. Mapea en memoria solo los bloques que decodifica.
+ */
+class ArchiveReader {
+public:
+    explicit ArchiveReader(const std::filesystem::path& archivo);
+    ~ArchiveReader();
+
+    ArchiveReader(const ArchiveReader&) = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    bool ok() const {
+        return fd_ >= 0;
+    }
+
+    const std::vector<archive::BlockInfo>& blocks() const {
+        return bloques_;
+    }
+
+    /**
+     * @brief Bloques que pueden tener filas con fecha en [desde, hasta].
+     */
+    std::vector<size_t> blocksInRange(int64_t desde, int64_t hasta) const;
+
+    /**
+     * @brief Decodifica un bloque.
+     *
+     * @param columnas Máscara de bits de archive::Column; las demás quedan vacías.
+     *                 La validez de las filas se decodifica siempre.
+     * @return false si el bloque está corrupto.
+     */
+    bool decodeBlock(size_t bloque, std::vector<OptionData>& filas,
+                     uint32_t columnas = archive::ALL_COLUMNS) const;
+
+    /**
+     * @brief Lee las filas con fecha en [desde, hasta], decodificando los bloques en paralelo.
+     *
+     * Sin rango se devuelven todas las filas, incluso las que no tienen fecha.
+     */
+    bool read(std::vector<OptionData>& filas, Scheduler& scheduler,
+              int64_t desde = std::numeric_limits<int64_t>::min(),
+              int64_t hasta = std::numeric_limits<int64_t>::max(),
+              uint32_t columnas = archive::ALL_COLUMNS) const;
+
+private:
+    int fd_;
+    uint64_t tamanio_;
+    uint16_t version_;
+    uint32_t filas_por_bloque_;
+    bool ordenado_;
+    std::vector<archive::BlockInfo> bloques_;
+};
+
+#endif // BLACKSCHOLES_ARCHIVE_HPP
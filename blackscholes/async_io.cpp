@@ -0,0 +1,550 @@
+#include "async_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define BS_CON_IO_URING 1
+#endif
+#endif
+
+#ifdef BS_CON_IO_URING
+
+/**
+ * @brief Anillos de io_uring mapeados del kernel.
+ */
+struct IoQueue::Uring {
+    /**
+     * @brief Resultado de pasarle al kernel la cola de envío.
+     */
+    enum class Envio { OK, REINTENTAR, ERROR };
+
+    int fd;
+    bool registrados;  // Buffers registrados: se usan READ_FIXED y WRITE_FIXED
+    unsigned sin_enviar;  // Entradas de la cola de envío que el kernel todavía no tomó
+
+    void* sq;
+    size_t sq_bytes;
+    void* cq;
+    size_t cq_bytes;
+    io_uring_sqe* sqes;
+    size_t sqes_bytes;
+
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+
+    Uring() : fd(-1), registrados(false), sin_enviar(0), sq(MAP_FAILED), sq_bytes(0),
+              cq(MAP_FAILED), cq_bytes(0), sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+              sqes_bytes(0) {}
+
+    ~Uring() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_bytes);
+        }
+        if (cq != MAP_FAILED && cq != sq) {
+            munmap(cq, cq_bytes);
+        }
+        if (sq != MAP_FAILED) {
+            munmap(sq, sq_bytes);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    /**
+     * @brief Crea el anillo y registra los buffers.
+     *
+     * @return false si el kernel no soporta (o no permite) io_uring.
+     */
+    bool setup(unsigned entradas, const std::vector<char*>& buffers, size_t tamanio) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entradas, &params));
+        if (fd < 0) {
+            return false;
+        }
+
+        sq_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool un_solo_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (un_solo_mmap) {
+            sq_bytes = cq_bytes = std::max(sq_bytes, cq_bytes);
+        }
+
+        sq = mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                  IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) {
+            return false;
+        }
+        cq = un_solo_mmap ? sq
+                          : mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            return false;
+        }
+
+        sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_bytes, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+
+        char* base_sq = static_cast<char*>(sq);
+        char* base_cq = static_cast<char*>(cq);
+        sq_tail = reinterpret_cast<unsigned*>(base_sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(base_sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(base_sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(base_cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(base_cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(base_cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base_cq + params.cq_off.cqes);
+
+        // Registrar los buffers evita que el kernel los mapee en cada operación.
+        // Puede fallar por RLIMIT_MEMLOCK; en ese caso se usan lecturas comunes.
+        std::vector<iovec> vectores(buffers.size());
+        for (size_t i = 0; i < buffers.size(); i++) {
+            vectores[i].iov_base = buffers[i];
+            vectores[i].iov_len = tamanio;
+        }
+        registrados = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                              vectores.data(), static_cast<unsigned>(vectores.size())) == 0;
+        return true;
+    }
+
+    /**
+     * @brief Envía las entradas pendientes de la cola de envío y, con
+     *        esperar, espera al menos un resultado.
+     *
+     * Sin recursos en el kernel (EAGAIN) o con la cola de resultados llena
+     * (EBUSY) las entradas quedan en la cola de envío y se reenvían en la
+     * próxima llamada.
+     */
+    Envio enter(bool esperar) {
+        while (true) {
+            long enviadas = syscall(__NR_io_uring_enter, fd, sin_enviar, esperar ? 1 : 0,
+                                    esperar ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (enviadas >= 0) {
+                sin_enviar -= static_cast<unsigned>(enviadas);
+                return Envio::OK;
+            }
+            if (errno == EAGAIN || errno == EBUSY) {
+                return Envio::REINTENTAR;
+            }
+            if (errno != EINTR) {
+                return Envio::ERROR;
+            }
+        }
+    }
+
+    /**
+     * @return false si el kernel rechazó el envío con un error que no es transitorio.
+     */
+    bool submit(const IoQueue::Operacion& operacion, char* direccion) {
+        // Un solo productor: la cola de envío nunca se llena porque hay a lo
+        // sumo una operación por buffer y el anillo tiene una entrada por buffer
+        unsigned cola = *sq_tail;
+        unsigned indice = cola & *sq_mask;
+
+        io_uring_sqe* sqe = &sqes[indice];
+        std::memset(sqe, 0, sizeof(*sqe));
+        if (registrados) {
+            sqe->opcode = operacion.escritura ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe->buf_index = static_cast<uint16_t>(operacion.buffer);
+        } else {
+            sqe->opcode = operacion.escritura ? IORING_OP_WRITE : IORING_OP_READ;
+        }
+        sqe->fd = operacion.fd;
+        sqe->off = operacion.offset;
+        sqe->addr = reinterpret_cast<uint64_t>(direccion);
+        sqe->len = static_cast<uint32_t>(operacion.bytes);
+        sqe->user_data = operacion.buffer;
+
+        sq_array[indice] = indice;
+        __atomic_store_n(sq_tail, cola + 1, __ATOMIC_RELEASE);
+        sin_enviar++;
+
+        // Se envía en el momento, para que la operación avance mientras el llamador calcula
+        return enter(false) != Envio::ERROR;
+    }
+
+    /**
+     * @return false si el kernel rechazó la espera con un error que no es transitorio.
+     */
+    bool wait(size_t& buffer, long& resultado) {
+        while (true) {
+            unsigned cabeza = *cq_head;
+            if (cabeza != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes[cabeza & *cq_mask];
+                buffer = static_cast<size_t>(cqe.user_data);
+                resultado = cqe.res;
+                __atomic_store_n(cq_head, cabeza + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            // También reenvía lo que no se pudo enviar antes
+            Envio envio = enter(true);
+            if (envio == Envio::ERROR) {
+                return false;
+            }
+            if (envio == Envio::REINTENTAR) {
+                sched_yield();
+            }
+        }
+    }
+};
+
+#else
+
+struct IoQueue::Uring {};
+
+#endif
+
+IoQueue::IoQueue(size_t cantidad_buffers, size_t tamanio_buffer, bool usar_uring)
+    : tamanio_buffer_(tamanio_buffer), en_vuelo_(0), fallo_(false), detener_(false) {
+    // Buffers alineados a página, como piden las lecturas con O_DIRECT
+    const size_t pagina = 4096;
+    size_t bytes = (tamanio_buffer + pagina - 1) / pagina * pagina;
+    for (size_t i = 0; i < cantidad_buffers; i++) {
+        char* buffer_datos = static_cast<char*>(std::aligned_alloc(pagina, bytes));
+        if (buffer_datos == nullptr) {
+            fallo_ = true;
+            return;
+        }
+        buffers_.push_back(buffer_datos);
+    }
+
+#ifdef BS_CON_IO_URING
+    if (usar_uring) {
+        uring_.reset(new Uring());
+        if (!uring_->setup(static_cast<unsigned>(cantidad_buffers), buffers_, bytes)) {
+            uring_.reset();
+        }
+    }
+#else
+    (void)usar_uring;
+#endif
+
+    if (!uring_) {
+        hilo_ = std::thread(&IoQueue::runFallback, this);
+    }
+}
+
+IoQueue::~IoQueue() {
+    // Las operaciones pendientes escriben en los buffers: hay que esperarlas
+    size_t buffer;
+    long resultado;
+    while (wait(buffer, resultado)) {
+    }
+
+    if (hilo_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            detener_ = true;
+        }
+        hay_pedidos_.notify_one();
+        hilo_.join();
+    }
+
+    // Si io_uring falló puede haber operaciones que el kernel todavía no
+    // terminó: es preferible perder los buffers que liberarlos
+    bool liberar = !(uring_ && fallo_);
+    uring_.reset();
+    if (liberar) {
+        for (char* buffer_datos : buffers_) {
+            std::free(buffer_datos);
+        }
+    }
+}
+
+void IoQueue::read(int fd, size_t i, size_t desde, size_t bytes, uint64_t offset) {
+    Operacion operacion = {false, fd, i, desde, bytes, offset};
+    submit(operacion);
+}
+
+void IoQueue::write(int fd, size_t i, size_t desde, size_t bytes, uint64_t offset) {
+    Operacion operacion = {true, fd, i, desde, bytes, offset};
+    submit(operacion);
+}
+
+void IoQueue::submit(const Operacion& operacion) {
+    if (fallo_) {
+        return;
+    }
+    en_vuelo_++;
+
+#ifdef BS_CON_IO_URING
+    if (uring_) {
+        if (!uring_->submit(operacion, buffers_[operacion.buffer] + operacion.desde)) {
+            fallo_ = true;
+        }
+        return;
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pedidos_.push_back(operacion);
+    }
+    hay_pedidos_.notify_one();
+}
+
+bool IoQueue::wait(size_t& i, long& resultado) {
+    if (en_vuelo_ == 0 || fallo_) {
+        return false;
+    }
+    en_vuelo_--;
+
+#ifdef BS_CON_IO_URING
+    if (uring_) {
+        if (!uring_->wait(i, resultado)) {
+            fallo_ = true;
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    hay_terminados_.wait(lock, [this]() { return !terminados_.empty(); });
+    i = terminados_.front().first;
+    resultado = terminados_.front().second;
+    terminados_.pop_front();
+    return true;
+}
+
+void IoQueue::runFallback() {
+    while (true) {
+        Operacion operacion;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            hay_pedidos_.wait(lock, [this]() { return detener_ || !pedidos_.empty(); });
+            if (pedidos_.empty()) {
+                return;
+            }
+            operacion = pedidos_.front();
+            pedidos_.pop_front();
+        }
+
+        char* direccion = buffers_[operacion.buffer] + operacion.desde;
+        ssize_t resultado;
+        do {
+            resultado = operacion.escritura
+                ? pwrite(operacion.fd, direccion, operacion.bytes,
+                         static_cast<off_t>(operacion.offset))
+                : pread(operacion.fd, direccion, operacion.bytes,
+                        static_cast<off_t>(operacion.offset));
+        } while (resultado < 0 && errno == EINTR);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            terminados_.emplace_back(operacion.buffer, resultado < 0 ? -errno : resultado);
+        }
+        hay_terminados_.notify_one();
+    }
+}
+
+AsyncFileReader::AsyncFileReader(const std::filesystem::path& archivo, size_t profundidad,
+                                 size_t bloque)
+    : fd_(open(archivo.c_str(), O_RDONLY | O_CLOEXEC)), tamanio_(0), bloque_(bloque),
+      cantidad_bloques_(0), siguiente_(0), error_(false), estados_(profundidad),
+      cola_(profundidad, bloque) {
+    if (fd_ < 0) {
+        return;
+    }
+    if (!cola_.ok()) {
+        error_ = true;
+        return;
+    }
+
+    struct stat estado;
+    if (fstat(fd_, &estado) != 0) {
+        error_ = true;
+        return;
+    }
+    tamanio_ = static_cast<uint64_t>(estado.st_size);
+    cantidad_bloques_ = (tamanio_ + bloque_ - 1) / bloque_;
+
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Arranca con todas las lecturas en vuelo
+    for (uint64_t b = 0; b < cantidad_bloques_ && b < estados_.size(); b++) {
+        issue(b);
+    }
+}
+
+AsyncFileReader::~AsyncFileReader() {
+    // Espera las lecturas adelantadas antes de cerrar el descriptor
+    size_t buffer;
+    long resultado;
+    while (cola_.wait(buffer, resultado)) {
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void AsyncFileReader::issue(uint64_t bloque) {
+    size_t i = bloque % estados_.size();
+    uint64_t offset = bloque * bloque_;
+
+    estados_[i].esperados = static_cast<size_t>(std::min<uint64_t>(bloque_, tamanio_ - offset));
+    estados_[i].leidos = 0;
+    estados_[i].listo = false;
+    cola_.read(fd_, i, 0, estados_[i].esperados, offset);
+}
+
+bool AsyncFileReader::next(const char*& datos, size_t& bytes) {
+    if (!ok() || siguiente_ >= cantidad_bloques_) {
+        return false;
+    }
+
+    size_t i = siguiente_ % estados_.size();
+    while (!estados_[i].listo) {
+        size_t buffer;
+        long resultado;
+        if (!cola_.wait(buffer, resultado) || resultado < 0) {
+            error_ = true;
+            return false;
+        }
+
+        Estado& estado = estados_[buffer];
+        estado.leidos += static_cast<size_t>(resultado);
+
+        // Una lectura corta se completa con otra; 0 bytes es que el archivo se achicó
+        uint64_t bloque = siguiente_ + (buffer + estados_.size() - i) % estados_.size();
+        if (resultado > 0 && estado.leidos < estado.esperados) {
+            cola_.read(fd_, buffer, estado.leidos, estado.esperados - estado.leidos,
+                       bloque * bloque_ + estado.leidos);
+        } else {
+            estado.esperados = estado.leidos;
+            estado.listo = true;
+        }
+    }
+
+    datos = cola_.buffer(i);
+    bytes = estados_[i].esperados;
+    return true;
+}
+
+void AsyncFileReader::release() {
+    uint64_t reutiliza = siguiente_ + estados_.size();
+    siguiente_++;
+    if (reutiliza < cantidad_bloques_) {
+        issue(reutiliza);
+    }
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::filesystem::path& archivo, size_t profundidad,
+                                 size_t bloque)
+    : fd_(open(archivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)), offset_(0),
+      actual_(0), llenado_(0), error_(false), estados_(profundidad), cola_(profundidad, bloque) {
+    error_ = !cola_.ok();
+    for (Estado& estado : estados_) {
+        estado.en_vuelo = false;
+    }
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    if (fd_ >= 0) {
+        close();
+    }
+}
+
+bool AsyncFileWriter::write(const char* datos, size_t bytes) {
+    while (bytes > 0 && ok()) {
+        // Si el buffer todavía se está escribiendo, hay que esperar a que se libere
+        while (estados_[actual_].en_vuelo && ok()) {
+            complete();
+        }
+
+        size_t copiar = std::min(bytes, cola_.bufferSize() - llenado_);
+        std::memcpy(cola_.buffer(actual_) + llenado_, datos, copiar);
+        llenado_ += copiar;
+        datos += copiar;
+        bytes -= copiar;
+
+        if (llenado_ == cola_.bufferSize()) {
+            flush();
+        }
+    }
+    return ok();
+}
+
+void AsyncFileWriter::flush() {
+    if (llenado_ == 0) {
+        return;
+    }
+
+    Estado& estado = estados_[actual_];
+    estado.offset = offset_;
+    estado.bytes = llenado_;
+    estado.escritos = 0;
+    estado.en_vuelo = true;
+    cola_.write(fd_, actual_, 0, llenado_, offset_);
+
+    offset_ += llenado_;
+    llenado_ = 0;
+    actual_ = (actual_ + 1) % estados_.size();
+}
+
+bool AsyncFileWriter::complete() {
+    size_t buffer;
+    long resultado;
+    if (!cola_.wait(buffer, resultado)) {
+        error_ = error_ || !cola_.ok();
+        return false;
+    }
+
+    Estado& estado = estados_[buffer];
+    if (resultado <= 0) {
+        error_ = true;
+        estado.en_vuelo = false;
+        return true;
+    }
+
+    // Una escritura corta se completa con otra
+    estado.escritos += static_cast<size_t>(resultado);
+    if (estado.escritos < estado.bytes) {
+        cola_.write(fd_, buffer, estado.escritos, estado.bytes - estado.escritos,
+                    estado.offset + estado.escritos);
+    } else {
+        estado.en_vuelo = false;
+    }
+    return true;
+}
+
+bool AsyncFileWriter::close() {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    if (!error_) {
+        flush();
+    }
+    while (complete()) {
+    }
+
+    if (::close(fd_) != 0) {
+        error_ = true;
+    }
+    fd_ = -1;
+    return !error_;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file
+ * @brief Lectura y escritura de archivos con varias operaciones en vuelo.
+ *
+ * En Linux se usa io_uring (por syscalls, sin liburing) con los buffers
+ * registrados en el kernel. Si io_uring no está disponible (kernel viejo,
+ * deshabilitado por sysctl o por seccomp) se usa pread/pwrite en un hilo de
+ * E/S aparte, que igual deja al hilo que llama libre para calcular.
+ *
+ * Las entradas que io_uring no acepta en el momento (EAGAIN, EBUSY) quedan
+ * en la cola de envío y se reenvían al esperar; un error que no es
+ * transitorio hace fallar la cola y el lector o escritor que la usa.
+ */
+
+#ifndef BLACKSCHOLES_ASYNC_IO_HPP
+#define BLACKSCHOLES_ASYNC_IO_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Cola de lecturas y escrituras asincrónicas sobre un conjunto fijo de buffers.
+ *
+ * Cada operación usa uno de los buffers de la cola, y se identifica por él al
+ * terminar: no puede haber dos operaciones en vuelo sobre el mismo buffer.
+ */
+class IoQueue {
+public:
+    /**
+     * @param cantidad_buffers Cantidad de buffers (y de operaciones en vuelo como máximo).
+     * @param tamanio_buffer Bytes de cada buffer.
+     * @param usar_uring false fuerza el respaldo con pread/pwrite.
+     */
+    IoQueue(size_t cantidad_buffers, size_t tamanio_buffer, bool usar_uring = true);
+    ~IoQueue();
+
+    IoQueue(const IoQueue&) = delete;
+    IoQueue& operator=(const IoQueue&) = delete;
+
+    /**
+     * @return true si las operaciones van por io_uring.
+     */
+    bool usingUring() const {
+        return uring_ != nullptr;
+    }
+
+    char* buffer(size_t i) {
+        return buffers_[i];
+    }
+
+    size_t bufferSize() const {
+        return tamanio_buffer_;
+    }
+
+    size_t buffers() const {
+        return buffers_.size();
+    }
+
+    /**
+     * @return false si no se pudieron reservar los buffers o si io_uring
+     *         rechazó una operación; desde ahí la cola no acepta más operaciones.
+     */
+    bool ok() const {
+        return !fallo_;
+    }
+
+    /**
+     * @brief Encola la lectura de bytes bytes desde offset hacia buffer(i) + desde.
+     */
+    void read(int fd, size_t i, size_t desde, size_t bytes, uint64_t offset);
+
+    /**
+     * @brief Encola la escritura de bytes bytes de buffer(i) + desde en offset.
+     */
+    void write(int fd, size_t i, size_t desde, size_t bytes, uint64_t offset);
+
+    /**
+     * @brief Espera a que termine alguna operación.
+     *
+     * @param i Buffer de la operación terminada.
+     * @param resultado Bytes transferidos, o -errno.
+     * @return false si no había operaciones en vuelo o si la cola falló (ver ok()).
+     */
+    bool wait(size_t& i, long& resultado);
+
+private:
+    struct Uring;
+
+    struct Operacion {
+        bool escritura;
+        int fd;
+        size_t buffer;
+        size_t desde;
+        size_t bytes;
+        uint64_t offset;
+    };
+
+    void submit(const Operacion& operacion);
+    void runFallback();
+
+    size_t tamanio_buffer_;
+    std::vector<char*> buffers_;
+    size_t en_vuelo_;
+    bool fallo_;
+
+    std::unique_ptr<Uring> uring_;
+
+    // Respaldo: un hilo de E/S con pread/pwrite
+    std::thread hilo_;
+    std::mutex mutex_;
+    std::condition_variable hay_pedidos_;
+    std::condition_variable hay_terminados_;
+    std::deque<Operacion> pedidos_;
+    std::deque<std::pair<size_t, long>> terminados_;
+    bool detener_;
+};
+
+/**
+ * @brief Lee un archivo secuencialmente en bloques, con varias lecturas adelantadas.
+ */
+class AsyncFileReader {
+public:
+    /**
+     * @param profundidad Lecturas en vuelo.
+     * @param bloque Bytes por lectura.
+     */
+    explicit AsyncFileReader(const std::filesystem::path& archivo, size_t profundidad = 8,
+                             size_t bloque = 1 << 20);
+    ~AsyncFileReader();
+
+    bool ok() const {
+        return fd_ >= 0 && !error_;
+    }
+
+    uint64_t size() const {
+        return tamanio_;
+    }
+
+    /**
+     * @brief Espera el próximo bloque del archivo.
+     *
+     * El bloque es válido hasta llamar a release(), que además encola la
+     * lectura que reutiliza su buffer.
+     *
+     * @return false al llegar al final del archivo o ante un error (ver ok()).
+     */
+    bool next(const char*& datos, size_t& bytes);
+
+    /**
+     * @brief Libera el bloque que devolvió next().
+     */
+    void release();
+
+private:
+    struct Estado {
+        size_t esperados;  // Bytes del bloque
+        size_t leidos;
+        bool listo;
+    };
+
+    void issue(uint64_t bloque);
+
+    int fd_;
+    uint64_t tamanio_;
+    size_t bloque_;
+    uint64_t cantidad_bloques_;
+    uint64_t siguiente_;
+    bool error_;
+    std::vector<Estado> estados_;
+    IoQueue cola_;
+};
+
+/**
+ * @brief Escribe un archivo secuencialmente, con varias escrituras en vuelo.
+ *
+ * Los datos se copian a los buffers de la cola; cada buffer lleno se escribe
+ * mientras el llamador sigue produciendo datos.
+ */
+class AsyncFileWriter {
+public:
+    explicit AsyncFileWriter(const std::filesystem::path& archivo, size_t profundidad = 8,
+                             size_t bloque = 1 << 20);
+    ~AsyncFileWriter();
+
+    bool ok() const {
+        return fd_ >= 0 && !error_;
+    }
+
+    /**
+     * @brief Agrega datos al final del archivo.
+     */
+    bool write(const char* datos, size_t bytes);
+
+    /**
+     * @brief Escribe lo pendiente, espera todas las escrituras y cierra el archivo.
+     *
+     * @return true si todo se escribió correctamente.
+     */
+    bool close();
+
+private:
+    struct Estado {
+        uint64_t offset;
+        size_t bytes;
+        size_t escritos;
+        bool en_vuelo;
+    };
+
+    void flush();
+    bool complete();
+
+    int fd_;
+    uint64_t offset_;
+    size_t actual_;   // Buffer que se está llenando
+    size_t llenado_;  // Bytes ya copiados al buffer actual
+    bool error_;
+    std::vector<Estado> estados_;
+    IoQueue cola_;
+};
+
+#endif // BLACKSCHOLES_ASYNC_IO_HPP
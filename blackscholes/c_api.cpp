@@ -0,0 +1,428 @@
+#include "c_api.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include "pricing.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <climits>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#define BS_CON_PTHREADS 1
+#endif
+
+namespace {
+
+// Cada hilo de trabajo usa una pila de al menos 64 KB tomada del scratch. La
+// bisección casi no usa pila, pero glibc ubica en ella el descriptor del hilo
+// y el TLS estático, así que se deja margen sobre PTHREAD_STACK_MIN.
+const size_t kPila = 64 * 1024;
+const size_t kLinea = 64;
+const uint64_t kMagia = 0x62735f776f726b73ULL;  // "bs_works"
+
+// Vueltas que un hilo espera activamente antes de dormirse: primero con
+// pause y después cediendo el núcleo, por si hay más hilos que núcleos
+const int kVueltas = 256;
+const int kCesiones = 64;
+// Registros mínimos por hilo: con menos, repartir cuesta más que calcular
+const size_t kMinimoPorHilo = 64;
+
+typedef void (*FuncionRango)(const void* contexto, size_t desde, size_t hasta);
+
+size_t redondearArriba(size_t valor, size_t multiplo) {
+    return (valor + multiplo - 1) / multiplo * multiplo;
+}
+
+#ifdef BS_CON_PTHREADS
+
+/**
+ * @brief Tamaño de página del sistema (4 KB en x86, hasta 64 KB en aarch64 o ppc64).
+ */
+size_t pagina() {
+    static const size_t tamano = [] {
+        long valor = sysconf(_SC_PAGESIZE);
+        return valor > 0 ? static_cast<size_t>(valor) : size_t(4096);
+    }();
+    return tamano;
+}
+
+/**
+ * @brief Pila de cada hilo: kPila, o PTHREAD_STACK_MIN si es mayor (128 KB en
+ *        glibc para aarch64), en páginas enteras.
+ */
+size_t tamanoPila() {
+    size_t minimo = static_cast<size_t>(PTHREAD_STACK_MIN);
+    return redondearArriba(std::max(kPila, minimo), pagina());
+}
+
+struct Trabajadores;
+
+/**
+ * @brief Descriptor de un hilo de trabajo. Vive en el scratch, después del encabezado.
+ */
+struct Trabajo {
+    pthread_t hilo;
+    Trabajadores* trabajadores;
+    size_t indice;  // Bloque del lote que calcula (el 0 es del llamador)
+};
+
+/**
+ * @brief Encabezado de los hilos de trabajo, al principio del scratch.
+ *
+ * Cada lote incrementa la generación; los hilos la esperan activamente un
+ * rato y después duermen en la condición, así que con lotes seguidos no hay
+ * llamadas al sistema. Todos los hilos responden a cada lote, aunque su
+ * bloque quede vacío, así que ninguno puede quedar leyendo un lote viejo.
+ */
+struct Trabajadores {
+    uint64_t magia;
+    Trabajadores* propio;  // Junto con la magia indica que el scratch tiene hilos
+    size_t extras;
+    pthread_mutex_t mutex;
+    pthread_cond_t hay_lote;
+    pthread_cond_t terminado;
+    std::atomic<uint64_t> generacion;
+    std::atomic<size_t> pendientes;
+    bool detener;
+
+    // Lote actual; se escribe antes de incrementar la generación
+    FuncionRango funcion;
+    const void* contexto;
+    size_t n;
+    size_t bloque;  // Los hilos cuyo bloque empieza después de n no calculan nada
+
+    Trabajo* trabajos() {
+        return reinterpret_cast<Trabajo*>(reinterpret_cast<char*>(this) +
+                                          redondearArriba(sizeof(Trabajadores), kLinea));
+    }
+};
+
+size_t tamanoEncabezado(size_t extras) {
+    return redondearArriba(sizeof(Trabajadores), kLinea) + extras * sizeof(Trabajo);
+}
+
+Trabajadores* encabezado(void* scratch) {
+    return reinterpret_cast<Trabajadores*>(
+        redondearArriba(reinterpret_cast<uintptr_t>(scratch), kLinea));
+}
+
+/**
+ * @brief Pilas alineadas a página, después del encabezado.
+ */
+char* pilas(Trabajadores* trabajadores, size_t extras) {
+    uintptr_t fin = reinterpret_cast<uintptr_t>(trabajadores) + tamanoEncabezado(extras);
+    return reinterpret_cast<char*>(redondearArriba(fin, pagina()));
+}
+
+/**
+ * @brief Hilos que arrancó bs_workers_init en el scratch, o nullptr.
+ */
+Trabajadores* trabajadoresDe(void* scratch, size_t scratch_size) {
+    if (scratch == nullptr || scratch_size < bs_scratch_size(2)) {
+        return nullptr;
+    }
+    Trabajadores* trabajadores = encabezado(scratch);
+    if (trabajadores->magia != kMagia || trabajadores->propio != trabajadores) {
+        return nullptr;
+    }
+    return trabajadores;
+}
+
+/**
+ * @brief Espera activamente a que se cumpla la condición, un número acotado de vueltas.
+ */
+template <typename Condicion>
+void esperar(Condicion condicion) {
+    for (int i = 0; i < kVueltas && !condicion(); i++) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    for (int i = 0; i < kCesiones && !condicion(); i++) {
+        sched_yield();
+    }
+}
+
+void calcularBloque(Trabajadores* t, size_t indice) {
+    size_t desde = indice * t->bloque;
+    if (desde < t->n) {
+        t->funcion(t->contexto, desde, (desde + t->bloque < t->n) ? desde + t->bloque : t->n);
+    }
+}
+
+void* ejecutarTrabajo(void* argumento) {
+    Trabajo* trabajo = static_cast<Trabajo*>(argumento);
+    Trabajadores* t = trabajo->trabajadores;
+    uint64_t vista = 0;  // Ningún lote sale antes de que arranquen todos los hilos
+
+    while (true) {
+        esperar([&] { return t->generacion.load(std::memory_order_acquire) != vista; });
+        if (t->generacion.load(std::memory_order_acquire) == vista) {
+            pthread_mutex_lock(&t->mutex);
+            while (t->generacion.load(std::memory_order_acquire) == vista) {
+                pthread_cond_wait(&t->hay_lote, &t->mutex);
+            }
+            pthread_mutex_unlock(&t->mutex);
+        }
+        vista = t->generacion.load(std::memory_order_acquire);
+        if (t->detener) {
+            return nullptr;
+        }
+        calcularBloque(t, trabajo->indice);
+        if (t->pendientes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pthread_mutex_lock(&t->mutex);
+            pthread_cond_signal(&t->terminado);
+            pthread_mutex_unlock(&t->mutex);
+        }
+    }
+}
+
+/**
+ * @brief Termina y espera los primeros `creados` hilos.
+ */
+void detenerTrabajadores(Trabajadores* t, size_t creados) {
+    pthread_mutex_lock(&t->mutex);
+    t->detener = true;
+    t->generacion.fetch_add(1, std::memory_order_release);
+    pthread_cond_broadcast(&t->hay_lote);
+    pthread_mutex_unlock(&t->mutex);
+    for (size_t i = 0; i < creados; i++) {
+        pthread_join(t->trabajos()[i].hilo, nullptr);
+    }
+    pthread_cond_destroy(&t->terminado);
+    pthread_cond_destroy(&t->hay_lote);
+    pthread_mutex_destroy(&t->mutex);
+    t->magia = 0;
+    t->propio = nullptr;
+    t->~Trabajadores();
+}
+
+#endif
+
+/**
+ * @brief Reparte [0, n) entre el hilo del llamador y los hilos del scratch.
+ *
+ * No reserva memoria ni crea hilos: usa los que arrancó bs_workers_init, y
+ * sin ellos el hilo del llamador calcula todo.
+ */
+bs_status repartir(size_t n, uint32_t n_threads, void* scratch, size_t scratch_size,
+                   FuncionRango funcion, const void* contexto) {
+    if (n_threads <= 1 || n < 2) {
+        funcion(contexto, 0, n);
+        return BS_OK;
+    }
+
+#ifdef BS_CON_PTHREADS
+    if (scratch == nullptr || scratch_size < bs_scratch_size(n_threads)) {
+        return BS_ERROR_SCRATCH;
+    }
+
+    Trabajadores* t = trabajadoresDe(scratch, scratch_size);
+    size_t extras = t ? std::min<size_t>(n_threads - 1, t->extras) : 0;
+    extras = std::min(extras, n / kMinimoPorHilo);
+    if (extras == 0) {
+        funcion(contexto, 0, n);
+        return BS_OK;
+    }
+
+    t->funcion = funcion;
+    t->contexto = contexto;
+    t->n = n;
+    t->bloque = (n + extras) / (extras + 1);
+    t->pendientes.store(t->extras, std::memory_order_relaxed);
+    pthread_mutex_lock(&t->mutex);
+    t->generacion.fetch_add(1, std::memory_order_release);
+    pthread_cond_broadcast(&t->hay_lote);
+    pthread_mutex_unlock(&t->mutex);
+
+    // El hilo del llamador calcula el primer bloque y espera a los demás
+    calcularBloque(t, 0);
+    esperar([t] { return t->pendientes.load(std::memory_order_acquire) == 0; });
+    if (t->pendientes.load(std::memory_order_acquire) > 0) {
+        pthread_mutex_lock(&t->mutex);
+        while (t->pendientes.load(std::memory_order_acquire) > 0) {
+            pthread_cond_wait(&t->terminado, &t->mutex);
+        }
+        pthread_mutex_unlock(&t->mutex);
+    }
+    return BS_OK;
+#else
+    funcion(contexto, 0, n);
+    return BS_OK;
+#endif
+}
+
+struct ContextoPrecio {
+    const double *S, *K, *T, *r, *sigma;
+    double* out;
+};
+
+void precioRango(const void* contexto, size_t desde, size_t hasta) {
+    const ContextoPrecio& c = *static_cast<const ContextoPrecio*>(contexto);
+    for (size_t i = desde; i < hasta; i++) {
+        c.out[i] = blackScholesCall(c.S[i], c.K[i], c.T[i], c.r[i], c.sigma[i]);
+    }
+}
+
+struct ContextoVolatilidad {
+    const double *S, *K, *T, *r, *price;
+    bs_iv_params params;
+    double* out;
+};
+
+void volatilidadRango(const void* contexto, size_t desde, size_t hasta) {
+    const ContextoVolatilidad& c = *static_cast<const ContextoVolatilidad*>(contexto);
+    for (size_t i = desde; i < hasta; i++) {
+        // Mismas validaciones que el pipeline: sin datos válidos no hay IV
+        if (c.T[i] > 0 && c.price[i] > 0 && c.S[i] > 0 && c.K[i] > 0) {
+            c.out[i] = findImpliedVolatility(c.S[i], c.K[i], c.T[i], c.r[i], c.price[i],
+                                             c.params.low, c.params.high,
+                                             c.params.tolerance, c.params.max_iterations);
+        } else {
+            c.out[i] = -1.0;
+        }
+    }
+}
+
+struct ContextoSubyacente {
+    const double *bid, *ask;
+    double* out;
+};
+
+void subyacenteRango(const void* contexto, size_t desde, size_t hasta) {
+    const ContextoSubyacente& c = *static_cast<const ContextoSubyacente*>(contexto);
+    for (size_t i = desde; i < hasta; i++) {
+        c.out[i] = calculateUnderVolatility(c.bid[i], c.ask[i], 0);
+    }
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t bs_abi_version(void) {
+    return (static_cast<uint32_t>(BS_ABI_VERSION_MAJOR) << 16) | BS_ABI_VERSION_MINOR;
+}
+
+size_t bs_scratch_size(uint32_t n_threads) {
+    if (n_threads <= 1) {
+        return 0;
+    }
+#ifdef BS_CON_PTHREADS
+    size_t extras = n_threads - 1;
+    // Margen para alinear el encabezado a línea de cache y las pilas a página
+    return kLinea + redondearArriba(tamanoEncabezado(extras), pagina()) + pagina() +
+           extras * tamanoPila();
+#else
+    return 0;
+#endif
+}
+
+bs_status bs_workers_init(uint32_t n_threads, void* scratch, size_t scratch_size) {
+    if (n_threads <= 1) {
+        return BS_OK;
+    }
+#ifdef BS_CON_PTHREADS
+    if (scratch == nullptr || scratch_size < bs_scratch_size(n_threads)) {
+        return BS_ERROR_SCRATCH;
+    }
+    size_t extras = n_threads - 1;
+    Trabajadores* t = new (encabezado(scratch)) Trabajadores();
+    t->extras = extras;
+    t->generacion.store(0, std::memory_order_relaxed);
+    t->pendientes.store(0, std::memory_order_relaxed);
+    t->detener = false;
+    pthread_mutex_init(&t->mutex, nullptr);
+    pthread_cond_init(&t->hay_lote, nullptr);
+    pthread_cond_init(&t->terminado, nullptr);
+
+    pthread_attr_t atributos;
+    pthread_attr_init(&atributos);
+    char* base = pilas(t, extras);
+    const size_t pila = tamanoPila();
+    size_t creados = 0;
+    for (; creados < extras; creados++) {
+        Trabajo* trabajo = &t->trabajos()[creados];
+        trabajo->trabajadores = t;
+        trabajo->indice = creados + 1;
+        if (pthread_attr_setstack(&atributos, base + creados * pila, pila) != 0 ||
+            pthread_create(&trabajo->hilo, &atributos, ejecutarTrabajo, trabajo) != 0) {
+            break;
+        }
+    }
+    pthread_attr_destroy(&atributos);
+    if (creados < extras) {
+        detenerTrabajadores(t, creados);
+        return BS_ERROR_THREADS;
+    }
+    t->propio = t;
+    t->magia = kMagia;
+#else
+    (void)scratch;
+    (void)scratch_size;
+#endif
+    return BS_OK;
+}
+
+void bs_workers_destroy(void* scratch) {
+#ifdef BS_CON_PTHREADS
+    Trabajadores* t = trabajadoresDe(scratch, bs_scratch_size(2));
+    if (t != nullptr) {
+        detenerTrabajadores(t, t->extras);
+    }
+#else
+    (void)scratch;
+#endif
+}
+
+bs_iv_params bs_default_iv_params(void) {
+    bs_iv_params params;
+    params.low = 0.00001;
+    params.high = 5;
+    params.tolerance = 0.00001;
+    params.max_iterations = 500;
+    return params;
+}
+
+bs_status bs_call_price_batch(const double* S, const double* K, const double* T,
+                              const double* r, const double* sigma, double* out, size_t n,
+                              uint32_t n_threads, void* scratch, size_t scratch_size) {
+    if (n > 0 && (!S || !K || !T || !r || !sigma || !out)) {
+        return BS_ERROR_ARGUMENT;
+    }
+
+    ContextoPrecio contexto = {S, K, T, r, sigma, out};
+    return repartir(n, n_threads, scratch, scratch_size, precioRango, &contexto);
+}
+
+bs_status bs_implied_vol_batch(const double* S, const double* K, const double* T,
+                               const double* r, const double* price,
+                               const bs_iv_params* params, double* out, size_t n,
+                               uint32_t n_threads, void* scratch, size_t scratch_size) {
+    if (n > 0 && (!S || !K || !T || !r || !price || !out)) {
+        return BS_ERROR_ARGUMENT;
+    }
+
+    ContextoVolatilidad contexto = {S, K, T, r, price,
+                                    params ? *params : bs_default_iv_params(), out};
+    if (contexto.params.max_iterations <= 0 || !(contexto.params.low < contexto.params.high)) {
+        return BS_ERROR_ARGUMENT;
+    }
+
+    return repartir(n, n_threads, scratch, scratch_size, volatilidadRango, &contexto);
+}
+
+bs_status bs_under_vol_batch(const double* bid, const double* ask, double* out, size_t n,
+                             uint32_t n_threads, void* scratch, size_t scratch_size) {
+    if (n > 0 && (!bid || !ask || !out)) {
+        return BS_ERROR_ARGUMENT;
+    }
+
+    ContextoSubyacente contexto = {bid, ask, out};
+    return repartir(n, n_threads, scratch, scratch_size, subyacenteRango, &contexto);
+}
+
+}  // extern "C"
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief ABI de C estable para calcular precios y volatilidades implícitas en lote.
+ *
+ * Pensada para usarse desde otros lenguajes a través de libblackscholes.so.
+ * Las funciones en lote trabajan sobre arrays del llamador y no reservan
+ * memoria ni crean hilos. Para usar varios hilos, el llamador los arranca una
+ * vez con bs_workers_init sobre un buffer `scratch` propio (ver
+ * bs_scratch_size), donde quedan sus pilas y descriptores; entre lotes
+ * esperan ahí y se terminan con bs_workers_destroy.
+ *
+ * Las funciones no lanzan excepciones y devuelven un bs_status.
+ */
+
+#ifndef BLACKSCHOLES_C_API_H
+#define BLACKSCHOLES_C_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define BS_API __declspec(dllexport)
+#else
+#define BS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Se incrementa MAJOR ante cambios incompatibles y MINOR al agregar funciones. */
+#define BS_ABI_VERSION_MAJOR 1
+#define BS_ABI_VERSION_MINOR 1
+
+typedef enum bs_status {
+    BS_OK = 0,
+    BS_ERROR_ARGUMENT = 1,  /* Puntero nulo o parámetro inválido */
+    BS_ERROR_SCRATCH = 2,   /* scratch nulo o más chico que bs_scratch_size */
+    BS_ERROR_THREADS = 3    /* No se pudieron crear los hilos de bs_workers_init */
+} bs_status;
+
+/**
+ * @brief Parámetros de la bisección de la volatilidad implícita.
+ */
+typedef struct bs_iv_params {
+    double low;              /* Extremo izquierdo del intervalo de búsqueda */
+    double high;             /* Extremo derecho del intervalo de búsqueda */
+    double tolerance;        /* Tolerancia para la convergencia */
+    int32_t max_iterations;  /* Número máximo de iteraciones */
+} bs_iv_params;
+
+/**
+ * @brief Versión de la ABI: (MAJOR << 16) | MINOR.
+ *
+ * El llamador debe verificar que el MAJOR coincida con el de este header.
+ */
+BS_API uint32_t bs_abi_version(void);
+
+/**
+ * @brief Bytes de scratch necesarios para usar n_threads hilos.
+ *
+ * Con n_threads <= 1 no hace falta scratch (devuelve 0).
+ */
+BS_API size_t bs_scratch_size(uint32_t n_threads);
+
+/**
+ * @brief Arranca n_threads - 1 hilos de trabajo que viven en el scratch.
+ *
+ * Los hilos esperan en el scratch hasta que una función en lote les reparte
+ * un bloque. El scratch no se puede mover ni liberar hasta bs_workers_destroy,
+ * y solo una función en lote a la vez puede usarlo. Con n_threads <= 1 no
+ * hace nada.
+ *
+ * @return BS_ERROR_THREADS si no se pudo crear algún hilo (no queda ninguno).
+ */
+BS_API bs_status bs_workers_init(uint32_t n_threads, void* scratch, size_t scratch_size);
+
+/**
+ * @brief Termina los hilos que arrancó bs_workers_init en ese scratch.
+ *
+ * Sin hilos en el scratch no hace nada.
+ */
+BS_API void bs_workers_destroy(void* scratch);
+
+/**
+ * @brief Parámetros por defecto de la bisección (los mismos que usa main).
+ */
+BS_API bs_iv_params bs_default_iv_params(void);
+
+/**
+ * @brief Precio Black-Scholes de n opciones de compra.
+ *
+ * out[i] = C(S[i], K[i], T[i], r[i], sigma[i]). r es la tasa continua.
+ *
+ * Con n_threads > 1 el lote se reparte entre el hilo del llamador y hasta
+ * n_threads - 1 hilos de bs_workers_init; si el scratch no tiene hilos, lo
+ * calcula todo el hilo del llamador. Lo mismo vale para las otras funciones.
+ */
+BS_API bs_status bs_call_price_batch(const double* S, const double* K, const double* T,
+                                     const double* r, const double* sigma, double* out,
+                                     size_t n, uint32_t n_threads, void* scratch,
+                                     size_t scratch_size);
+
+/**
+ * @brief Volatilidad implícita de n opciones de compra por bisección.
+ *
+ * out[i] es -1 si la bisección no converge o si T, S, K o el precio no son positivos.
+ *
+ * @param params Parámetros de la bisección; NULL usa bs_default_iv_params().
+ */
+BS_API bs_status bs_implied_vol_batch(const double* S, const double* K, const double* T,
+                                      const double* r, const double* price,
+                                      const bs_iv_params* params, double* out, size_t n,
+                                      uint32_t n_threads, void* scratch, size_t scratch_size);
+
+/**
+ * @brief Volatilidad anualizada del subyacente a partir de n pares bid/ask.
+ */
+BS_API bs_status bs_under_vol_batch(const double* bid, const double* ask, double* out,
+                                    size_t n, uint32_t n_threads, void* scratch,
+                                    size_t scratch_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLACKSCHOLES_C_API_H */
@@ -0,0 +1,452 @@
+#include "compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef BS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef BS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// Tamaño de cada bloque descomprimido que se entrega al parser
+const size_t kBloqueSalida = 1 << 20;
+
+}  // namespace
+
+Compression detectCompression(const std::filesystem::path& archivo, const char* inicio,
+                              size_t bytes) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(inicio);
+
+    if (bytes >= 2 && b[0] == 0x1f && b[1] == 0x8b) {
+        return Compression::GZIP;
+    }
+    if (bytes >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f && b[3] == 0xfd) {
+        return Compression::ZSTD;
+    }
+    if (bytes >= 4) {
+        return Compression::NONE;
+    }
+
+    std::string extension = archivo.extension().string();
+    if (extension == ".gz") {
+        return Compression::GZIP;
+    }
+    if (extension == ".zst") {
+        return Compression::ZSTD;
+    }
+    return Compression::NONE;
+}
+
+const char* compressionName(Compression formato) {
+    switch (formato) {
+        case Compression::GZIP:
+            return "gzip";
+        case Compression::ZSTD:
+            return "zstd";
+        default:
+            return "sin comprimir";
+    }
+}
+
+std::filesystem::path stripCompressionExtension(const std::filesystem::path& archivo) {
+    std::string extension = archivo.extension().string();
+    if (extension == ".gz" || extension == ".zst") {
+        return archivo.parent_path() / archivo.stem();
+    }
+    return archivo;
+}
+
+#ifdef BS_HAVE_ZLIB
+
+struct DecompressingReader::Gzip {
+    z_stream stream;
+    std::vector<char> salida;
+    bool fin_miembro;  // Terminó un miembro; si sigue habiendo datos, empieza otro
+
+    Gzip() : salida(kBloqueSalida), fin_miembro(false) {
+        std::memset(&stream, 0, sizeof(stream));
+    }
+
+    ~Gzip() {
+        inflateEnd(&stream);
+    }
+};
+
+#else
+
+struct DecompressingReader::Gzip {};
+
+#endif
+
+#ifdef BS_HAVE_ZSTD
+
+struct DecompressingReader::Zstd {
+    /**
+     * @brief Frame independiente que se descomprime en una tarea del scheduler.
+     */
+    struct Frame {
+        std::string comprimido;
+        std::string texto;
+        bool error;
+        TaskGroup grupo;
+    };
+
+    std::deque<std::unique_ptr<Frame>> frames;  // En vuelo, en orden
+    bool entregado;  // El primer frame ya se devolvió y se descarta en release()
+
+    std::string pendiente;  // Datos comprimidos que todavía no se cortaron en frames
+    size_t inicio;
+    bool fin_entrada;
+
+    // Modo streaming, para frames que no conviene guardar enteros
+    bool streaming;
+    ZSTD_DCtx* contexto;
+    ZSTD_inBuffer entrada;
+    size_t ultimo_resultado;  // 0 si el último frame quedó completo
+    std::vector<char> salida;
+
+    Zstd() : entregado(false), inicio(0), fin_entrada(false), streaming(false),
+             contexto(nullptr), ultimo_resultado(0) {
+        entrada.src = nullptr;
+        entrada.size = 0;
+        entrada.pos = 0;
+    }
+
+    ~Zstd() {
+        ZSTD_freeDCtx(contexto);
+    }
+
+    /**
+     * @brief Descomprime un frame completo.
+     */
+    static void decompress(Frame& frame) {
+        // Un contexto por hilo, reutilizado entre frames
+        struct Contexto {
+            ZSTD_DCtx* dctx = ZSTD_createDCtx();
+            ~Contexto() {
+                ZSTD_freeDCtx(dctx);
+            }
+        };
+        thread_local Contexto contexto;
+
+        const char* origen = frame.comprimido.data();
+        size_t bytes = frame.comprimido.size();
+        unsigned long long tamanio = ZSTD_getFrameContentSize(origen, bytes);
+
+        if (tamanio != ZSTD_CONTENTSIZE_UNKNOWN && tamanio != ZSTD_CONTENTSIZE_ERROR) {
+            frame.texto.resize(tamanio);
+            size_t resultado = ZSTD_decompressDCtx(contexto.dctx, frame.texto.data(), tamanio,
+                                                   origen, bytes);
+            frame.error = ZSTD_isError(resultado) || resultado != tamanio;
+        } else {
+            // El frame no dice cuánto ocupa descomprimido: se agranda a medida que hace falta
+            ZSTD_DCtx_reset(contexto.dctx, ZSTD_reset_session_only);
+            ZSTD_inBuffer entrada = {origen, bytes, 0};
+            size_t resultado = 1;
+            while (entrada.pos < entrada.size && !ZSTD_isError(resultado)) {
+                size_t usado = frame.texto.size();
+                frame.texto.resize(usado + kBloqueSalida);
+                ZSTD_outBuffer salida = {frame.texto.data() + usado, kBloqueSalida, 0};
+                resultado = ZSTD_decompressStream(contexto.dctx, &salida, &entrada);
+                frame.texto.resize(usado + salida.pos);
+            }
+            frame.error = ZSTD_isError(resultado) || resultado != 0;
+        }
+
+        // Libera la copia comprimida apenas deja de hacer falta
+        std::string().swap(frame.comprimido);
+    }
+};
+
+#else
+
+struct DecompressingReader::Zstd {};
+
+#endif
+
+DecompressingReader::DecompressingReader(const std::filesystem::path& archivo,
+                                         Scheduler& scheduler)
+    : lector_(archivo), scheduler_(scheduler), formato_(Compression::NONE), error_(false),
+      primero_(nullptr), bytes_primero_(0), primero_pendiente_(false), bloque_tomado_(false) {
+    if (!lector_.ok()) {
+        return;
+    }
+
+    if (lector_.next(primero_, bytes_primero_)) {
+        primero_pendiente_ = true;
+        bloque_tomado_ = true;
+    }
+    formato_ = detectCompression(archivo, primero_, bytes_primero_);
+
+    switch (formato_) {
+        case Compression::NONE:
+            break;
+
+        case Compression::GZIP:
+#ifdef BS_HAVE_ZLIB
+            gzip_.reset(new Gzip());
+            // 15 + 32: ventana máxima y detección automática del encabezado gzip/zlib
+            if (inflateInit2(&gzip_->stream, 15 + 32) != Z_OK) {
+                error_ = true;
+            }
+#else
+            std::cerr << archivo << ": compilado sin soporte para gzip (BS_HAVE_ZLIB)\n";
+            error_ = true;
+#endif
+            break;
+
+        case Compression::ZSTD:
+#ifdef BS_HAVE_ZSTD
+            zstd_.reset(new Zstd());
+#else
+            std::cerr << archivo << ": compilado sin soporte para zstd (BS_HAVE_ZSTD)\n";
+            error_ = true;
+#endif
+            break;
+    }
+}
+
+DecompressingReader::~DecompressingReader() {
+#ifdef BS_HAVE_ZSTD
+    // Las tareas de los frames en vuelo usan memoria de este objeto
+    if (zstd_) {
+        for (auto& frame : zstd_->frames) {
+            scheduler_.wait(frame->grupo);
+        }
+    }
+#endif
+}
+
+bool DecompressingReader::nextInput(const char*& datos, size_t& bytes) {
+    if (primero_pendiente_) {
+        primero_pendiente_ = false;
+        datos = primero_;
+        bytes = bytes_primero_;
+        return true;
+    }
+
+    if (bloque_tomado_) {
+        lector_.release();
+        bloque_tomado_ = false;
+    }
+
+    if (!lector_.next(datos, bytes)) {
+        return false;
+    }
+    bloque_tomado_ = true;
+    return true;
+}
+
+bool DecompressingReader::next(const char*& datos, size_t& bytes) {
+    if (!ok()) {
+        return false;
+    }
+
+    switch (formato_) {
+        case Compression::GZIP:
+            return nextGzip(datos, bytes);
+        case Compression::ZSTD:
+            return nextZstd(datos, bytes);
+        default:
+            return nextInput(datos, bytes);
+    }
+}
+
+void DecompressingReader::release() {
+    switch (formato_) {
+        case Compression::NONE:
+            // El bloque es del lector: se libera para que encole la próxima lectura
+            if (bloque_tomado_) {
+                lector_.release();
+                bloque_tomado_ = false;
+            }
+            break;
+
+        case Compression::ZSTD:
+#ifdef BS_HAVE_ZSTD
+            if (zstd_->entregado) {
+                zstd_->frames.pop_front();
+                zstd_->entregado = false;
+            }
+#endif
+            break;
+
+        default:
+            // El bloque de salida se reutiliza en el próximo next()
+            break;
+    }
+}
+
+bool DecompressingReader::nextGzip(const char*& datos, size_t& bytes) {
+#ifdef BS_HAVE_ZLIB
+    z_stream& stream = gzip_->stream;
+    stream.next_out = reinterpret_cast<Bytef*>(gzip_->salida.data());
+    stream.avail_out = static_cast<uInt>(gzip_->salida.size());
+
+    bool fin_entrada = false;
+    while (stream.avail_out > 0) {
+        if (stream.avail_in == 0) {
+            const char* entrada;
+            size_t bytes_entrada;
+            if (!nextInput(entrada, bytes_entrada)) {
+                fin_entrada = true;
+                break;
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(entrada));
+            stream.avail_in = static_cast<uInt>(bytes_entrada);
+        }
+
+        // Varios miembros gzip concatenados (por ejemplo de pigz o de cat a.gz b.gz)
+        if (gzip_->fin_miembro) {
+            inflateReset(&stream);
+            gzip_->fin_miembro = false;
+        }
+
+        int resultado = inflate(&stream, Z_NO_FLUSH);
+        if (resultado == Z_STREAM_END) {
+            gzip_->fin_miembro = true;
+        } else if (resultado != Z_OK && resultado != Z_BUF_ERROR) {
+            error_ = true;
+            return false;
+        }
+    }
+
+    // Un archivo cortado a la mitad de un miembro
+    if (fin_entrada && (!gzip_->fin_miembro || !lector_.ok())) {
+        error_ = true;
+    }
+
+    datos = gzip_->salida.data();
+    bytes = gzip_->salida.size() - stream.avail_out;
+    return bytes > 0;
+#else
+    (void)datos;
+    (void)bytes;
+    return false;
+#endif
+}
+
+bool DecompressingReader::nextZstd(const char*& datos, size_t& bytes) {
+#ifdef BS_HAVE_ZSTD
+    Zstd& z = *zstd_;
+
+    // Más allá de este tamaño, un frame se descomprime en streaming en lugar de guardarlo entero
+    const size_t limite_frame = 64 << 20;
+    const size_t max_en_vuelo = 2 * scheduler_.size() + 2;
+
+    while (true) {
+        // Corta los frames completos y los encola, hasta llenar la ventana
+        while (!z.streaming && !z.fin_entrada && z.frames.size() < max_en_vuelo) {
+            size_t disponible = z.pendiente.size() - z.inicio;
+            size_t tamanio = disponible > 0
+                ? ZSTD_findFrameCompressedSize(z.pendiente.data() + z.inicio, disponible)
+                : 0;
+
+            if (disponible > 0 && !ZSTD_isError(tamanio)) {
+                std::unique_ptr<Zstd::Frame> frame(new Zstd::Frame());
+                frame->comprimido.assign(z.pendiente, z.inicio, tamanio);
+                frame->error = false;
+                z.inicio += tamanio;
+
+                Zstd::Frame* puntero = frame.get();
+                scheduler_.submit(frame->grupo, [puntero]() { Zstd::decompress(*puntero); });
+                z.frames.push_back(std::move(frame));
+                continue;
+            }
+
+            if (disponible > limite_frame) {
+                z.streaming = true;
+                break;
+            }
+
+            z.pendiente.erase(0, z.inicio);
+            z.inicio = 0;
+
+            const char* entrada;
+            size_t bytes_entrada;
+            if (!nextInput(entrada, bytes_entrada)) {
+                z.fin_entrada = true;
+                // Quedaron datos que no forman un frame completo
+                if (!z.pendiente.empty() || !lector_.ok()) {
+                    error_ = true;
+                }
+                break;
+            }
+            z.pendiente.append(entrada, bytes_entrada);
+        }
+
+        // Entrega los frames en el orden del archivo
+        if (!z.frames.empty()) {
+            Zstd::Frame& frame = *z.frames.front();
+            scheduler_.wait(frame.grupo);
+            if (frame.error) {
+                error_ = true;
+                return false;
+            }
+            if (frame.texto.empty()) {
+                z.frames.pop_front();
+                continue;
+            }
+
+            z.entregado = true;
+            datos = frame.texto.data();
+            bytes = frame.texto.size();
+            return true;
+        }
+
+        if (!z.streaming || error_) {
+            return false;
+        }
+
+        // Streaming: primero lo que quedó en pendiente y después el resto del archivo
+        if (z.contexto == nullptr) {
+            z.contexto = ZSTD_createDCtx();
+            z.salida.resize(kBloqueSalida);
+            z.entrada.src = z.pendiente.data() + z.inicio;
+            z.entrada.size = z.pendiente.size() - z.inicio;
+            z.entrada.pos = 0;
+        }
+
+        ZSTD_outBuffer salida = {z.salida.data(), z.salida.size(), 0};
+        bool fin = false;
+        while (salida.pos < salida.size) {
+            if (z.entrada.pos == z.entrada.size) {
+                const char* entrada;
+                size_t bytes_entrada;
+                if (!nextInput(entrada, bytes_entrada)) {
+                    fin = true;
+                    break;
+                }
+                // El bloque del lector sigue vigente hasta el próximo nextInput
+                z.entrada.src = entrada;
+                z.entrada.size = bytes_entrada;
+                z.entrada.pos = 0;
+            }
+
+            z.ultimo_resultado = ZSTD_decompressStream(z.contexto, &salida, &z.entrada);
+            if (ZSTD_isError(z.ultimo_resultado)) {
+                error_ = true;
+                return false;
+            }
+        }
+
+        if (fin && (z.ultimo_resultado != 0 || !lector_.ok())) {
+            error_ = true;
+        }
+
+        datos = z.salida.data();
+        bytes = salida.pos;
+        return bytes > 0;
+    }
+#else
+    (void)datos;
+    (void)bytes;
+    return false;
+#endif
+}
@@ -0,0 +1,118 @@
+/**
+ * @file
+ * @brief Lectura de archivos de cotizaciones comprimidos con gzip o zstd.
+ *
+ * El archivo se descomprime en memoria a medida que se lee, sin escribir
+ * nunca la versión descomprimida en disco. El soporte de cada formato es
+ * opcional y se activa al compilar:
+ *
+ *   -DBS_HAVE_ZLIB ... -lz      gzip
+ *   -DBS_HAVE_ZSTD ... -lzstd   zstd
+ */
+
+#ifndef BLACKSCHOLES_COMPRESSION_HPP
+#define BLACKSCHOLES_COMPRESSION_HPP
+
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "async_io.hpp"
+#include "scheduler.hpp"
+
+/**
+ * @brief Formato de compresión de un archivo.
+ */
+enum class Compression {
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+/**
+ * @brief Detecta el formato por los primeros bytes del archivo y, si no
+ *        alcanzan para decidir, por la extensión (.gz, .zst).
+ */
+Compression detectCompression(const std::filesystem::path& archivo, const char* inicio,
+                              size_t bytes);
+
+/**
+ * @brief Nombre del formato, para los mensajes.
+ */
+const char* compressionName(Compression formato);
+
+/**
+ * @brief Quita la extensión .gz o .zst (Exp_Octubre.csv.gz -> Exp_Octubre.csv).
+ */
+std::filesystem::path stripCompressionExtension(const std::filesystem::path& archivo);
+
+/**
+ * @brief Lee un archivo en bloques ya descomprimidos.
+ *
+ * Tiene la misma interfaz que AsyncFileReader. Un archivo sin comprimir pasa
+ * tal cual. Con zstd, los frames independientes (como los que escribe
+ * pzstd, o varios .zst concatenados) se descomprimen en paralelo en el scheduler;
+ * si un frame es demasiado grande para guardarlo entero, se pasa a
+ * descomprimir en modo streaming. gzip no tiene puntos de corte
+ * independientes, así que se descomprime en orden mientras se lee.
+ */
+class DecompressingReader {
+public:
+    DecompressingReader(const std::filesystem::path& archivo, Scheduler& scheduler);
+    ~DecompressingReader();
+
+    /**
+     * @return false si no se pudo abrir o leer el archivo, si los datos están
+     *         corruptos o si el formato no se compiló.
+     */
+    bool ok() const {
+        return !error_ && lector_.ok();
+    }
+
+    Compression compression() const {
+        return formato_;
+    }
+
+    /**
+     * @brief Espera el próximo bloque descomprimido; es válido hasta release().
+     *
+     * @return false al final del archivo o ante un error (ver ok()).
+     */
+    bool next(const char*& datos, size_t& bytes);
+
+    /**
+     * @brief Libera el bloque que devolvió next().
+     */
+    void release();
+
+private:
+    struct Gzip;
+    struct Zstd;
+
+    /**
+     * @brief Trae el próximo bloque comprimido del archivo.
+     */
+    bool nextInput(const char*& datos, size_t& bytes);
+
+    bool nextGzip(const char*& datos, size_t& bytes);
+    bool nextZstd(const char*& datos, size_t& bytes);
+
+    AsyncFileReader lector_;
+    Scheduler& scheduler_;
+    Compression formato_;
+    bool error_;
+
+    // Primer bloque del archivo, que se lee para detectar el formato
+    const char* primero_;
+    size_t bytes_primero_;
+    bool primero_pendiente_;
+    bool bloque_tomado_;  // Hay un bloque de lector_ sin liberar
+
+    std::unique_ptr<Gzip> gzip_;
+    std::unique_ptr<Zstd> zstd_;
+};
+
+#endif // BLACKSCHOLES_COMPRESSION_HPP
@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @brief Densidad neutral al riesgo (Breeden-Litzenberger) de cada minuto y vencimiento.
+ *
+ * La densidad de S_T es e^(rT) d^2 C / dK^2. Con la sonrisa ajustada por SSVI
+ * (ssvi.hpp) la derivada segunda sale analítica en función de la varianza
+ * total w(k) y sus derivadas, con k = ln(K / F) y d2 = -k / sqrt(w) - sqrt(w) / 2:
+ *
+ *   q(K) = g(k) n(d2) / (K sqrt(w)),
+ *   g(k) = (1 - k w_k / (2w))^2 - w_k^2 / 4 (1 / w + 1 / 4) + w_kk / 2
+ *
+ * (n es la densidad normal estándar; g < 0 donde hay arbitraje de mariposa),
+ * así que no se derivan numéricamente precios con ruido. Las colas también son
+ * analíticas:
+ * P(S_T > K) = N(d2) - n(d2) w_k / (2 sqrt(w)).
+ *
+ * La densidad se evalúa en una grilla densa en k y de ahí salen la masa, la
+ * media de S_T y los momentos de ln(S_T / F). Los minutos se reparten en el
+ * scheduler en bloques; dentro de un bloque cada ajuste SSVI parte del anterior.
+ */
+
+#ifndef BLACKSCHOLES_DENSITY_HPP
+#define BLACKSCHOLES_DENSITY_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "scheduler.hpp"
+#include "ssvi.hpp"
+
+/**
+ * @brief Parámetros de la grilla y de las colas.
+ */
+struct DensityConfig {
+    size_t nodos;     // Puntos de la grilla en k
+    double desvios;   // La grilla cubre k = +-desvios sqrt(w(0))
+    double cola;      // Colas: P(S_T < (1 - cola) F) y P(S_T > (1 + cola) F)
+    size_t bloque;    // Minutos seguidos que se ajustan en orden, con warm start
+    SsviCalibrationConfig ssvi;
+};
+
+DensityConfig defaultDensityConfig();
+
+/**
+ * @brief Densidad de un vencimiento en un minuto.
+ */
+struct ImpliedDensity {
+    std::string created_at;
+    std::string expiration_date;
+    double T;
+    double F;
+    std::vector<double> k;         // ln(K / F), uniforme
+    std::vector<double> densidad;  // Densidad de S_T en K = F e^k
+    double masa;                   // Integral de la densidad; 1 salvo truncamiento
+    double media;                  // E[S_T]; F si la sonrisa no tiene arbitraje
+    double desvio;                 // De ln(S_T / F)
+    double asimetria;
+    double curtosis;               // En exceso
+    double cola_izquierda;         // P(S_T < (1 - cola) F)
+    double cola_derecha;           // P(S_T > (1 + cola) F)
+};
+
+/**
+ * @brief Evalúa la densidad de un plazo de la superficie en la grilla y
+ *        calcula los momentos y las colas.
+ *
+ * Reusa los vectores de salida. Con la superficie vacía la grilla queda vacía.
+ *
+ * @param F Forward del plazo.
+ */
+void computeDensity(const SsviSurface& superficie, double T, double F,
+                    const DensityConfig& config, ImpliedDensity& salida);
+
+/**
+ * @brief Ajusta cada cadena y calcula la densidad de cada uno de sus vencimientos.
+ *
+ * @return Una densidad por sonrisa, en el orden de las cadenas y de sus
+ *         vencimientos; las de minutos sin ajuste quedan con la grilla vacía.
+ */
+std::vector<ImpliedDensity> computeDensities(const std::vector<SsviChain>& cadenas,
+                                             const DensityConfig& config, Scheduler& scheduler);
+
+/**
+ * @brief Escribe un CSV con la masa, los momentos y las colas de cada densidad.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveDensitySummaries(const std::vector<ImpliedDensity>& densidades,
+                          const std::string& archivo);
+
+/**
+ * @brief Escribe un CSV con la densidad en cada punto de cada grilla.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveDensityGrids(const std::vector<ImpliedDensity>& densidades, const std::string& archivo);
+
+#endif // BLACKSCHOLES_DENSITY_HPP
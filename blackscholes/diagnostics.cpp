@@ -0,0 +1,110 @@
+#include "diagnostics.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Largo máximo de los ejemplos
+const size_t kLargoEjemplo = 80;
+
+}  // namespace
+
+const char* rowErrorName(RowError error) {
+    switch (error) {
+        case RowError::NONE: return "ok";
+        case RowError::MALFORMED_LINE: return "malformed_line";
+        case RowError::INVALID_QUOTE_DATE: return "invalid_quote_date";
+        case RowError::INVALID_EXPIRATION_DATE: return "invalid_expiration_date";
+        case RowError::EXPIRED: return "expired";
+        case RowError::INVALID_PRICE: return "invalid_price";
+        case RowError::INVALID_UNDER_PRICE: return "invalid_under_price";
+        case RowError::INVALID_STRIKE: return "invalid_strike";
+        case RowError::IV_NOT_FOUND: return "iv_not_found";
+        case RowError::INVALID_KIND: return "invalid_kind";
+        case RowError::OFF_TICK_GRID: return "off_tick_grid";
+        case RowError::COUNT: break;
+    }
+    return "unknown";
+}
+
+Diagnostics::Diagnostics(std::ostream& salida, std::chrono::milliseconds intervalo)
+    : salida_(salida), intervalo_(intervalo), terminar_(false), informado_(0) {
+    for (size_t i = 0; i < kMotivos; i++) {
+        cuentas_[i].store(0, std::memory_order_relaxed);
+        con_ejemplo_[i].store(false, std::memory_order_relaxed);
+    }
+    hilo_ = std::thread(&Diagnostics::run, this);
+}
+
+Diagnostics::~Diagnostics() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        terminar_ = true;
+    }
+    despertar_.notify_one();
+    hilo_.join();
+
+    // Si el hilo ya escribió estas mismas cuentas, no se repite la línea
+    if (total() != informado_) {
+        writeSummary(salida_);
+        salida_.flush();
+    }
+}
+
+void Diagnostics::record(RowError error, const char* ejemplo, size_t largo) {
+    size_t motivo = static_cast<size_t>(error);
+    cuentas_[motivo].fetch_add(1, std::memory_order_relaxed);
+
+    // Solo la primera fila de cada motivo toma el mutex
+    if (!con_ejemplo_[motivo].load(std::memory_order_relaxed) &&
+        !con_ejemplo_[motivo].exchange(true, std::memory_order_acq_rel)) {
+        std::lock_guard<std::mutex> lock(mutex_ejemplos_);
+        ejemplos_[motivo].assign(ejemplo, std::min(largo, kLargoEjemplo));
+    }
+}
+
+uint64_t Diagnostics::total() const {
+    uint64_t suma = 0;
+    for (size_t i = 1; i < kMotivos; i++) {
+        suma += cuentas_[i].load(std::memory_order_relaxed);
+    }
+    return suma;
+}
+
+void Diagnostics::writeSummary(std::ostream& salida) const {
+    // Se arma la línea entera antes de escribirla, para no mezclarla con otros mensajes
+    std::ostringstream linea;
+    linea << "Filas con errores: " << total();
+
+    std::lock_guard<std::mutex> lock(mutex_ejemplos_);
+    for (size_t i = 1; i < kMotivos; i++) {
+        uint64_t cuenta = cuentas_[i].load(std::memory_order_relaxed);
+        if (cuenta == 0) {
+            continue;
+        }
+        linea << " " << rowErrorName(static_cast<RowError>(i)) << "=" << cuenta;
+        if (!ejemplos_[i].empty()) {
+            linea << " (ej. \"" << ejemplos_[i] << "\")";
+        }
+    }
+    linea << "\n";
+    salida << linea.str();
+}
+
+void Diagnostics::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!terminar_) {
+        despertar_.wait_for(lock, intervalo_, [this] { return terminar_; });
+        if (terminar_) {
+            break;
+        }
+
+        // El resumen final lo escribe el destructor
+        uint64_t actual = total();
+        if (actual != informado_) {
+            writeSummary(salida_);
+            informado_ = actual;
+        }
+    }
+}
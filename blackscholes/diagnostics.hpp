@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Diagnóstico de las filas con problemas: un código de error por fila,
+ *        cuentas por motivo y resúmenes periódicos.
+ *
+ * Registrar un error cuesta un incremento atómico. Los mensajes los escribe un
+ * hilo aparte, a lo sumo uno por intervalo, así que un archivo con muchas
+ * filas inválidas no convierte a la consola en el cuello de botella.
+ */
+
+#ifndef BLACKSCHOLES_DIAGNOSTICS_HPP
+#define BLACKSCHOLES_DIAGNOSTICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Motivo por el que una fila no tiene todos sus resultados.
+ *
+ * Si una fila tiene varios problemas se guarda el primero, en este orden;
+ * OFF_TICK_GRID se controla antes que INVALID_PRICE. Los códigos se guardan en
+ * los archivos .bsc, así que los nuevos van al final.
+ */
+enum class RowError : uint8_t {
+    NONE = 0,
+    MALFORMED_LINE,           // Menos de 8 campos; la línea se descarta
+    INVALID_QUOTE_DATE,       // Created At vacío o con otro formato
+    INVALID_EXPIRATION_DATE,  // Vencimiento que no es dd/mm/YYYY
+    EXPIRED,                  // Vencimiento anterior a la cotización
+    INVALID_PRICE,            // Bid o ask no numéricos
+    INVALID_UNDER_PRICE,      // Bid o ask del subyacente no numéricos
+    INVALID_STRIKE,
+    IV_NOT_FOUND,             // La bisección no encontró la volatilidad implícita
+    INVALID_KIND,             // Kind que no es CALL ni PUT: no hay volatilidad implícita
+    OFF_TICK_GRID,            // Precio fuera de la grilla de ticks de su instrumento
+    COUNT
+};
+
+/**
+ * @brief Nombre del motivo, como aparece en la columna Error del CSV.
+ */
+const char* rowErrorName(RowError error);
+
+/**
+ * @brief Cuenta los errores por motivo y los resume periódicamente.
+ *
+ * record() se puede llamar desde cualquier hilo. Se guarda un ejemplo (el
+ * primero) de cada motivo para los resúmenes.
+ */
+class Diagnostics {
+public:
+    /**
+     * @param salida Stream donde se escriben los resúmenes.
+     * @param intervalo Tiempo mínimo entre dos resúmenes. Solo se escribe si
+     *                  hubo errores nuevos.
+     */
+    Diagnostics(std::ostream& salida, std::chrono::milliseconds intervalo);
+
+    /**
+     * @brief Detiene el hilo de resúmenes y escribe el resumen final si hubo
+     *        errores desde el último que escribió el hilo.
+     */
+    ~Diagnostics();
+
+    Diagnostics(const Diagnostics&) = delete;
+    Diagnostics& operator=(const Diagnostics&) = delete;
+
+    /**
+     * @brief Registra una fila con error.
+     *
+     * @param ejemplo Texto que identifica la fila; solo se copia si es el primero del motivo.
+     */
+    void record(RowError error, const char* ejemplo, size_t largo);
+
+    void record(RowError error, const std::string& ejemplo) {
+        record(error, ejemplo.data(), ejemplo.size());
+    }
+
+    uint64_t count(RowError error) const {
+        return cuentas_[static_cast<size_t>(error)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Filas con error de todos los motivos.
+     */
+    uint64_t total() const;
+
+    /**
+     * @brief Escribe una línea con las cuentas de cada motivo y sus ejemplos.
+     */
+    void writeSummary(std::ostream& salida) const;
+
+private:
+    static const size_t kMotivos = static_cast<size_t>(RowError::COUNT);
+
+    /**
+     * @brief Hilo de resúmenes.
+     */
+    void run();
+
+    std::array<std::atomic<uint64_t>, kMotivos> cuentas_;
+    std::array<std::atomic<bool>, kMotivos> con_ejemplo_;
+    std::array<std::string, kMotivos> ejemplos_;
+    mutable std::mutex mutex_ejemplos_;
+
+    std::ostream& salida_;
+    std::chrono::milliseconds intervalo_;
+    std::mutex mutex_;
+    std::condition_variable despertar_;
+    bool terminar_;
+    uint64_t informado_;  // Total del último resumen; solo lo usa el hilo hasta el join
+    std::thread hilo_;
+};
+
+#endif // BLACKSCHOLES_DIAGNOSTICS_HPP
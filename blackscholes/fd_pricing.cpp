@@ -0,0 +1,277 @@
+#include "fd_pricing.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+FdConfig defaultFdConfig() {
+    FdConfig config;
+    config.nodos = 200;
+    config.pasos = 200;
+    config.pasos_rannacher = 2;
+    config.concentracion = 0.1;
+    config.desvios = 6.0;
+    return config;
+}
+
+FdSolver::FdSolver(const FdConfig& config) : config_(config) {
+    config_.nodos = std::max<size_t>(config_.nodos, 4);
+    config_.pasos = std::max<size_t>(config_.pasos, 1);
+    config_.pasos_rannacher = std::min(config_.pasos_rannacher, config_.pasos);
+
+    const size_t celdas = (config_.nodos + 1) * FD_LANES;
+    grilla_.resize(config_.nodos + 1);
+    valores_.resize(celdas);
+    pagos_.resize(celdas);
+    inferior_.resize(celdas);
+    diagonal_.resize(celdas);
+    superior_.resize(celdas);
+    derecha_.resize(celdas);
+    auxiliar_.resize(celdas);
+    inversas_.resize(celdas);
+    factorizacion_valida_ = false;
+}
+
+void FdSolver::buildGrid(double m_maximo) {
+    const size_t M = config_.nodos;
+    const double c = config_.concentracion;
+    const double inicio = std::asinh(-1.0 / c);
+    const double fin = std::asinh((m_maximo - 1.0) / c);
+    for (size_t i = 0; i <= M; i++) {
+        double xi = inicio + (fin - inicio) * static_cast<double>(i) / static_cast<double>(M);
+        grilla_[i] = 1.0 + c * std::sinh(xi);
+    }
+    grilla_[0] = 0.0;
+    grilla_[M] = m_maximo;
+}
+
+void FdSolver::assembleOperator(const FdContract* contratos, const double* t) {
+    const size_t M = config_.nodos;
+    factorizacion_valida_ = false;
+    for (size_t i = 1; i < M; i++) {
+        const double m = grilla_[i];
+        const double h_menos = m - grilla_[i - 1];
+        const double h_mas = grilla_[i + 1] - m;
+        const double suma = h_menos + h_mas;
+
+        for (size_t l = 0; l < FD_LANES; l++) {
+            const FdContract& contrato = contratos[l];
+            double sigma = contrato.local != nullptr ? (*contrato.local)(contrato.K * m, t[l])
+                                                     : contrato.sigma;
+            double difusion = 0.5 * sigma * sigma * m * m;
+            double arrastre = contrato.r * m;
+            size_t celda = i * FD_LANES + l;
+            inferior_[celda] = (2.0 * difusion - arrastre * h_mas) / (h_menos * suma);
+            diagonal_[celda] =
+                (-2.0 * difusion + arrastre * (h_mas - h_menos)) / (h_menos * h_mas) - contrato.r;
+            superior_[celda] = (2.0 * difusion + arrastre * h_menos) / (h_mas * suma);
+        }
+    }
+}
+
+void FdSolver::factorize(const double* dt, double theta) {
+    const size_t M = config_.nodos;
+    const size_t L = FD_LANES;
+    double* c = auxiliar_.data();
+    double* inversas = inversas_.data();
+
+    double implicito[FD_LANES];
+    for (size_t l = 0; l < L; l++) {
+        implicito[l] = theta * dt[l];
+        size_t k = L + l;
+        inversas[k] = 1.0 / (1.0 - implicito[l] * diagonal_[k]);
+        c[k] = -implicito[l] * superior_[k] * inversas[k];
+    }
+    for (size_t i = 2; i < M; i++) {
+        for (size_t l = 0; l < L; l++) {
+            size_t k = i * L + l;
+            double a = -implicito[l] * inferior_[k];
+            double b = 1.0 - implicito[l] * diagonal_[k];
+            inversas[k] = 1.0 / (b - a * c[k - L]);
+            c[k] = -implicito[l] * superior_[k] * inversas[k];
+        }
+    }
+
+    factorizacion_valida_ = true;
+    theta_factorizado_ = theta;
+    std::copy(dt, dt + L, dt_factorizado_);
+}
+
+void FdSolver::step(const FdContract* contratos, const double* dt, const double* tau,
+                    double theta) {
+    const size_t M = config_.nodos;
+    const size_t L = FD_LANES;
+    double* V = valores_.data();
+    double* d = derecha_.data();
+    const double* c = auxiliar_.data();
+
+    double explicito[FD_LANES];
+    double implicito[FD_LANES];
+    double borde_inferior[FD_LANES];
+    double borde_superior[FD_LANES];
+    for (size_t l = 0; l < L; l++) {
+        const FdContract& contrato = contratos[l];
+        double descuento = std::exp(-contrato.r * tau[l]);
+        explicito[l] = (1.0 - theta) * dt[l];
+        implicito[l] = theta * dt[l];
+        if (contrato.call) {
+            borde_inferior[l] = 0.0;
+            borde_superior[l] = grilla_[M] - descuento;
+        } else {
+            borde_inferior[l] = contrato.american ? 1.0 : descuento;
+            borde_superior[l] = 0.0;
+        }
+    }
+
+    // Lado derecho con los valores del paso anterior
+    for (size_t i = 1; i < M; i++) {
+        for (size_t l = 0; l < L; l++) {
+            size_t k = i * L + l;
+            d[k] = V[k] + explicito[l] * (inferior_[k] * V[k - L] + diagonal_[k] * V[k] +
+                                          superior_[k] * V[k + L]);
+        }
+    }
+    for (size_t l = 0; l < L; l++) {
+        d[L + l] += implicito[l] * inferior_[L + l] * borde_inferior[l];
+        d[(M - 1) * L + l] += implicito[l] * superior_[(M - 1) * L + l] * borde_superior[l];
+    }
+
+    // Thomas, todos los carriles a la vez. Con volatilidad constante la
+    // factorización solo cambia con theta y dt (Rannacher y Crank-Nicolson)
+    bool misma = factorizacion_valida_ && theta == theta_factorizado_ &&
+                 std::equal(dt, dt + L, dt_factorizado_);
+    if (!misma) {
+        factorize(dt, theta);
+    }
+
+    // Eliminación hacia adelante...
+    const double* inversas = inversas_.data();
+    for (size_t l = 0; l < L; l++) {
+        d[L + l] *= inversas[L + l];
+    }
+    for (size_t i = 2; i < M; i++) {
+        for (size_t l = 0; l < L; l++) {
+            size_t k = i * L + l;
+            d[k] = (d[k] + implicito[l] * inferior_[k] * d[k - L]) * inversas[k];
+        }
+    }
+
+    // ...y sustitución hacia atrás
+    for (size_t l = 0; l < L; l++) {
+        V[l] = borde_inferior[l];
+        V[M * L + l] = borde_superior[l];
+        V[(M - 1) * L + l] = d[(M - 1) * L + l];
+    }
+    for (size_t i = M - 1; i-- > 1;) {
+        for (size_t l = 0; l < L; l++) {
+            size_t k = i * L + l;
+            V[k] = d[k] - c[k] * V[k + L];
+        }
+    }
+
+    // Ejercicio anticipado: los carriles europeos tienen pago -infinito
+    for (size_t k = 0; k <= M * L + L - 1; k++) {
+        V[k] = std::max(V[k], pagos_[k]);
+    }
+}
+
+void FdSolver::solve(const FdContract* contratos, size_t cantidad, double* precios) {
+    if (cantidad == 0) {
+        return;
+    }
+    cantidad = std::min(cantidad, FD_LANES);
+    const size_t M = config_.nodos;
+    const size_t L = FD_LANES;
+
+    // Los carriles libres repiten el primer contrato
+    FdContract carriles[FD_LANES];
+    bool con_local = false;
+    double m_maximo = 2.0;
+    for (size_t l = 0; l < L; l++) {
+        carriles[l] = contratos[l < cantidad ? l : 0];
+        const FdContract& contrato = carriles[l];
+        con_local = con_local || contrato.local != nullptr;
+        double ancho = config_.desvios * contrato.sigma * std::sqrt(std::max(contrato.T, 0.0));
+        m_maximo = std::max({m_maximo, 2.0 * contrato.S / contrato.K, std::exp(ancho)});
+    }
+    buildGrid(m_maximo);
+
+    // Condición final (pago en m, por unidad de strike)
+    for (size_t i = 0; i <= M; i++) {
+        for (size_t l = 0; l < L; l++) {
+            double m = grilla_[i];
+            double pago = carriles[l].call ? std::max(m - 1.0, 0.0) : std::max(1.0 - m, 0.0);
+            valores_[i * L + l] = pago;
+            pagos_[i * L + l] = carriles[l].american ? pago : -INFINITY;
+        }
+    }
+
+    double dt[FD_LANES];
+    double medio[FD_LANES];
+    double tau[FD_LANES];
+    double t[FD_LANES];
+    for (size_t l = 0; l < L; l++) {
+        dt[l] = std::max(carriles[l].T, 0.0) / static_cast<double>(config_.pasos);
+        medio[l] = 0.5 * dt[l];
+        t[l] = 0.0;
+    }
+    if (!con_local) {
+        assembleOperator(carriles, t);
+    }
+
+    for (size_t n = 0; n < config_.pasos; n++) {
+        if (n < config_.pasos_rannacher) {
+            for (int mitad = 0; mitad < 2; mitad++) {
+                for (size_t l = 0; l < L; l++) {
+                    tau[l] = (n + 0.5 * (mitad + 1)) * dt[l];
+                    t[l] = carriles[l].T - (n + 0.5 * mitad + 0.25) * dt[l];
+                }
+                if (con_local) {
+                    assembleOperator(carriles, t);
+                }
+                step(carriles, medio, tau, 1.0);
+            }
+            continue;
+        }
+        for (size_t l = 0; l < L; l++) {
+            tau[l] = (n + 1) * dt[l];
+            t[l] = carriles[l].T - (n + 0.5) * dt[l];
+        }
+        if (con_local) {
+            assembleOperator(carriles, t);
+        }
+        step(carriles, dt, tau, 0.5);
+    }
+
+    // Interpolación cuadrática en m = S / K con los tres nodos más cercanos
+    for (size_t l = 0; l < cantidad; l++) {
+        double m = carriles[l].S / carriles[l].K;
+        size_t j = static_cast<size_t>(std::upper_bound(grilla_.begin(), grilla_.end(), m) -
+                                       grilla_.begin());
+        j = std::min(std::max<size_t>(j, 1), M - 1);
+        double x0 = grilla_[j - 1], x1 = grilla_[j], x2 = grilla_[j + 1];
+        double y0 = valores_[(j - 1) * L + l], y1 = valores_[j * L + l],
+               y2 = valores_[(j + 1) * L + l];
+        double valor = y0 * (m - x1) * (m - x2) / ((x0 - x1) * (x0 - x2)) +
+                       y1 * (m - x0) * (m - x2) / ((x1 - x0) * (x1 - x2)) +
+                       y2 * (m - x0) * (m - x1) / ((x2 - x0) * (x2 - x1));
+        precios[l] = carriles[l].K * valor;
+    }
+}
+
+std::vector<double> priceFiniteDifferences(const std::vector<FdContract>& contratos,
+                                           const FdConfig& config, Scheduler& scheduler) {
+    std::vector<double> precios(contratos.size());
+    const size_t grupos = (contratos.size() + FD_LANES - 1) / FD_LANES;
+
+    // Unos cuantos bloques por hilo; cada bloque reserva los buffers de un solver
+    size_t bloque = std::max<size_t>(1, grupos / (4 * std::max<size_t>(1, scheduler.size())));
+    scheduler.parallelFor(grupos, bloque, [&](size_t desde, size_t hasta) {
+        FdSolver solver(config);
+        for (size_t g = desde; g < hasta; g++) {
+            size_t inicio = g * FD_LANES;
+            size_t cantidad = std::min(FD_LANES, contratos.size() - inicio);
+            solver.solve(&contratos[inicio], cantidad, &precios[inicio]);
+        }
+    });
+    return precios;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file
+ * @brief Diferencias finitas (Crank-Nicolson con arranque de Rannacher) para
+ *        opciones europeas y americanas, con volatilidad constante o local.
+ *
+ * La ecuación de Black-Scholes se resuelve en moneyness m = S / K, con una
+ * grilla no uniforme (seno hiperbólico) que concentra los nodos cerca del
+ * strike, donde el pago tiene el quiebre. Los primeros pasos son de Euler
+ * implícito a medio paso (Rannacher) para amortiguar las oscilaciones que
+ * Crank-Nicolson deja con pagos no suaves; el resto es Crank-Nicolson.
+ *
+ * Varios contratos se resuelven juntos, uno por carril: los valores de todos
+ * los carriles de un nodo están contiguos (valor[i * FD_LANES + carril]), así
+ * que cada paso del algoritmo de Thomas recorre los carriles en un lazo
+ * corto sin dependencias que el compilador vectoriza. Los buffers se
+ * reservan una vez por solver y se reusan entre grupos.
+ */
+
+#ifndef BLACKSCHOLES_FD_PRICING_HPP
+#define BLACKSCHOLES_FD_PRICING_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "scheduler.hpp"
+
+/**
+ * @brief Contratos que se resuelven a la vez (4 doubles: un registro AVX2).
+ */
+const size_t FD_LANES = 4;
+
+/**
+ * @brief Volatilidad local sigma(S, t), con t en años desde hoy.
+ */
+using LocalVolatility = std::function<double(double, double)>;
+
+/**
+ * @brief Contrato a valuar.
+ */
+struct FdContract {
+    double S;
+    double K;
+    double T;       // Años hasta la expiración
+    double r;       // Tasa continua
+    double sigma;   // Volatilidad constante; con volatilidad local, la de referencia para la grilla
+    bool call;      // false = opción de venta
+    bool american;  // Ejercicio anticipado
+    const LocalVolatility* local;  // nullptr = volatilidad constante
+};
+
+/**
+ * @brief Parámetros de la discretización.
+ */
+struct FdConfig {
+    size_t nodos;            // Intervalos de la grilla de moneyness
+    size_t pasos;            // Pasos de tiempo
+    size_t pasos_rannacher;  // Pasos iniciales hechos como dos medios pasos implícitos
+    double concentracion;    // Ancho (en moneyness) de la zona densa alrededor del strike
+    double desvios;          // La grilla llega a exp(desvios * sigma * sqrt(T)) veces el strike
+};
+
+FdConfig defaultFdConfig();
+
+/**
+ * @brief Solver con los buffers de un grupo de FD_LANES contratos.
+ *
+ * No es thread-safe: cada hilo usa el suyo.
+ */
+class FdSolver {
+public:
+    explicit FdSolver(const FdConfig& config = defaultFdConfig());
+
+    const FdConfig& config() const {
+        return config_;
+    }
+
+    /**
+     * @brief Valúa hasta FD_LANES contratos a la vez.
+     *
+     * @param precios Recibe un precio por contrato.
+     */
+    void solve(const FdContract* contratos, size_t cantidad, double* precios);
+
+private:
+    /**
+     * @brief Arma la grilla del grupo: m_0 = 0, más densa cerca de m = 1.
+     */
+    void buildGrid(double m_maximo);
+
+    /**
+     * @brief Coeficientes del operador en cada nodo interior y carril, con la
+     *        volatilidad en el tiempo t (años) de cada carril.
+     */
+    void assembleOperator(const FdContract* contratos, const double* t);
+
+    /**
+     * @brief Factoriza I - theta dt L (algoritmo de Thomas): c' y la inversa
+     *        del pivote de cada nodo y carril.
+     */
+    void factorize(const double* dt, double theta);
+
+    /**
+     * @brief Un paso theta: (I - theta dt L) V' = (I + (1 - theta) dt L) V,
+     *        con las condiciones de borde de cada carril al final del paso.
+     *
+     * @param dt Paso de cada carril.
+     * @param tau Tiempo hasta la expiración de cada carril al final del paso.
+     */
+    void step(const FdContract* contratos, const double* dt, const double* tau, double theta);
+
+    FdConfig config_;
+    std::vector<double> grilla_;     // m_i, nodos + 1
+    std::vector<double> valores_;    // V[i * FD_LANES + carril]
+    std::vector<double> pagos_;      // Pago al ejercer, mismo formato
+    std::vector<double> inferior_;   // Coeficiente de V_{i-1} en L
+    std::vector<double> diagonal_;   // Coeficiente de V_i
+    std::vector<double> superior_;   // Coeficiente de V_{i+1}
+    std::vector<double> derecha_;    // Lado derecho del sistema
+    std::vector<double> auxiliar_;   // c' del algoritmo de Thomas
+    std::vector<double> inversas_;   // 1 / pivote del algoritmo de Thomas
+
+    // La factorización sirve mientras no cambien el operador, theta ni dt
+    bool factorizacion_valida_;
+    double theta_factorizado_;
+    double dt_factorizado_[FD_LANES];
+};
+
+/**
+ * @brief Valúa todos los contratos en grupos de FD_LANES, repartidos en el scheduler.
+ */
+std::vector<double> priceFiniteDifferences(const std::vector<FdContract>& contratos,
+                                           const FdConfig& config, Scheduler& scheduler);
+
+#endif // BLACKSCHOLES_FD_PRICING_HPP
@@ -0,0 +1,155 @@
+#include "fft_pricing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+}  // namespace
+
+std::complex<double> blackScholesCharacteristic(std::complex<double> u, double S, double T,
+                                                double r, double sigma) {
+    const std::complex<double> i(0.0, 1.0);
+    double media = std::log(S) + (r - 0.5 * sigma * sigma) * T;
+    return std::exp(i * u * media - 0.5 * sigma * sigma * T * u * u);
+}
+
+CarrMadanConfig defaultCarrMadanConfig() {
+    CarrMadanConfig config;
+    config.puntos = 4096;
+    config.eta = 0.25;
+    config.alpha = 1.5;
+    return config;
+}
+
+CarrMadanPricer::CarrMadanPricer(const CarrMadanConfig& config) : config_(config), bits_(1) {
+    while ((size_t(1) << bits_) < config.puntos) {
+        bits_++;
+    }
+    config_.puntos = size_t(1) << bits_;
+    const size_t n = config_.puntos;
+
+    raices_.resize(n / 2);
+    for (size_t k = 0; k < n / 2; k++) {
+        raices_[k] = std::polar(1.0, -2.0 * kPi * static_cast<double>(k) / static_cast<double>(n));
+    }
+
+    // Simpson: eta / 3 * (1, 4, 2, 4, 2, ...)
+    pesos_.resize(n);
+    for (size_t j = 0; j < n; j++) {
+        double factor = j == 0 ? 1.0 : (j % 2 == 1 ? 4.0 : 2.0);
+        pesos_[j] = config_.eta / 3.0 * factor;
+    }
+}
+
+void CarrMadanPricer::transform(std::vector<std::complex<double>>& datos) const {
+    const size_t n = datos.size();
+
+    // Permutación por inversión de bits
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(datos[i], datos[j]);
+        }
+    }
+
+    for (size_t largo = 2; largo <= n; largo <<= 1) {
+        const size_t mitad = largo / 2;
+        const size_t paso = n / largo;
+        for (size_t inicio = 0; inicio < n; inicio += largo) {
+            for (size_t k = 0; k < mitad; k++) {
+                std::complex<double> a = datos[inicio + k];
+                std::complex<double> b = datos[inicio + k + mitad] * raices_[k * paso];
+                datos[inicio + k] = a + b;
+                datos[inicio + k + mitad] = a - b;
+            }
+        }
+    }
+}
+
+void CarrMadanPricer::priceGrid(const CharacteristicFunction& phi, double S, double T, double r,
+                                std::vector<double>& log_strikes,
+                                std::vector<double>& precios) const {
+    const size_t n = config_.puntos;
+    const double eta = config_.eta;
+    const double alpha = config_.alpha;
+    const double lambda = 2.0 * kPi / (static_cast<double>(n) * eta);
+    const double k_minimo = std::log(S) - 0.5 * static_cast<double>(n) * lambda;
+    const double descuento = std::exp(-r * T);
+
+    // psi(v) = e^-rT phi(v - (alpha + 1) i) / (alpha^2 + alpha - v^2 + i (2 alpha + 1) v),
+    // corrido al primer log-strike de la grilla
+    std::vector<std::complex<double>> datos(n);
+    for (size_t j = 0; j < n; j++) {
+        double v = eta * static_cast<double>(j);
+        std::complex<double> psi =
+            descuento * phi(std::complex<double>(v, -(alpha + 1.0))) /
+            std::complex<double>(alpha * alpha + alpha - v * v, (2.0 * alpha + 1.0) * v);
+        datos[j] = std::polar(pesos_[j], -v * k_minimo) * psi;
+    }
+
+    transform(datos);
+
+    log_strikes.resize(n);
+    precios.resize(n);
+    for (size_t u = 0; u < n; u++) {
+        double k = k_minimo + lambda * static_cast<double>(u);
+        log_strikes[u] = k;
+        precios[u] = std::exp(-alpha * k) / kPi * datos[u].real();
+    }
+}
+
+std::vector<double> CarrMadanPricer::priceStrikes(const CharacteristicFunction& phi, double S,
+                                                  double T, double r,
+                                                  const std::vector<double>& strikes) const {
+    std::vector<double> log_strikes;
+    std::vector<double> grilla;
+    priceGrid(phi, S, T, r, log_strikes, grilla);
+
+    const size_t n = grilla.size();
+    const double lambda = log_strikes[1] - log_strikes[0];
+    std::vector<double> precios(strikes.size(), std::numeric_limits<double>::quiet_NaN());
+
+    for (size_t s = 0; s < strikes.size(); s++) {
+        if (!(strikes[s] > 0)) {
+            continue;
+        }
+        double posicion = (std::log(strikes[s]) - log_strikes[0]) / lambda;
+        double base = std::floor(posicion);
+        if (base < 1 || base + 2 >= static_cast<double>(n)) {
+            continue;
+        }
+
+        // Lagrange cúbico sobre los puntos i - 1, i, i + 1 e i + 2
+        size_t i = static_cast<size_t>(base);
+        double t = posicion - base;
+        double y0 = grilla[i - 1];
+        double y1 = grilla[i];
+        double y2 = grilla[i + 1];
+        double y3 = grilla[i + 2];
+        precios[s] = -y0 * t * (t - 1) * (t - 2) / 6 +
+                     y1 * (t + 1) * (t - 1) * (t - 2) / 2 -
+                     y2 * (t + 1) * t * (t - 2) / 2 +
+                     y3 * (t + 1) * t * (t - 1) / 6;
+    }
+    return precios;
+}
+
+std::vector<std::vector<double>> CarrMadanPricer::priceChains(
+    const std::vector<ExpiryChain>& cadenas, Scheduler& scheduler) const {
+    std::vector<std::vector<double>> precios(cadenas.size());
+    scheduler.parallelFor(cadenas.size(), 1, [&](size_t desde, size_t hasta) {
+        for (size_t c = desde; c < hasta; c++) {
+            const ExpiryChain& cadena = cadenas[c];
+            precios[c] = priceStrikes(cadena.phi, cadena.S, cadena.T, cadena.r, cadena.strikes);
+        }
+    });
+    return precios;
+}
@@ -0,0 +1,402 @@
+#include "gap_fill.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+// Filas por vuelta del relleno lineal. El ciclo interno tiene largo fijo, así
+// que el compilador lo vectoriza ya con -O2, sin una versión escalar aparte
+const size_t kBloque = 4;
+
+// 1,5 * 2^52: sumado a un double con |x| < 2^51, los bits bajos de la mantisa
+// quedan con el entero más cercano
+const double kMagia = 6755399441055744.0;
+
+int64_t bitsOf(double valor) {
+    int64_t bits;
+    std::memcpy(&bits, &valor, sizeof(bits));
+    return bits;
+}
+
+double fromBits(int64_t bits) {
+    double valor;
+    std::memcpy(&valor, &bits, sizeof(valor));
+    return valor;
+}
+
+/**
+ * @brief 1 si el bit de signo está prendido, 0 si no.
+ */
+int64_t signBit(int64_t bits) {
+    return static_cast<int64_t>(static_cast<uint64_t>(bits) >> 63);
+}
+
+/**
+ * @brief int64 a double para |valor| < 2^51, sin la conversión de 64 bits
+ *        que SSE2 y AVX2 no tienen en forma vectorial.
+ */
+double toDouble(int64_t valor) {
+    return fromBits(bitsOf(kMagia) + valor) - kMagia;
+}
+
+/**
+ * @brief Entero más cercano a x, con los empates lejos de cero como
+ *        std::llround, para |x| < 2^51. Sin saltos ni conversiones, así que
+ *        se vectoriza.
+ */
+int64_t roundToInt(double x) {
+    const int64_t signo = -signBit(bitsOf(x));
+    const double absoluto = fromBits(bitsOf(x) & std::numeric_limits<int64_t>::max());
+    // La suma redondea al par más cercano; en un empate el resto es 0,5 y se sube uno
+    const double redondeado = (absoluto + kMagia) - kMagia;
+    const int64_t entero = bitsOf(redondeado + kMagia) - bitsOf(kMagia) + 1 -
+                           signBit(bitsOf((absoluto - redondeado) - 0.5));
+    return (entero ^ signo) - signo;
+}
+
+/**
+ * @brief Bits de una palabra de la máscara que corresponden a las filas [desde, hasta).
+ */
+uint64_t rangeBits(size_t palabra, size_t desde, size_t hasta) {
+    const size_t primera = palabra * ValidityMask::FILAS_POR_PALABRA;
+    const size_t inicio = desde > primera ? desde - primera : 0;
+    const size_t fin = std::min(hasta - primera, ValidityMask::FILAS_POR_PALABRA);
+    uint64_t hasta_fin = fin == ValidityMask::FILAS_POR_PALABRA ? ~uint64_t(0)
+                                                                 : (uint64_t(1) << fin) - 1;
+    return hasta_fin & ~((uint64_t(1) << inicio) - 1);
+}
+
+/**
+ * @brief Marca como válidas las filas [desde, hasta), de a una palabra.
+ */
+void setRange(ValidityMask& validos, size_t desde, size_t hasta) {
+    const size_t filas_por_palabra = ValidityMask::FILAS_POR_PALABRA;
+    for (size_t palabra = desde / filas_por_palabra; palabra * filas_por_palabra < hasta;
+         palabra++) {
+        validos.word(palabra) |= rangeBits(palabra, desde, hasta);
+    }
+}
+
+/**
+ * @brief Aritmética de las columnas de doubles.
+ */
+struct DoubleValues {
+    static double midpoint(double anterior, double siguiente) {
+        return (anterior + siguiente) / 2;
+    }
+
+    static double toReal(double valor) {
+        return valor;
+    }
+
+    static double fromReal(double valor) {
+        return valor;
+    }
+};
+
+/**
+ * @brief Aritmética de las columnas de ticks: los resultados se redondean al tick.
+ */
+struct TickValues {
+    static int64_t midpoint(int64_t anterior, int64_t siguiente) {
+        return midpointTicks(anterior, siguiente);
+    }
+
+    static double toReal(int64_t ticks) {
+        return static_cast<double>(ticks);
+    }
+
+    static int64_t fromReal(double valor) {
+        return roundToInt(valor);
+    }
+};
+
+/**
+ * @brief Rellena las filas [desde, hasta), que están entre los válidos
+ *        anterior y siguiente.
+ *
+ * @param ninguno Valor de anterior o siguiente cuando no hay válido de ese lado.
+ */
+template <typename Aritmetica, typename Valor>
+void fillGap(std::vector<Valor>& valores, ValidityMask& validos, const RowTimes& fechas,
+             const GapFillOptions& opciones, size_t anterior, size_t siguiente, size_t desde,
+             size_t hasta, size_t ninguno) {
+    const bool limitado = opciones.max_hueco >= 0;
+    const std::vector<int64_t>& segundos = fechas.segundos;
+
+    // Sin límite siempre se rellena; con límite, las dos filas necesitan fecha
+    auto cerca = [&](size_t primera, size_t segunda) {
+        return !limitado || (fechas.validos.test(primera) && fechas.validos.test(segunda) &&
+                             segundos[segunda] - segundos[primera] <= opciones.max_hueco);
+    };
+
+    if (opciones.metodo == GapFill::FORWARD || siguiente == ninguno) {
+        if (anterior == ninguno) {
+            return;
+        }
+        if (!limitado) {
+            std::fill(valores.begin() + desde, valores.begin() + hasta, valores[anterior]);
+            setRange(validos, desde, hasta);
+            return;
+        }
+        for (size_t i = desde; i < hasta; i++) {
+            if (cerca(anterior, i)) {
+                valores[i] = valores[anterior];
+                validos.set(i);
+            }
+        }
+        return;
+    }
+
+    if (anterior == ninguno) {
+        for (size_t i = desde; i < hasta; i++) {
+            if (cerca(i, siguiente)) {
+                valores[i] = valores[siguiente];
+                validos.set(i);
+            }
+        }
+        return;
+    }
+
+    if (!cerca(anterior, siguiente)) {
+        return;
+    }
+
+    if (opciones.metodo == GapFill::MIDPOINT) {
+        // Cada fila promedia la anterior (ya rellenada) con la siguiente válida
+        Valor previo = valores[anterior];
+        for (size_t i = desde; i < hasta; i++) {
+            previo = valores[i] = Aritmetica::midpoint(previo, valores[siguiente]);
+        }
+        setRange(validos, desde, hasta);
+        return;
+    }
+
+    // LINEAR: el peso de cada fila es la parte del tiempo entre los dos válidos
+    if (!fechas.validos.test(anterior) || !fechas.validos.test(siguiente)) {
+        return;
+    }
+    const double inicio = Aritmetica::toReal(valores[anterior]);
+    const double diferencia = Aritmetica::toReal(valores[siguiente]) - inicio;
+    const int64_t base = segundos[anterior];
+    const int64_t ancho = segundos[siguiente] - base;
+
+    if (ancho > 0) {
+        // Sin dependencias ni saltos entre filas: los bloques de kBloque filas
+        // se vectorizan, y el resto se hace de a una. El tiempo de cada fila
+        // se acota a [0, ancho] con máscaras, así que el peso queda en [0, 1]
+        const double escala = 1.0 / static_cast<double>(ancho);
+        auto interpolar = [&](int64_t segundo) {
+            int64_t desde_base = segundo - base;
+            desde_base &= signBit(desde_base) - 1;
+            const int64_t pasado = -signBit(ancho - desde_base);
+            desde_base = (desde_base & ~pasado) | (ancho & pasado);
+            const double peso = toDouble(desde_base) * escala;
+            return Aritmetica::fromReal(inicio + diferencia * peso);
+        };
+        // El bloque se calcula en un arreglo local: con ticks, valores y
+        // segundos son los dos de int64_t y sin él habría que chequear solapamiento
+        size_t i = desde;
+        for (; i + kBloque <= hasta; i += kBloque) {
+            Valor bloque[kBloque];
+            for (size_t j = 0; j < kBloque; j++) {
+                bloque[j] = interpolar(segundos[i + j]);
+            }
+            std::copy(bloque, bloque + kBloque, valores.begin() + i);
+        }
+        for (; i < hasta; i++) {
+            valores[i] = interpolar(segundos[i]);
+        }
+    } else {
+        std::fill(valores.begin() + desde, valores.begin() + hasta,
+                  Aritmetica::fromReal(inicio + diferencia * 0.5));
+    }
+
+    // Las filas sin fecha quedan sin valor; la validez se copia de a una palabra
+    const size_t filas_por_palabra = ValidityMask::FILAS_POR_PALABRA;
+    for (size_t palabra = desde / filas_por_palabra; palabra * filas_por_palabra < hasta;
+         palabra++) {
+        const uint64_t rango = rangeBits(palabra, desde, hasta);
+        const uint64_t con_fecha = fechas.validos.word(palabra) & rango;
+        validos.word(palabra) = (validos.word(palabra) & ~rango) | con_fecha;
+        ValidityMask::forEachSet(palabra, rango & ~con_fecha,
+                                 [&valores](size_t fila) { valores[fila] = Valor(0); });
+    }
+}
+
+/**
+ * @brief Recorre la columna una vez y rellena cada hueco al encontrar el
+ *        siguiente válido.
+ */
+template <typename Aritmetica, typename Valor>
+void fillColumn(std::vector<Valor>& valores, ValidityMask& validos, const RowTimes& fechas,
+                const GapFillOptions& opciones) {
+    const size_t n = valores.size();
+    const size_t ninguno = n;
+    const size_t filas_por_palabra = ValidityMask::FILAS_POR_PALABRA;
+
+    size_t anterior = ninguno;  // Último válido
+    size_t pendiente = 0;       // Primera fila que todavía no se revisó
+
+    for (size_t palabra = 0; palabra < validos.words(); palabra++) {
+        uint64_t bits = validos.word(palabra);
+        size_t primera = palabra * filas_por_palabra;
+
+        // 64 filas válidas seguidas, sin hueco antes: no hay nada que rellenar
+        if (bits == ~uint64_t(0) && pendiente == primera) {
+            anterior = primera + filas_por_palabra - 1;
+            pendiente = primera + filas_por_palabra;
+            continue;
+        }
+
+        ValidityMask::forEachSet(palabra, bits, [&](size_t i) {
+            if (i > pendiente) {
+                fillGap<Aritmetica>(valores, validos, fechas, opciones, anterior, i, pendiente,
+                                    i, ninguno);
+            }
+            anterior = i;
+            pendiente = i + 1;
+        });
+    }
+
+    if (pendiente < n) {
+        fillGap<Aritmetica>(valores, validos, fechas, opciones, anterior, ninguno, pendiente, n,
+                            ninguno);
+    }
+}
+
+/**
+ * @brief Rellena cada contrato por separado: copia su serie a columnas
+ *        contiguas, la rellena y copia el resultado a sus filas.
+ */
+template <typename Aritmetica, typename Valor>
+void fillContracts(std::vector<Valor>& valores, ValidityMask& validos, const RowTimes& fechas,
+                   const ContractSeries& series, const GapFillOptions& opciones) {
+    if (validos.count() == valores.size()) {
+        return;
+    }
+    const bool con_fechas = needsRowTimes(opciones);
+    std::vector<Valor> serie;
+    ValidityMask serie_validos;
+    RowTimes serie_fechas;
+
+    for (size_t c = 0; c + 1 < series.inicios.size(); c++) {
+        const size_t* filas = series.filas.data() + series.inicios[c];
+        const size_t n = series.inicios[c + 1] - series.inicios[c];
+        bool completa = true;
+        for (size_t j = 0; j < n; j++) {
+            completa = completa && validos.test(filas[j]);
+        }
+        if (completa) {
+            continue;
+        }
+
+        serie.resize(n);
+        serie_validos.resize(n, false);
+        if (con_fechas) {
+            serie_fechas.resize(n);
+        }
+        for (size_t j = 0; j < n; j++) {
+            serie[j] = valores[filas[j]];
+            serie_validos.assign(j, validos.test(filas[j]));
+            if (con_fechas) {
+                serie_fechas.segundos[j] = fechas.segundos[filas[j]];
+                serie_fechas.validos.assign(j, fechas.validos.test(filas[j]));
+            }
+        }
+        fillColumn<Aritmetica>(serie, serie_validos, serie_fechas, opciones);
+        for (size_t j = 0; j < n; j++) {
+            valores[filas[j]] = serie[j];
+            validos.assign(filas[j], serie_validos.test(j));
+        }
+    }
+}
+
+}  // namespace
+
+ContractSeries groupByContract(const std::vector<Data>& datos, const RowTimes& fechas) {
+    std::vector<std::vector<size_t>> contratos;
+    std::unordered_map<std::string, size_t> posiciones;
+    for (size_t i = 0; i < datos.size(); i++) {
+        auto it = posiciones.emplace(datos[i].description, contratos.size()).first;
+        if (it->second == contratos.size()) {
+            contratos.emplace_back();
+        }
+        contratos[it->second].push_back(i);
+    }
+
+    ContractSeries series;
+    series.filas.reserve(datos.size());
+    series.inicios.reserve(contratos.size() + 1);
+    auto fecha = [&fechas](size_t fila) {
+        return fechas.validos.test(fila) ? fechas.segundos[fila]
+                                         : std::numeric_limits<int64_t>::min();
+    };
+    for (std::vector<size_t>& filas : contratos) {
+        std::stable_sort(filas.begin(), filas.end(),
+                         [&fecha](size_t a, size_t b) { return fecha(a) < fecha(b); });
+        series.inicios.push_back(series.filas.size());
+        series.filas.insert(series.filas.end(), filas.begin(), filas.end());
+    }
+    series.inicios.push_back(series.filas.size());
+    return series;
+}
+
+bool hasGaps(const QuoteColumns& cotizaciones) {
+    auto completa = [](const ValidityMask& validos) { return validos.count() == validos.size(); };
+    if (cotizaciones.en_ticks) {
+        return !completa(cotizaciones.bid_ticks.validos) ||
+               !completa(cotizaciones.ask_ticks.validos) ||
+               !completa(cotizaciones.under_bid_ticks.validos) ||
+               !completa(cotizaciones.under_ask_ticks.validos);
+    }
+    return !completa(cotizaciones.bid.validos) || !completa(cotizaciones.ask.validos) ||
+           !completa(cotizaciones.under_bid.validos) || !completa(cotizaciones.under_ask.validos);
+}
+
+GapFillOptions defaultGapFill() {
+    GapFillOptions opciones;
+    opciones.metodo = GapFill::MIDPOINT;
+    opciones.max_hueco = -1;
+    return opciones;
+}
+
+bool parseGapFill(const std::string& nombre, GapFill& metodo) {
+    if (nombre == "midpoint") {
+        metodo = GapFill::MIDPOINT;
+    } else if (nombre == "linear") {
+        metodo = GapFill::LINEAR;
+    } else if (nombre == "forward") {
+        metodo = GapFill::FORWARD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void fillGaps(NumericColumn& columna, const RowTimes& fechas, const GapFillOptions& opciones) {
+    fillColumn<DoubleValues>(columna.valores, columna.validos, fechas, opciones);
+}
+
+void fillGaps(TickColumn& columna, const RowTimes& fechas, const GapFillOptions& opciones) {
+    fillColumn<TickValues>(columna.ticks, columna.validos, fechas, opciones);
+}
+
+void fillGaps(QuoteColumns& cotizaciones, const RowTimes& fechas, const ContractSeries& series,
+              const GapFillOptions& opciones) {
+    if (cotizaciones.en_ticks) {
+        for (TickColumn* columna : {&cotizaciones.ask_ticks, &cotizaciones.bid_ticks,
+                                    &cotizaciones.under_bid_ticks, &cotizaciones.under_ask_ticks}) {
+            fillContracts<TickValues>(columna->ticks, columna->validos, fechas, series, opciones);
+        }
+        return;
+    }
+    for (NumericColumn* columna : {&cotizaciones.ask, &cotizaciones.bid, &cotizaciones.under_bid,
+                                   &cotizaciones.under_ask}) {
+        fillContracts<DoubleValues>(columna->valores, columna->validos, fechas, series,
+                                    opciones);
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @brief Relleno de valores faltantes en las columnas de las cotizaciones.
+ *
+ * Los huecos se rellenan con cotizaciones del mismo contrato: las filas de un
+ * archivo se agrupan por Description y cada serie, en orden de fecha, se
+ * rellena por separado. Una serie se recorre una sola vez: las palabras de la
+ * máscara de validez sin huecos se saltean de a 64 filas, y cada hueco se
+ * rellena cuando aparece el siguiente valor válido. La interpolación lineal
+ * recorre el hueco en bloques de largo fijo, sin saltos ni conversiones de 64
+ * bits (el redondeo al tick se hace con aritmética de doubles), así que el
+ * compilador la vectoriza ya con -O2; la validez se actualiza de a 64 filas.
+ */
+
+#ifndef BLACKSCHOLES_GAP_FILL_HPP
+#define BLACKSCHOLES_GAP_FILL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "parsing.hpp"
+
+/**
+ * @brief Forma de rellenar un hueco.
+ */
+enum class GapFill : uint8_t {
+    MIDPOINT,  // Promedio entre el anterior (que puede ser uno ya rellenado) y el siguiente válido
+    LINEAR,    // Interpolación lineal entre los válidos, ponderada por la fecha de cada fila
+    FORWARD    // Repite el último válido
+};
+
+/**
+ * @brief Parámetros del relleno.
+ *
+ * Con MIDPOINT y LINEAR las filas anteriores al primer válido toman el
+ * primero y las posteriores al último toman el último; con FORWARD las
+ * anteriores al primero quedan sin valor.
+ */
+struct GapFillOptions {
+    GapFill metodo;
+    int64_t max_hueco;  // Segundos entre los válidos que rodean el hueco (o desde el
+                        // válido que se repite); más lejos queda sin valor. < 0 = sin límite
+};
+
+/**
+ * @brief Relleno del programa original: promedio, sin límite.
+ */
+GapFillOptions defaultGapFill();
+
+/**
+ * @brief Indica si el relleno usa la fecha de las filas.
+ */
+inline bool needsRowTimes(const GapFillOptions& opciones) {
+    return opciones.metodo == GapFill::LINEAR || opciones.max_hueco >= 0;
+}
+
+/**
+ * @brief Lee el nombre de un método: midpoint, linear o forward.
+ */
+bool parseGapFill(const std::string& nombre, GapFill& metodo);
+
+/**
+ * @brief Filas de cada contrato de un archivo, en orden de fecha.
+ *
+ * Las filas con la misma fecha quedan en el orden del archivo, y las que no
+ * tienen fecha quedan al principio de su contrato.
+ */
+struct ContractSeries {
+    std::vector<size_t> filas;    // Las de cada contrato, seguidas
+    std::vector<size_t> inicios;  // Posición en filas del primero de cada contrato, y el total
+};
+
+/**
+ * @brief Agrupa las filas por Description y ordena cada grupo por fecha.
+ *
+ * @param fechas Fechas de todas las filas (ver parseRowTimes).
+ */
+ContractSeries groupByContract(const std::vector<Data>& datos, const RowTimes& fechas);
+
+/**
+ * @brief Indica si a algún precio (bid y ask de la opción y del subyacente) le faltan valores.
+ */
+bool hasGaps(const QuoteColumns& cotizaciones);
+
+/**
+ * @brief Rellena los valores faltantes de una serie y los marca como válidos.
+ *
+ * Cuando hace falta la fecha (LINEAR o con límite), una fila sin fecha, o
+ * cuyos válidos vecinos no tienen fecha, queda sin valor.
+ *
+ * @param fechas Fechas de las filas (ver parseRowTimes); solo se usan si hacen falta.
+ */
+void fillGaps(NumericColumn& columna, const RowTimes& fechas, const GapFillOptions& opciones);
+
+/**
+ * @brief Como la anterior, sobre precios en ticks. Los valores rellenados se
+ *        redondean al tick más cercano, así que siguen en la grilla. Todas las
+ *        filas tienen que ser de la misma grilla (ver QuoteColumns::grillas).
+ */
+void fillGaps(TickColumn& columna, const RowTimes& fechas, const GapFillOptions& opciones);
+
+/**
+ * @brief Rellena los precios (bid y ask de la opción y del subyacente) de cada
+ *        contrato con sus propias cotizaciones. El strike no se rellena.
+ *
+ * @param fechas Fechas de todas las filas; solo se usan si hacen falta.
+ */
+void fillGaps(QuoteColumns& cotizaciones, const RowTimes& fechas, const ContractSeries& series,
+              const GapFillOptions& opciones);
+
+#endif // BLACKSCHOLES_GAP_FILL_HPP
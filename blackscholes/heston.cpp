@@ -0,0 +1,498 @@
+#include "heston.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+
+#include "least_squares.hpp"
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Nodos por tramo de Gauss-Legendre
+const size_t NODOS_POR_TRAMO = 16;
+const size_t MAX_TRAMOS = 128;
+
+/**
+ * @brief Número complejo con sus derivadas respecto de los 5 parámetros.
+ *
+ * Las funciones que se usan (exp, log, sqrt) son holomorfas, así que la regla
+ * de la cadena compleja da la derivada exacta respecto de cada parámetro real.
+ */
+struct Jet {
+    std::complex<double> v;
+    std::array<std::complex<double>, HESTON_PARAMS> d;
+};
+
+/**
+ * @brief Producto complejo sin el chequeo de infinitos de std::complex, que
+ *        con -O2 (sin -ffast-math) es una llamada a __muldc3 y domina las derivadas.
+ */
+inline std::complex<double> multiply(std::complex<double> a, std::complex<double> b) {
+    return std::complex<double>(a.real() * b.real() - a.imag() * b.imag(),
+                                a.real() * b.imag() + a.imag() * b.real());
+}
+
+Jet variable(double valor, size_t indice) {
+    Jet x;
+    x.v = valor;
+    x.d.fill(0.0);
+    x.d[indice] = 1.0;
+    return x;
+}
+
+Jet operator+(const Jet& a, const Jet& b) {
+    Jet x;
+    x.v = a.v + b.v;
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = a.d[m] + b.d[m];
+    }
+    return x;
+}
+
+Jet operator-(const Jet& a, const Jet& b) {
+    Jet x;
+    x.v = a.v - b.v;
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = a.d[m] - b.d[m];
+    }
+    return x;
+}
+
+Jet operator-(std::complex<double> c, const Jet& a) {
+    Jet x;
+    x.v = c - a.v;
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = -a.d[m];
+    }
+    return x;
+}
+
+Jet operator*(const Jet& a, const Jet& b) {
+    Jet x;
+    x.v = multiply(a.v, b.v);
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = multiply(a.d[m], b.v) + multiply(b.d[m], a.v);
+    }
+    return x;
+}
+
+Jet operator*(const Jet& a, std::complex<double> c) {
+    Jet x;
+    x.v = multiply(a.v, c);
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = multiply(a.d[m], c);
+    }
+    return x;
+}
+
+Jet operator/(const Jet& a, const Jet& b) {
+    Jet x;
+    std::complex<double> inversa = 1.0 / b.v;
+    x.v = multiply(a.v, inversa);
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = multiply(a.d[m] - multiply(x.v, b.d[m]), inversa);
+    }
+    return x;
+}
+
+Jet exp(const Jet& a) {
+    Jet x;
+    x.v = std::exp(a.v);
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = multiply(a.d[m], x.v);
+    }
+    return x;
+}
+
+Jet log(const Jet& a) {
+    Jet x;
+    x.v = std::log(a.v);
+    std::complex<double> inversa = 1.0 / a.v;
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = multiply(a.d[m], inversa);
+    }
+    return x;
+}
+
+Jet sqrt(const Jet& a) {
+    Jet x;
+    x.v = std::sqrt(a.v);
+    std::complex<double> factor = 0.5 / x.v;
+    for (size_t m = 0; m < HESTON_PARAMS; m++) {
+        x.d[m] = multiply(a.d[m], factor);
+    }
+    return x;
+}
+
+/**
+ * @brief Logaritmo de E[exp(i u X)], con X = ln(S_T / F) y F el forward.
+ *
+ * Formulación "little trap" (Albrecher et al.): usa g = (b - d) / (b + d) y
+ * exp(-d T), que no cruza el corte del logaritmo para plazos largos. Numero
+ * es std::complex<double> o Jet.
+ */
+template <typename Numero>
+Numero logCharacteristic(std::complex<double> u, double T, const Numero& v0,
+                         const Numero& kappa, const Numero& theta, const Numero& xi,
+                         const Numero& rho) {
+    using std::exp;
+    using std::log;
+    using std::sqrt;
+
+    const std::complex<double> iu = std::complex<double>(0.0, 1.0) * u;
+    Numero b = kappa - xi * rho * iu;
+    Numero xi2 = xi * xi;
+    Numero d = sqrt(b * b + xi2 * (u * u + iu));
+    Numero b_menos_d = b - d;
+    Numero g = b_menos_d / (b + d);
+    Numero e = exp(d * std::complex<double>(-T));
+    Numero denominador = 1.0 - g * e;
+
+    Numero C = kappa * theta / xi2 *
+               (b_menos_d * std::complex<double>(T) -
+                log(denominador / (1.0 - g)) * std::complex<double>(2.0));
+    Numero D = b_menos_d / xi2 * ((1.0 - e) / denominador);
+    return C + D * v0;
+}
+
+/**
+ * @brief Nodos y pesos de Gauss-Legendre en [-1, 1], por Newton sobre P_n.
+ */
+const std::array<std::pair<double, double>, NODOS_POR_TRAMO>& gaussLegendre() {
+    static const std::array<std::pair<double, double>, NODOS_POR_TRAMO> nodos = [] {
+        std::array<std::pair<double, double>, NODOS_POR_TRAMO> resultado;
+        const size_t n = NODOS_POR_TRAMO;
+        for (size_t i = 0; i < n; i++) {
+            double x = std::cos(kPi * (i + 0.75) / (n + 0.5));
+            double derivada = 1.0;
+            for (int iteracion = 0; iteracion < 100; iteracion++) {
+                double p0 = 1.0;
+                double p1 = x;
+                for (size_t k = 2; k <= n; k++) {
+                    double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                    p0 = p1;
+                    p1 = p2;
+                }
+                derivada = n * (x * p1 - p0) / (x * x - 1.0);
+                double paso = p1 / derivada;
+                x -= paso;
+                if (std::fabs(paso) < 1e-15) {
+                    break;
+                }
+            }
+            resultado[i] = std::make_pair(x, 2.0 / ((1.0 - x * x) * derivada * derivada));
+        }
+        return resultado;
+    }();
+    return nodos;
+}
+
+/**
+ * @brief Vega de Black-Scholes, con un piso para que las opciones muy fuera
+ *        o muy dentro del dinero no dominen el error.
+ */
+double weightVega(double S, double K, double T, double r, double sigma) {
+    double raiz = std::sqrt(T);
+    double d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * raiz);
+    double vega = S * raiz * std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * kPi);
+    return std::max(vega, 1e-3 * S * raiz);
+}
+
+HestonParams clampParams(HestonParams p) {
+    p.v0 = std::min(25.0, std::max(1e-4, p.v0));
+    p.kappa = std::min(50.0, std::max(1e-3, p.kappa));
+    p.theta = std::min(25.0, std::max(1e-4, p.theta));
+    p.xi = std::min(20.0, std::max(1e-3, p.xi));
+    p.rho = std::min(0.999, std::max(-0.999, p.rho));
+    return p;
+}
+
+std::array<double, HESTON_PARAMS> toArray(const HestonParams& p) {
+    return {p.v0, p.kappa, p.theta, p.xi, p.rho};
+}
+
+HestonParams fromArray(const std::array<double, HESTON_PARAMS>& x) {
+    return HestonParams{x[0], x[1], x[2], x[3], x[4]};
+}
+
+}  // namespace
+
+std::complex<double> hestonCharacteristic(std::complex<double> u, double S, double T, double r,
+                                          const HestonParams& p) {
+    const std::complex<double> i(0.0, 1.0);
+    std::complex<double> logaritmo = logCharacteristic<std::complex<double>>(
+        u, T, p.v0, p.kappa, p.theta, p.xi, p.rho);
+    return std::exp(i * u * (std::log(S) + r * T) + logaritmo);
+}
+
+HestonPricer::HestonPricer(double S, const std::vector<HestonQuote>& cotizaciones)
+    : S_(S), cantidad_(cotizaciones.size()) {
+    const auto& legendre = gaussLegendre();
+
+    // Agrupar por plazo y tasa, en el orden en que aparecen
+    for (size_t q = 0; q < cotizaciones.size(); q++) {
+        const HestonQuote& cotizacion = cotizaciones[q];
+        auto plazo = std::find_if(plazos_.begin(), plazos_.end(), [&](const Slice& s) {
+            return s.T == cotizacion.T && s.r == cotizacion.r;
+        });
+        if (plazo == plazos_.end()) {
+            plazos_.push_back(Slice{cotizacion.T, cotizacion.r, {}, {}, {}, {}, {}});
+            plazo = plazos_.end() - 1;
+        }
+        plazo->filas.push_back(q);
+    }
+
+    for (Slice& plazo : plazos_) {
+        const double F = S * std::exp(plazo.r * plazo.T);
+        const double descuento = std::exp(-plazo.r * plazo.T);
+
+        // El integrando decae como la función característica; con la mitad de
+        // la menor volatilidad del plazo, exp(-sigma^2 T u^2 / 2) < 1e-10 en el corte
+        double sigma = INFINITY;
+        double x_maximo = 0.0;
+        std::vector<double> x(plazo.filas.size());
+        for (size_t k = 0; k < plazo.filas.size(); k++) {
+            const HestonQuote& cotizacion = cotizaciones[plazo.filas[k]];
+            sigma = std::min(sigma, cotizacion.iv);
+            x[k] = std::log(F / cotizacion.K);
+            x_maximo = std::max(x_maximo, std::fabs(x[k]));
+            plazo.factores.push_back(std::sqrt(F * cotizacion.K) * descuento / kPi);
+        }
+        sigma = std::max(0.05, 0.5 * sigma);
+        double varianza = std::max(1e-8, sigma * sigma * plazo.T);
+        double corte = std::min(5000.0, std::sqrt(2.0 * std::log(1e10) / varianza));
+
+        // Tramos de a lo sumo dos oscilaciones de cos(u x) para el strike más
+        // lejano. 1 / (u^2 + 1/4) cambia en una escala de 1/2 cerca de 0, así
+        // que los primeros tramos empiezan de ancho 1 y se duplican
+        double ancho = std::min(corte / 4.0, 4.0 * kPi / std::max(x_maximo, 1e-3));
+        ancho = std::max(ancho, corte / static_cast<double>(MAX_TRAMOS));
+
+        std::vector<double> pesos;
+        double izquierda = 0.0;
+        while (izquierda < corte) {
+            double tramo = std::min({ancho, std::max(1.0, izquierda), corte - izquierda});
+            double centro = izquierda + 0.5 * tramo;
+            for (const auto& nodo : legendre) {
+                double u = centro + 0.5 * tramo * nodo.first;
+                plazo.nodos.push_back(u);
+                pesos.push_back(0.5 * tramo * nodo.second / (u * u + 0.25));
+            }
+            izquierda += tramo;
+        }
+
+        const size_t n = plazo.nodos.size();
+        plazo.cosenos.resize(plazo.filas.size() * n);
+        plazo.senos.resize(plazo.filas.size() * n);
+        for (size_t k = 0; k < plazo.filas.size(); k++) {
+            for (size_t j = 0; j < n; j++) {
+                double angulo = plazo.nodos[j] * x[k];
+                plazo.cosenos[k * n + j] = pesos[j] * std::cos(angulo);
+                plazo.senos[k * n + j] = pesos[j] * std::sin(angulo);
+            }
+        }
+    }
+}
+
+void HestonPricer::price(const HestonParams& p, std::vector<double>& precios,
+                         std::vector<std::array<double, HESTON_PARAMS>>* gradientes) const {
+    precios.assign(cantidad_, 0.0);
+    if (gradientes) {
+        gradientes->assign(cantidad_, std::array<double, HESTON_PARAMS>{});
+    }
+
+    const Jet v0 = variable(p.v0, 0);
+    const Jet kappa = variable(p.kappa, 1);
+    const Jet theta = variable(p.theta, 2);
+    const Jet xi = variable(p.xi, 3);
+    const Jet rho = variable(p.rho, 4);
+
+    // Valor y derivadas de la función característica en cada nodo, por
+    // separado la parte real y la imaginaria: fila 0 el valor, 1..5 las derivadas
+    const size_t filas_valores = gradientes ? HESTON_PARAMS + 1 : 1;
+    std::vector<double> reales;
+    std::vector<double> imaginarias;
+
+    for (const Slice& plazo : plazos_) {
+        const size_t n = plazo.nodos.size();
+        reales.assign(filas_valores * n, 0.0);
+        imaginarias.assign(filas_valores * n, 0.0);
+
+        for (size_t j = 0; j < n; j++) {
+            std::complex<double> u(plazo.nodos[j], -0.5);
+            if (gradientes) {
+                Jet psi = exp(logCharacteristic(u, plazo.T, v0, kappa, theta, xi, rho));
+                reales[j] = psi.v.real();
+                imaginarias[j] = psi.v.imag();
+                for (size_t m = 0; m < HESTON_PARAMS; m++) {
+                    reales[(m + 1) * n + j] = psi.d[m].real();
+                    imaginarias[(m + 1) * n + j] = psi.d[m].imag();
+                }
+            } else {
+                std::complex<double> psi = std::exp(logCharacteristic<std::complex<double>>(
+                    u, plazo.T, p.v0, p.kappa, p.theta, p.xi, p.rho));
+                reales[j] = psi.real();
+                imaginarias[j] = psi.imag();
+            }
+        }
+
+        // Re[e^{iux} psi] = cos(ux) Re psi - sin(ux) Im psi, strike por strike:
+        // sumas de productos sin dependencias, que el compilador vectoriza
+        for (size_t k = 0; k < plazo.filas.size(); k++) {
+            const double* cosenos = &plazo.cosenos[k * n];
+            const double* senos = &plazo.senos[k * n];
+            const size_t fila = plazo.filas[k];
+            for (size_t valor = 0; valor < filas_valores; valor++) {
+                const double* re = &reales[valor * n];
+                const double* im = &imaginarias[valor * n];
+                double suma = 0.0;
+                for (size_t j = 0; j < n; j++) {
+                    suma += cosenos[j] * re[j] - senos[j] * im[j];
+                }
+                if (valor == 0) {
+                    precios[fila] = S_ - plazo.factores[k] * suma;
+                } else {
+                    (*gradientes)[fila][valor - 1] = -plazo.factores[k] * suma;
+                }
+            }
+        }
+    }
+}
+
+HestonCalibrationConfig defaultHestonCalibration() {
+    HestonCalibrationConfig config;
+    config.max_iteraciones = 100;
+    config.tolerancia = 1e-8;
+    return config;
+}
+
+HestonParams initialHestonGuess(double iv_atm) {
+    double varianza = iv_atm * iv_atm;
+    HestonParams p;
+    p.v0 = varianza;
+    p.kappa = 2.0;
+    p.theta = varianza;
+    p.xi = std::max(0.1, iv_atm);
+    p.rho = -0.5;
+    return clampParams(p);
+}
+
+HestonFit calibrateHeston(const HestonChain& cadena, const HestonParams& inicial,
+                          const HestonCalibrationConfig& config) {
+    const std::vector<HestonQuote>& cotizaciones = cadena.cotizaciones;
+    const size_t n = cotizaciones.size();
+
+    HestonFit ajuste;
+    ajuste.parametros = clampParams(inicial);
+    ajuste.rmse = 0.0;
+    ajuste.iteraciones = 0;
+    ajuste.convergio = false;
+    if (n == 0) {
+        return ajuste;
+    }
+
+    HestonPricer pricer(cadena.S, cotizaciones);
+    std::vector<double> escalas(n);
+    for (size_t k = 0; k < n; k++) {
+        const HestonQuote& q = cotizaciones[k];
+        escalas[k] = 1.0 / weightVega(cadena.S, q.K, q.T, q.r, q.iv);
+    }
+
+    std::vector<double> precios;
+    auto evaluar = [&](const std::array<double, HESTON_PARAMS>& x, std::vector<double>& r,
+                       std::vector<std::array<double, HESTON_PARAMS>>& J) {
+        pricer.price(fromArray(x), precios, &J);
+        double costo = 0.0;
+        for (size_t k = 0; k < n; k++) {
+            r[k] = (precios[k] - cotizaciones[k].precio) * escalas[k];
+            for (size_t m = 0; m < HESTON_PARAMS; m++) {
+                J[k][m] *= escalas[k];
+            }
+            costo += r[k] * r[k];
+        }
+        return std::isfinite(costo) ? costo : INFINITY;
+    };
+    auto acotar = [](std::array<double, HESTON_PARAMS>& x) {
+        x = toArray(clampParams(fromArray(x)));
+    };
+
+    std::array<double, HESTON_PARAMS> x = toArray(ajuste.parametros);
+    LeastSquaresResult resultado = levenbergMarquardt(x, n, evaluar, acotar,
+                                                      config.max_iteraciones, config.tolerancia);
+
+    ajuste.parametros = fromArray(x);
+    ajuste.rmse = std::sqrt(resultado.costo / static_cast<double>(n));
+    ajuste.iteraciones = resultado.iteraciones;
+    ajuste.convergio = resultado.convergio;
+    return ajuste;
+}
+
+std::vector<HestonFit> calibrateChains(const std::vector<HestonChain>& cadenas,
+                                       const HestonCalibrationConfig& config,
+                                       Scheduler& scheduler) {
+    std::vector<HestonFit> ajustes(cadenas.size());
+    scheduler.parallelFor(cadenas.size(), 1, [&](size_t desde, size_t hasta) {
+        for (size_t c = desde; c < hasta; c++) {
+            const HestonChain& cadena = cadenas[c];
+
+            // Volatilidad del strike más cercano al subyacente
+            double iv_atm = 0.3;
+            double distancia = INFINITY;
+            for (const HestonQuote& q : cadena.cotizaciones) {
+                if (std::fabs(q.K - cadena.S) < distancia) {
+                    distancia = std::fabs(q.K - cadena.S);
+                    iv_atm = q.iv;
+                }
+            }
+            ajustes[c] = calibrateHeston(cadena, initialHestonGuess(iv_atm), config);
+        }
+    });
+    return ajustes;
+}
+
+std::vector<HestonChain> buildHestonChains(const std::vector<OptionData>& dataframe,
+                                           const RateCurve& curva) {
+    std::vector<HestonChain> cadenas;
+    std::unordered_map<std::string, size_t> posiciones;
+
+    for (const OptionData& fila : dataframe) {
+        if (!usableForSmile(fila) || !isValid(fila, csv::PRICE) || fila.kind != "CALL") {
+            continue;
+        }
+
+        auto it = posiciones.find(fila.created_at);
+        if (it == posiciones.end()) {
+            it = posiciones.emplace(fila.created_at, cadenas.size()).first;
+            cadenas.push_back(HestonChain{fila.created_at, fila.under_price, {}});
+        }
+
+        HestonQuote cotizacion;
+        cotizacion.K = fila.strike;
+        cotizacion.T = fila.expiration;
+        cotizacion.r = curva.continuous(fila.expiration);
+        cotizacion.precio = fila.price;
+        cotizacion.iv = fila.implied_volatility;
+        cadenas[it->second].cotizaciones.push_back(cotizacion);
+    }
+    return cadenas;
+}
+
+bool saveHestonFits(const std::vector<HestonChain>& cadenas, const std::vector<HestonFit>& ajustes,
+                    const std::string& archivo) {
+    std::ofstream salida(archivo);
+    if (!salida) {
+        return false;
+    }
+    salida << "Created At,Options,v0,kappa,theta,xi,rho,RMSE,Iterations,Converged\n";
+    for (size_t c = 0; c < cadenas.size() && c < ajustes.size(); c++) {
+        const HestonParams& p = ajustes[c].parametros;
+        salida << cadenas[c].created_at << ',' << cadenas[c].cotizaciones.size() << ',' << p.v0
+               << ',' << p.kappa << ',' << p.theta << ',' << p.xi << ',' << p.rho << ','
+               << ajustes[c].rmse << ',' << ajustes[c].iteraciones << ','
+               << (ajustes[c].convergio ? 1 : 0) << '\n';
+    }
+    return static_cast<bool>(salida);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file
+ * @brief Modelo de Heston: pricing de cadenas de opciones y calibración.
+ *
+ * Con una sola volatilidad, Black-Scholes no explica la sonrisa ni la suba de
+ * la volatilidad implícita cerca del vencimiento. Heston agrega una varianza
+ * estocástica con reversión a la media y correlación con el subyacente.
+ *
+ * El precio se calcula con la fórmula de Lewis, una integral de la función
+ * característica sobre la recta Im(u) = -1/2. Los nodos de la integral
+ * (Gauss-Legendre por tramos) dependen solo del plazo, así que se arman una
+ * vez por vencimiento; los cosenos y senos de cada strike en cada nodo
+ * también. Valuar la cadena con otros parámetros es evaluar la función
+ * característica una vez por nodo y un producto matriz-vector sobre los
+ * strikes. El gradiente respecto de los parámetros sale exacto de la misma
+ * evaluación (diferenciación automática hacia adelante), y lo usa
+ * Levenberg-Marquardt.
+ */
+
+#ifndef BLACKSCHOLES_HESTON_HPP
+#define BLACKSCHOLES_HESTON_HPP
+
+#include <array>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "scheduler.hpp"
+
+/**
+ * @brief Parámetros del modelo de Heston.
+ */
+struct HestonParams {
+    double v0;     // Varianza inicial
+    double kappa;  // Velocidad de reversión a la media
+    double theta;  // Varianza de largo plazo
+    double xi;     // Volatilidad de la varianza
+    double rho;    // Correlación entre el subyacente y la varianza
+};
+
+const size_t HESTON_PARAMS = 5;
+
+/**
+ * @brief Función característica de ln S_T, para usarla con CarrMadanPricer.
+ */
+std::complex<double> hestonCharacteristic(std::complex<double> u, double S, double T, double r,
+                                          const HestonParams& parametros);
+
+/**
+ * @brief Cotización de una opción de compra para calibrar.
+ */
+struct HestonQuote {
+    double K;
+    double T;       // Años hasta la expiración
+    double r;       // Tasa continua
+    double precio;  // Precio de mercado de la opción de compra
+    double iv;      // Volatilidad implícita de mercado; pondera el error por el vega
+};
+
+/**
+ * @brief Pricer de una cadena fija de cotizaciones.
+ *
+ * Al construirlo se agrupan las cotizaciones por plazo y se arman los nodos
+ * de cada plazo; después se puede valuar con distintos parámetros.
+ */
+class HestonPricer {
+public:
+    HestonPricer(double S, const std::vector<HestonQuote>& cotizaciones);
+
+    size_t size() const {
+        return cantidad_;
+    }
+
+    /**
+     * @brief Precios de las opciones de compra, en el orden de las cotizaciones.
+     *
+     * @param gradientes Si no es nullptr, recibe la derivada de cada precio
+     *                   respecto de (v0, kappa, theta, xi, rho).
+     */
+    void price(const HestonParams& parametros, std::vector<double>& precios,
+               std::vector<std::array<double, HESTON_PARAMS>>* gradientes = nullptr) const;
+
+private:
+    /**
+     * @brief Cotizaciones de un mismo plazo y tasa, con sus nodos.
+     */
+    struct Slice {
+        double T;
+        double r;
+        std::vector<double> nodos;       // u de cada nodo
+        std::vector<size_t> filas;       // Posición de cada strike en las cotizaciones
+        std::vector<double> factores;    // sqrt(F K) e^-rT / pi de cada strike
+        std::vector<double> cosenos;     // peso * cos(u x), strike por strike
+        std::vector<double> senos;       // peso * sin(u x)
+    };
+
+    double S_;
+    size_t cantidad_;
+    std::vector<Slice> plazos_;
+};
+
+/**
+ * @brief Parámetros de la calibración.
+ */
+struct HestonCalibrationConfig {
+    int max_iteraciones;
+    double tolerancia;  // Mejora relativa del error o del paso por debajo de la cual se termina
+};
+
+HestonCalibrationConfig defaultHestonCalibration();
+
+/**
+ * @brief Punto de partida genérico: varianzas iguales a la volatilidad ATM al cuadrado.
+ */
+HestonParams initialHestonGuess(double iv_atm);
+
+/**
+ * @brief Cadena de un instante: todas las opciones cotizadas en el mismo minuto.
+ */
+struct HestonChain {
+    std::string created_at;
+    double S;
+    std::vector<HestonQuote> cotizaciones;
+};
+
+/**
+ * @brief Resultado de calibrar una cadena.
+ */
+struct HestonFit {
+    HestonParams parametros;
+    double rmse;      // Error cuadrático medio, aproximadamente en volatilidad (precio / vega)
+    int iteraciones;
+    bool convergio;
+};
+
+/**
+ * @brief Calibra los parámetros con Levenberg-Marquardt.
+ *
+ * El error de cada opción es (precio del modelo - precio de mercado) / vega,
+ * que se parece al error en volatilidad implícita. Los parámetros se
+ * mantienen dentro de rangos razonables (varianzas positivas, |rho| < 1).
+ */
+HestonFit calibrateHeston(const HestonChain& cadena, const HestonParams& inicial,
+                          const HestonCalibrationConfig& config);
+
+/**
+ * @brief Calibra varias cadenas en paralelo, cada una desde initialHestonGuess.
+ */
+std::vector<HestonFit> calibrateChains(const std::vector<HestonChain>& cadenas,
+                                       const HestonCalibrationConfig& config,
+                                       Scheduler& scheduler);
+
+/**
+ * @brief Arma una cadena por minuto de cotización con las filas que tienen
+ *        precio, subyacente, plazo y volatilidad implícita.
+ *
+ * Solo entran las opciones de compra, por elección: la calibración se hace
+ * sobre una sola familia de precios, aunque processData también invierte las
+ * de venta con su propio pricer. Se descartan los outliers de IV. El
+ * subyacente de la cadena es el de la primera fila del minuto.
+ */
+std::vector<HestonChain> buildHestonChains(const std::vector<OptionData>& dataframe,
+                                           const RateCurve& curva);
+
+/**
+ * @brief Escribe un CSV con los parámetros calibrados de cada cadena.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveHestonFits(const std::vector<HestonChain>& cadenas, const std::vector<HestonFit>& ajustes,
+                    const std::string& archivo);
+
+#endif // BLACKSCHOLES_HESTON_HPP
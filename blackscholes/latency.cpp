@@ -0,0 +1,67 @@
+#include "latency.hpp"
+
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucketOf(uint64_t nanos) {
+    if (nanos < SUB_BUCKETS) {
+        return static_cast<int>(nanos);
+    }
+    int exponente = 63 - __builtin_clzll(nanos);
+    int sub = static_cast<int>((nanos >> (exponente - 4)) & (SUB_BUCKETS - 1));
+    return std::min(BUCKETS - 1, (exponente - 3) * SUB_BUCKETS + sub);
+}
+
+uint64_t LatencyHistogram::upperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int exponente = bucket / SUB_BUCKETS + 3;
+    uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+    return ((SUB_BUCKETS + sub + 1) << (exponente - 4)) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latencia) {
+    uint64_t nanos = static_cast<uint64_t>(std::max<int64_t>(0, latencia.count()));
+    buckets_[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t objetivo = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+    uint64_t acumulado = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        acumulado += buckets_[i].load(std::memory_order_relaxed);
+        if (acumulado >= objetivo) {
+            return upperBound(i);
+        }
+    }
+    return upperBound(BUCKETS - 1);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void printLatency(std::ostream& salida, const LatencyHistogram& histograma) {
+    salida << "pedidos=" << histograma.count()
+           << " p50=" << histograma.percentile(0.50) / 1000.0 << "us"
+           << " p99=" << histograma.percentile(0.99) / 1000.0 << "us\n";
+}
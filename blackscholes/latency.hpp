@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @brief Histograma de latencias para reportar percentiles.
+ */
+
+#ifndef BLACKSCHOLES_LATENCY_HPP
+#define BLACKSCHOLES_LATENCY_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Histograma de latencias sin locks, con buckets logarítmicos.
+ *
+ * Cada potencia de dos de nanosegundos se divide en 16 buckets lineales,
+ * así que los percentiles tienen un error relativo menor al 7%.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds latencia);
+
+    /**
+     * @brief Latencia del percentil p (entre 0 y 1), en nanosegundos.
+     */
+    uint64_t percentile(double p) const;
+
+    uint64_t count() const;
+
+    void reset();
+
+private:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = 64 * SUB_BUCKETS;
+
+    static int bucketOf(uint64_t nanos);
+    static uint64_t upperBound(int bucket);
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_;
+};
+
+/**
+ * @brief Escribe p50 y p99 de un histograma en una línea.
+ */
+void printLatency(std::ostream& salida, const LatencyHistogram& histograma);
+
+#endif // BLACKSCHOLES_LATENCY_HPP
@@ -0,0 +1,169 @@
+/**
+ * @file
+ * @brief Mínimos cuadrados no lineales con Levenberg-Marquardt, para las
+ *        calibraciones de pocos parámetros (Heston, SABR).
+ */
+
+#ifndef BLACKSCHOLES_LEAST_SQUARES_HPP
+#define BLACKSCHOLES_LEAST_SQUARES_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Resultado de levenbergMarquardt.
+ */
+struct LeastSquaresResult {
+    double costo;     // Suma de residuos al cuadrado en la solución
+    int iteraciones;
+    bool convergio;
+};
+
+/**
+ * @brief Resuelve A x = b por Cholesky (A simétrica definida positiva).
+ *
+ * @return false si A no es definida positiva.
+ */
+template <size_t N>
+bool solveCholesky(const double (&A)[N][N], const double* b, double* x) {
+    double L[N][N] = {};
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j <= i; j++) {
+            double suma = A[i][j];
+            for (size_t k = 0; k < j; k++) {
+                suma -= L[i][k] * L[j][k];
+            }
+            if (i == j) {
+                if (!(suma > 0)) {
+                    return false;
+                }
+                L[i][i] = std::sqrt(suma);
+            } else {
+                L[i][j] = suma / L[j][j];
+            }
+        }
+    }
+    double y[N];
+    for (size_t i = 0; i < N; i++) {
+        double suma = b[i];
+        for (size_t k = 0; k < i; k++) {
+            suma -= L[i][k] * y[k];
+        }
+        y[i] = suma / L[i][i];
+    }
+    for (size_t i = N; i-- > 0;) {
+        double suma = y[i];
+        for (size_t k = i + 1; k < N; k++) {
+            suma -= L[k][i] * x[k];
+        }
+        x[i] = suma / L[i][i];
+    }
+    return true;
+}
+
+/**
+ * @brief Minimiza la suma de residuos al cuadrado con Levenberg-Marquardt.
+ *
+ * La amortiguación es proporcional a la diagonal de J'J (Marquardt), con un
+ * piso para los parámetros que los datos no determinan. Termina cuando la
+ * mejora relativa del costo o el paso relativo a los parámetros quedan por
+ * debajo de la tolerancia, o cuando ningún paso mejora.
+ *
+ * @param x Punto de partida; al volver, la solución.
+ * @param residuos Cantidad de residuos.
+ * @param evaluar double(const std::array<double, N>& x, std::vector<double>& r,
+ *                std::vector<std::array<double, N>>& J): llena los residuos y
+ *                el jacobiano en x y devuelve la suma de residuos al cuadrado
+ *                (infinito si no es finita).
+ * @param acotar void(std::array<double, N>& x): lleva x a la región válida.
+ */
+template <size_t N, typename Evaluar, typename Acotar>
+LeastSquaresResult levenbergMarquardt(std::array<double, N>& x, size_t residuos,
+                                      Evaluar evaluar, Acotar acotar, int max_iteraciones,
+                                      double tolerancia) {
+    LeastSquaresResult resultado;
+    resultado.iteraciones = 0;
+    resultado.convergio = false;
+
+    acotar(x);
+    std::vector<double> r(residuos);
+    std::vector<double> r_nuevo(residuos);
+    std::vector<std::array<double, N>> J(residuos);
+    std::vector<std::array<double, N>> J_nuevo(residuos);
+    double costo = evaluar(x, r, J);
+    double lambda = 1e-3;
+
+    for (int iteracion = 0; iteracion < max_iteraciones && std::isfinite(costo); iteracion++) {
+        resultado.iteraciones = iteracion + 1;
+
+        double A[N][N] = {};
+        double g[N] = {};
+        for (size_t k = 0; k < residuos; k++) {
+            for (size_t i = 0; i < N; i++) {
+                g[i] -= J[k][i] * r[k];
+                for (size_t j = 0; j <= i; j++) {
+                    A[i][j] += J[k][i] * J[k][j];
+                }
+            }
+        }
+        double diagonal_maxima = 0.0;
+        for (size_t i = 0; i < N; i++) {
+            diagonal_maxima = std::max(diagonal_maxima, A[i][i]);
+            for (size_t j = 0; j < i; j++) {
+                A[j][i] = A[i][j];
+            }
+        }
+        if (!(diagonal_maxima > 0)) {
+            resultado.convergio = true;  // Los residuos no dependen de los parámetros
+            break;
+        }
+        for (size_t i = 0; i < N; i++) {
+            A[i][i] = A[i][i] * (1.0 + lambda) + 1e-12 * diagonal_maxima;
+        }
+
+        double paso[N];
+        double costo_nuevo = INFINITY;
+        std::array<double, N> candidato = x;
+        if (solveCholesky(A, g, paso)) {
+            // Paso despreciable frente a los parámetros: no hay más para mejorar
+            double relativo = 0.0;
+            for (size_t i = 0; i < N; i++) {
+                relativo = std::max(relativo, std::fabs(paso[i]) / (std::fabs(x[i]) + 1e-2));
+                candidato[i] += paso[i];
+            }
+            if (relativo < tolerancia) {
+                resultado.convergio = true;
+                break;
+            }
+            acotar(candidato);
+            costo_nuevo = evaluar(candidato, r_nuevo, J_nuevo);
+        }
+
+        if (costo_nuevo < costo) {
+            double mejora = (costo - costo_nuevo) / costo;
+            x = candidato;
+            costo = costo_nuevo;
+            r.swap(r_nuevo);
+            J.swap(J_nuevo);
+            lambda = std::max(lambda / 3.0, 1e-12);
+            if (mejora < tolerancia || costo < 1e-30) {
+                resultado.convergio = true;
+                break;
+            }
+        } else {
+            lambda *= 4.0;
+            if (lambda > 1e10) {
+                resultado.convergio = true;  // Ningún paso mejora: mínimo local
+                break;
+            }
+        }
+    }
+
+    resultado.costo = costo;
+    return resultado;
+}
+
+#endif // BLACKSCHOLES_LEAST_SQUARES_HPP
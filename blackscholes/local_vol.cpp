@@ -0,0 +1,127 @@
+#include "local_vol.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+LocalVolConfig defaultLocalVolConfig() {
+    LocalVolConfig config;
+    config.nodos_k = 97;
+    config.nodos_t = 16;
+    config.desvios = 6.0;
+    config.bloque = 32;
+    config.ssvi = defaultSsviCalibration();
+    return config;
+}
+
+LocalVolGrid::LocalVolGrid()
+    : S_(0.0), r_(0.0), nodos_k_(0), nodos_t_(0), z_inicial_(0.0), dz_(1.0), s_inicial_(0.0),
+      ds_(1.0) {}
+
+void LocalVolGrid::build(const SsviSurface& superficie, double S, double r,
+                         const LocalVolConfig& config) {
+    S_ = S;
+    r_ = r;
+    if (superficie.plazos.empty()) {
+        valores_.clear();
+        return;
+    }
+
+    // sqrt(T_j) = sqrt(T_max) (j + 1) / nodos_t: en T = 0 la varianza total se anula
+    nodos_k_ = std::max<size_t>(config.nodos_k, 2);
+    nodos_t_ = std::max<size_t>(config.nodos_t, 2);
+    ds_ = std::sqrt(superficie.plazos.back()) / static_cast<double>(nodos_t_);
+    s_inicial_ = ds_;
+    const double z_maximo = std::max(config.desvios, 1e-3);
+    dz_ = 2.0 * z_maximo / static_cast<double>(nodos_k_ - 1);
+    z_inicial_ = -z_maximo;
+
+    valores_.resize(nodos_k_ * nodos_t_);
+    escalas_.resize(nodos_t_);
+    k_.resize(nodos_k_);
+    derivadas_.resize(nodos_k_);
+
+    for (size_t j = 0; j < nodos_t_; j++) {
+        const double T = maturity(j);
+        escalas_[j] = std::sqrt(superficie.theta(T));
+        for (size_t i = 0; i < nodos_k_; i++) {
+            k_[i] = logMoneyness(i, j);
+        }
+        superficie.derivatives(T, k_.data(), nodos_k_, derivadas_.data());
+        double* fila = &valores_[j * nodos_k_];
+        for (size_t i = 0; i < nodos_k_; i++) {
+            const SsviDerivatives& d = derivadas_[i];
+            const double k = k_[i];
+            double g = 1.0 - k * d.w_k / d.w +
+                       0.25 * d.w_k * d.w_k * (-0.25 - 1.0 / d.w + k * k / (d.w * d.w)) +
+                       0.5 * d.w_kk;
+            // Sin arbitraje g > 0 y w_T >= 0; el máximo solo descarta redondeos
+            double varianza = g > 0 ? d.w_T / g : 0.0;
+            fila[i] = std::sqrt(std::max(varianza, 0.0));
+        }
+    }
+}
+
+LocalVolatility localVolatilityFunction(const LocalVolGrid& grilla) {
+    const LocalVolGrid* puntero = &grilla;
+    return [puntero](double S, double t) { return puntero->volatility(S, t); };
+}
+
+LocalVolBuilder::LocalVolBuilder(const LocalVolConfig& config)
+    : config_(config), hay_anterior_(false) {
+    ajuste_.superficie.parametros = initialSsviGuess(config_.ssvi.gamma);
+    ajuste_.rmse = 0.0;
+    ajuste_.iteraciones = 0;
+    ajuste_.convergio = false;
+}
+
+const LocalVolGrid& LocalVolBuilder::update(const SsviChain& cadena) {
+    SsviParams inicial = hay_anterior_ && ajuste_.convergio
+                             ? ajuste_.superficie.parametros
+                             : initialSsviGuess(config_.ssvi.gamma);
+    ajuste_ = calibrateSsvi(cadena, inicial, config_.ssvi);
+    hay_anterior_ = !ajuste_.superficie.plazos.empty();
+    grilla_.build(ajuste_.superficie, cadena.S, cadena.r, config_);
+    return grilla_;
+}
+
+std::vector<LocalVolGrid> buildLocalVolSurfaces(const std::vector<SsviChain>& cadenas,
+                                                const LocalVolConfig& config,
+                                                Scheduler& scheduler) {
+    std::vector<LocalVolGrid> grillas(cadenas.size());
+    const size_t bloque = std::max<size_t>(1, config.bloque);
+    const size_t bloques = (cadenas.size() + bloque - 1) / bloque;
+
+    scheduler.parallelFor(bloques, 1, [&](size_t desde, size_t hasta) {
+        for (size_t b = desde; b < hasta; b++) {
+            LocalVolBuilder constructor(config);
+            size_t fin = std::min(cadenas.size(), (b + 1) * bloque);
+            for (size_t c = b * bloque; c < fin; c++) {
+                grillas[c] = constructor.update(cadenas[c]);
+            }
+        }
+    });
+    return grillas;
+}
+
+bool saveLocalVolSurfaces(const std::vector<SsviChain>& cadenas,
+                          const std::vector<LocalVolGrid>& grillas, const std::string& archivo) {
+    std::ofstream salida(archivo);
+    if (!salida) {
+        return false;
+    }
+    salida << "Created At,Maturity,Log-Moneyness,Strike,Local Volatility\n";
+    for (size_t c = 0; c < cadenas.size() && c < grillas.size(); c++) {
+        const LocalVolGrid& grilla = grillas[c];
+        for (size_t j = 0; !grilla.empty() && j < grilla.nodesT(); j++) {
+            double T = grilla.maturity(j);
+            double forward = grilla.spot() * std::exp(grilla.rate() * T);
+            for (size_t i = 0; i < grilla.nodesK(); i++) {
+                double k = grilla.logMoneyness(i, j);
+                salida << cadenas[c].created_at << ',' << T << ',' << k << ','
+                       << forward * std::exp(k) << ',' << grilla.value(i, j) << '\n';
+            }
+        }
+    }
+    return static_cast<bool>(salida);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file
+ * @brief Volatilidad local de Dupire a partir de la superficie SSVI de cada minuto.
+ *
+ * Con la varianza total w(k, T) en log-moneyness k = ln(K / F(T)), la fórmula
+ * de Dupire queda
+ *
+ *   sigma_loc^2 = w_T / (1 - k w_k / w + w_k^2 / 4 (-1/4 - 1/w + k^2 / w^2) + w_kk / 2)
+ *
+ * Las derivadas salen analíticas del ajuste SSVI (ssvi.hpp), que no tiene
+ * arbitraje estático, así que el denominador es positivo y no hace falta
+ * derivar numéricamente cotizaciones con ruido. El resultado se guarda en una
+ * grilla en moneyness estandarizada z = k / sqrt(theta(T)) y en sqrt(T): la
+ * sonrisa de los plazos cortos es angosta en k y la volatilidad local cambia
+ * más rápido cerca de T = 0, así que una grilla uniforme en (k, T) necesita
+ * muchos más nodos para el mismo error. La consulta es bilineal y no busca.
+ *
+ * LocalVolBuilder procesa los minutos en orden: cada ajuste parte del
+ * anterior y la grilla reusa su memoria.
+ */
+
+#ifndef BLACKSCHOLES_LOCAL_VOL_HPP
+#define BLACKSCHOLES_LOCAL_VOL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "fd_pricing.hpp"
+#include "scheduler.hpp"
+#include "ssvi.hpp"
+
+/**
+ * @brief Parámetros de la grilla y del ajuste.
+ */
+struct LocalVolConfig {
+    size_t nodos_k;              // Nodos en log-moneyness
+    size_t nodos_t;              // Nodos en plazo, hasta el último vencimiento
+    double desvios;              // En cada plazo la grilla cubre k = +-desvios sqrt(theta(T))
+    size_t bloque;               // Minutos seguidos que se procesan en orden, con warm start
+    SsviCalibrationConfig ssvi;
+};
+
+LocalVolConfig defaultLocalVolConfig();
+
+/**
+ * @brief Volatilidad local de un minuto en una grilla (z, sqrt(T)).
+ *
+ * Fuera de la grilla se usa el valor del borde.
+ */
+class LocalVolGrid {
+public:
+    LocalVolGrid();
+
+    /**
+     * @brief Llena la grilla con la fórmula de Dupire sobre la superficie.
+     *
+     * Sin vencimientos la grilla queda vacía.
+     *
+     * @param S Subyacente del minuto.
+     * @param r Tasa continua, para el forward F(T) = S e^(rT).
+     */
+    void build(const SsviSurface& superficie, double S, double r, const LocalVolConfig& config);
+
+    bool empty() const {
+        return valores_.empty();
+    }
+
+    /**
+     * @brief Interpolación bilineal en log-moneyness k = ln(K / F(T)) y plazo T.
+     *
+     * @return 0 si la grilla está vacía.
+     */
+    double at(double k, double T) const {
+        if (valores_.empty()) {
+            return 0.0;
+        }
+        size_t i, j;
+        const double s = std::sqrt(std::max(T, 0.0));
+        const double b = coordinate(s, s_inicial_, ds_, nodos_t_, j);
+        double escala = escalas_[j] + b * (escalas_[j + 1] - escalas_[j]);
+        // Fuera de los plazos de la grilla la escala sigue a sqrt(theta), casi
+        // proporcional a sqrt(T): en z la sonrisa de SSVI cambia poco con T
+        const double s_final = s_inicial_ + ds_ * static_cast<double>(nodos_t_ - 1);
+        if (s < s_inicial_) {
+            escala = escalas_.front() * s / s_inicial_;
+        } else if (s > s_final) {
+            escala = escalas_.back() * s / s_final;
+        }
+        double a = coordinate(k / std::max(escala, 1e-12), z_inicial_, dz_, nodos_k_, i);
+        const double* fila = &valores_[j * nodos_k_ + i];
+        const double* siguiente = fila + nodos_k_;
+        return (1.0 - b) * ((1.0 - a) * fila[0] + a * fila[1]) +
+               b * ((1.0 - a) * siguiente[0] + a * siguiente[1]);
+    }
+
+    /**
+     * @brief Volatilidad local con el subyacente S en el tiempo t (años desde
+     *        el minuto de la grilla), como la usa FdSolver.
+     */
+    double volatility(double S, double t) const {
+        return at(std::log(S / S_) - r_ * t, t);
+    }
+
+    size_t nodesK() const {
+        return nodos_k_;
+    }
+
+    size_t nodesT() const {
+        return nodos_t_;
+    }
+
+    /**
+     * @brief k del nodo (i, j).
+     */
+    double logMoneyness(size_t i, size_t j) const {
+        return (z_inicial_ + dz_ * static_cast<double>(i)) * escalas_[j];
+    }
+
+    double maturity(size_t j) const {
+        double s = s_inicial_ + ds_ * static_cast<double>(j);
+        return s * s;
+    }
+
+    double value(size_t i, size_t j) const {
+        return valores_[j * nodos_k_ + i];
+    }
+
+    double spot() const {
+        return S_;
+    }
+
+    double rate() const {
+        return r_;
+    }
+
+private:
+    /**
+     * @brief Celda y posición dentro de la celda de x en un eje uniforme.
+     */
+    static double coordinate(double x, double inicio, double paso, size_t nodos, size_t& celda) {
+        double u = (x - inicio) / paso;
+        u = std::min(static_cast<double>(nodos - 1), std::max(0.0, u));
+        celda = std::min(static_cast<size_t>(u), nodos - 2);
+        return u - static_cast<double>(celda);
+    }
+
+    double S_;
+    double r_;
+    size_t nodos_k_;
+    size_t nodos_t_;
+    double z_inicial_;
+    double dz_;
+    double s_inicial_;               // sqrt(T) del primer plazo
+    double ds_;
+    std::vector<double> escalas_;    // sqrt(theta(T_j))
+    std::vector<double> valores_;    // valores_[j * nodos_k_ + i]: z_i, T_j
+    std::vector<double> k_;          // Auxiliares de build
+    std::vector<SsviDerivatives> derivadas_;
+};
+
+/**
+ * @brief Adapta la grilla a la volatilidad local de FdContract.
+ *
+ * La grilla tiene que vivir mientras se use la función.
+ */
+LocalVolatility localVolatilityFunction(const LocalVolGrid& grilla);
+
+/**
+ * @brief Ajusta y llena la grilla de cada minuto nuevo, partiendo del ajuste anterior.
+ */
+class LocalVolBuilder {
+public:
+    explicit LocalVolBuilder(const LocalVolConfig& config = defaultLocalVolConfig());
+
+    /**
+     * @brief Procesa el minuto siguiente.
+     *
+     * @return La grilla del minuto; se reescribe en la próxima llamada.
+     */
+    const LocalVolGrid& update(const SsviChain& cadena);
+
+    /**
+     * @brief Ajuste SSVI del último minuto procesado.
+     */
+    const SsviFit& fit() const {
+        return ajuste_;
+    }
+
+private:
+    LocalVolConfig config_;
+    SsviFit ajuste_;
+    bool hay_anterior_;
+    LocalVolGrid grilla_;
+};
+
+/**
+ * @brief Grilla de cada cadena, en paralelo por bloques de minutos seguidos.
+ *
+ * Dentro de un bloque cada minuto parte del ajuste anterior.
+ */
+std::vector<LocalVolGrid> buildLocalVolSurfaces(const std::vector<SsviChain>& cadenas,
+                                                const LocalVolConfig& config,
+                                                Scheduler& scheduler);
+
+/**
+ * @brief Escribe un CSV con la volatilidad local de cada nodo de cada minuto.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveLocalVolSurfaces(const std::vector<SsviChain>& cadenas,
+                          const std::vector<LocalVolGrid>& grillas, const std::string& archivo);
+
+#endif // BLACKSCHOLES_LOCAL_VOL_HPP
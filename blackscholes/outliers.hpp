@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief Detección de outliers en series de volatilidad.
+ */
+
+#ifndef BLACKSCHOLES_OUTLIERS_HPP
+#define BLACKSCHOLES_OUTLIERS_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+/**
+ * @brief Filtro de Hampel en streaming sobre una ventana movil.
+ *
+ * Mantiene las ultimas `ventana` observaciones validas en un arbol de
+ * estadisticos de orden, por lo que insertar, quitar y obtener la mediana
+ * cuesta O(log w). La MAD se obtiene como el k-esimo elemento de las dos
+ * secuencias ordenadas de desvios (a izquierda y a derecha de la mediana),
+ * en O(log^2 w), sin copiar la ventana. Nunca se guarda la serie completa.
+ */
+class HampelFilter {
+public:
+    /**
+     * @param ventana Cantidad de observaciones de la ventana movil.
+     * @param umbral Cantidad de desvios robustos (1.4826 * MAD) tolerados.
+     */
+    HampelFilter(size_t ventana, double umbral)
+        : ventana_(ventana), umbral_(umbral), secuencia_(0) {}
+
+    /**
+     * @brief Evalua una observacion contra la ventana y luego la incorpora.
+     *
+     * La observacion se compara con las anteriores (ventana causal), de modo
+     * que el filtro no agrega rezago a la serie.
+     *
+     * @param x Observacion a evaluar. Los valores negativos (sin dato) se ignoran.
+     * @param mediana Mediana de la ventana, para usar como reemplazo.
+     * @return true si la observacion es un outlier.
+     */
+    bool filter(double x, double& mediana) {
+        if (!(x >= 0) || !std::isfinite(x)) {
+            return false;
+        }
+
+        bool outlier = false;
+        if (arbol_.size() == ventana_) {
+            mediana = median();
+            double limite = umbral_ * 1.4826 * mad(mediana);
+            outlier = std::fabs(x - mediana) > limite;
+        }
+
+        add(x);
+        return outlier;
+    }
+
+private:
+    // Se guarda un numero de secuencia junto al valor para admitir repetidos
+    typedef std::pair<double, uint64_t> Clave;
+    typedef __gnu_pbds::tree<Clave, __gnu_pbds::null_type, std::less<Clave>,
+                             __gnu_pbds::rb_tree_tag,
+                             __gnu_pbds::tree_order_statistics_node_update> Arbol;
+
+    void add(double x) {
+        Clave clave(x, secuencia_++);
+        arbol_.insert(clave);
+        fifo_.push_back(clave);
+
+        if (fifo_.size() > ventana_) {
+            arbol_.erase(fifo_.front());
+            fifo_.pop_front();
+        }
+    }
+
+    double at(size_t k) const {
+        return arbol_.find_by_order(k)->first;
+    }
+
+    double median() const {
+        size_t n = arbol_.size();
+        if (n % 2 == 1) {
+            return at(n / 2);
+        }
+        return (at(n / 2 - 1) + at(n / 2)) / 2;
+    }
+
+    /**
+     * @brief k-esimo desvio absoluto respecto de m (k empieza en 0).
+     *
+     * A la izquierda de m los desvios m - v crecen al bajar en el orden y a la
+     * derecha v - m crecen al subir, asi que son dos secuencias ordenadas y se
+     * puede hacer busqueda binaria sobre cuantos elementos tomar de cada una.
+     */
+    double kthDeviation(double m, size_t k) const {
+        size_t a = arbol_.order_of_key(Clave(m, 0));
+        size_t b = arbol_.size() - a;
+
+        auto izquierda = [&](size_t i) { return m - at(a - 1 - i); };
+        auto derecha = [&](size_t j) { return at(a + j) - m; };
+
+        size_t lo = (k + 1 > b) ? k + 1 - b : 0;
+        size_t hi = std::min(a, k + 1);
+        while (lo < hi) {
+            size_t i = (lo + hi) / 2;
+            size_t j = k + 1 - i;
+            if (izquierda(i) < derecha(j - 1)) {
+                lo = i + 1;
+            } else {
+                hi = i;
+            }
+        }
+
+        size_t i = lo;
+        size_t j = k + 1 - i;
+        double resultado = -std::numeric_limits<double>::infinity();
+        if (i > 0) {
+            resultado = std::max(resultado, izquierda(i - 1));
+        }
+        if (j > 0) {
+            resultado = std::max(resultado, derecha(j - 1));
+        }
+        return resultado;
+    }
+
+    double mad(double m) const {
+        size_t n = arbol_.size();
+        if (n % 2 == 1) {
+            return kthDeviation(m, n / 2);
+        }
+        return (kthDeviation(m, n / 2 - 1) + kthDeviation(m, n / 2)) / 2;
+    }
+
+    size_t ventana_;
+    double umbral_;
+    uint64_t secuencia_;
+    std::deque<Clave> fifo_;
+    Arbol arbol_;
+};
+
+#endif // BLACKSCHOLES_OUTLIERS_HPP
@@ -0,0 +1,335 @@
+#include "parsing.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <iomanip>
+#include <sstream>
+#include <regex>
+#include <ctime>
+#include <chrono>
+#include <cstdio>
+
+bool isValidDouble(const std::string& str, double& result) {
+    std::string strWithDot = str;
+    
+    // Reemplazar comas por puntos en la cadena
+    size_t pos = 0;
+
+    // std::string::npos es una constante especial de la clase std::string en C++. 
+    // Representa un valor que indica una posición no encontrada o inválida dentro 
+    // de la cadena.
+    // pos busca la posición en la que se encuentra la , en la cadena de texto.
+    while ((pos = strWithDot.find(',', pos)) != std::string::npos) {
+        strWithDot.replace(pos, 1, ".");
+    }
+
+    try {
+        size_t pos;
+        result = std::stod(strWithDot, &pos); // Se intenta convertir a double
+        // Verifica si se consumieron todos los caracteres de la cadena
+        return pos == strWithDot.length();
+    // Si no se consumieron, hubo algun error.
+    } catch (const std::invalid_argument&) {
+        return false; // Error de conversión
+    } catch (const std::out_of_range&) {
+        return false; // Valor fuera de rango
+    }
+}
+
+void parseQuotes(const std::vector<Data>& datos, size_t desde, size_t hasta,
+                 QuoteColumns& cotizaciones) {
+    auto convertir = [](const std::string& texto, NumericColumn& columna, size_t fila) {
+        double valor = 0.0;
+        bool valido = isValidDouble(texto, valor);
+        columna.valores[fila] = valido ? valor : 0.0;
+        columna.validos.assign(fila, valido);
+    };
+
+    auto convertirTicks = [](const std::string& texto, TickColumn& columna, size_t fila,
+                             uint32_t grilla) {
+        int64_t ticks = 0;
+        bool en_grilla = true;
+        bool valido = parseTicks(texto, columna.tamanios[grilla], ticks, en_grilla) &&
+                      en_grilla;
+        columna.ticks[fila] = valido ? ticks : 0;
+        columna.validos.assign(fila, valido);
+        return en_grilla;
+    };
+
+    // Las filas de un mismo contrato suelen venir juntas: la grilla se busca
+    // solo cuando cambia la Description
+    const std::string* descripcion = nullptr;
+    uint32_t grilla = 0;
+    for (size_t i = desde; i < hasta; i++) {
+        convertir(datos[i].strike, cotizaciones.strike, i);
+        if (cotizaciones.en_ticks) {
+            if (!cotizaciones.grillas.empty()) {
+                if (descripcion == nullptr || *descripcion != datos[i].description) {
+                    descripcion = &datos[i].description;
+                    grilla = static_cast<uint32_t>(findTickGrid(*cotizaciones.tabla,
+                                                                *descripcion));
+                }
+                cotizaciones.grillas[i] = grilla;
+            }
+            bool en_grilla = convertirTicks(datos[i].bid, cotizaciones.bid_ticks, i, grilla);
+            en_grilla &= convertirTicks(datos[i].ask, cotizaciones.ask_ticks, i, grilla);
+            en_grilla &= convertirTicks(datos[i].underBid, cotizaciones.under_bid_ticks, i,
+                                        grilla);
+            en_grilla &= convertirTicks(datos[i].underAsk, cotizaciones.under_ask_ticks, i,
+                                        grilla);
+            cotizaciones.fuera_de_grilla.assign(i, !en_grilla);
+        } else {
+            convertir(datos[i].bid, cotizaciones.bid, i);
+            convertir(datos[i].ask, cotizaciones.ask, i);
+            convertir(datos[i].underBid, cotizaciones.under_bid, i);
+            convertir(datos[i].underAsk, cotizaciones.under_ask, i);
+        }
+    }
+}
+
+void parseRowTimes(const std::vector<Data>& datos, size_t desde, size_t hasta, RowTimes& fechas) {
+    for (size_t i = desde; i < hasta; i++) {
+        int64_t segundos = 0;
+        bool valida = parseTimestamp(datos[i].created_at, segundos);
+        fechas.segundos[i] = valida ? segundos : 0;
+        fechas.validos.assign(i, valida);
+    }
+}
+
+bool isValidFormatDate(const std::string& date) {
+    // Expresión regular para el formato de fecha
+    std::regex date_regex("^(0?[1-9]|1[0-2])/(0?[1-9]|1[0-9]|2[0-9]|3[0-1])/(20[0-9][0-9]) (0?[0-9]|1[0-9]|2[0-3]):([0-5][0-9])$");
+    /*
+    (0?[1-9]|1[0-2]): Representa el mes, permitiendo un dígito opcional para los 
+    meses del 1 al 9.
+    (0?[1-9]|1[0-9]|2[0-9]|3[0-1]): Representa el día, permitiendo un dígito opcional 
+    para los días del 1 al 9 y dos dígitos para los días del 10 al 31.
+    (20[0-9][0-9]): Representa el año, asegurándose de que sea un año válido del 
+    siglo XXI.
+    (0?[0-9]|1[0-9]|2[0-3]): Representa la hora en formato de 24 horas,
+     permitiendo un dígito opcional para las horas del 0 al 9 y dos dígitos para 
+     las horas del 10 al 23.
+    ([0-5][0-9]): Representa los minutos, asegurándose de que estén en el rango 
+    de 00 a 59.
+    */
+
+    // Verificar si la cadena cumple con el formato
+    return std::regex_match(date, date_regex);
+}
+
+bool isValidFormatExpirationDate(const std::string& date) {
+    // Expresión regular para el formato de fecha
+    std::regex date_regex("\\d{2}/\\d{2}/\\d{4}");
+
+    // Verificar si la cadena cumple con el formato
+    return std::regex_match(date, date_regex);
+}
+
+double obtenerDiferenciaEnAnios(const std::string& fecha1_str, const std::string& fecha2_str,
+                                RowError* error) {
+    RowError sin_uso;
+    if (error == nullptr) {
+        error = &sin_uso;
+    }
+    *error = RowError::NONE;
+
+    // Convertir cadenas a tipos de fecha y hora
+    std::tm tm1 = {};
+    std::tm tm2 = {};
+
+    // The std::istringstream is a string class object which is used to stream 
+    // the string into different variables and similarly files can be stream into 
+    // strings
+    std::istringstream ss1(fecha1_str);
+    std::istringstream ss2(fecha2_str);
+
+    if (!isValidFormatDate(fecha1_str)) {
+        *error = RowError::INVALID_QUOTE_DATE;
+        return -1;
+    }
+
+    if (!isValidFormatExpirationDate(fecha2_str)) {
+        *error = RowError::INVALID_EXPIRATION_DATE;
+        return -1;
+    }
+
+    // Formato de fecha y hora para la primer cadena
+    ss1 >> std::get_time(&tm1, "%m/%d/%Y");
+    // Ignorar el espacio entre la fecha y la hora
+    ss1.ignore(1);
+    ss1 >> std::get_time(&tm1, "%H:%M:%S");
+
+    // Formato de fecha para la segunda cadena
+    ss2 >> std::get_time(&tm2, "%d/%m/%Y %H:%M:%S");
+
+    // Convertir a tipos de duración
+    std::time_t time1 = std::mktime(&tm1);
+    std::time_t time2 = std::mktime(&tm2);
+
+    // La fecha de expiracion no puede ser menor a la fecha de valuacion de la opcion
+    if (time2 < time1) {
+        *error = RowError::EXPIRED;
+        return -1.0;
+    }
+
+    // Primero calcula la diferencia en segundos y despues la pasa a años
+    auto duracion = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::seconds(time2 - time1));
+    double diferencia_en_anios = duracion.count() / (365 * 24 * 60 * 60); // Dividir por segundos en un año
+
+    return diferencia_en_anios;
+}
+
+IngestFilter acceptAllRows() {
+    IngestFilter filtro;
+    filtro.desde = std::numeric_limits<int64_t>::min();
+    filtro.hasta = std::numeric_limits<int64_t>::max();
+    return filtro;
+}
+
+bool parseLine(const std::string& linea, Data& dato) {
+    static const IngestFilter todas = acceptAllRows();
+    return parseLine(linea.data(), linea.data() + linea.size(), todas, dato);
+}
+
+bool parseLine(const char* inicio, const char* fin, const IngestFilter& filtro, Data& dato,
+               RowError* error) {
+    if (error != nullptr) {
+        *error = RowError::NONE;
+    }
+
+    // Ejemplo de línea:
+    // GFGC1033OC;1033;CALL;130;178,999;1180,5;1184,85;10/18/2023 12:18
+    // Solo se guardan las posiciones de los primeros 8 campos; un ; al final
+    // de la línea no abre un campo nuevo
+    const char* campos[8];
+    const char* fines[8];
+    size_t cantidad = 0;
+    const char* campo = inicio;
+    while (cantidad < 8 && campo < fin) {
+        const char* separador = static_cast<const char*>(std::memchr(campo, ';', fin - campo));
+        campos[cantidad] = campo;
+        fines[cantidad] = separador ? separador : fin;
+        cantidad++;
+        campo = separador ? separador + 1 : fin;
+    }
+
+    // Verifica si hay suficientes elementos para construir una fila
+    if (cantidad < 8) {
+        if (error != nullptr && inicio < fin) {
+            *error = RowError::MALFORMED_LINE;
+        }
+        return false;
+    }
+
+    // Filtros, de los más baratos a los más caros
+    if (!filtro.kind.empty() &&
+        filtro.kind.compare(0, std::string::npos, campos[2], fines[2] - campos[2]) != 0) {
+        return false;
+    }
+
+    if (!filtro.strikes.empty()) {
+        // La parte entera del strike, como queda en la salida
+        int strike = 0;
+        auto convertido = std::from_chars(campos[1], fines[1], strike);
+        if (convertido.ec != std::errc() ||
+            !std::binary_search(filtro.strikes.begin(), filtro.strikes.end(), strike)) {
+            return false;
+        }
+    }
+
+    dato.created_at.assign(campos[7], fines[7]);
+    if (filtro.desde != std::numeric_limits<int64_t>::min() ||
+        filtro.hasta != std::numeric_limits<int64_t>::max()) {
+        int64_t segundos;
+        if (!parseTimestamp(dato.created_at, segundos) || segundos < filtro.desde ||
+            segundos > filtro.hasta) {
+            return false;
+        }
+    }
+
+    dato.description.assign(campos[0], fines[0]);
+    dato.strike.assign(campos[1], fines[1]);
+    dato.kind.assign(campos[2], fines[2]);
+    dato.bid.assign(campos[3], fines[3]);
+    dato.ask.assign(campos[4], fines[4]);
+    dato.underBid.assign(campos[5], fines[5]);
+    dato.underAsk.assign(campos[6], fines[6]);
+
+    return true;
+}
+
+namespace {
+
+// Días desde el 01/01/1970 de una fecha del calendario gregoriano (H. Hinnant)
+int64_t daysFromCivil(int64_t anio, unsigned mes, unsigned dia) {
+    anio -= mes <= 2;
+    const int64_t era = (anio >= 0 ? anio : anio - 399) / 400;
+    const unsigned anio_era = static_cast<unsigned>(anio - era * 400);
+    const unsigned dia_anio = (153 * (mes > 2 ? mes - 3 : mes + 9) + 2) / 5 + dia - 1;
+    const unsigned dia_era = anio_era * 365 + anio_era / 4 - anio_era / 100 + dia_anio;
+    return era * 146097 + static_cast<int64_t>(dia_era) - 719468;
+}
+
+void civilFromDays(int64_t dias, int& anio, unsigned& mes, unsigned& dia) {
+    dias += 719468;
+    const int64_t era = (dias >= 0 ? dias : dias - 146096) / 146097;
+    const unsigned dia_era = static_cast<unsigned>(dias - era * 146097);
+    const unsigned anio_era = (dia_era - dia_era / 1460 + dia_era / 36524 - dia_era / 146096) / 365;
+    const unsigned dia_anio = dia_era - (365 * anio_era + anio_era / 4 - anio_era / 100);
+    const unsigned mp = (5 * dia_anio + 2) / 153;
+    dia = dia_anio - (153 * mp + 2) / 5 + 1;
+    mes = mp < 10 ? mp + 3 : mp - 9;
+    anio = static_cast<int>(static_cast<int64_t>(anio_era) + era * 400 + (mes <= 2));
+}
+
+}  // namespace
+
+bool parseTimestamp(const std::string& created_at, int64_t& segundos) {
+    int mes, dia, anio, hora, minuto, segundo = 0;
+    int leidos = 0;
+    if (std::sscanf(created_at.c_str(), "%d/%d/%d %d:%d%n", &mes, &dia, &anio, &hora, &minuto,
+                    &leidos) != 5) {
+        return false;
+    }
+    if (created_at[leidos] == ':') {
+        int extra = 0;
+        if (std::sscanf(created_at.c_str() + leidos, ":%d%n", &segundo, &extra) != 1) {
+            return false;
+        }
+        leidos += extra;
+    }
+    if (static_cast<size_t>(leidos) != created_at.size() ||
+        mes < 1 || mes > 12 || dia < 1 || dia > 31 ||
+        hora < 0 || hora > 23 || minuto < 0 || minuto > 59 || segundo < 0 || segundo > 59) {
+        return false;
+    }
+
+    segundos = daysFromCivil(anio, static_cast<unsigned>(mes), static_cast<unsigned>(dia)) * 86400 +
+               hora * 3600 + minuto * 60 + segundo;
+    return true;
+}
+
+std::string formatTimestamp(int64_t segundos) {
+    int64_t dias = segundos >= 0 ? segundos / 86400 : (segundos - 86399) / 86400;
+    int64_t resto = segundos - dias * 86400;
+
+    int anio;
+    unsigned mes, dia;
+    civilFromDays(dias, anio, mes, dia);
+
+    char texto[32];
+    int hora = static_cast<int>(resto / 3600);
+    int minuto = static_cast<int>(resto / 60 % 60);
+    int segundo = static_cast<int>(resto % 60);
+    if (segundo != 0) {
+        std::snprintf(texto, sizeof(texto), "%02u/%02u/%04d %02d:%02d:%02d", mes, dia, anio,
+                      hora, minuto, segundo);
+    } else {
+        std::snprintf(texto, sizeof(texto), "%02u/%02u/%04d %02d:%02d", mes, dia, anio, hora,
+                      minuto);
+    }
+    return texto;
+}
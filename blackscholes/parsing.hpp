@@ -0,0 +1,262 @@
+/**
+ * @file
+ * @brief Lectura y validación de las cotizaciones (números, fechas y líneas del CSV).
+ */
+
+#ifndef BLACKSCHOLES_PARSING_HPP
+#define BLACKSCHOLES_PARSING_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <filesystem>
+
+#include "diagnostics.hpp"
+#include "ticks.hpp"
+#include "validity.hpp"
+
+/**
+ * @brief Estructura para representar los datos de una opción antes de la interpolación.
+ */
+struct Data {
+    std::string description;
+    std::string strike;
+    std::string kind;
+    std::string bid;
+    std::string ask;
+    std::string underBid;
+    std::string underAsk;
+    std::string created_at;
+};
+
+/**
+ * @brief Columna numérica con su máscara de validez.
+ *
+ * Un valor faltante o que no es un número queda en 0 con su bit de validez en 0.
+ */
+struct NumericColumn {
+    std::vector<double> valores;
+    ValidityMask validos;
+
+    void resize(size_t filas) {
+        valores.assign(filas, 0.0);
+        validos.resize(filas, false);
+    }
+};
+
+/**
+ * @brief Columna de precios en ticks (ver ticks.hpp) con su máscara de validez.
+ *
+ * Cada fila está en la grilla de su instrumento (ver QuoteColumns::grillas);
+ * tamanios tiene el tick de cada grilla.
+ */
+struct TickColumn {
+    std::vector<int64_t> ticks;
+    ValidityMask validos;
+    std::vector<TickSize> tamanios;
+
+    void resize(size_t filas, std::vector<TickSize> grillas) {
+        ticks.assign(filas, 0);
+        validos.resize(filas, false);
+        tamanios = std::move(grillas);
+    }
+
+    double value(size_t fila, uint32_t grilla) const {
+        return ticksToDouble(ticks[fila], tamanios[grilla]);
+    }
+};
+
+/**
+ * @brief Columnas numéricas de las cotizaciones de un archivo.
+ *
+ * Los precios se guardan como double o, si se indicaron los ticks, en
+ * columnas de ticks; las otras quedan vacías.
+ */
+struct QuoteColumns {
+    NumericColumn strike;
+    NumericColumn bid;
+    NumericColumn ask;
+    NumericColumn under_bid;
+    NumericColumn under_ask;
+
+    bool en_ticks;  // Los precios están en las columnas *_ticks
+    TickColumn bid_ticks;
+    TickColumn ask_ticks;
+    TickColumn under_bid_ticks;
+    TickColumn under_ask_ticks;
+    const PriceTicks* tabla;        // Ticks de cada instrumento
+    std::vector<uint32_t> grillas;  // Grilla de cada fila (ver findTickGrid); vacío sin tabla
+    ValidityMask fuera_de_grilla;   // Filas con algún precio fuera de su grilla
+
+    QuoteColumns() : en_ticks(false), tabla(nullptr) {}
+
+    uint32_t grilla(size_t fila) const {
+        return grillas.empty() ? 0 : grillas[fila];
+    }
+
+    void resize(size_t filas) {
+        en_ticks = false;
+        strike.resize(filas);
+        bid.resize(filas);
+        ask.resize(filas);
+        under_bid.resize(filas);
+        under_ask.resize(filas);
+    }
+
+    void resize(size_t filas, const PriceTicks& ticks) {
+        en_ticks = true;
+        strike.resize(filas);
+        std::vector<TickSize> opcion(1, ticks.opcion);
+        std::vector<TickSize> subyacente(1, ticks.subyacente);
+        for (const InstrumentTicks& instrumento : ticks.instrumentos) {
+            opcion.push_back(instrumento.opcion);
+            subyacente.push_back(instrumento.subyacente);
+        }
+        bid_ticks.resize(filas, opcion);
+        ask_ticks.resize(filas, opcion);
+        under_bid_ticks.resize(filas, subyacente);
+        under_ask_ticks.resize(filas, subyacente);
+        tabla = &ticks;
+        grillas.assign(ticks.instrumentos.empty() ? 0 : filas, 0);
+        fuera_de_grilla.resize(filas, false);
+    }
+};
+
+/**
+ * @brief Convierte los campos numéricos de las filas [desde, hasta).
+ *
+ * Varios hilos pueden convertir rangos distintos de las mismas columnas si
+ * desde es múltiplo de ValidityMask::FILAS_POR_PALABRA.
+ *
+ * Con ticks, un precio que no está en la grilla de su instrumento no se
+ * redondea: queda inválido, como uno faltante, y la fila se marca en
+ * fuera_de_grilla para informarla como RowError::OFF_TICK_GRID.
+ *
+ * @param cotizaciones Columnas ya dimensionadas para todas las filas; los
+ *                     precios se leen en ticks si se dimensionaron con ticks.
+ */
+void parseQuotes(const std::vector<Data>& datos, size_t desde, size_t hasta,
+                 QuoteColumns& cotizaciones);
+
+/**
+ * @brief Fecha de cada fila en segundos, con su máscara de validez.
+ */
+struct RowTimes {
+    std::vector<int64_t> segundos;  // Ver parseTimestamp
+    ValidityMask validos;           // Filas con fecha
+
+    void resize(size_t filas) {
+        segundos.assign(filas, 0);
+        validos.resize(filas, false);
+    }
+};
+
+/**
+ * @brief Convierte las fechas de las filas [desde, hasta), con las mismas
+ *        condiciones que parseQuotes para repartirlas entre hilos.
+ */
+void parseRowTimes(const std::vector<Data>& datos, size_t desde, size_t hasta, RowTimes& fechas);
+
+/**
+ * @brief Función de validación para la conversión de cadena a double.
+ * 
+ * @param str Cadena a validar y convertir.
+ * @param result Variable donde se almacenará el resultado de la conversión.
+ * @return true si la conversión es exitosa, false en caso contrario.
+ */
+bool isValidDouble(const std::string& str, double& result);
+
+/**
+ * @brief Función de validación para el formato de fecha.
+ *
+ * No escribe nada; los errores se registran en Diagnostics.
+ * 
+ * @param date Cadena que representa una fecha.
+ * @return true si el formato es válido, false en caso contrario.
+ */
+bool isValidFormatDate(const std::string& date);
+
+/**
+ * @brief Función de validación para el formato de fecha de vencimiento.
+ * 
+ * @param date Cadena que representa una fecha de vencimiento.
+ * @return true si el formato es válido, false en caso contrario.
+ */
+bool isValidFormatExpirationDate(const std::string& date);
+
+/**
+ * @brief Obtiene la diferencia en años entre dos fechas.
+ * 
+ * @param fecha1_str Cadena que representa la primera fecha.
+ * @param fecha2_str Cadena que representa la segunda fecha.
+ * @param error Si no es nullptr, recibe el motivo cuando hay un error.
+ * @return Diferencia en años entre las fechas o -1 si hay un error.
+ */
+double obtenerDiferenciaEnAnios(const std::string& fecha1_str, const std::string& fecha2_str,
+                                RowError* error = nullptr);
+
+/**
+ * @brief Convierte la fecha de una cotización (mm/dd/YYYY HH:MM[:SS]) en segundos.
+ *
+ * Los segundos se cuentan desde el 01/01/1970 sin zona horaria, así que solo
+ * sirven para ordenar y comparar cotizaciones entre sí. No usa mktime, así que
+ * se puede llamar desde varios hilos.
+ *
+ * @param created_at Fecha de la cotización.
+ * @param segundos Resultado de la conversión.
+ * @return false si la fecha no tiene ese formato.
+ */
+bool parseTimestamp(const std::string& created_at, int64_t& segundos);
+
+/**
+ * @brief Inversa de parseTimestamp: mm/dd/YYYY HH:MM, con :SS solo si no son cero.
+ */
+std::string formatTimestamp(int64_t segundos);
+
+/**
+ * @brief Filtro de filas que se aplica al separar los campos de cada línea.
+ *
+ * Las filas que no pasan se descartan antes de copiar el resto de los campos
+ * y antes de convertir cualquier número.
+ */
+struct IngestFilter {
+    int64_t desde;             // Segundos, ver parseTimestamp
+    int64_t hasta;
+    std::vector<int> strikes;  // Ordenados; vacío = todos
+    std::string kind;          // CALL o PUT; vacío = todos
+};
+
+/**
+ * @brief Filtro que deja pasar todas las filas.
+ */
+IngestFilter acceptAllRows();
+
+/**
+ * @brief Convierte una línea del archivo de cotizaciones en una fila.
+ *
+ * @param linea Línea con los campos separados por ;
+ * @param dato Fila donde se guardan los campos.
+ * @return true si la línea tiene suficientes campos.
+ */
+bool parseLine(const std::string& linea, Data& dato);
+
+/**
+ * @brief Convierte una línea en una fila si pasa el filtro.
+ *
+ * Los campos se separan sin copiarlos; primero se miran el tipo, el strike y
+ * la fecha, y solo si la fila pasa el filtro se copian los demás.
+ *
+ * @param inicio Comienzo de la línea.
+ * @param fin Fin de la línea (sin el salto de línea).
+ * @param filtro Filas que se conservan.
+ * @param dato Fila donde se guardan los campos.
+ * @param error Si no es nullptr, recibe RowError::MALFORMED_LINE cuando la línea
+ *              no tiene suficientes campos, o RowError::NONE (las líneas vacías
+ *              y las que no pasan el filtro no son errores).
+ * @return true si la línea tiene suficientes campos y pasa el filtro.
+ */
+bool parseLine(const char* inicio, const char* fin, const IngestFilter& filtro, Data& dato,
+               RowError* error = nullptr);
+
+#endif // BLACKSCHOLES_PARSING_HPP
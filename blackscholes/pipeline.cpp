@@ -0,0 +1,873 @@
+#include "pipeline.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
+#include "archive.hpp"
+#include "async_io.hpp"
+#include "compression.hpp"
+#include "outliers.hpp"
+#include "pricing.hpp"
+#include "query.hpp"
+
+namespace {
+
+template <size_t N>
+void copiarTexto(char (&destino)[N], const std::string& origen) {
+    size_t largo = std::min(origen.size(), N - 1);
+    std::memcpy(destino, origen.data(), largo);
+    std::memset(destino + largo, 0, N - largo);
+}
+
+/**
+ * @brief Volatilidades implícitas ya calculadas de un archivo.
+ *
+ * La clave son los ticks del precio y del subyacente con su grilla, el strike,
+ * el plazo y el tipo, así que dos cotizaciones iguales dan exactamente la
+ * misma clave. Se reparte en particiones con su propio mutex para que los
+ * hilos casi no compitan.
+ */
+class ImpliedVolatilityCache {
+public:
+    struct Key {
+        int64_t precio;      // Bid + ask en ticks
+        int64_t subyacente;  // Under bid + under ask en ticks
+        uint64_t strike;     // Bits del strike
+        uint64_t plazo;      // Bits del plazo en años
+        uint64_t call;       // 1 para las opciones de compra, 0 para las de venta
+        uint64_t grilla;     // Grilla de ticks del instrumento (ver QuoteColumns::grillas)
+
+        bool operator==(const Key& otra) const {
+            return precio == otra.precio && subyacente == otra.subyacente &&
+                   strike == otra.strike && plazo == otra.plazo && call == otra.call &&
+                   grilla == otra.grilla;
+        }
+    };
+
+    /**
+     * @brief Devuelve la volatilidad guardada o la calcula con calcular().
+     *
+     * Si dos hilos piden la misma clave a la vez las dos la calculan; el
+     * resultado es el mismo.
+     */
+    template <typename Calcular>
+    double get(const Key& clave, Calcular calcular) {
+        size_t hash = Hash()(clave);
+        Particion& particion = particiones_[hash % kParticiones];
+        {
+            std::lock_guard<std::mutex> lock(particion.mutex);
+            auto it = particion.valores.find(clave);
+            if (it != particion.valores.end()) {
+                return it->second;
+            }
+        }
+
+        double volatilidad = calcular();
+        std::lock_guard<std::mutex> lock(particion.mutex);
+        particion.valores.emplace(clave, volatilidad);
+        return volatilidad;
+    }
+
+private:
+    struct Hash {
+        size_t operator()(const Key& clave) const {
+            // splitmix64 de cada campo
+            uint64_t h = 0;
+            for (uint64_t campo : {static_cast<uint64_t>(clave.precio),
+                                   static_cast<uint64_t>(clave.subyacente),
+                                   clave.strike, clave.plazo, clave.call, clave.grilla}) {
+                h ^= campo + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+                h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+                h ^= h >> 31;
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    static const size_t kParticiones = 64;
+
+    struct Particion {
+        std::mutex mutex;
+        std::unordered_map<Key, double, Hash> valores;
+    };
+
+    std::array<Particion, kParticiones> particiones_;
+};
+
+}  // namespace
+
+ResultRecord toResultRecord(const OptionData& opcion) {
+    ResultRecord registro;
+    copiarTexto(registro.description, opcion.description);
+    copiarTexto(registro.kind, opcion.kind);
+    copiarTexto(registro.created_at, opcion.created_at);
+    registro.strike = opcion.strike;
+    registro.bid = opcion.bid;
+    registro.ask = opcion.ask;
+    registro.under_bid = opcion.under_bid;
+    registro.under_ask = opcion.under_ask;
+    registro.price = opcion.price;
+    registro.under_price = opcion.under_price;
+    registro.implied_volatility = opcion.implied_volatility;
+    registro.under_volatility = opcion.under_volatility;
+    registro.expiration = opcion.expiration;
+    registro.iv_outlier = opcion.iv_outlier;
+    registro.under_vol_outlier = opcion.under_vol_outlier;
+    registro.error = static_cast<uint8_t>(opcion.error);
+    registro.validez = opcion.validez;
+    registro.reservado = 0;
+    registro.publicado_ns = 0;
+    return registro;
+}
+
+const std::vector<std::string>& csvColumns() {
+    static const std::vector<std::string> columnas = {
+        "Description", "Strike", "Kind", "Bid", "Ask", "Under Bid", "Under Ask", "Created At",
+        "Price", "Valor intrinsico", "Valor extrinsico", "Under Price", "Implied volatility",
+        "Under volatility", "Years to expiration", "IV outlier", "Under vol outlier", "Error"};
+    return columnas;
+}
+
+std::string csvHeader() {
+    std::string encabezado;
+    for (const std::string& columna : csvColumns()) {
+        if (!encabezado.empty()) {
+            encabezado += ",";
+        }
+        encabezado += columna;
+    }
+    return encabezado;
+}
+
+bool resolveCsvColumns(const std::vector<std::string>& nombres, std::vector<size_t>& columnas) {
+    const std::vector<std::string>& todas = csvColumns();
+    columnas.clear();
+    for (const std::string& nombre : nombres) {
+        auto it = std::find(todas.begin(), todas.end(), nombre);
+        if (it == todas.end()) {
+            std::cerr << "Columna desconocida: " << nombre << std::endl;
+            return false;
+        }
+        columnas.push_back(static_cast<size_t>(it - todas.begin()));
+    }
+    return true;
+}
+
+void writeRows(std::ostream& salida, const std::vector<OptionData>& dataframe,
+               size_t desde, size_t hasta) {
+    static const std::vector<size_t> todas = [] {
+        std::vector<size_t> columnas(csv::COLUMN_COUNT);
+        for (size_t c = 0; c < columnas.size(); c++) {
+            columnas[c] = c;
+        }
+        return columnas;
+    }();
+    writeRows(salida, dataframe, desde, hasta, todas);
+}
+
+void writeRows(std::ostream& salida, const std::vector<OptionData>& dataframe,
+               size_t desde, size_t hasta, const std::vector<size_t>& columnas) {
+    for (size_t i = desde; i < hasta; i++) {
+        const OptionData& row = dataframe[i];
+        for (size_t c = 0; c < columnas.size(); c++) {
+            if (c > 0) {
+                salida << ",";
+            }
+            // Sin valor, el campo queda vacío
+            if (!isValid(row, static_cast<csv::Column>(columnas[c]))) {
+                continue;
+            }
+            switch (columnas[c]) {
+                case csv::DESCRIPTION: salida << row.description; break;
+                case csv::STRIKE: salida << row.strike; break;
+                case csv::KIND: salida << row.kind; break;
+                case csv::BID: salida << row.bid; break;
+                case csv::ASK: salida << row.ask; break;
+                case csv::UNDER_BID: salida << row.under_bid; break;
+                case csv::UNDER_ASK: salida << row.under_ask; break;
+                case csv::CREATED_AT: salida << row.created_at; break;
+                case csv::PRICE: salida << row.price; break;
+                case csv::INTRINSIC_VALUE: salida << row.intrinsic_value; break;
+                case csv::EXTRINSIC_VALUE: salida << row.extrinsic_value; break;
+                case csv::UNDER_PRICE: salida << row.under_price; break;
+                case csv::IMPLIED_VOLATILITY: salida << row.implied_volatility; break;
+                case csv::UNDER_VOLATILITY: salida << row.under_volatility; break;
+                case csv::EXPIRATION: salida << row.expiration; break;
+                case csv::IV_OUTLIER: salida << row.iv_outlier; break;
+                case csv::UNDER_VOL_OUTLIER: salida << row.under_vol_outlier; break;
+                case csv::ERROR: salida << rowErrorName(row.error); break;
+            }
+        }
+        salida << "\n";
+    }
+}
+
+void saveFile(const std::vector<OptionData>& dataframe,
+              const std::filesystem::path& archivoPath,
+              Scheduler* scheduler,
+              const std::vector<size_t>& columnas) {
+
+    if (archivoPath.extension() == ".bsc") {
+        if (!writeArchive(dataframe, archivoPath, scheduler)) {
+            std::cerr << "Error al escribir " << archivoPath << std::endl;
+            return;
+        }
+        std::cout << "Datos guardados correctamente" << std::endl;
+        return;
+    }
+
+    // Abrir un archivo para escritura
+    AsyncFileWriter archivoSalida(archivoPath);
+
+    // Verificar si el archivo se abrió correctamente
+    if (!archivoSalida.ok()) {
+        std::cerr << "No se pudo abrir el archivo de salida." << std::endl;
+        return; // Salir sin escribir si hay un error
+    }
+
+    // Encabezados
+    std::string encabezados = csvHeader() + "\n";
+    if (!columnas.empty()) {
+        encabezados.clear();
+        for (size_t c = 0; c < columnas.size(); c++) {
+            encabezados += (c > 0 ? "," : "") + csvColumns()[columnas[c]];
+        }
+        encabezados += "\n";
+    }
+    archivoSalida.write(encabezados.data(), encabezados.size());
+
+    // Las filas se formatean por tandas de bloques: mientras se formatea una
+    // tanda, las escrituras de la anterior siguen en vuelo
+    const size_t filas_por_bloque = 4096;
+    const size_t bloques_por_tanda = 32;
+    size_t cantidad_bloques = (dataframe.size() + filas_por_bloque - 1) / filas_por_bloque;
+    std::vector<std::string> bloques(std::min(cantidad_bloques, bloques_por_tanda));
+
+    // Índice de fechas: posición y rango de fechas de cada bloque (ver runQuery)
+    std::vector<archive::BlockInfo> indice(cantidad_bloques);
+    uint64_t offset = encabezados.size();
+
+    for (size_t tanda = 0; tanda < cantidad_bloques; tanda += bloques_por_tanda) {
+        size_t en_tanda = std::min(bloques_por_tanda, cantidad_bloques - tanda);
+
+        auto formatear = [&](size_t desde, size_t hasta) {
+            for (size_t b = desde; b < hasta; b++) {
+                std::ostringstream bloque;
+                size_t primera = (tanda + b) * filas_por_bloque;
+                size_t ultima = std::min(dataframe.size(), primera + filas_por_bloque);
+                if (columnas.empty()) {
+                    writeRows(bloque, dataframe, primera, ultima);
+                } else {
+                    writeRows(bloque, dataframe, primera, ultima, columnas);
+                }
+                bloques[b] = bloque.str();
+
+                archive::BlockInfo& entrada = indice[tanda + b];
+                entrada.filas = static_cast<uint32_t>(ultima - primera);
+                entrada.desde = std::numeric_limits<int64_t>::max();
+                entrada.hasta = std::numeric_limits<int64_t>::min();
+                for (size_t i = primera; i < ultima; i++) {
+                    int64_t segundos;
+                    if (parseTimestamp(dataframe[i].created_at, segundos)) {
+                        entrada.desde = std::min(entrada.desde, segundos);
+                        entrada.hasta = std::max(entrada.hasta, segundos);
+                    }
+                }
+            }
+        };
+
+        if (scheduler == nullptr) {
+            formatear(0, en_tanda);
+        } else {
+            scheduler->parallelFor(en_tanda, 1, formatear);
+        }
+
+        for (size_t b = 0; b < en_tanda; b++) {
+            indice[tanda + b].offset = offset;
+            indice[tanda + b].bytes = bloques[b].size();
+            offset += bloques[b].size();
+            archivoSalida.write(bloques[b].data(), bloques[b].size());
+        }
+    }
+
+    // Cerrar el archivo después de escribir
+    if (!archivoSalida.close()) {
+        std::cerr << "Error al escribir " << archivoPath << std::endl;
+        return;
+    }
+
+    if (!writeTimeIndex(archivoPath, indice, offset)) {
+        std::cerr << "No se pudo escribir " << timeIndexPath(archivoPath) << std::endl;
+    }
+
+    std::cout << "Datos guardados correctamente" << std::endl;
+}
+
+namespace {
+
+/**
+ * @brief Parsea las líneas completas de un bloque del archivo.
+ */
+void parseBlock(const std::string& texto, const IngestFilter& filtro,
+                Diagnostics* diagnostico, std::vector<Data>& destino) {
+    const char* linea = texto.data();
+    const char* fin = texto.data() + texto.size();
+
+    // Recorre cada línea del bloque
+    while (linea < fin) {
+        const char* fin_linea = static_cast<const char*>(std::memchr(linea, '\n', fin - linea));
+        if (fin_linea == nullptr) {
+            fin_linea = fin;
+        }
+        const char* siguiente = fin_linea + 1;
+        if (fin_linea > linea && fin_linea[-1] == '\r') {
+            fin_linea--;
+        }
+
+        Data dato;
+        RowError error;
+        if (parseLine(linea, fin_linea, filtro, dato, &error)) {
+            destino.push_back(std::move(dato));
+        } else if (error != RowError::NONE && diagnostico != nullptr) {
+            diagnostico->record(error, linea, static_cast<size_t>(fin_linea - linea));
+        }
+        linea = siguiente;
+    }
+}
+
+}  // namespace
+
+bool readFile(const std::filesystem::path& nombreArchivo, std::vector<Data>& datos,
+              Scheduler& scheduler, const IngestFilter* filtro, Diagnostics* diagnostico) {
+    static const IngestFilter todas = acceptAllRows();
+    if (filtro == nullptr) {
+        filtro = &todas;
+    }
+
+    // Abre el archivo; las primeras lecturas quedan en vuelo desde ya.
+    // Si está comprimido se descomprime en memoria a medida que se lee
+    DecompressingReader archivo(nombreArchivo, scheduler);
+
+    // Verifica si la apertura fue exitosa
+    if (!archivo.ok()) {
+        return false;
+    }
+
+    // Cada bloque leído se parsea en el scheduler mientras se leen los siguientes.
+    // deque: las referencias a los parciales no cambian al agregar bloques
+    TaskGroup grupo;
+    std::deque<std::vector<Data>> parciales;
+    std::string resto;
+    bool encabezado = true;
+
+    const char* bloque;
+    size_t bytes;
+    while (archivo.next(bloque, bytes)) {
+        // La última línea incompleta del bloque pasa al siguiente
+        const char* ultimo = static_cast<const char*>(memrchr(bloque, '\n', bytes));
+        size_t completos = ultimo ? static_cast<size_t>(ultimo - bloque) + 1 : 0;
+
+        std::string texto;
+        texto.swap(resto);
+        texto.append(bloque, completos);
+        resto.assign(bloque + completos, bytes - completos);
+        archivo.release();
+
+        if (texto.empty()) {
+            continue;
+        }
+
+        // Saltea la primera línea (encabezados)
+        if (encabezado) {
+            texto.erase(0, texto.find('\n') + 1);
+            encabezado = false;
+        }
+
+        parciales.emplace_back();
+        std::vector<Data>& destino = parciales.back();
+        scheduler.submit(grupo, [texto = std::move(texto), filtro, diagnostico, &destino]() {
+            parseBlock(texto, *filtro, diagnostico, destino);
+        });
+    }
+
+    // Una última línea sin fin de línea
+    if (!resto.empty() && !encabezado) {
+        parciales.emplace_back();
+        parseBlock(resto, *filtro, diagnostico, parciales.back());
+    }
+
+    scheduler.wait(grupo);
+
+    if (!archivo.ok()) {
+        std::cerr << "Error al leer " << nombreArchivo << std::endl;
+        return false;
+    }
+
+    for (auto& parcial : parciales) {
+        datos.insert(datos.end(), std::make_move_iterator(parcial.begin()),
+                     std::make_move_iterator(parcial.end()));
+    }
+
+    return true;
+}
+
+std::vector<OptionData> processData(std::vector<Data>& datos, const std::string& fecha_vencimiento,
+                                    const RateCurve& curva, const PipelineConfig& config,
+                                    Scheduler& scheduler) {
+    if (datos.empty()) {
+        return std::vector<OptionData>();
+    }
+
+    // Campos numéricos con su validez. Las tareas toman de a 256 filas, que
+    // empiezan en múltiplos de 64, así que cada una escribe sus propias
+    // palabras de las máscaras
+    const size_t filas_por_tarea = 256;
+    const size_t filas_por_palabra = ValidityMask::FILAS_POR_PALABRA;
+    QuoteColumns cotizaciones;
+    if (config.ticks != nullptr) {
+        cotizaciones.resize(datos.size(), *config.ticks);
+    } else {
+        cotizaciones.resize(datos.size());
+    }
+    scheduler.parallelFor(datos.size(), filas_por_tarea, [&](size_t desde, size_t hasta) {
+        parseQuotes(datos, desde, hasta, cotizaciones);
+    });
+
+    // Los huecos se rellenan con la serie de cada contrato en orden de fecha;
+    // sin huecos no hace falta convertir las fechas
+    if (hasGaps(cotizaciones)) {
+        RowTimes fechas;
+        fechas.resize(datos.size());
+        scheduler.parallelFor(datos.size(), filas_por_tarea, [&](size_t desde, size_t hasta) {
+            parseRowTimes(datos, desde, hasta, fechas);
+        });
+        fillGaps(cotizaciones, fechas, groupByContract(datos, fechas), config.relleno);
+    }
+
+    // Los precios pasan a double recién acá, al entrar al pricer
+    const bool en_ticks = cotizaciones.en_ticks;
+    auto precio = [en_ticks, &cotizaciones](const NumericColumn& valores,
+                                            const TickColumn& ticks, size_t i) {
+        return en_ticks ? ticks.value(i, cotizaciones.grilla(i)) : valores.valores[i];
+    };
+    auto validos = [en_ticks](const NumericColumn& valores, const TickColumn& ticks,
+                              size_t palabra) {
+        return en_ticks ? ticks.validos.word(palabra) : valores.validos.word(palabra);
+    };
+    std::unique_ptr<ImpliedVolatilityCache> cache_iv;
+    if (en_ticks) {
+        cache_iv.reset(new ImpliedVolatilityCache());
+    }
+
+    // Solo se calcula lo que necesitan las columnas de la salida, las que se
+    // piden aparte (config.calculadas), el ring y la superficie
+    auto necesita = [&](csv::Column columna) {
+        auto pedida = [columna](const std::vector<size_t>& columnas) {
+            return std::find(columnas.begin(), columnas.end(), static_cast<size_t>(columna)) !=
+                   columnas.end();
+        };
+        return config.columnas.empty() || config.publicador != nullptr ||
+               pedida(config.columnas) || pedida(config.calculadas);
+    };
+    const bool calcular_iv = necesita(csv::IMPLIED_VOLATILITY) || necesita(csv::IV_OUTLIER) ||
+                             config.superficie != nullptr;
+    const bool calcular_under_vol = necesita(csv::UNDER_VOLATILITY) ||
+                                    necesita(csv::UNDER_VOL_OUTLIER);
+    const bool calcular_plazo = calcular_iv || calcular_under_vol || necesita(csv::EXPIRATION);
+    const bool calcular_precio = calcular_iv || necesita(csv::BID) || necesita(csv::ASK) ||
+                                 necesita(csv::PRICE) || necesita(csv::EXTRINSIC_VALUE);
+    const bool calcular_under = calcular_iv || calcular_under_vol || necesita(csv::UNDER_BID) ||
+                                necesita(csv::UNDER_ASK) || necesita(csv::UNDER_PRICE) ||
+                                necesita(csv::INTRINSIC_VALUE) || necesita(csv::EXTRINSIC_VALUE);
+
+    // Máscara de una etapa: todas las filas si se calcula, ninguna si no
+    auto etapa = [](bool calcular) { return calcular ? ~uint64_t(0) : uint64_t(0); };
+
+    // Vector para almacenar filas del DataFrame
+    std::vector<OptionData> dataframe(datos.size());
+
+    // Calcula las filas de una palabra de las máscaras (64 filas)
+    auto calcularPalabra = [&](size_t palabra) {
+        size_t primera = palabra * filas_por_palabra;
+        size_t ultima = std::min(datos.size(), primera + filas_por_palabra);
+
+        uint64_t plazo = 0;      // Plazo calculado
+        uint64_t positivos = 0;  // Plazo, precios y strike mayores a 0
+        uint64_t calls = 0;      // Kind CALL
+        uint64_t puts = 0;       // Kind PUT
+        RowError motivos_plazo[filas_por_palabra];
+
+        for (size_t i = primera; i < ultima; i++) {
+            size_t bit = i - primera;
+            // Construye una estructura OptionData y la guarda en el DataFrame
+            OptionData& opcion = dataframe[i];
+            opcion.description = datos[i].description;
+            opcion.kind = datos[i].kind;
+            opcion.created_at = datos[i].created_at;
+            opcion.expiration_date = fecha_vencimiento;
+
+            // Valido con una expresion regular que la fecha tenga siempre
+            // el mismo formato.
+            RowError motivo = RowError::NONE;
+            opcion.expiration = 0.0;
+            if (calcular_plazo) {
+                motivo = RowError::INVALID_QUOTE_DATE;
+                if (!datos[i].created_at.empty()) {
+                    opcion.expiration = obtenerDiferenciaEnAnios(datos[i].created_at,
+                                                                 fecha_vencimiento, &motivo);
+                }
+            }
+            motivos_plazo[bit] = motivo;
+            plazo |= uint64_t(calcular_plazo && motivo == RowError::NONE) << bit;
+
+            // La aritmética se hace en todas las filas; las máscaras dicen
+            // cuáles resultados valen
+            opcion.bid = precio(cotizaciones.bid, cotizaciones.bid_ticks, i);
+            opcion.ask = precio(cotizaciones.ask, cotizaciones.ask_ticks, i);
+            opcion.under_bid = precio(cotizaciones.under_bid, cotizaciones.under_bid_ticks, i);
+            opcion.under_ask = precio(cotizaciones.under_ask, cotizaciones.under_ask_ticks, i);
+            opcion.price = (opcion.bid + opcion.ask) / 2;
+            opcion.under_price = (opcion.under_ask + opcion.under_bid) / 2;
+            opcion.strike = static_cast<int>(cotizaciones.strike.valores[i]);
+            // El valor intrínseco depende del tipo; con otro kind no tiene valor
+            bool call = opcion.kind == "CALL";
+            bool put = opcion.kind == "PUT";
+            calls |= uint64_t(call) << bit;
+            puts |= uint64_t(put) << bit;
+            opcion.intrinsic_value = put ? opcion.strike - opcion.under_price
+                                         : opcion.under_price - opcion.strike;
+            opcion.extrinsic_value = opcion.price - opcion.intrinsic_value;
+            opcion.implied_volatility = 0.0;
+            opcion.under_volatility = 0.0;
+            opcion.iv_outlier = false;
+            opcion.under_vol_outlier = false;
+
+            bool positivo = (opcion.expiration > 0) & (opcion.price > 0) &
+                            (opcion.under_price > 0) & (cotizaciones.strike.valores[i] > 0);
+            positivos |= uint64_t(positivo) << bit;
+        }
+
+        // Validez de cada resultado, de a 64 filas
+        uint64_t strike = cotizaciones.strike.validos.word(palabra);
+        uint64_t bid = validos(cotizaciones.bid, cotizaciones.bid_ticks, palabra);
+        uint64_t ask = validos(cotizaciones.ask, cotizaciones.ask_ticks, palabra);
+        uint64_t under_bid = validos(cotizaciones.under_bid, cotizaciones.under_bid_ticks,
+                                     palabra);
+        uint64_t under_ask = validos(cotizaciones.under_ask, cotizaciones.under_ask_ticks,
+                                     palabra);
+        uint64_t fuera_de_grilla = en_ticks ? cotizaciones.fuera_de_grilla.word(palabra) : 0;
+        uint64_t precio = bid & ask & etapa(calcular_precio);
+        uint64_t under = under_bid & under_ask & etapa(calcular_under);
+        uint64_t intrinseco = under & strike & (calls | puts);
+        uint64_t extrinseco = precio & intrinseco;
+        uint64_t under_vol = under & etapa(calcular_under_vol);
+
+        // Si todas las validaciones fueron correctas calcula la
+        // volatilidad implicita, con el pricer del tipo de la fila
+        uint64_t iv = plazo & precio & under & strike & positivos & (calls | puts) &
+                      etapa(calcular_iv);
+        ValidityMask::forEachSet(palabra, iv, [&](size_t i) {
+            OptionData& opcion = dataframe[i];
+            const bool call = (calls >> (i - primera)) & 1;
+            auto calcular = [&] {
+                auto invertir = call ? findImpliedVolatility : findImpliedVolatilityPut;
+                return invertir(opcion.under_price,
+                    cotizaciones.strike.valores[i], opcion.expiration,
+                    curva.continuous(opcion.expiration), opcion.price,
+                    0.00001, 5, config.tolerance, config.max_iterations);
+            };
+            if (cache_iv) {
+                ImpliedVolatilityCache::Key clave;
+                clave.precio = cotizaciones.bid_ticks.ticks[i] + cotizaciones.ask_ticks.ticks[i];
+                clave.subyacente = cotizaciones.under_bid_ticks.ticks[i] +
+                                   cotizaciones.under_ask_ticks.ticks[i];
+                std::memcpy(&clave.strike, &cotizaciones.strike.valores[i], sizeof(clave.strike));
+                std::memcpy(&clave.plazo, &opcion.expiration, sizeof(clave.plazo));
+                clave.call = call ? 1 : 0;
+                clave.grilla = cotizaciones.grilla(i);
+                opcion.implied_volatility = cache_iv->get(clave, calcular);
+            } else {
+                opcion.implied_volatility = calcular();
+            }
+            if (opcion.implied_volatility < 0) {
+                iv &= ~(uint64_t(1) << (i - primera));
+            }
+        });
+
+        ValidityMask::forEachSet(palabra, under_vol, [&](size_t i) {
+            OptionData& opcion = dataframe[i];
+            opcion.under_volatility = calculateUnderVolatility(opcion.under_bid,
+                                                               opcion.under_ask,
+                                                               opcion.expiration);
+        });
+
+        for (size_t i = primera; i < ultima; i++) {
+            size_t bit = i - primera;
+            OptionData& opcion = dataframe[i];
+            auto validez = [bit](uint64_t mascara, csv::Column columna) {
+                return static_cast<uint32_t>((mascara >> bit) & 1) << columna;
+            };
+            opcion.validez = csv::ALWAYS_VALID |
+                             validez(strike, csv::STRIKE) |
+                             validez(bid, csv::BID) |
+                             validez(ask, csv::ASK) |
+                             validez(under_bid, csv::UNDER_BID) |
+                             validez(under_ask, csv::UNDER_ASK) |
+                             validez(precio, csv::PRICE) |
+                             validez(intrinseco, csv::INTRINSIC_VALUE) |
+                             validez(extrinseco, csv::EXTRINSIC_VALUE) |
+                             validez(under, csv::UNDER_PRICE) |
+                             validez(iv, csv::IMPLIED_VOLATILITY) |
+                             validez(under_vol, csv::UNDER_VOLATILITY) |
+                             validez(plazo, csv::EXPIRATION);
+
+            // Se guarda el primer problema de la fila
+            RowError error = motivos_plazo[bit];
+            if (error == RowError::NONE && (fuera_de_grilla >> bit & 1)) {
+                error = RowError::OFF_TICK_GRID;
+            }
+            if (error == RowError::NONE && calcular_precio && !((bid & ask) >> bit & 1)) {
+                error = RowError::INVALID_PRICE;
+            }
+            if (error == RowError::NONE && calcular_under &&
+                !((under_bid & under_ask) >> bit & 1)) {
+                error = RowError::INVALID_UNDER_PRICE;
+            }
+            if (error == RowError::NONE && !(strike >> bit & 1)) {
+                error = RowError::INVALID_STRIKE;
+            }
+            if (error == RowError::NONE && calcular_iv && !((calls | puts) >> bit & 1)) {
+                error = RowError::INVALID_KIND;
+            }
+            if (error == RowError::NONE && calcular_iv && (positivos >> bit & 1) &&
+                !(iv >> bit & 1)) {
+                error = RowError::IV_NOT_FOUND;
+            }
+
+            opcion.error = error;
+            if (error != RowError::NONE && config.diagnostico != nullptr) {
+                config.diagnostico->record(error, datos[i].created_at);
+            }
+        }
+    };
+
+    scheduler.parallelFor(datos.size(), filas_por_tarea, [&](size_t desde, size_t hasta) {
+        for (size_t palabra = desde / filas_por_palabra; palabra * filas_por_palabra < hasta;
+             palabra++) {
+            calcularPalabra(palabra);
+        }
+    });
+
+    // Cada contrato (Description) tiene su propia serie, en orden de fecha, con
+    // su par de filtros: la ventana no mezcla strikes ni tipos. Las filas de
+    // una misma fecha quedan en el orden del archivo
+    std::vector<std::vector<size_t>> contratos;
+    std::unordered_map<std::string, size_t> posiciones;
+    for (size_t i = 0; i < dataframe.size(); i++) {
+        auto it = posiciones.emplace(dataframe[i].description, contratos.size()).first;
+        if (it->second == contratos.size()) {
+            contratos.emplace_back();
+        }
+        contratos[it->second].push_back(i);
+    }
+
+    // Marca (o reemplaza) los outliers de cada serie. Los valores que faltan
+    // no entran en la ventana
+    scheduler.parallelFor(contratos.size(), 1, [&](size_t desde, size_t hasta) {
+        std::vector<std::pair<int64_t, size_t>> serie;
+        for (size_t c = desde; c < hasta; c++) {
+            serie.clear();
+            for (size_t i : contratos[c]) {
+                int64_t segundos;
+                if (!parseTimestamp(dataframe[i].created_at, segundos)) {
+                    segundos = std::numeric_limits<int64_t>::min();
+                }
+                serie.emplace_back(segundos, i);
+            }
+            std::sort(serie.begin(), serie.end());
+
+            HampelFilter filtro_iv(config.ventana_outliers, config.umbral_outliers);
+            HampelFilter filtro_under_vol(config.ventana_outliers, config.umbral_outliers);
+            for (const auto& elemento : serie) {
+                OptionData& opcion = dataframe[elemento.second];
+                double mediana;
+                if (isValid(opcion, csv::IMPLIED_VOLATILITY)) {
+                    opcion.validez |= 1u << csv::IV_OUTLIER;
+                    opcion.iv_outlier = filtro_iv.filter(opcion.implied_volatility, mediana);
+                    if (opcion.iv_outlier && config.reemplazar_outliers) {
+                        opcion.implied_volatility = mediana;
+                    }
+                }
+
+                if (isValid(opcion, csv::UNDER_VOLATILITY)) {
+                    opcion.validez |= 1u << csv::UNDER_VOL_OUTLIER;
+                    opcion.under_vol_outlier = filtro_under_vol.filter(opcion.under_volatility,
+                                                                       mediana);
+                    if (opcion.under_vol_outlier && config.reemplazar_outliers) {
+                        opcion.under_volatility = mediana;
+                    }
+                }
+            }
+        }
+    });
+
+    // Publica las filas terminadas en el orden del archivo
+    for (OptionData& opcion : dataframe) {
+        // Un minuto nuevo cierra la superficie del minuto anterior
+        if (config.superficie != nullptr && &opcion != &dataframe.front() &&
+            opcion.created_at != (&opcion - 1)->created_at) {
+            config.superficie->publish();
+        }
+
+        if (config.publicador != nullptr) {
+            config.publicador->publish(toResultRecord(opcion));
+        }
+
+        if (config.superficie != nullptr && isValid(opcion, csv::IMPLIED_VOLATILITY)) {
+            config.superficie->update(opcion.kind, opcion.expiration_date, opcion.strike,
+                                      opcion.implied_volatility, opcion.expiration,
+                                      opcion.created_at);
+        }
+    }
+
+    if (config.superficie != nullptr) {
+        config.superficie->publish();
+    }
+
+    return dataframe;
+}
+
+bool matchesPattern(const std::string& nombre, const std::string& patron) {
+    size_t n = 0, p = 0;
+    size_t estrella = std::string::npos, marca = 0;
+
+    while (n < nombre.size()) {
+        if (p < patron.size() && (patron[p] == '?' || patron[p] == nombre[n])) {
+            n++;
+            p++;
+        } else if (p < patron.size() && patron[p] == '*') {
+            estrella = p++;
+            marca = n;
+        } else if (estrella != std::string::npos) {
+            p = estrella + 1;
+            n = ++marca;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < patron.size() && patron[p] == '*') {
+        p++;
+    }
+    return p == patron.size();
+}
+
+std::vector<std::filesystem::path> listInputFiles(const std::string& entrada) {
+    std::vector<std::filesystem::path> archivos;
+    std::filesystem::path ruta(entrada);
+
+    std::filesystem::path directorio = ruta;
+    std::vector<std::string> patrones = {"*.csv", "*.csv.gz", "*.csv.zst"};
+
+    if (!std::filesystem::is_directory(ruta)) {
+        directorio = ruta.has_parent_path() ? ruta.parent_path() : ".";
+        patrones = {ruta.filename().string()};
+    }
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directorio, error)) {
+        std::string nombre = entry.path().filename().string();
+        if (entry.is_regular_file() &&
+            std::any_of(patrones.begin(), patrones.end(),
+                        [&](const std::string& patron) { return matchesPattern(nombre, patron); })) {
+            archivos.push_back(entry.path());
+        }
+    }
+
+    std::sort(archivos.begin(), archivos.end());
+    return archivos;
+}
+
+int runBatch(const std::string& entrada, bool merge, Scheduler& scheduler,
+             const RateCurve& curva, ExpirationCalendar& calendario,
+             const PipelineConfig& config) {
+    std::vector<std::filesystem::path> archivos = listInputFiles(entrada);
+
+    if (archivos.empty()) {
+        std::cerr << "No se encontraron archivos en " << entrada << std::endl;
+        return 1;
+    }
+
+    std::vector<uintmax_t> tamanios(archivos.size());
+    std::vector<size_t> orden(archivos.size());
+    for (size_t i = 0; i < archivos.size(); i++) {
+        std::error_code error;
+        tamanios[i] = std::filesystem::file_size(archivos[i], error);
+        orden[i] = i;
+    }
+    std::sort(orden.begin(), orden.end(),
+              [&](size_t a, size_t b) { return tamanios[a] > tamanios[b]; });
+
+    std::vector<std::vector<OptionData>> resultados(archivos.size());
+    std::atomic<size_t> fallidos(0);
+    TaskGroup grupo;
+    std::vector<uintmax_t> asignado(scheduler.size(), 0);
+
+    for (size_t i : orden) {
+        size_t hilo = std::min_element(asignado.begin(), asignado.end()) - asignado.begin();
+        asignado[hilo] += tamanios[i];
+
+        scheduler.submit(grupo, [&, i] {
+            std::vector<Data> datos;
+            if (!readFile(archivos[i], datos, scheduler, &config.filtro, config.diagnostico)) {
+                std::cerr << "Error al abrir el archivo " << archivos[i] << "\n";
+                fallidos.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            std::string fecha_vencimiento;
+            if (datos.empty() ||
+                !calendario.expirationFor(archivos[i], datos[0].created_at, fecha_vencimiento)) {
+                std::cerr << "No se pudo determinar el vencimiento de " << archivos[i] << "\n";
+                fallidos.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            resultados[i] = processData(datos, fecha_vencimiento, curva, config, scheduler);
+
+            if (!merge) {
+                saveFile(resultados[i],
+                         "output_" + stripCompressionExtension(archivos[i]).stem().string() +
+                             config.extension_salida,
+                         &scheduler, config.columnas);
+            }
+        }, hilo);
+    }
+
+    scheduler.wait(grupo);
+
+    if (merge) {
+        std::vector<OptionData> dataframe;
+        for (auto& resultado : resultados) {
+            dataframe.insert(dataframe.end(), resultado.begin(), resultado.end());
+        }
+        saveFile(dataframe, "output" + config.extension_salida, &scheduler, config.columnas);
+    }
+
+    if (fallidos > 0) {
+        std::cerr << fallidos << " de " << archivos.size() << " archivos no se procesaron"
+                  << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,389 @@
+/**
+ * @file
+ * @brief Pipeline de un archivo de cotizaciones (lectura, cálculo y escritura) y
+ * procesamiento de varios archivos.
+ */
+
+#ifndef BLACKSCHOLES_PIPELINE_HPP
+#define BLACKSCHOLES_PIPELINE_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "diagnostics.hpp"
+#include "gap_fill.hpp"
+#include "parsing.hpp"
+#include "result_ring.hpp"
+#include "scheduler.hpp"
+#include "vol_surface.hpp"
+
+/**
+ * @brief Estructura para representar los datos de una opción en el DataFrame.
+ */
+struct OptionData {
+    std::string description;
+    int strike;
+    std::string kind;
+    double bid;
+    double ask;
+    double under_bid;
+    double under_ask;
+    std::string created_at;
+    std::string expiration_date;
+    double price;
+    double intrinsic_value;
+    double extrinsic_value;
+    double under_price;
+    double implied_volatility;
+    double under_volatility;
+    double expiration;
+    bool iv_outlier;
+    bool under_vol_outlier;
+    RowError error;  // Primer problema de la fila, ver Diagnostics
+    uint32_t validez;  // Un bit por columna (csv::Column) con valor; ver isValid
+};
+
+namespace csv {
+
+/**
+ * @brief Columnas del CSV de resultados, en orden.
+ */
+enum Column : size_t {
+    DESCRIPTION,
+    STRIKE,
+    KIND,
+    BID,
+    ASK,
+    UNDER_BID,
+    UNDER_ASK,
+    CREATED_AT,
+    PRICE,
+    INTRINSIC_VALUE,
+    EXTRINSIC_VALUE,
+    UNDER_PRICE,
+    IMPLIED_VOLATILITY,
+    UNDER_VOLATILITY,
+    EXPIRATION,
+    IV_OUTLIER,
+    UNDER_VOL_OUTLIER,
+    ERROR,
+    COLUMN_COUNT
+};
+
+/**
+ * @brief Columnas de texto, que siempre tienen valor.
+ */
+const uint32_t ALWAYS_VALID = (1u << DESCRIPTION) | (1u << KIND) | (1u << CREATED_AT) |
+                              (1u << ERROR);
+
+/**
+ * @brief Todas las columnas.
+ */
+const uint32_t ALL_VALID = (1u << COLUMN_COUNT) - 1;
+
+}  // namespace csv
+
+/**
+ * @brief Indica si una columna de la fila tiene valor.
+ *
+ * Los valores que faltan o que no se pudieron calcular no tienen valor; en el
+ * CSV quedan vacíos.
+ */
+inline bool isValid(const OptionData& fila, csv::Column columna) {
+    return (fila.validez >> columna) & 1;
+}
+
+/**
+ * @brief Indica si la fila sirve para ajustar o revisar una sonrisa: strike,
+ *        subyacente, plazo y volatilidad implícita con valor y positivos, y
+ *        volatilidad implícita no marcada como outlier. El tipo lo filtra cada uno.
+ */
+inline bool usableForSmile(const OptionData& fila) {
+    bool completa = isValid(fila, csv::STRIKE) && isValid(fila, csv::UNDER_PRICE) &&
+                    isValid(fila, csv::EXPIRATION) && isValid(fila, csv::IMPLIED_VOLATILITY);
+    return completa && !fila.iv_outlier && fila.strike > 0 && fila.under_price > 0 &&
+           fila.expiration > 0 && fila.implied_volatility > 0;
+}
+
+/**
+ * @brief Parametros del calculo que se aplican igual a todos los archivos.
+ */
+struct PipelineConfig {
+    double tolerance;            // Tolerancia de la biseccion
+    int max_iterations;          // Número máximo de iteraciones
+    size_t ventana_outliers;     // Observaciones de la ventana movil
+    double umbral_outliers;      // Desvios robustos tolerados
+    bool reemplazar_outliers;    // true reemplaza por la mediana, false solo marca
+    ResultRingWriter* publicador;  // Ring donde se publica cada fila terminada, o nullptr
+    VolSurfaceWriter* superficie;  // Superficie que se publica por minuto, o nullptr
+    std::string extension_salida;  // ".csv", o ".bsc" para el formato columnar
+    IngestFilter filtro;           // Filas que se leen de los archivos
+    std::vector<size_t> columnas;  // Columnas de la salida (csv::Column); vacío = todas
+    std::vector<size_t> calculadas;  // Columnas que se calculan aunque no se escriban
+    Diagnostics* diagnostico;      // Donde se registran las filas con errores, o nullptr
+    const PriceTicks* ticks;       // Ticks de los precios, o nullptr para leerlos como double
+    GapFillOptions relleno;        // Cómo se rellenan los precios faltantes
+};
+
+/**
+ * @brief Curva de tasas libre de riesgo, compartida entre todos los archivos.
+ *
+ * Por ahora es plana: una TNA constante que se pasa a tasa continua una sola vez.
+ */
+class RateCurve {
+public:
+    explicit RateCurve(double tna) : continua_(std::log(1 + tna)) {}
+
+    /**
+     * @param T Tiempo hasta la expiración en años.
+     * @return Tasa continua para el plazo T.
+     */
+    double continuous(double T) const {
+        (void)T;
+        return continua_;
+    }
+
+private:
+    double continua_;
+};
+
+/**
+ * @brief Calendario de vencimientos, compartido entre todos los archivos.
+ *
+ * Las opciones expiran el tercer viernes de cada mes. El mes se toma del nombre
+ * del archivo (por ejemplo Exp_Octubre.csv) y el año de la primera cotización.
+ * Los vencimientos ya calculados se guardan para no repetir la cuenta.
+ */
+class ExpirationCalendar {
+public:
+    /**
+     * @brief Tercer viernes de un mes en formato dd/mm/YYYY.
+     */
+    std::string thirdFriday(int anio, int mes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = cache_.find(std::make_pair(anio, mes));
+        if (it != cache_.end()) {
+            return it->second;
+        }
+
+        // Dia de la semana del primero del mes (0 = domingo), Sakamoto
+        static const int t[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+        int y = mes < 3 ? anio - 1 : anio;
+        int dia_semana = (y + y / 4 - y / 100 + y / 400 + t[mes - 1] + 1) % 7;
+        int primer_viernes = 1 + (5 - dia_semana + 7) % 7;
+
+        std::ostringstream fecha;
+        fecha << std::setfill('0') << std::setw(2) << primer_viernes + 14 << "/"
+              << std::setw(2) << mes << "/" << anio;
+
+        cache_[std::make_pair(anio, mes)] = fecha.str();
+        return fecha.str();
+    }
+
+    /**
+     * @brief Obtiene el vencimiento de un archivo de cotizaciones.
+     *
+     * @param archivo Ruta del archivo, con el mes en español en el nombre.
+     * @param created_at Fecha de alguna cotización del archivo (mm/dd/YYYY HH:MM).
+     * @param fecha_vencimiento Vencimiento encontrado en formato dd/mm/YYYY.
+     * @return true si se pudo determinar el vencimiento.
+     */
+    bool expirationFor(const std::filesystem::path& archivo, const std::string& created_at,
+                       std::string& fecha_vencimiento) {
+        static const char* meses[] = {"enero", "febrero", "marzo", "abril", "mayo", "junio",
+                                      "julio", "agosto", "septiembre", "octubre",
+                                      "noviembre", "diciembre"};
+
+        std::string nombre = archivo.stem().string();
+        std::transform(nombre.begin(), nombre.end(), nombre.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+
+        int mes = 0;
+        for (int i = 0; i < 12; i++) {
+            if (nombre.find(meses[i]) != std::string::npos) {
+                mes = i + 1;
+                break;
+            }
+        }
+
+        int mes_cotizacion, dia, anio;
+        if (mes == 0 ||
+            std::sscanf(created_at.c_str(), "%d/%d/%d", &mes_cotizacion, &dia, &anio) != 3) {
+            return false;
+        }
+
+        // Si el mes de vencimiento ya paso, corresponde al año siguiente
+        if (mes < mes_cotizacion) {
+            anio++;
+        }
+
+        fecha_vencimiento = thirdFriday(anio, mes);
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::pair<int, int>, std::string> cache_;
+};
+
+/**
+ * @brief Copia una fila al formato fijo del ring de memoria compartida.
+ *
+ * Los textos que no entran en el campo se truncan.
+ */
+ResultRecord toResultRecord(const OptionData& opcion);
+
+/**
+ * @brief Nombres de las columnas del CSV de resultados, en el orden de csv::Column.
+ */
+const std::vector<std::string>& csvColumns();
+
+/**
+ * @brief Encabezado del CSV de resultados, sin el salto de línea.
+ */
+std::string csvHeader();
+
+/**
+ * @brief Busca columnas del CSV de resultados por nombre.
+ *
+ * @param nombres Nombres como en el encabezado.
+ * @param columnas Posiciones encontradas (csv::Column).
+ * @return false si alguna no existe.
+ */
+bool resolveCsvColumns(const std::vector<std::string>& nombres, std::vector<size_t>& columnas);
+
+/**
+ * @brief Escribe un rango de filas del DataFrame en formato CSV.
+ *
+ * Las columnas sin valor (ver isValid) quedan vacías.
+ *
+ * @param salida Stream donde se escriben las filas.
+ * @param dataframe Vector que contiene los datos del DataFrame.
+ * @param desde Primera fila a escribir.
+ * @param hasta Fila siguiente a la última a escribir.
+ */
+void writeRows(std::ostream& salida, const std::vector<OptionData>& dataframe,
+               size_t desde, size_t hasta);
+
+/**
+ * @brief Como writeRows, pero solo con algunas columnas.
+ *
+ * @param columnas Columnas a escribir (csv::Column), en orden.
+ */
+void writeRows(std::ostream& salida, const std::vector<OptionData>& dataframe,
+               size_t desde, size_t hasta, const std::vector<size_t>& columnas);
+
+/**
+ * @brief Guarda los datos en un archivo CSV, o en formato columnar si la
+ *        extensión es .bsc (ver writeArchive).
+ *
+ * Con un scheduler, las filas se formatean en bloques en paralelo y despues
+ * se escriben en orden. Junto al CSV se guarda su índice de fechas
+ * (output.csv.idx, ver writeTimeIndex).
+ *
+ * @param dataframe Vector que contiene los datos del DataFrame.
+ * @param archivoPath Ruta del archivo de salida.
+ * @param scheduler Scheduler para formatear en paralelo, o nullptr.
+ * @param columnas Columnas del CSV (csv::Column); vacío = todas. El formato
+ *                 columnar siempre guarda todas.
+ */
+void saveFile(const std::vector<OptionData>& dataframe,
+              const std::filesystem::path& archivoPath = "output.csv",
+              Scheduler* scheduler = nullptr,
+              const std::vector<size_t>& columnas = std::vector<size_t>());
+
+/**
+ * @brief Lee un archivo de cotizaciones separado por ;
+ *
+ * El archivo se lee en bloques (descomprimidos si es un .gz o .zst) que se
+ * parten en líneas completas y se parsean en paralelo en el scheduler
+ * mientras se leen los siguientes; el orden de las filas se conserva.
+ *
+ * @param nombreArchivo Ruta del archivo CSV.
+ * @param datos Vector donde se agregan las filas leídas.
+ * @param scheduler Scheduler donde se parsean los bloques.
+ * @param filtro Filas que se conservan, o nullptr para todas (ver IngestFilter).
+ * @param diagnostico Donde se cuentan las líneas mal formadas, o nullptr.
+ * @return true si se pudo abrir el archivo.
+ */
+bool readFile(const std::filesystem::path& nombreArchivo, std::vector<Data>& datos,
+              Scheduler& scheduler, const IngestFilter* filtro = nullptr,
+              Diagnostics* diagnostico = nullptr);
+
+/**
+ * @brief Calcula precios y volatilidades de todas las cotizaciones de un archivo.
+ *
+ * Las filas son independientes entre si, asi que se calculan en bloques en
+ * el scheduler. El filtro de outliers depende del orden de cada serie: se
+ * aplica despues, con un filtro por contrato (Description) en orden de fecha,
+ * y los contratos se filtran en paralelo. Recién cuando terminaron todos, una
+ * última pasada en el orden del archivo publica cada fila en el ring, si hay
+ * un publicador, y en la superficie, si hay una, que se publica una vez por
+ * minuto de cotización con todas las filas de ese minuto.
+ *
+ * Con config.ticks, los precios se leen, se interpolan y se comparan en
+ * ticks y se pasan a double al entrar al pricer; la volatilidad implícita de
+ * una cotización que se repite (mismos ticks, strike y plazo) se calcula una
+ * sola vez.
+ *
+ * Si config.columnas no está vacío, solo se calcula lo que necesitan esas
+ * columnas, las de config.calculadas, el ring y la superficie; por ejemplo,
+ * sin "Implied volatility" ni "IV outlier" no se busca la volatilidad implícita.
+ *
+ * @param datos Filas leídas del archivo. Se completan los valores faltantes.
+ * @param fecha_vencimiento Vencimiento de las opciones en formato dd/mm/YYYY.
+ * @param curva Curva de tasas libre de riesgo.
+ * @param config Parametros del calculo.
+ * @param scheduler Scheduler donde se calculan las filas.
+ * @return Filas del DataFrame de salida.
+ */
+std::vector<OptionData> processData(std::vector<Data>& datos, const std::string& fecha_vencimiento,
+                                    const RateCurve& curva, const PipelineConfig& config,
+                                    Scheduler& scheduler);
+
+/**
+ * @brief Indica si un nombre de archivo cumple un patrón con * y ?.
+ */
+bool matchesPattern(const std::string& nombre, const std::string& patron);
+
+/**
+ * @brief Lista los archivos de cotizaciones de un directorio o de un patrón.
+ *
+ * @param entrada Directorio (se toman los .csv, .csv.gz y .csv.zst) o patrón como datos/Exp_*.csv
+ * @return Archivos encontrados, ordenados por nombre.
+ */
+std::vector<std::filesystem::path> listInputFiles(const std::string& entrada);
+
+/**
+ * @brief Procesa varios archivos de cotizaciones (uno por vencimiento) en paralelo.
+ *
+ * Los archivos se reparten entre los hilos de mayor a menor tamaño, siempre al
+ * hilo con menos bytes asignados; si igual queda un hilo libre, roba trabajo.
+ * Cada archivo encola sus propias etapas (parseo, cálculo y escritura) en el
+ * mismo scheduler.
+ *
+ * @param entrada Directorio o patrón de archivos.
+ * @param merge true escribe todo en output.csv, false un output_<archivo>.csv por archivo
+ *              (con la extensión de config.extension_salida).
+ * @param scheduler Scheduler compartido por todas las etapas.
+ * @param curva Curva de tasas compartida.
+ * @param calendario Calendario de vencimientos compartido.
+ * @param config Parametros del calculo.
+ * @return Codigo de salida del programa: distinto de 0 si no hay archivos o si
+ *         alguno no se pudo leer o no se le encontró el vencimiento.
+ */
+int runBatch(const std::string& entrada, bool merge, Scheduler& scheduler,
+             const RateCurve& curva, ExpirationCalendar& calendario,
+             const PipelineConfig& config);
+
+#endif // BLACKSCHOLES_PIPELINE_HPP
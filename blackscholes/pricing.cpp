@@ -0,0 +1,60 @@
+#include "pricing.hpp"
+
+double cdf(double x) {
+    return 0.5 * (1 + std::erf(x / std::sqrt(2)));
+}
+
+double calculate_d1(double S, double K, double T, double r, double sigma){
+    return (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
+}
+
+double blackScholesCall(double S, double K, double T, double r, double sigma) {
+
+    double d1 = calculate_d1(S, K, T, r, sigma);
+
+    double d2 = d1 - sigma * std::sqrt(T);
+
+    return S * cdf(d1) - K * std::exp(-r * T) * cdf(d2);
+}
+
+double blackScholesPut(double S, double K, double T, double r, double sigma) {
+    return blackScholesCall(S, K, T, r, sigma) - S + K * std::exp(-r * T);
+}
+
+double findImpliedVolatility(double S, double K, double T, double r, double optionPrice,
+                              double a, double b, double tolerance, int maxIterations) {
+    double p, precio_teorico;
+    
+    for (int i = 0; i < maxIterations; ++i) {
+        p = (a+b)/2;
+
+        precio_teorico = blackScholesCall(S, K, T, r, p);
+        
+        if( fabs(precio_teorico-optionPrice) < tolerance) {
+            return p;
+        }
+
+        if (optionPrice > precio_teorico) {
+            a = p;
+        } else {
+            b = p;
+        }
+    }
+    return -1.0;
+}
+
+double findImpliedVolatilityPut(double S, double K, double T, double r, double optionPrice,
+                                double a, double b, double tolerance, int maxIterations) {
+    double call = optionPrice + S - K * std::exp(-r * T);
+    return findImpliedVolatility(S, K, T, r, call, a, b, tolerance, maxIterations);
+}
+
+double calculateUnderVolatility(const double& bid, const double& ask, const double& expiration) {
+    double logDifference = std::log(bid) - std::log(ask);
+    double term1 = 0.5 * std::pow(logDifference, 2);
+    double term2 = (2 * std::log(2) - 1) * std::pow(logDifference, 2);
+
+    // 6 horas y media de ruedas diaria. 6.5 x 60 = 390
+    // 256 son los dias que se pueden operar (aproximadamente) en un año
+    return std::sqrt(term1 - term2) * std::sqrt(256 * 390) ;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Modelo Black-Scholes: precios de las opciones de compra y de venta, volatilidad
+ * implícita y volatilidad del subyacente.
+ */
+
+#ifndef BLACKSCHOLES_PRICING_HPP
+#define BLACKSCHOLES_PRICING_HPP
+
+#include <cmath>
+
+/**
+ * @brief Función de distribución acumulativa normal estándar (CDF).
+ * 
+ * @param x Valor para el cual se calcula la CDF.
+ * @return Valor de la CDF en x.
+ */
+double cdf(double x);
+
+/**
+ * @brief Calcula d1 del modelo Black-Scholes.
+ */
+double calculate_d1(double S, double K, double T, double r, double sigma);
+
+/**
+ * @brief Calcula el precio de una opción de compra utilizando el modelo Black-Scholes.
+ * 
+ * @param S Precio del activo subyacente.
+ * @param K Precio de ejercicio de la opción.
+ * @param T Tiempo hasta la expiración de la opción.
+ * @param r Tasa de interés libre de riesgo continua.
+ * @param sigma Volatilidad del activo subyacente.
+ * @return Precio de la opción de compra.
+ */
+double blackScholesCall(double S, double K, double T, double r, double sigma);
+
+/**
+ * @brief Precio de una opción de venta europea, por paridad con la de compra.
+ *
+ * Los parámetros son los de blackScholesCall.
+ */
+double blackScholesPut(double S, double K, double T, double r, double sigma);
+
+/**
+ * @brief Encuentra la volatilidad implícita utilizando el método de bisección.
+ * 
+ *
+ * Este método define los dos extremos (a y b) y calcula el punto en el medio (p).
+ * En base a este punto medio, se calcula el precio de la opción y se evalúa si
+ * hay que ir a la derecha o izquierda de p, achicando el intervalo.
+ * 
+ * @param S Precio del activo subyacente.
+ * @param K Precio de ejercicio de la opción.
+ * @param T Tiempo hasta la expiración de la opción.
+ * @param r Tasa de interés libre de riesgo continua.
+ * @param optionPrice Precio de la opción de compra.
+ * @param a Extremo izquierdo del intervalo de búsqueda.
+ * @param b Extremo derecho del intervalo de búsqueda.
+ * @param tolerance Tolerancia para la convergencia.
+ * @param maxIterations Número máximo de iteraciones.
+ * @return Volatilidad implícita encontrada o -1 si no converge.
+ */
+double findImpliedVolatility(double S, double K, double T, double r, double optionPrice,
+                              double a, double b, double tolerance, int maxIterations);
+
+/**
+ * @brief Volatilidad implícita de una opción de venta.
+ *
+ * Por paridad, P + S - K e^(-rT) es el precio de la opción de compra con el
+ * mismo strike y la misma volatilidad, así que se invierte esa con
+ * findImpliedVolatility. Los parámetros son los mismos, con el precio de la
+ * opción de venta.
+ *
+ * @return Volatilidad implícita encontrada o -1 si no converge.
+ */
+double findImpliedVolatilityPut(double S, double K, double T, double r, double optionPrice,
+                                double a, double b, double tolerance, int maxIterations);
+
+/**
+ * @brief Calcula la volatilidad del activo subyacente.
+ * 
+ * @param bid Precio de la oferta.
+ * @param ask Precio de la demanda.
+ * @param expiration Tiempo hasta la expiración de la opción.
+ * @return Volatilidad del activo subyacente.
+ */
+double calculateUnderVolatility(const double& bid, const double& ask, const double& expiration);
+
+#endif // BLACKSCHOLES_PRICING_HPP
@@ -0,0 +1,318 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "async_io.hpp"
+#include "parsing.hpp"
+#include "pipeline.hpp"
+
+namespace {
+
+const size_t kEncabezadoIndice = 24;
+
+// Columna del archivo .bsc que corresponde a cada columna del CSV (csv::Column)
+const archive::Column kColumnasArchivo[csv::COLUMN_COUNT] = {
+    archive::DESCRIPTION, archive::STRIKE, archive::KIND, archive::BID, archive::ASK,
+    archive::UNDER_BID, archive::UNDER_ASK, archive::CREATED_AT, archive::PRICE,
+    archive::INTRINSIC_VALUE, archive::EXTRINSIC_VALUE, archive::UNDER_PRICE,
+    archive::IMPLIED_VOLATILITY, archive::UNDER_VOLATILITY, archive::EXPIRATION,
+    archive::IV_OUTLIER, archive::UNDER_VOL_OUTLIER, archive::ERROR_CODE};
+
+void appendLittleEndian(std::string& salida, uint64_t valor, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        salida.push_back(static_cast<char>(valor >> (8 * i)));
+    }
+}
+
+uint64_t loadLittleEndian(const uint8_t* datos, int bytes) {
+    uint64_t valor = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        valor = (valor << 8) | datos[i];
+    }
+    return valor;
+}
+
+/**
+ * @brief Separa una línea del CSV de resultados en campos.
+ */
+void splitFields(const char* inicio, const char* fin, std::vector<std::string>& campos) {
+    campos.clear();
+    const char* campo = inicio;
+    for (const char* p = inicio; p <= fin; p++) {
+        if (p == fin || *p == ',') {
+            campos.emplace_back(campo, p);
+            campo = p + 1;
+        }
+    }
+}
+
+/**
+ * @brief Busca las columnas pedidas en el encabezado.
+ */
+bool resolveColumns(const std::vector<std::string>& encabezado,
+                    const std::vector<std::string>& pedidas, std::vector<size_t>& indices) {
+    indices.clear();
+    if (pedidas.empty()) {
+        for (size_t i = 0; i < encabezado.size(); i++) {
+            indices.push_back(i);
+        }
+        return true;
+    }
+
+    for (const std::string& nombre : pedidas) {
+        auto it = std::find(encabezado.begin(), encabezado.end(), nombre);
+        if (it == encabezado.end()) {
+            std::cerr << "Columna desconocida: " << nombre << std::endl;
+            return false;
+        }
+        indices.push_back(static_cast<size_t>(it - encabezado.begin()));
+    }
+    return true;
+}
+
+void appendSelected(const std::vector<std::string>& campos, const std::vector<size_t>& indices,
+                    std::string& salida) {
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (i > 0) {
+            salida.push_back(',');
+        }
+        if (indices[i] < campos.size()) {
+            salida += campos[indices[i]];
+        }
+    }
+    salida.push_back('\n');
+}
+
+/**
+ * @brief Filtra por fecha las líneas de un bloque del CSV.
+ */
+void filterLines(const char* inicio, const char* fin, const TimeQuery& consulta,
+                 size_t columna_fecha, const std::vector<size_t>& indices,
+                 std::string& salida) {
+    std::vector<std::string> campos;
+    while (inicio < fin) {
+        const char* fin_linea = static_cast<const char*>(std::memchr(inicio, '\n', fin - inicio));
+        if (fin_linea == nullptr) {
+            fin_linea = fin;
+        }
+
+        splitFields(inicio, fin_linea, campos);
+        int64_t segundos;
+        if (campos.size() > columna_fecha && parseTimestamp(campos[columna_fecha], segundos) &&
+            segundos >= consulta.desde && segundos <= consulta.hasta) {
+            appendSelected(campos, indices, salida);
+        }
+        inicio = fin_linea + 1;
+    }
+}
+
+int queryCsv(const std::filesystem::path& archivo, const TimeQuery& consulta,
+             Scheduler& scheduler, std::ostream& salida) {
+    int fd = open(archivo.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat estado;
+    if (fd < 0 || fstat(fd, &estado) != 0) {
+        std::cerr << "No se pudo abrir " << archivo << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    uint64_t tamanio = static_cast<uint64_t>(estado.st_size);
+
+    // El encabezado entra de sobra en la primera página
+    char primera[4096];
+    ssize_t leidos = pread(fd, primera, sizeof(primera), 0);
+    const char* fin_encabezado =
+        leidos > 0 ? static_cast<const char*>(std::memchr(primera, '\n', leidos)) : nullptr;
+    if (fin_encabezado == nullptr) {
+        std::cerr << "Encabezado inválido en " << archivo << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    std::vector<std::string> encabezado;
+    splitFields(primera, fin_encabezado, encabezado);
+    std::vector<size_t> indices;
+    if (!resolveColumns(encabezado, consulta.columnas, indices)) {
+        close(fd);
+        return 1;
+    }
+
+    // El CSV puede tener solo algunas columnas (--columns al calcular)
+    size_t columna_fecha = static_cast<size_t>(
+        std::find(encabezado.begin(), encabezado.end(), csvColumns()[csv::CREATED_AT]) -
+        encabezado.begin());
+    if (columna_fecha == encabezado.size()) {
+        std::cerr << archivo << " no tiene la columna " << csvColumns()[csv::CREATED_AT]
+                  << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    std::vector<archive::BlockInfo> bloques;
+    if (!readTimeIndex(archivo, bloques)) {
+        std::cerr << "Sin índice válido para " << archivo << ", se recorre el archivo entero"
+                  << std::endl;
+        archive::BlockInfo todo;
+        todo.offset = static_cast<uint64_t>(fin_encabezado - primera) + 1;
+        todo.bytes = tamanio - todo.offset;
+        todo.filas = 0;
+        todo.desde = std::numeric_limits<int64_t>::min();
+        todo.hasta = std::numeric_limits<int64_t>::max();
+        bloques.assign(1, todo);
+    }
+
+    std::vector<size_t> seleccion = archive::blocksInRange(
+        bloques, archive::sortedByTime(bloques), consulta.desde, consulta.hasta);
+
+    const uint64_t pagina = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    std::vector<std::string> partes(seleccion.size());
+    std::vector<char> correctos(seleccion.size(), 1);
+    scheduler.parallelFor(seleccion.size(), 1, [&](size_t primero, size_t ultimo) {
+        for (size_t i = primero; i < ultimo; i++) {
+            const archive::BlockInfo& bloque = bloques[seleccion[i]];
+            if (bloque.bytes == 0) {
+                continue;
+            }
+            if (bloque.offset + bloque.bytes > tamanio) {
+                correctos[i] = 0;
+                continue;
+            }
+
+            // Solo se mapea el bloque, desde el comienzo de su página
+            uint64_t inicio = bloque.offset / pagina * pagina;
+            size_t largo = static_cast<size_t>(bloque.offset + bloque.bytes - inicio);
+            void* memoria = mmap(nullptr, largo, PROT_READ, MAP_PRIVATE, fd,
+                                 static_cast<off_t>(inicio));
+            if (memoria == MAP_FAILED) {
+                correctos[i] = 0;
+                continue;
+            }
+            madvise(memoria, largo, MADV_SEQUENTIAL);
+
+            const char* datos = static_cast<const char*>(memoria) + (bloque.offset - inicio);
+            filterLines(datos, datos + bloque.bytes, consulta, columna_fecha, indices, partes[i]);
+            munmap(memoria, largo);
+        }
+    });
+    close(fd);
+
+    if (std::find(correctos.begin(), correctos.end(), 0) != correctos.end()) {
+        std::cerr << "No se pudo leer " << archivo << std::endl;
+        return 1;
+    }
+
+    std::string titulos;
+    appendSelected(encabezado, indices, titulos);
+    salida << titulos;
+    for (const std::string& parte : partes) {
+        salida << parte;
+    }
+    return 0;
+}
+
+int queryArchive(const std::filesystem::path& archivo, const TimeQuery& consulta,
+                 Scheduler& scheduler, std::ostream& salida) {
+    ArchiveReader lector(archivo);
+    if (!lector.ok()) {
+        std::cerr << "No se pudo abrir " << archivo << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string>& encabezado = csvColumns();
+    std::vector<size_t> indices;
+    if (!resolveColumns(encabezado, consulta.columnas, indices)) {
+        return 1;
+    }
+
+    // Solo se decodifican las columnas pedidas
+    uint32_t columnas = 0;
+    for (size_t indice : indices) {
+        columnas |= 1u << kColumnasArchivo[indice];
+    }
+
+    std::vector<OptionData> filas;
+    if (!lector.read(filas, scheduler, consulta.desde, consulta.hasta, columnas)) {
+        std::cerr << "No se pudo leer " << archivo << std::endl;
+        return 1;
+    }
+
+    // Las filas se formatean igual que en el CSV
+    std::string titulos;
+    appendSelected(encabezado, indices, titulos);
+    salida << titulos;
+    writeRows(salida, filas, 0, filas.size(), indices);
+    return 0;
+}
+
+}  // namespace
+
+std::filesystem::path timeIndexPath(const std::filesystem::path& resultados) {
+    std::filesystem::path indice = resultados;
+    indice += ".idx";
+    return indice;
+}
+
+bool writeTimeIndex(const std::filesystem::path& resultados,
+                    const std::vector<archive::BlockInfo>& bloques, uint64_t tamanio_csv) {
+    std::string contenido;
+    appendLittleEndian(contenido, time_index::MAGIC, 4);
+    appendLittleEndian(contenido, time_index::VERSION, 2);
+    appendLittleEndian(contenido, 0, 2);
+    appendLittleEndian(contenido, bloques.size(), 4);
+    appendLittleEndian(contenido, 0, 4);
+    appendLittleEndian(contenido, tamanio_csv, 8);
+    contenido += archive::encodeIndex(bloques);
+
+    AsyncFileWriter salida(timeIndexPath(resultados));
+    salida.write(contenido.data(), contenido.size());
+    return salida.close();
+}
+
+bool readTimeIndex(const std::filesystem::path& resultados,
+                   std::vector<archive::BlockInfo>& bloques) {
+    std::error_code error;
+    uint64_t tamanio_csv = std::filesystem::file_size(resultados, error);
+    if (error) {
+        return false;
+    }
+
+    int fd = open(timeIndexPath(resultados).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    uint8_t encabezado[kEncabezadoIndice];
+    bool valido = pread(fd, encabezado, kEncabezadoIndice, 0) ==
+                      static_cast<ssize_t>(kEncabezadoIndice) &&
+                  loadLittleEndian(encabezado, 4) == time_index::MAGIC &&
+                  loadLittleEndian(encabezado + 4, 2) == time_index::VERSION &&
+                  loadLittleEndian(encabezado + 16, 8) == tamanio_csv;
+
+    size_t cantidad = valido ? loadLittleEndian(encabezado + 8, 4) : 0;
+    std::vector<uint8_t> entradas(cantidad * archive::INDEX_ENTRY_BYTES);
+    valido = valido && (entradas.empty() ||
+                        pread(fd, entradas.data(), entradas.size(), kEncabezadoIndice) ==
+                            static_cast<ssize_t>(entradas.size()));
+    close(fd);
+
+    if (valido) {
+        archive::decodeIndex(entradas.data(), cantidad, bloques);
+    }
+    return valido;
+}
+
+int runQuery(const std::filesystem::path& archivo, const TimeQuery& consulta,
+             Scheduler& scheduler, std::ostream& salida) {
+    if (archivo.extension() == ".bsc") {
+        return queryArchive(archivo, consulta, scheduler, salida);
+    }
+    return queryCsv(archivo, consulta, scheduler, salida);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file
+ * @brief Índice de fechas de los resultados y consultas por rango de fechas.
+ *
+ * Junto a cada output.csv se guarda output.csv.idx, un índice disperso con la
+ * posición y las fechas mínima y máxima de cada bloque de filas. Una consulta
+ * busca en el índice los bloques que se solapan con el rango, mapea en memoria
+ * solo esos bloques y devuelve las columnas pedidas. Los archivos .bsc ya
+ * tienen su propio índice, así que se consultan igual.
+ */
+
+#ifndef BLACKSCHOLES_QUERY_HPP
+#define BLACKSCHOLES_QUERY_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "archive.hpp"
+#include "scheduler.hpp"
+
+namespace time_index {
+
+const uint32_t MAGIC = 0x58495342;  // "BSIX"
+const uint16_t VERSION = 1;
+
+}  // namespace time_index
+
+/**
+ * @brief Ruta del índice de un archivo de resultados (output.csv -> output.csv.idx).
+ */
+std::filesystem::path timeIndexPath(const std::filesystem::path& resultados);
+
+/**
+ * @brief Guarda el índice de un CSV de resultados.
+ *
+ * @param tamanio_csv Tamaño del CSV, para detectar después un índice desactualizado.
+ */
+bool writeTimeIndex(const std::filesystem::path& resultados,
+                    const std::vector<archive::BlockInfo>& bloques, uint64_t tamanio_csv);
+
+/**
+ * @brief Lee el índice de un CSV de resultados.
+ *
+ * @return false si no existe, está corrupto o no corresponde al tamaño actual del CSV.
+ */
+bool readTimeIndex(const std::filesystem::path& resultados,
+                   std::vector<archive::BlockInfo>& bloques);
+
+/**
+ * @brief Consulta por rango de fechas sobre un archivo de resultados.
+ */
+struct TimeQuery {
+    int64_t desde;                      // Segundos, ver parseTimestamp
+    int64_t hasta;
+    std::vector<std::string> columnas;  // Nombres del encabezado del CSV; vacío = todas
+};
+
+/**
+ * @brief Escribe en salida, como CSV, las filas del rango con las columnas pedidas.
+ *
+ * @param archivo output.csv (con su .idx; sin índice se recorre entero) o un .bsc.
+ * @return Código de salida del programa.
+ */
+int runQuery(const std::filesystem::path& archivo, const TimeQuery& consulta,
+             Scheduler& scheduler, std::ostream& salida);
+
+#endif // BLACKSCHOLES_QUERY_HPP
@@ -0,0 +1,160 @@
+#include "result_ring.hpp"
+
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int64_t monotonicNanos() {
+    timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return static_cast<int64_t>(ahora.tv_sec) * 1000000000LL + ahora.tv_nsec;
+}
+
+namespace {
+
+size_t bytesDelSegmento(uint64_t capacidad) {
+    return sizeof(ring::Header) + capacidad * sizeof(ring::Slot);
+}
+
+}  // namespace
+
+ResultRingWriter::ResultRingWriter(const std::string& nombre, size_t capacidad)
+    : nombre_(nombre), bytes_(0), header_(nullptr), slots_(nullptr) {
+    uint64_t potencia = 1;
+    while (potencia < capacidad) {
+        potencia <<= 1;
+    }
+    bytes_ = bytesDelSegmento(potencia);
+
+    // Un segmento viejo puede tener otro tamaño: se lo descarta
+    shm_unlink(nombre_.c_str());
+    int fd = shm_open(nombre_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+        close(fd);
+        shm_unlink(nombre_.c_str());
+        return;
+    }
+
+    void* memoria = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memoria == MAP_FAILED) {
+        shm_unlink(nombre_.c_str());
+        return;
+    }
+
+    // ftruncate deja el segmento en cero, así que todas las secuencias arrancan vacías.
+    // El magic se escribe al final para que un lector no vea un header a medio armar.
+    ring::Header* header = static_cast<ring::Header*>(memoria);
+    header->version = ring::VERSION;
+    header->tamanio_registro = sizeof(ResultRecord);
+    header->capacidad = potencia;
+    header->escritos.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = ring::MAGIC;
+
+    header_ = header;
+    slots_ = reinterpret_cast<ring::Slot*>(static_cast<char*>(memoria) + sizeof(ring::Header));
+}
+
+ResultRingWriter::~ResultRingWriter() {
+    if (header_ != nullptr) {
+        munmap(header_, bytes_);
+        shm_unlink(nombre_.c_str());
+    }
+}
+
+uint64_t ResultRingWriter::publish(const ResultRecord& registro) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t numero = header_->escritos.load(std::memory_order_relaxed);
+    ring::Slot& slot = slots_[numero & (header_->capacidad - 1)];
+
+    // Secuencia impar: el lector que llegue ahora descarta lo que copie
+    slot.secuencia.store(2 * numero + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&slot.registro, &registro, sizeof(ResultRecord));
+    slot.registro.publicado_ns = monotonicNanos();
+
+    slot.secuencia.store(2 * (numero + 1), std::memory_order_release);
+    header_->escritos.store(numero + 1, std::memory_order_release);
+    return numero;
+}
+
+ResultRingReader::ResultRingReader(const std::string& nombre)
+    : bytes_(0), header_(nullptr), slots_(nullptr) {
+    int fd = shm_open(nombre.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat estado;
+    if (fstat(fd, &estado) != 0 || static_cast<size_t>(estado.st_size) < sizeof(ring::Header)) {
+        close(fd);
+        return;
+    }
+    bytes_ = static_cast<size_t>(estado.st_size);
+
+    void* memoria = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memoria == MAP_FAILED) {
+        return;
+    }
+
+    const ring::Header* header = static_cast<const ring::Header*>(memoria);
+    if (header->magic != ring::MAGIC || header->version != ring::VERSION ||
+        header->tamanio_registro != sizeof(ResultRecord) ||
+        bytesDelSegmento(header->capacidad) > bytes_) {
+        munmap(memoria, bytes_);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    header_ = header;
+    slots_ = reinterpret_cast<const ring::Slot*>(static_cast<const char*>(memoria) +
+                                                 sizeof(ring::Header));
+}
+
+ResultRingReader::~ResultRingReader() {
+    if (header_ != nullptr) {
+        munmap(const_cast<ring::Header*>(header_), bytes_);
+    }
+}
+
+uint64_t ResultRingReader::published() const {
+    return header_->escritos.load(std::memory_order_acquire);
+}
+
+uint64_t ResultRingReader::oldest() const {
+    uint64_t escritos = published();
+    return escritos > header_->capacidad ? escritos - header_->capacidad : 0;
+}
+
+ResultRingReader::Estado ResultRingReader::read(uint64_t secuencia, ResultRecord& registro) const {
+    const ring::Slot& slot = slots_[secuencia & (header_->capacidad - 1)];
+    uint64_t esperada = 2 * (secuencia + 1);
+
+    uint64_t antes = slot.secuencia.load(std::memory_order_acquire);
+    if (antes < esperada) {
+        // Si la secuencia es impar y es la de este registro, se está escribiendo ahora
+        return PENDIENTE;
+    }
+    if (antes != esperada) {
+        return PERDIDO;
+    }
+
+    std::memcpy(&registro, &slot.registro, sizeof(ResultRecord));
+
+    // Si el escritor empezó a pisar la posición durante la copia, la secuencia cambió
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.secuencia.load(std::memory_order_relaxed) != esperada) {
+        return PERDIDO;
+    }
+    return LEIDO;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Ring buffer en memoria compartida para publicar resultados a otros procesos.
+ *
+ * Un único proceso escribe registros de tamaño fijo; cualquier cantidad de
+ * procesos se engancha en modo solo lectura y los lee por número de secuencia.
+ * Cada posición funciona como un seqlock: el lector detecta si el registro
+ * todavía no se escribió, si se está escribiendo o si ya fue pisado por una
+ * vuelta posterior del ring, sin bloquear nunca al escritor.
+ */
+
+#ifndef BLACKSCHOLES_RESULT_RING_HPP
+#define BLACKSCHOLES_RESULT_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Fila de resultados con formato fijo (sin punteros), apta para memoria compartida.
+ */
+struct ResultRecord {
+    char description[16];
+    char kind[8];
+    char created_at[24];
+    double strike;
+    double bid;
+    double ask;
+    double under_bid;
+    double under_ask;
+    double price;
+    double under_price;
+    double implied_volatility;
+    double under_volatility;
+    double expiration;
+    uint8_t iv_outlier;
+    uint8_t under_vol_outlier;
+    uint8_t error;         // RowError
+    uint8_t reservado;
+    uint32_t validez;      // Un bit por columna del CSV con valor (csv::Column)
+    int64_t publicado_ns;  // CLOCK_MONOTONIC al publicar, para medir latencia
+};
+
+/**
+ * @brief Instante actual de CLOCK_MONOTONIC en nanosegundos (comparable entre procesos).
+ */
+int64_t monotonicNanos();
+
+namespace ring {
+
+const uint64_t MAGIC = 0x474e495253425342ULL;  // "BSBSRING"
+const uint32_t VERSION = 2;
+
+struct alignas(64) Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t tamanio_registro;
+    uint64_t capacidad;              // Potencia de dos
+    std::atomic<uint64_t> escritos;  // Cantidad de registros publicados
+};
+
+/**
+ * @brief Posición del ring. secuencia es impar mientras se escribe y vale
+ *        2 * (n + 1) cuando contiene el registro número n.
+ */
+struct alignas(64) Slot {
+    std::atomic<uint64_t> secuencia;
+    ResultRecord registro;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "el ring necesita atómicos de 64 bits sin locks");
+
+}  // namespace ring
+
+/**
+ * @brief Lado escritor del ring. Crea (o recrea) el segmento de memoria compartida.
+ *
+ * Es un único productor: si se publica desde varios hilos del mismo proceso,
+ * publish los serializa con un mutex.
+ */
+class ResultRingWriter {
+public:
+    /**
+     * @param nombre Nombre del segmento POSIX (por ejemplo "/blackscholes").
+     * @param capacidad Cantidad de registros; se redondea a potencia de dos.
+     */
+    ResultRingWriter(const std::string& nombre, size_t capacidad);
+    ~ResultRingWriter();
+
+    ResultRingWriter(const ResultRingWriter&) = delete;
+    ResultRingWriter& operator=(const ResultRingWriter&) = delete;
+
+    bool ok() const {
+        return header_ != nullptr;
+    }
+
+    /**
+     * @brief Publica un registro y devuelve su número de secuencia.
+     */
+    uint64_t publish(const ResultRecord& registro);
+
+private:
+    std::string nombre_;
+    size_t bytes_;
+    ring::Header* header_;
+    ring::Slot* slots_;
+    std::mutex mutex_;
+};
+
+/**
+ * @brief Lado lector del ring, enganchado en modo solo lectura.
+ */
+class ResultRingReader {
+public:
+    enum Estado {
+        LEIDO,       // Se copió el registro pedido
+        PENDIENTE,   // Todavía no se publicó
+        PERDIDO      // El escritor ya lo pisó; hay que saltar a oldest()
+    };
+
+    explicit ResultRingReader(const std::string& nombre);
+    ~ResultRingReader();
+
+    ResultRingReader(const ResultRingReader&) = delete;
+    ResultRingReader& operator=(const ResultRingReader&) = delete;
+
+    bool ok() const {
+        return header_ != nullptr;
+    }
+
+    /**
+     * @brief Cantidad de registros publicados hasta ahora.
+     */
+    uint64_t published() const;
+
+    /**
+     * @brief Secuencia más vieja que todavía está en el ring.
+     */
+    uint64_t oldest() const;
+
+    /**
+     * @brief Intenta copiar el registro número secuencia.
+     */
+    Estado read(uint64_t secuencia, ResultRecord& registro) const;
+
+private:
+    size_t bytes_;
+    const ring::Header* header_;
+    const ring::Slot* slots_;
+};
+
+#endif // BLACKSCHOLES_RESULT_RING_HPP
@@ -0,0 +1,307 @@
+#include "sabr.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+
+#include "least_squares.hpp"
+
+namespace {
+
+const size_t SABR_PARAMS = 3;  // alpha, rho, nu
+
+/**
+ * @brief Términos de la fórmula de Hagan que no dependen del strike.
+ */
+struct HaganTerms {
+    double uno_menos_beta;
+    double log_F;
+    double c2;             // (1 - beta)^2 / 24
+    double c4;             // (1 - beta)^4 / 1920
+    double nu_sobre_alpha;
+    double alpha;
+    double rho;
+    double uno_menos_rho;
+    double t_alpha2;       // T (1 - beta)^2 / 24 alpha^2
+    double t_cruzado;      // T rho beta nu alpha / 4
+    double t_nu2;          // 1 + T (2 - 3 rho^2) nu^2 / 24
+
+    HaganTerms(double F, double T, const SabrParams& p) {
+        uno_menos_beta = 1.0 - p.beta;
+        log_F = std::log(F);
+        c2 = uno_menos_beta * uno_menos_beta / 24.0;
+        c4 = c2 * c2 * 24.0 * 24.0 / 1920.0;
+        nu_sobre_alpha = p.nu / p.alpha;
+        alpha = p.alpha;
+        rho = p.rho;
+        uno_menos_rho = 1.0 - p.rho;
+        t_alpha2 = T * c2 * p.alpha * p.alpha;
+        t_cruzado = T * p.rho * p.beta * p.nu * p.alpha / 4.0;
+        t_nu2 = 1.0 + T * (2.0 - 3.0 * p.rho * p.rho) * p.nu * p.nu / 24.0;
+    }
+
+    double volatility(double K) const {
+        double log_K = std::log(K);
+        double lfk = log_F - log_K;
+        double lfk2 = lfk * lfk;
+        // (F K)^((1 - beta) / 2)
+        double fk_b = std::exp(0.5 * uno_menos_beta * (log_F + log_K));
+
+        double z = nu_sobre_alpha * fk_b * lfk;
+        double cociente;  // z / x(z), que tiende a 1 en el dinero
+        if (std::fabs(z) < 1e-7) {
+            cociente = 1.0 - 0.5 * rho * z;
+        } else {
+            double x = std::log((std::sqrt(1.0 - 2.0 * rho * z + z * z) + z - rho) /
+                                uno_menos_rho);
+            cociente = z / x;
+        }
+
+        double denominador = fk_b * (1.0 + c2 * lfk2 + c4 * lfk2 * lfk2);
+        double correccion = t_nu2 + t_alpha2 / (fk_b * fk_b) + t_cruzado / fk_b;
+        return alpha / denominador * cociente * correccion;
+    }
+};
+
+SabrParams clampParams(SabrParams p) {
+    p.alpha = std::min(100.0, std::max(1e-6, p.alpha));
+    p.rho = std::min(0.999, std::max(-0.999, p.rho));
+    p.nu = std::min(50.0, std::max(1e-4, p.nu));
+    return p;
+}
+
+/**
+ * @brief Volatilidad del strike más cercano al forward.
+ */
+double atmVolatility(const SabrSlice& sonrisa) {
+    double iv = 0.3;
+    double distancia = INFINITY;
+    for (size_t k = 0; k < sonrisa.strikes.size(); k++) {
+        if (std::fabs(sonrisa.strikes[k] - sonrisa.F) < distancia) {
+            distancia = std::fabs(sonrisa.strikes[k] - sonrisa.F);
+            iv = sonrisa.iv[k];
+        }
+    }
+    return iv;
+}
+
+/**
+ * @brief Ajusta los primeros N de (alpha, rho, nu); el resto queda como en p.
+ *
+ * Se trabaja con (ln alpha, atanh rho, ln nu), que no tienen cotas: así los
+ * pasos de Levenberg-Marquardt no se recortan contra los bordes. El jacobiano
+ * sale de diferencias hacia adelante, una sonrisa más por parámetro.
+ */
+template <size_t N>
+LeastSquaresResult fitSabr(const SabrSlice& sonrisa, const SabrCalibrationConfig& config,
+                           SabrParams& p) {
+    const size_t n = sonrisa.strikes.size();
+    const double limites[SABR_PARAMS][2] = {
+        {std::log(1e-6), std::log(100.0)}, {-3.8, 3.8}, {std::log(1e-4), std::log(50.0)}};
+
+    auto parametros = [&p](const std::array<double, N>& x) {
+        SabrParams q = p;
+        q.alpha = std::exp(x[0]);
+        if constexpr (N > 1) {
+            q.rho = std::tanh(x[1]);
+        }
+        if constexpr (N > 2) {
+            q.nu = std::exp(x[2]);
+        }
+        return q;
+    };
+
+    std::vector<double> base(n);
+    std::vector<double> movida(n);
+    auto evaluar = [&](const std::array<double, N>& x, std::vector<double>& r,
+                       std::vector<std::array<double, N>>& J) {
+        sabrVolatilities(sonrisa.F, sonrisa.T, parametros(x), sonrisa.strikes.data(), n,
+                         base.data());
+        double costo = 0.0;
+        for (size_t k = 0; k < n; k++) {
+            r[k] = base[k] - sonrisa.iv[k];
+            costo += r[k] * r[k];
+        }
+        for (size_t m = 0; m < N; m++) {
+            std::array<double, N> corrido = x;
+            double h = 1e-7 * (std::fabs(x[m]) + 1.0);
+            corrido[m] += h;
+            sabrVolatilities(sonrisa.F, sonrisa.T, parametros(corrido), sonrisa.strikes.data(),
+                             n, movida.data());
+            for (size_t k = 0; k < n; k++) {
+                J[k][m] = (movida[k] - base[k]) / h;
+            }
+        }
+        return std::isfinite(costo) ? costo : INFINITY;
+    };
+    auto acotar = [&](std::array<double, N>& x) {
+        for (size_t m = 0; m < N; m++) {
+            x[m] = std::min(limites[m][1], std::max(limites[m][0], x[m]));
+        }
+    };
+
+    const double transformados[SABR_PARAMS] = {std::log(p.alpha), std::atanh(p.rho),
+                                               std::log(p.nu)};
+    std::array<double, N> x;
+    std::copy(transformados, transformados + N, x.begin());
+    LeastSquaresResult resultado = levenbergMarquardt(x, n, evaluar, acotar,
+                                                      config.max_iteraciones, config.tolerancia);
+    p = parametros(x);
+    return resultado;
+}
+
+}  // namespace
+
+double sabrVolatility(double F, double K, double T, const SabrParams& parametros) {
+    return HaganTerms(F, T, parametros).volatility(K);
+}
+
+void sabrVolatilities(double F, double T, const SabrParams& parametros, const double* strikes,
+                      size_t cantidad, double* volatilidades) {
+    const HaganTerms terminos(F, T, parametros);
+    for (size_t k = 0; k < cantidad; k++) {
+        volatilidades[k] = terminos.volatility(strikes[k]);
+    }
+}
+
+SabrCalibrationConfig defaultSabrCalibration() {
+    SabrCalibrationConfig config;
+    config.beta = 1.0;
+    config.max_iteraciones = 100;
+    config.tolerancia = 1e-8;
+    config.bloque = 32;
+    return config;
+}
+
+SabrParams initialSabrGuess(double iv_atm, double F, double beta) {
+    SabrParams p;
+    p.alpha = iv_atm * std::pow(F, 1.0 - beta);
+    p.beta = beta;
+    p.rho = 0.0;
+    p.nu = 0.5;
+    return clampParams(p);
+}
+
+SabrFit calibrateSabr(const SabrSlice& sonrisa, const SabrParams& inicial,
+                      const SabrCalibrationConfig& config) {
+    const size_t n = sonrisa.strikes.size();
+
+    SabrFit ajuste;
+    ajuste.parametros = inicial;
+    ajuste.parametros.beta = config.beta;
+    ajuste.parametros = clampParams(ajuste.parametros);
+    ajuste.rmse = 0.0;
+    ajuste.iteraciones = 0;
+    ajuste.convergio = false;
+    if (n == 0) {
+        return ajuste;
+    }
+
+    // Con menos strikes que parámetros la sonrisa no determina rho ni nu
+    LeastSquaresResult resultado =
+        n >= SABR_PARAMS ? fitSabr<SABR_PARAMS>(sonrisa, config, ajuste.parametros)
+                         : fitSabr<1>(sonrisa, config, ajuste.parametros);
+
+    ajuste.rmse = std::sqrt(resultado.costo / static_cast<double>(n));
+    ajuste.iteraciones = resultado.iteraciones;
+    ajuste.convergio = resultado.convergio;
+    return ajuste;
+}
+
+std::vector<SabrFit> calibrateSabrSlices(const std::vector<SabrSlice>& sonrisas,
+                                         const SabrCalibrationConfig& config,
+                                         Scheduler& scheduler) {
+    // Serie de cada vencimiento, en el orden del vector
+    std::vector<std::vector<size_t>> series;
+    std::unordered_map<std::string, size_t> posiciones;
+    for (size_t s = 0; s < sonrisas.size(); s++) {
+        auto it = posiciones.emplace(sonrisas[s].expiration_date, series.size()).first;
+        if (it->second == series.size()) {
+            series.emplace_back();
+        }
+        series[it->second].push_back(s);
+    }
+
+    // Cada tarea es un bloque de minutos seguidos de una serie
+    struct Tarea {
+        const std::vector<size_t>* serie;
+        size_t desde;
+        size_t hasta;
+    };
+    const size_t bloque = std::max<size_t>(1, config.bloque);
+    std::vector<Tarea> tareas;
+    for (const std::vector<size_t>& serie : series) {
+        for (size_t desde = 0; desde < serie.size(); desde += bloque) {
+            tareas.push_back(Tarea{&serie, desde, std::min(serie.size(), desde + bloque)});
+        }
+    }
+
+    std::vector<SabrFit> ajustes(sonrisas.size());
+    scheduler.parallelFor(tareas.size(), 1, [&](size_t desde, size_t hasta) {
+        for (size_t t = desde; t < hasta; t++) {
+            const Tarea& tarea = tareas[t];
+            const SabrFit* anterior = nullptr;
+            for (size_t i = tarea.desde; i < tarea.hasta; i++) {
+                size_t s = (*tarea.serie)[i];
+                const SabrSlice& sonrisa = sonrisas[s];
+                SabrParams inicial =
+                    anterior != nullptr && anterior->convergio
+                        ? anterior->parametros
+                        : initialSabrGuess(atmVolatility(sonrisa), sonrisa.F, config.beta);
+                ajustes[s] = calibrateSabr(sonrisa, inicial, config);
+                anterior = &ajustes[s];
+            }
+        }
+    });
+    return ajustes;
+}
+
+std::vector<SabrSlice> buildSabrSlices(const std::vector<OptionData>& dataframe,
+                                       const RateCurve& curva) {
+    std::vector<SabrSlice> sonrisas;
+    std::unordered_map<std::string, size_t> posiciones;
+
+    for (const OptionData& fila : dataframe) {
+        if (!usableForSmile(fila) || fila.kind != "CALL") {
+            continue;
+        }
+
+        std::string clave = fila.expiration_date + '|' + fila.created_at;
+        auto it = posiciones.find(clave);
+        if (it == posiciones.end()) {
+            it = posiciones.emplace(clave, sonrisas.size()).first;
+            SabrSlice sonrisa;
+            sonrisa.created_at = fila.created_at;
+            sonrisa.expiration_date = fila.expiration_date;
+            sonrisa.T = fila.expiration;
+            sonrisa.F = fila.under_price * std::exp(curva.continuous(fila.expiration) *
+                                                    fila.expiration);
+            sonrisas.push_back(sonrisa);
+        }
+
+        SabrSlice& sonrisa = sonrisas[it->second];
+        sonrisa.strikes.push_back(fila.strike);
+        sonrisa.iv.push_back(fila.implied_volatility);
+    }
+    return sonrisas;
+}
+
+bool saveSabrFits(const std::vector<SabrSlice>& sonrisas, const std::vector<SabrFit>& ajustes,
+                  const std::string& archivo) {
+    std::ofstream salida(archivo);
+    if (!salida) {
+        return false;
+    }
+    salida << "Created At,Expiration,Forward,Options,alpha,beta,rho,nu,RMSE,Iterations,"
+              "Converged\n";
+    for (size_t s = 0; s < sonrisas.size() && s < ajustes.size(); s++) {
+        const SabrParams& p = ajustes[s].parametros;
+        salida << sonrisas[s].created_at << ',' << sonrisas[s].expiration_date << ','
+               << sonrisas[s].F << ',' << sonrisas[s].strikes.size() << ',' << p.alpha << ','
+               << p.beta << ',' << p.rho << ',' << p.nu << ',' << ajustes[s].rmse << ','
+               << ajustes[s].iteraciones << ',' << (ajustes[s].convergio ? 1 : 0) << '\n';
+    }
+    return static_cast<bool>(salida);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Modelo SABR: volatilidad implícita de Hagan y calibración por vencimiento.
+ *
+ * SABR describe la sonrisa de un vencimiento con cuatro parámetros: alpha
+ * (nivel), beta (elasticidad, fija), rho (pendiente) y nu (curvatura). La
+ * aproximación de Hagan da la volatilidad implícita de Black-Scholes en forma
+ * cerrada, así que se calibra directamente contra la salida del cálculo de IV.
+ *
+ * Las cotizaciones de un minuto y un vencimiento forman una sonrisa. Los
+ * minutos seguidos de un mismo vencimiento se parecen, así que cada ajuste
+ * parte del anterior (warm start); las series se cortan en bloques para
+ * repartirlas en el scheduler junto con los demás vencimientos.
+ */
+
+#ifndef BLACKSCHOLES_SABR_HPP
+#define BLACKSCHOLES_SABR_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "scheduler.hpp"
+
+/**
+ * @brief Parámetros de SABR.
+ */
+struct SabrParams {
+    double alpha;  // Volatilidad inicial del forward
+    double beta;   // Elasticidad, entre 0 (normal) y 1 (lognormal); no se calibra
+    double rho;    // Correlación entre el forward y su volatilidad
+    double nu;     // Volatilidad de la volatilidad
+};
+
+/**
+ * @brief Volatilidad implícita de Black según la aproximación de Hagan (2002).
+ *
+ * @param F Forward del vencimiento.
+ * @param K Strike.
+ * @param T Años hasta la expiración.
+ */
+double sabrVolatility(double F, double K, double T, const SabrParams& parametros);
+
+/**
+ * @brief sabrVolatility para todos los strikes de un vencimiento.
+ *
+ * Los términos que no dependen del strike se calculan una vez.
+ */
+void sabrVolatilities(double F, double T, const SabrParams& parametros, const double* strikes,
+                      size_t cantidad, double* volatilidades);
+
+/**
+ * @brief Sonrisa de un vencimiento en un minuto.
+ */
+struct SabrSlice {
+    std::string created_at;
+    std::string expiration_date;  // dd/mm/YYYY
+    double F;                     // Forward: subyacente por e^(rT)
+    double T;
+    std::vector<double> strikes;
+    std::vector<double> iv;
+};
+
+/**
+ * @brief Parámetros de la calibración.
+ */
+struct SabrCalibrationConfig {
+    double beta;          // Beta fija de todos los ajustes
+    int max_iteraciones;
+    double tolerancia;    // Mejora relativa del error o del paso por debajo de la cual se termina
+    size_t bloque;        // Minutos seguidos que se ajustan en orden, con warm start
+};
+
+SabrCalibrationConfig defaultSabrCalibration();
+
+/**
+ * @brief Punto de partida sin ajuste anterior: alpha según la volatilidad
+ *        ATM, sin pendiente y con curvatura moderada.
+ */
+SabrParams initialSabrGuess(double iv_atm, double F, double beta);
+
+/**
+ * @brief Resultado de calibrar una sonrisa.
+ */
+struct SabrFit {
+    SabrParams parametros;
+    double rmse;  // Error cuadrático medio en volatilidad
+    int iteraciones;
+    bool convergio;
+};
+
+/**
+ * @brief Ajusta alpha, rho y nu con Levenberg-Marquardt sobre el error en
+ *        volatilidad. El jacobiano se aproxima por diferencias hacia adelante.
+ *
+ * Con menos de tres strikes solo se ajusta alpha; rho y nu quedan como en inicial.
+ *
+ * @param inicial Punto de partida; su beta se reemplaza por la de config.
+ */
+SabrFit calibrateSabr(const SabrSlice& sonrisa, const SabrParams& inicial,
+                      const SabrCalibrationConfig& config);
+
+/**
+ * @brief Calibra todas las sonrisas, en paralelo por vencimiento y por bloque
+ *        de minutos.
+ *
+ * Dentro de un vencimiento las sonrisas se toman en el orden del vector. Cada
+ * bloque arranca desde initialSabrGuess y cada sonrisa siguiente desde el
+ * ajuste anterior, si convergió.
+ */
+std::vector<SabrFit> calibrateSabrSlices(const std::vector<SabrSlice>& sonrisas,
+                                         const SabrCalibrationConfig& config,
+                                         Scheduler& scheduler);
+
+/**
+ * @brief Arma una sonrisa por vencimiento y minuto con las opciones de compra
+ *        que tienen volatilidad implícita (sin outliers).
+ *
+ * El forward y el plazo son los de la primera fila de la sonrisa.
+ */
+std::vector<SabrSlice> buildSabrSlices(const std::vector<OptionData>& dataframe,
+                                       const RateCurve& curva);
+
+/**
+ * @brief Escribe un CSV con los parámetros de cada sonrisa.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveSabrFits(const std::vector<SabrSlice>& sonrisas, const std::vector<SabrFit>& ajustes,
+                  const std::string& archivo);
+
+#endif // BLACKSCHOLES_SABR_HPP
@@ -0,0 +1,362 @@
+/**
+ * @file
+ * @brief Scheduler con robo de trabajo compartido por todas las etapas del pipeline.
+ */
+
+#ifndef BLACKSCHOLES_SCHEDULER_HPP
+#define BLACKSCHOLES_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Grupo de tareas que se espera en conjunto (por ejemplo, una etapa).
+ */
+class TaskGroup {
+public:
+    TaskGroup() : pendientes_(0) {}
+
+private:
+    friend class Scheduler;
+
+    std::atomic<size_t> pendientes_;
+    std::mutex mutex_;
+    std::condition_variable terminado_;
+};
+
+/**
+ * @brief Métricas acumuladas de un hilo del scheduler.
+ */
+struct WorkerMetrics {
+    size_t ejecutadas;          // Tareas ejecutadas por el hilo
+    size_t robadas;             // Tareas tomadas de la cola de otro hilo
+    size_t profundidad;         // Tareas en la cola en este momento
+    size_t profundidad_maxima;  // Mayor cantidad de tareas encoladas observada
+};
+
+/**
+ * @brief Scheduler con robo de trabajo (work stealing) compartido por todas las etapas.
+ *
+ * Cada hilo tiene su propia cola. Un hilo toma tareas del final de su cola y,
+ * cuando se queda sin trabajo, roba del principio de la cola de otro hilo.
+ * Las tareas que se encolan desde un hilo del scheduler van a su propia cola,
+ * asi el trabajo anidado (archivo -> filas) queda cerca de quien lo genero.
+ *
+ * Quien espera un TaskGroup ejecuta tareas mientras tanto, de modo que una
+ * tarea puede esperar a sus subtareas sin bloquear un hilo.
+ */
+class Scheduler {
+public:
+    /**
+     * @param cantidad_hilos Cantidad de hilos.
+     * @param fijar_nucleos true fija cada hilo a un núcleo, llenando un nodo NUMA
+     *                      antes de pasar al siguiente.
+     */
+    explicit Scheduler(size_t cantidad_hilos, bool fijar_nucleos = false)
+        : cantidad_(std::max<size_t>(1, cantidad_hilos)), encoladas_(0), detener_(false),
+          siguiente_(0) {
+        cantidad_hilos = cantidad_;
+
+        // Una cola por hilo y una mas para las métricas de hilos externos
+        for (size_t i = 0; i <= cantidad_hilos; i++) {
+            colas_.push_back(std::make_unique<Cola>());
+        }
+
+        std::vector<int> nucleos;
+        if (fijar_nucleos) {
+            nucleos = cpuOrder();
+        }
+
+        for (size_t i = 0; i < cantidad_hilos; i++) {
+            hilos_.emplace_back(&Scheduler::run, this, i);
+            if (!nucleos.empty()) {
+                pin(hilos_.back(), nucleos[i % nucleos.size()]);
+            }
+        }
+    }
+
+    ~Scheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            detener_ = true;
+        }
+        hay_trabajo_.notify_all();
+
+        for (auto& hilo : hilos_) {
+            hilo.join();
+        }
+    }
+
+    size_t size() const {
+        return cantidad_;
+    }
+
+    /**
+     * @brief Encola una tarea del grupo.
+     *
+     * @param grupo Grupo al que pertenece la tarea.
+     * @param tarea Tarea a ejecutar.
+     * @param hilo Cola destino. Si no se indica, la del hilo actual o round robin.
+     */
+    void submit(TaskGroup& grupo, std::function<void()> tarea,
+                size_t hilo = std::numeric_limits<size_t>::max()) {
+        if (hilo == std::numeric_limits<size_t>::max()) {
+            hilo = (trabajador() < size()) ? trabajador() : siguiente_++;
+        }
+
+        grupo.pendientes_++;
+
+        {
+            Cola& cola = *colas_[hilo % size()];
+            std::lock_guard<std::mutex> lock(cola.mutex);
+            cola.tareas.push_back(Tarea{std::move(tarea), &grupo});
+            cola.profundidad_maxima = std::max(cola.profundidad_maxima, cola.tareas.size());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            encoladas_++;
+        }
+        hay_trabajo_.notify_one();
+    }
+
+    /**
+     * @brief Espera a que terminen las tareas del grupo, ejecutando tareas mientras tanto.
+     */
+    void wait(TaskGroup& grupo) {
+        size_t id = trabajador() < size() ? trabajador() : size();
+
+        while (grupo.pendientes_ > 0) {
+            if (runOne(id)) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(grupo.mutex_);
+            grupo.terminado_.wait_for(lock, std::chrono::milliseconds(1),
+                                      [&grupo] { return grupo.pendientes_ == 0; });
+        }
+
+        // Espera a que el último hilo suelte el mutex del grupo
+        std::lock_guard<std::mutex> lock(grupo.mutex_);
+    }
+
+    /**
+     * @brief Ejecuta funcion(desde, hasta) sobre bloques de [0, n) y espera a que terminen.
+     *
+     * @param n Cantidad de elementos.
+     * @param bloque Cantidad de elementos por tarea.
+     * @param funcion Funcion a aplicar a cada bloque.
+     */
+    void parallelFor(size_t n, size_t bloque,
+                     const std::function<void(size_t, size_t)>& funcion) {
+        bloque = std::max<size_t>(1, bloque);
+        if (n <= bloque) {
+            funcion(0, n);
+            return;
+        }
+
+        TaskGroup grupo;
+        for (size_t desde = 0; desde < n; desde += bloque) {
+            size_t hasta = std::min(n, desde + bloque);
+            submit(grupo, [&funcion, desde, hasta] { funcion(desde, hasta); });
+        }
+        wait(grupo);
+    }
+
+    /**
+     * @brief Métricas por hilo. La última posición corresponde a hilos externos.
+     */
+    std::vector<WorkerMetrics> metrics() const {
+        std::vector<WorkerMetrics> resultado;
+        for (const auto& cola : colas_) {
+            std::lock_guard<std::mutex> lock(cola->mutex);
+            resultado.push_back(WorkerMetrics{cola->ejecutadas, cola->robadas,
+                                              cola->tareas.size(), cola->profundidad_maxima});
+        }
+        return resultado;
+    }
+
+    /**
+     * @brief Imprime las métricas por hilo.
+     */
+    void printMetrics(std::ostream& salida) const {
+        std::vector<WorkerMetrics> metricas = metrics();
+        for (size_t i = 0; i < metricas.size(); i++) {
+            salida << (i < size() ? "hilo " + std::to_string(i) : std::string("externo"))
+                   << ": ejecutadas=" << metricas[i].ejecutadas
+                   << " robadas=" << metricas[i].robadas
+                   << " en cola=" << metricas[i].profundidad
+                   << " maximo en cola=" << metricas[i].profundidad_maxima << "\n";
+        }
+    }
+
+private:
+    struct Tarea {
+        std::function<void()> funcion;
+        TaskGroup* grupo;
+    };
+
+    struct Cola {
+        mutable std::mutex mutex;
+        std::deque<Tarea> tareas;
+        size_t ejecutadas = 0;
+        size_t robadas = 0;
+        size_t profundidad_maxima = 0;
+    };
+
+    static size_t& trabajador() {
+        thread_local size_t id = std::numeric_limits<size_t>::max();
+        return id;
+    }
+
+    /**
+     * @brief Toma una tarea: primero de la cola propia, despues robando de otra.
+     */
+    bool pop(size_t id, Tarea& tarea) {
+        // La cola propia se consume por el final
+        if (id < size()) {
+            Cola& cola = *colas_[id];
+            std::lock_guard<std::mutex> lock(cola.mutex);
+            if (!cola.tareas.empty()) {
+                tarea = std::move(cola.tareas.back());
+                cola.tareas.pop_back();
+                cola.ejecutadas++;
+                return true;
+            }
+        }
+
+        // Las demas se roban por el principio
+        for (size_t i = 1; i <= size(); i++) {
+            Cola& cola = *colas_[(id + i) % size()];
+            std::unique_lock<std::mutex> lock(cola.mutex);
+            if (!cola.tareas.empty()) {
+                tarea = std::move(cola.tareas.front());
+                cola.tareas.pop_front();
+                lock.unlock();
+
+                std::lock_guard<std::mutex> propia(colas_[id]->mutex);
+                colas_[id]->ejecutadas++;
+                colas_[id]->robadas++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool runOne(size_t id) {
+        Tarea tarea;
+        if (!pop(id, tarea)) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            encoladas_--;
+        }
+
+        try {
+            tarea.funcion();
+        } catch (const std::exception& e) {
+            std::cerr << "Error en una tarea: " << e.what() << "\n";
+        }
+
+        // Se descuenta con el mutex tomado para que quien espera no destruya
+        // el grupo mientras este hilo todavía lo está usando
+        std::lock_guard<std::mutex> lock(tarea.grupo->mutex_);
+        if (--tarea.grupo->pendientes_ == 0) {
+            tarea.grupo->terminado_.notify_all();
+        }
+        return true;
+    }
+
+    void run(size_t id) {
+        trabajador() = id;
+
+        while (true) {
+            if (runOne(id)) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            hay_trabajo_.wait(lock, [this] { return detener_ || encoladas_ > 0; });
+            if (detener_ && encoladas_ == 0) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Núcleos disponibles ordenados por nodo NUMA.
+     */
+    static std::vector<int> cpuOrder() {
+        std::vector<int> nucleos;
+
+        for (int nodo = 0;; nodo++) {
+            std::ifstream lista("/sys/devices/system/node/node" + std::to_string(nodo) + "/cpulist");
+            if (!lista.is_open()) {
+                break;
+            }
+
+            // Formato: 0-3,8-11
+            std::string rango;
+            while (std::getline(lista, rango, ',')) {
+                int desde, hasta;
+                int leidos = std::sscanf(rango.c_str(), "%d-%d", &desde, &hasta);
+                if (leidos == 1) {
+                    hasta = desde;
+                }
+                for (int cpu = desde; leidos >= 1 && cpu <= hasta; cpu++) {
+                    nucleos.push_back(cpu);
+                }
+            }
+        }
+
+        if (nucleos.empty()) {
+            for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++) {
+                nucleos.push_back(cpu);
+            }
+        }
+        return nucleos;
+    }
+
+    static void pin(std::thread& hilo, int nucleo) {
+#ifdef __linux__
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        CPU_SET(nucleo, &conjunto);
+        pthread_setaffinity_np(hilo.native_handle(), sizeof(cpu_set_t), &conjunto);
+#else
+        (void)hilo;
+        (void)nucleo;
+#endif
+    }
+
+    const size_t cantidad_;
+    std::vector<std::unique_ptr<Cola>> colas_;
+    std::vector<std::thread> hilos_;
+    std::mutex mutex_;
+    std::condition_variable hay_trabajo_;
+    size_t encoladas_;
+    bool detener_;
+    std::atomic<size_t> siguiente_;
+};
+
+#endif // BLACKSCHOLES_SCHEDULER_HPP
@@ -0,0 +1,510 @@
+#include "server.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "c_api.h"
+#include "latency.hpp"
+
+ServerConfig defaultServerConfig(const std::string& direccion) {
+    ServerConfig config;
+    config.direccion = direccion;
+    config.max_lote = 1024;
+    config.espera = std::chrono::microseconds(200);
+    config.max_pendientes = 1 << 16;
+    config.max_registros_pedido = 1 << 16;
+    config.hilos_pricer = 1;
+    config.intervalo_reporte = std::chrono::seconds(10);
+    return config;
+}
+
+namespace {
+
+std::atomic<bool> g_detener(false);
+
+void manejarSenial(int) {
+    g_detener = true;
+}
+
+/**
+ * @brief Buffer de doubles alineado a línea de cache, reservado una sola vez.
+ */
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(size_t cantidad)
+        : datos_(static_cast<double*>(std::aligned_alloc(64, redondear(cantidad) * sizeof(double)))) {
+        if (datos_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~AlignedBuffer() {
+        std::free(datos_);
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    double* data() {
+        return datos_;
+    }
+
+private:
+    static size_t redondear(size_t cantidad) {
+        return (cantidad + 7) / 8 * 8;
+    }
+
+    double* datos_;
+};
+
+/**
+ * @brief Pedido de una conexión, esperando ser procesado en un micro-lote.
+ */
+struct Pedido {
+    protocol::RequestHeader encabezado;
+    std::vector<double> registros;   // count * 5
+    std::vector<double> resultados;  // count
+    std::chrono::steady_clock::time_point llegada;
+    std::promise<void> listo;
+};
+
+/**
+ * @brief Junta pedidos chicos de varias conexiones en micro-lotes.
+ *
+ * Un lote sale cuando acumula max_lote registros o cuando el pedido más viejo
+ * esperó `espera`. Los registros se copian a columnas alineadas y el pricer
+ * los reparte entre hilos que se arrancan una sola vez, con el batcher.
+ */
+class MicroBatcher {
+public:
+    explicit MicroBatcher(const ServerConfig& config)
+        : config_(config),
+          capacidad_(config.max_lote),
+          S_(capacidad_), K_(capacidad_), T_(capacidad_), r_(capacidad_), x_(capacidad_),
+          salida_(capacidad_),
+          scratch_(bs_scratch_size(config.hilos_pricer)),
+          hilos_pricer_(config.hilos_pricer),
+          pendientes_(0),
+          detener_(false) {
+        if (bs_workers_init(hilos_pricer_, scratch_.data(), scratch_.size()) != BS_OK) {
+            std::cerr << "No se pudieron crear los hilos del pricer, se usa uno" << std::endl;
+            hilos_pricer_ = 1;
+        }
+        hilo_ = std::thread(&MicroBatcher::run, this);
+    }
+
+    ~MicroBatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            detener_ = true;
+        }
+        hay_pedidos_.notify_all();
+        hilo_.join();
+        bs_workers_destroy(scratch_.data());
+    }
+
+    /**
+     * @brief Encola un pedido.
+     *
+     * @return false si hay demasiados registros pendientes (back-pressure).
+     */
+    bool submit(const std::shared_ptr<Pedido>& pedido) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pendientes_ + pedido->encabezado.count > config_.max_pendientes) {
+                return false;
+            }
+            pendientes_ += pedido->encabezado.count;
+            cola_.push_back(pedido);
+        }
+        hay_pedidos_.notify_one();
+        return true;
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::vector<std::shared_ptr<Pedido>> lote;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                hay_pedidos_.wait(lock, [this] { return detener_ || !cola_.empty(); });
+                if (cola_.empty()) {
+                    return;
+                }
+
+                // Espera a llenar el lote, como mucho hasta el plazo del pedido más viejo
+                auto plazo = cola_.front()->llegada + config_.espera;
+                hay_pedidos_.wait_until(lock, plazo, [this] {
+                    return detener_ || pendientes_ >= config_.max_lote;
+                });
+
+                size_t registros = 0;
+                while (!cola_.empty() &&
+                       (lote.empty() || registros + cola_.front()->encabezado.count <= config_.max_lote)) {
+                    registros += cola_.front()->encabezado.count;
+                    lote.push_back(cola_.front());
+                    cola_.pop_front();
+                }
+                pendientes_ -= registros;
+            }
+
+            process(lote, protocol::OP_IMPLIED_VOL);
+            process(lote, protocol::OP_CALL_PRICE);
+
+            for (auto& pedido : lote) {
+                pedido->listo.set_value();
+            }
+        }
+    }
+
+    struct Tramo {
+        Pedido* pedido;
+        size_t desde;     // Primer registro del pedido en el tramo
+        size_t cantidad;  // Registros del tramo
+        size_t posicion;  // Posición en las columnas del lote
+    };
+
+    /**
+     * @brief Procesa los registros de una operación del lote, por bloques de capacidad_.
+     */
+    void process(std::vector<std::shared_ptr<Pedido>>& lote, protocol::Operation operacion) {
+        std::vector<Tramo> tramos;
+        size_t usados = 0;
+
+        for (auto& pedido : lote) {
+            if (pedido->encabezado.operation != operacion) {
+                continue;
+            }
+
+            size_t total = pedido->encabezado.count;
+            for (size_t desde = 0; desde < total;) {
+                size_t cantidad = std::min(total - desde, capacidad_ - usados);
+                const double* registros = pedido->registros.data();
+
+                // De filas (S, K, T, r, x) a columnas
+                for (size_t i = 0; i < cantidad; i++) {
+                    const double* registro = registros + (desde + i) * protocol::CAMPOS_POR_REGISTRO;
+                    S_.data()[usados + i] = registro[0];
+                    K_.data()[usados + i] = registro[1];
+                    T_.data()[usados + i] = registro[2];
+                    r_.data()[usados + i] = registro[3];
+                    x_.data()[usados + i] = registro[4];
+                }
+
+                tramos.push_back(Tramo{pedido.get(), desde, cantidad, usados});
+                usados += cantidad;
+                desde += cantidad;
+
+                if (usados == capacidad_) {
+                    flush(tramos, usados, operacion);
+                    tramos.clear();
+                    usados = 0;
+                }
+            }
+        }
+
+        if (usados > 0) {
+            flush(tramos, usados, operacion);
+        }
+    }
+
+    void flush(const std::vector<Tramo>& tramos, size_t usados, protocol::Operation operacion) {
+        if (operacion == protocol::OP_IMPLIED_VOL) {
+            bs_implied_vol_batch(S_.data(), K_.data(), T_.data(), r_.data(), x_.data(), nullptr,
+                                 salida_.data(), usados, hilos_pricer_, scratch_.data(),
+                                 scratch_.size());
+        } else {
+            bs_call_price_batch(S_.data(), K_.data(), T_.data(), r_.data(), x_.data(),
+                                salida_.data(), usados, hilos_pricer_, scratch_.data(),
+                                scratch_.size());
+        }
+
+        for (const Tramo& tramo : tramos) {
+            std::copy(salida_.data() + tramo.posicion,
+                      salida_.data() + tramo.posicion + tramo.cantidad,
+                      tramo.pedido->resultados.begin() + tramo.desde);
+        }
+    }
+
+    const ServerConfig& config_;
+    size_t capacidad_;
+    AlignedBuffer S_, K_, T_, r_, x_, salida_;
+    std::vector<char> scratch_;  // Pilas de los hilos del pricer, vivos mientras viva el batcher
+    uint32_t hilos_pricer_;
+
+    std::mutex mutex_;
+    std::condition_variable hay_pedidos_;
+    std::deque<std::shared_ptr<Pedido>> cola_;
+    size_t pendientes_;
+    bool detener_;
+    std::thread hilo_;
+};
+
+bool readExact(int fd, void* destino, size_t bytes) {
+    char* p = static_cast<char*>(destino);
+    while (bytes > 0) {
+        ssize_t leidos = ::recv(fd, p, bytes, 0);
+        if (leidos <= 0) {
+            return false;
+        }
+        p += leidos;
+        bytes -= static_cast<size_t>(leidos);
+    }
+    return true;
+}
+
+bool writeExact(int fd, const void* origen, size_t bytes) {
+    const char* p = static_cast<const char*>(origen);
+    while (bytes > 0) {
+        ssize_t escritos = ::send(fd, p, bytes, MSG_NOSIGNAL);
+        if (escritos <= 0) {
+            return false;
+        }
+        p += escritos;
+        bytes -= static_cast<size_t>(escritos);
+    }
+    return true;
+}
+
+bool reply(int fd, uint32_t id, protocol::Status estado, const std::vector<double>& resultados) {
+    protocol::ResponseHeader encabezado;
+    encabezado.magic = protocol::RESPONSE_MAGIC;
+    encabezado.version = protocol::VERSION;
+    encabezado.status = estado;
+    encabezado.id = id;
+    encabezado.count = static_cast<uint32_t>(resultados.size());
+
+    return writeExact(fd, &encabezado, sizeof(encabezado)) &&
+           writeExact(fd, resultados.data(), resultados.size() * sizeof(double));
+}
+
+/**
+ * @brief Atiende los pedidos de una conexión hasta que el cliente la cierra.
+ */
+void serveConnection(int fd, MicroBatcher& batcher, const ServerConfig& config,
+                     LatencyHistogram& ventana, LatencyHistogram& total) {
+    const std::vector<double> vacio;
+
+    while (true) {
+        auto pedido = std::make_shared<Pedido>();
+        protocol::RequestHeader& encabezado = pedido->encabezado;
+
+        if (!readExact(fd, &encabezado, sizeof(encabezado))) {
+            break;
+        }
+
+        if (encabezado.magic != protocol::REQUEST_MAGIC || encabezado.version != protocol::VERSION ||
+            (encabezado.operation != protocol::OP_IMPLIED_VOL &&
+             encabezado.operation != protocol::OP_CALL_PRICE) ||
+            encabezado.count > config.max_registros_pedido) {
+            // No se puede saber dónde empieza el próximo pedido, así que se cierra
+            reply(fd, encabezado.id, protocol::STATUS_INVALID, vacio);
+            break;
+        }
+
+        pedido->registros.resize(static_cast<size_t>(encabezado.count) * protocol::CAMPOS_POR_REGISTRO);
+        if (!readExact(fd, pedido->registros.data(), pedido->registros.size() * sizeof(double))) {
+            break;
+        }
+        pedido->resultados.resize(encabezado.count);
+        pedido->llegada = std::chrono::steady_clock::now();
+
+        if (encabezado.count == 0) {
+            if (!reply(fd, encabezado.id, protocol::STATUS_OK, vacio)) {
+                break;
+            }
+            continue;
+        }
+
+        if (!batcher.submit(pedido)) {
+            if (!reply(fd, encabezado.id, protocol::STATUS_OVERLOADED, vacio)) {
+                break;
+            }
+            continue;
+        }
+
+        pedido->listo.get_future().wait();
+
+        auto latencia = std::chrono::steady_clock::now() - pedido->llegada;
+        ventana.record(latencia);
+        total.record(latencia);
+
+        if (!reply(fd, encabezado.id, protocol::STATUS_OK, pedido->resultados)) {
+            break;
+        }
+    }
+
+    ::close(fd);
+}
+
+/**
+ * @brief Abre el socket de escucha: Unix si la dirección es una ruta, TCP en loopback si es host:puerto.
+ */
+int listenOn(const std::string& direccion) {
+    size_t dos_puntos = direccion.rfind(':');
+    bool es_tcp = dos_puntos != std::string::npos && direccion.find('/') == std::string::npos;
+
+    if (es_tcp) {
+        std::string host = direccion.substr(0, dos_puntos);
+        if (!host.empty() && host != "127.0.0.1" && host != "localhost") {
+            std::cerr << "Solo se escucha en loopback: " << direccion << std::endl;
+            return -1;
+        }
+
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int uno = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+
+        sockaddr_in dir = {};
+        dir.sin_family = AF_INET;
+        dir.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        dir.sin_port = htons(static_cast<uint16_t>(std::atoi(direccion.c_str() + dos_puntos + 1)));
+
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir)) != 0 ||
+            ::listen(fd, 128) != 0) {
+            std::cerr << "No se pudo escuchar en " << direccion << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return -1;
+        }
+        return fd;
+    }
+
+    sockaddr_un dir = {};
+    dir.sun_family = AF_UNIX;
+    if (direccion.size() >= sizeof(dir.sun_path)) {
+        std::cerr << "Ruta de socket demasiado larga: " << direccion << std::endl;
+        return -1;
+    }
+    std::strcpy(dir.sun_path, direccion.c_str());
+    ::unlink(direccion.c_str());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir)) != 0 ||
+        ::listen(fd, 128) != 0) {
+        std::cerr << "No se pudo escuchar en " << direccion << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+}  // namespace
+
+int runServer(const ServerConfig& config) {
+    int escucha = listenOn(config.direccion);
+    if (escucha < 0) {
+        return 1;
+    }
+
+    std::signal(SIGINT, manejarSenial);
+    std::signal(SIGTERM, manejarSenial);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cerr << "Escuchando en " << config.direccion << std::endl;
+
+    LatencyHistogram ventana;
+    LatencyHistogram total;
+
+    struct Conexion {
+        std::thread hilo;
+        std::shared_ptr<std::atomic<bool>> terminada;
+    };
+    std::list<Conexion> conexiones;
+    std::mutex mutex_activas;
+    std::set<int> activas;
+
+    {
+        MicroBatcher batcher(config);
+        auto ultimo_reporte = std::chrono::steady_clock::now();
+
+        while (!g_detener) {
+            pollfd p = {escucha, POLLIN, 0};
+            if (::poll(&p, 1, 200) > 0 && (p.revents & POLLIN)) {
+                int fd = ::accept(escucha, nullptr, nullptr);
+                if (fd >= 0) {
+                    int uno = 1;
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_activas);
+                        activas.insert(fd);
+                    }
+                    auto terminada = std::make_shared<std::atomic<bool>>(false);
+                    std::thread hilo([&, fd, terminada] {
+                        serveConnection(fd, batcher, config, ventana, total);
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_activas);
+                            activas.erase(fd);
+                        }
+                        *terminada = true;
+                    });
+                    conexiones.push_back(Conexion{std::move(hilo), terminada});
+                }
+            }
+
+            // Libera los hilos de las conexiones que ya se cerraron
+            for (auto it = conexiones.begin(); it != conexiones.end();) {
+                if (*it->terminada) {
+                    it->hilo.join();
+                    it = conexiones.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            auto ahora = std::chrono::steady_clock::now();
+            if (ahora - ultimo_reporte >= config.intervalo_reporte) {
+                if (ventana.count() > 0) {
+                    printLatency(std::cerr, ventana);
+                    ventana.reset();
+                }
+                ultimo_reporte = ahora;
+            }
+        }
+
+        // Corta las conexiones abiertas para que sus hilos terminen
+        {
+            std::lock_guard<std::mutex> lock(mutex_activas);
+            for (int fd : activas) {
+                ::shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto& conexion : conexiones) {
+            conexion.hilo.join();
+        }
+    }
+
+    ::close(escucha);
+    if (config.direccion.find('/') != std::string::npos ||
+        config.direccion.find(':') == std::string::npos) {
+        ::unlink(config.direccion.c_str());
+    }
+
+    std::cerr << "Total: ";
+    printLatency(std::cerr, total);
+    return 0;
+}
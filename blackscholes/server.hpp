@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Servidor de pricing de larga duración sobre un socket local.
+ *
+ * Protocolo binario (enteros y doubles en el orden de bytes de la máquina):
+ *
+ *   Pedido:    RequestHeader + count registros de 5 doubles (S, K, T, r, x)
+ *              x es el precio de la opción (OP_IMPLIED_VOL) o sigma (OP_CALL_PRICE).
+ *   Respuesta: ResponseHeader + count doubles (volatilidad o precio).
+ *
+ * Los pedidos chicos de distintas conexiones se juntan en micro-lotes
+ * alineados al ancho SIMD antes de pasar por el pricer.
+ */
+
+#ifndef BLACKSCHOLES_SERVER_HPP
+#define BLACKSCHOLES_SERVER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace protocol {
+
+const uint32_t REQUEST_MAGIC = 0x51525342;   // "BSRQ"
+const uint32_t RESPONSE_MAGIC = 0x50525342;  // "BSRP"
+const uint16_t VERSION = 1;
+
+enum Operation : uint16_t {
+    OP_IMPLIED_VOL = 1,
+    OP_CALL_PRICE = 2
+};
+
+enum Status : uint16_t {
+    STATUS_OK = 0,
+    STATUS_OVERLOADED = 1,  // Demasiados registros pendientes, reintentar más tarde
+    STATUS_INVALID = 2      // Encabezado inválido o pedido demasiado grande
+};
+
+struct RequestHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t operation;
+    uint32_t id;     // Se devuelve tal cual en la respuesta
+    uint32_t count;  // Cantidad de registros
+};
+
+struct ResponseHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t status;
+    uint32_t id;
+    uint32_t count;
+};
+
+const size_t CAMPOS_POR_REGISTRO = 5;
+
+}  // namespace protocol
+
+/**
+ * @brief Configuración del servidor.
+ */
+struct ServerConfig {
+    std::string direccion;        // Ruta del socket Unix, o host:puerto en loopback
+    size_t max_lote;              // Registros por micro-lote
+    std::chrono::microseconds espera;  // Tiempo máximo que un pedido espera a juntar lote
+    size_t max_pendientes;        // Registros encolados a partir de los que se rechaza
+    size_t max_registros_pedido;  // Tamaño máximo de un pedido
+    uint32_t hilos_pricer;        // Hilos del pricer, que se arrancan una vez y se reparten
+                                  // cada micro-lote
+    std::chrono::seconds intervalo_reporte;  // Cada cuánto se reportan las latencias
+};
+
+/**
+ * @brief Configuración por defecto para una dirección.
+ */
+ServerConfig defaultServerConfig(const std::string& direccion);
+
+/**
+ * @brief Corre el servidor hasta recibir SIGINT o SIGTERM.
+ *
+ * @return Código de salida del programa.
+ */
+int runServer(const ServerConfig& config);
+
+#endif // BLACKSCHOLES_SERVER_HPP
@@ -0,0 +1,313 @@
+#include "ssvi.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+#include "least_squares.hpp"
+
+namespace {
+
+/**
+ * @brief phi(theta) / eta.
+ */
+double unitCurvature(double theta, double gamma) {
+    return std::pow(theta, -gamma) * std::pow(1.0 + theta, gamma - 1.0);
+}
+
+/**
+ * @brief Varianza total en el dinero de una sonrisa: interpolación lineal
+ *        entre las cotizaciones a ambos lados de k = 0, o la más cercana.
+ */
+double atmTotalVariance(const SsviSlice& sonrisa) {
+    double k_abajo = -INFINITY, w_abajo = 0.0;
+    double k_arriba = INFINITY, w_arriba = 0.0;
+    for (size_t j = 0; j < sonrisa.strikes.size(); j++) {
+        double k = std::log(sonrisa.strikes[j] / sonrisa.F);
+        double w = sonrisa.iv[j] * sonrisa.iv[j] * sonrisa.T;
+        if (k <= 0 && k > k_abajo) {
+            k_abajo = k;
+            w_abajo = w;
+        }
+        if (k >= 0 && k < k_arriba) {
+            k_arriba = k;
+            w_arriba = w;
+        }
+    }
+    if (std::isinf(k_abajo)) {
+        return w_arriba;
+    }
+    if (std::isinf(k_arriba) || k_arriba == k_abajo) {
+        return w_abajo;
+    }
+    return w_abajo + (w_arriba - w_abajo) * (-k_abajo) / (k_arriba - k_abajo);
+}
+
+/**
+ * @brief Cotización lista para el ajuste.
+ */
+struct Quote {
+    double k;
+    double T;
+    double theta;
+    double phi_unitario;  // phi / eta
+    double iv;
+};
+
+SsviParams clampParams(SsviParams p) {
+    p.rho = std::min(0.999, std::max(-0.999, p.rho));
+    p.eta = std::min(2.0 / (1.0 + std::fabs(p.rho)), std::max(1e-4, p.eta));
+    p.gamma = std::min(0.5, std::max(1e-3, p.gamma));
+    return p;
+}
+
+}  // namespace
+
+double SsviSurface::thetaTangent(size_t i) const {
+    const size_t n = plazos.size();
+    auto x = [this](size_t j) { return j == 0 ? 0.0 : plazos[j - 1]; };
+    auto y = [this](size_t j) { return j == 0 ? 0.0 : thetas[j - 1]; };
+    auto secante = [&](size_t j) { return (y(j + 1) - y(j)) / (x(j + 1) - x(j)); };
+    if (i == 0) {
+        return secante(0);
+    }
+    if (i == n) {
+        return secante(n - 1);
+    }
+
+    // Media armónica ponderada de las secantes: no pasa de 3 veces ninguna
+    // de las dos, así que el spline no sale del rango de los datos
+    double d0 = secante(i - 1), d1 = secante(i);
+    if (!(d0 > 0) || !(d1 > 0)) {
+        return 0.0;
+    }
+    double h0 = x(i) - x(i - 1), h1 = x(i + 1) - x(i);
+    return 3.0 * (h0 + h1) / ((2.0 * h1 + h0) / d0 + (h1 + 2.0 * h0) / d1);
+}
+
+double SsviSurface::theta(double T, double* pendiente) const {
+    double derivada = 0.0;
+    double valor = 0.0;
+    if (!plazos.empty()) {
+        if (T >= plazos.back()) {
+            derivada = thetaTangent(plazos.size());
+            valor = thetas.back() + derivada * (T - plazos.back());
+        } else {
+            // Tramo entre los nodos i e i + 1 (el nodo 0 es T = 0)
+            size_t i = static_cast<size_t>(std::upper_bound(plazos.begin(), plazos.end(), T) -
+                                           plazos.begin());
+            double x0 = i == 0 ? 0.0 : plazos[i - 1];
+            double y0 = i == 0 ? 0.0 : thetas[i - 1];
+            double h = plazos[i] - x0;
+            double y1 = thetas[i];
+            double m0 = thetaTangent(i), m1 = thetaTangent(i + 1);
+
+            double t = std::max(T - x0, 0.0) / h;
+            double t2 = t * t, t3 = t2 * t;
+            valor = (2 * t3 - 3 * t2 + 1) * y0 + (t3 - 2 * t2 + t) * h * m0 +
+                    (-2 * t3 + 3 * t2) * y1 + (t3 - t2) * h * m1;
+            derivada = (6 * t2 - 6 * t) / h * (y0 - y1) + (3 * t2 - 4 * t + 1) * m0 +
+                       (3 * t2 - 2 * t) * m1;
+        }
+    }
+    if (pendiente != nullptr) {
+        *pendiente = derivada;
+    }
+    return valor;
+}
+
+double SsviSurface::totalVariance(double k, double T) const {
+    const SsviParams& p = parametros;
+    double t = theta(T);
+    double phi = p.eta * unitCurvature(t, p.gamma);
+    double a = phi * k + p.rho;
+    return 0.5 * t * (1.0 + p.rho * phi * k + std::sqrt(a * a + 1.0 - p.rho * p.rho));
+}
+
+double SsviSurface::impliedVolatility(double k, double T) const {
+    return T > 0 ? std::sqrt(std::max(totalVariance(k, T), 0.0) / T) : 0.0;
+}
+
+SsviDerivatives SsviSurface::derivatives(double k, double T) const {
+    SsviDerivatives d;
+    derivatives(T, &k, 1, &d);
+    return d;
+}
+
+void SsviSurface::derivatives(double T, const double* k, size_t cantidad,
+                              SsviDerivatives* salida) const {
+    const SsviParams& p = parametros;
+    double pendiente;
+    const double t = theta(T, &pendiente);
+    const double phi = p.eta * unitCurvature(t, p.gamma);
+    const double phi_t = phi * (-p.gamma / t + (p.gamma - 1.0) / (1.0 + t));  // d phi / d theta
+    const double uno_menos_rho2 = 1.0 - p.rho * p.rho;
+
+    for (size_t j = 0; j < cantidad; j++) {
+        double a = phi * k[j] + p.rho;
+        double s = std::sqrt(a * a + uno_menos_rho2);
+        double pendiente_k = p.rho + a / s;  // (d w / d k) / (theta phi / 2)
+
+        SsviDerivatives& d = salida[j];
+        d.w = 0.5 * t * (1.0 + p.rho * phi * k[j] + s);
+        d.w_k = 0.5 * t * phi * pendiente_k;
+        d.w_kk = 0.5 * t * phi * phi * uno_menos_rho2 / (s * s * s);
+        d.w_T = (d.w / t + 0.5 * t * phi_t * k[j] * pendiente_k) * pendiente;
+    }
+}
+
+SsviCalibrationConfig defaultSsviCalibration() {
+    SsviCalibrationConfig config;
+    config.gamma = 0.5;
+    config.max_iteraciones = 100;
+    config.tolerancia = 1e-8;
+    return config;
+}
+
+SsviParams initialSsviGuess(double gamma) {
+    SsviParams p;
+    p.rho = 0.0;
+    p.eta = 1.0;
+    p.gamma = gamma;
+    return clampParams(p);
+}
+
+SsviFit calibrateSsvi(const SsviChain& cadena, const SsviParams& inicial,
+                      const SsviCalibrationConfig& config) {
+    SsviFit ajuste;
+    ajuste.superficie.parametros = inicial;
+    ajuste.superficie.parametros.gamma = config.gamma;
+    ajuste.superficie.parametros = clampParams(ajuste.superficie.parametros);
+    ajuste.rmse = 0.0;
+    ajuste.iteraciones = 0;
+    ajuste.convergio = false;
+
+    // theta de cada vencimiento, no decreciente para que no haya arbitraje de calendario
+    SsviSurface& superficie = ajuste.superficie;
+    std::vector<Quote> cotizaciones;
+    for (const SsviSlice& sonrisa : cadena.vencimientos) {
+        if (sonrisa.strikes.empty() || !(sonrisa.T > 0) ||
+            (!superficie.plazos.empty() && sonrisa.T <= superficie.plazos.back())) {
+            continue;
+        }
+        double theta = atmTotalVariance(sonrisa);
+        if (!superficie.thetas.empty()) {
+            theta = std::max(theta, superficie.thetas.back());
+        }
+        if (!(theta > 0)) {
+            continue;
+        }
+        superficie.plazos.push_back(sonrisa.T);
+        superficie.thetas.push_back(theta);
+
+        double phi_unitario = unitCurvature(theta, superficie.parametros.gamma);
+        for (size_t j = 0; j < sonrisa.strikes.size(); j++) {
+            cotizaciones.push_back(Quote{std::log(sonrisa.strikes[j] / sonrisa.F), sonrisa.T,
+                                         theta, phi_unitario, sonrisa.iv[j]});
+        }
+    }
+    const size_t n = cotizaciones.size();
+    if (n == 0) {
+        return ajuste;
+    }
+
+    // Residuos en volatilidad y jacobiano en (atanh rho, ln eta)
+    auto parametros = [&superficie](const std::array<double, 2>& x) {
+        SsviParams q = superficie.parametros;
+        q.rho = std::tanh(x[0]);
+        q.eta = std::exp(x[1]);
+        return q;
+    };
+    auto evaluar = [&](const std::array<double, 2>& x, std::vector<double>& r,
+                       std::vector<std::array<double, 2>>& J) {
+        const SsviParams q = parametros(x);
+        const double uno_menos_rho2 = 1.0 - q.rho * q.rho;
+        double costo = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            const Quote& c = cotizaciones[j];
+            double phi = q.eta * c.phi_unitario;
+            double a = phi * c.k + q.rho;
+            double s = std::sqrt(a * a + uno_menos_rho2);
+            double w = 0.5 * c.theta * (1.0 + q.rho * phi * c.k + s);
+            double sigma = std::sqrt(std::max(w, 1e-300) / c.T);
+            double escala = 1.0 / (2.0 * sigma * c.T);  // d sigma / d w
+
+            r[j] = sigma - c.iv;
+            J[j][0] = escala * 0.5 * c.theta * phi * c.k * (1.0 + 1.0 / s) * uno_menos_rho2;
+            J[j][1] = escala * 0.5 * c.theta * phi * c.k * (q.rho + a / s);
+            costo += r[j] * r[j];
+        }
+        return std::isfinite(costo) ? costo : INFINITY;
+    };
+    auto acotar = [](std::array<double, 2>& x) {
+        x[0] = std::min(3.8, std::max(-3.8, x[0]));
+        double eta_maximo = 2.0 / (1.0 + std::fabs(std::tanh(x[0])));
+        x[1] = std::min(std::log(eta_maximo), std::max(std::log(1e-4), x[1]));
+    };
+
+    std::array<double, 2> x = {std::atanh(superficie.parametros.rho),
+                               std::log(superficie.parametros.eta)};
+    LeastSquaresResult resultado;
+    if (n >= 3) {
+        resultado = levenbergMarquardt(x, n, evaluar, acotar, config.max_iteraciones,
+                                       config.tolerancia);
+    } else {
+        // Con una o dos cotizaciones la forma no está determinada
+        std::vector<double> r(n);
+        std::vector<std::array<double, 2>> J(n);
+        resultado.costo = evaluar(x, r, J);
+        resultado.iteraciones = 0;
+        resultado.convergio = true;
+    }
+
+    superficie.parametros = parametros(x);
+    ajuste.rmse = std::sqrt(resultado.costo / static_cast<double>(n));
+    ajuste.iteraciones = resultado.iteraciones;
+    ajuste.convergio = resultado.convergio;
+    return ajuste;
+}
+
+std::vector<SsviChain> buildSsviChains(const std::vector<OptionData>& dataframe,
+                                       const RateCurve& curva) {
+    std::vector<SsviChain> cadenas;
+    std::unordered_map<std::string, size_t> posiciones;
+
+    for (const OptionData& fila : dataframe) {
+        if (!usableForSmile(fila) || fila.kind != "CALL") {
+            continue;
+        }
+
+        auto it = posiciones.find(fila.created_at);
+        if (it == posiciones.end()) {
+            it = posiciones.emplace(fila.created_at, cadenas.size()).first;
+            SsviChain cadena;
+            cadena.created_at = fila.created_at;
+            cadena.S = fila.under_price;
+            cadena.r = curva.continuous(fila.expiration);
+            cadenas.push_back(cadena);
+        }
+
+        SsviChain& cadena = cadenas[it->second];
+        auto sonrisa = std::find_if(
+            cadena.vencimientos.begin(), cadena.vencimientos.end(),
+            [&fila](const SsviSlice& s) { return s.expiration_date == fila.expiration_date; });
+        if (sonrisa == cadena.vencimientos.end()) {
+            SsviSlice nueva;
+            nueva.expiration_date = fila.expiration_date;
+            nueva.T = fila.expiration;
+            nueva.F = fila.under_price * std::exp(curva.continuous(fila.expiration) *
+                                                  fila.expiration);
+            cadena.vencimientos.push_back(nueva);
+            sonrisa = cadena.vencimientos.end() - 1;
+        }
+        sonrisa->strikes.push_back(fila.strike);
+        sonrisa->iv.push_back(fila.implied_volatility);
+    }
+
+    for (SsviChain& cadena : cadenas) {
+        std::stable_sort(cadena.vencimientos.begin(), cadena.vencimientos.end(),
+                         [](const SsviSlice& a, const SsviSlice& b) { return a.T < b.T; });
+    }
+    return cadenas;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Superficie SSVI (Gatheral-Jacquier): varianza total de todos los
+ *        vencimientos de un minuto, sin arbitraje estático por construcción.
+ *
+ * La varianza total w = iv^2 T en log-moneyness k = ln(K / F) es
+ *
+ *   w(k, theta) = theta / 2 (1 + rho phi k + sqrt((phi k + rho)^2 + 1 - rho^2))
+ *
+ * con theta(T) la varianza total en el dinero y phi(theta) = eta /
+ * (theta^gamma (1 + theta)^(1 - gamma)). Con theta no decreciente en T,
+ * gamma en (0, 1/2] y eta (1 + |rho|) <= 2 no hay arbitraje de mariposa ni
+ * de calendario, y las derivadas en k y en T son analíticas.
+ *
+ * theta sale de las cotizaciones (interpolando la varianza total en k = 0)
+ * y rho y eta se ajustan con Levenberg-Marquardt contra todas las sonrisas
+ * del minuto a la vez.
+ */
+
+#ifndef BLACKSCHOLES_SSVI_HPP
+#define BLACKSCHOLES_SSVI_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+
+/**
+ * @brief Parámetros de la forma de la sonrisa, comunes a todos los vencimientos.
+ */
+struct SsviParams {
+    double rho;    // Pendiente
+    double eta;    // Curvatura; eta (1 + |rho|) <= 2
+    double gamma;  // Decaimiento de la curvatura con el plazo; no se calibra
+};
+
+/**
+ * @brief Varianza total y sus derivadas en un punto (k, T).
+ */
+struct SsviDerivatives {
+    double w;
+    double w_k;
+    double w_kk;
+    double w_T;  // Con k fijo
+};
+
+/**
+ * @brief Superficie de un minuto: parámetros y theta en cada vencimiento.
+ *
+ * theta se interpola en T con un spline cúbico monótono (Fritsch-Butland)
+ * que pasa por (0, 0) y por cada vencimiento: sigue siendo no decreciente y
+ * su derivada es continua, así que la volatilidad local no salta en cada
+ * vencimiento. Después del último se extiende en línea recta.
+ */
+struct SsviSurface {
+    SsviParams parametros;
+    std::vector<double> plazos;  // T de cada vencimiento, creciente
+    std::vector<double> thetas;  // Varianza total en el dinero, no decreciente
+
+    /**
+     * @brief theta(T) y su derivada.
+     */
+    double theta(double T, double* pendiente = nullptr) const;
+
+    /**
+     * @brief Derivada del spline en el nodo i (0 es T = 0, i > 0 el vencimiento i - 1).
+     */
+    double thetaTangent(size_t i) const;
+
+    double totalVariance(double k, double T) const;
+
+    /**
+     * @brief Volatilidad implícita sqrt(w / T).
+     */
+    double impliedVolatility(double k, double T) const;
+
+    SsviDerivatives derivatives(double k, double T) const;
+
+    /**
+     * @brief derivatives para varios k del mismo plazo.
+     *
+     * Los términos que dependen solo de T se calculan una vez.
+     */
+    void derivatives(double T, const double* k, size_t cantidad, SsviDerivatives* salida) const;
+};
+
+/**
+ * @brief Sonrisa de un vencimiento dentro de un minuto.
+ */
+struct SsviSlice {
+    std::string expiration_date;  // dd/mm/YYYY
+    double T;
+    double F;                     // Forward: subyacente por e^(rT)
+    std::vector<double> strikes;
+    std::vector<double> iv;
+};
+
+/**
+ * @brief Todas las sonrisas de un minuto, ordenadas por plazo.
+ */
+struct SsviChain {
+    std::string created_at;
+    double S;  // Subyacente
+    double r;  // Tasa continua
+    std::vector<SsviSlice> vencimientos;
+};
+
+/**
+ * @brief Parámetros de la calibración.
+ */
+struct SsviCalibrationConfig {
+    double gamma;         // Gamma fija de todos los ajustes
+    int max_iteraciones;
+    double tolerancia;    // Mejora relativa del error o del paso por debajo de la cual se termina
+};
+
+SsviCalibrationConfig defaultSsviCalibration();
+
+/**
+ * @brief Punto de partida sin ajuste anterior: sin pendiente y con curvatura moderada.
+ */
+SsviParams initialSsviGuess(double gamma);
+
+/**
+ * @brief Resultado de calibrar un minuto.
+ */
+struct SsviFit {
+    SsviSurface superficie;
+    double rmse;  // Error cuadrático medio en volatilidad
+    int iteraciones;
+    bool convergio;
+};
+
+/**
+ * @brief Calcula theta de cada vencimiento y ajusta rho y eta.
+ *
+ * El jacobiano es analítico. Con menos de tres cotizaciones en total no se
+ * ajusta la forma: rho y eta quedan como en inicial.
+ *
+ * @param inicial Punto de partida; su gamma se reemplaza por la de config.
+ */
+SsviFit calibrateSsvi(const SsviChain& cadena, const SsviParams& inicial,
+                      const SsviCalibrationConfig& config);
+
+/**
+ * @brief Arma una cadena por minuto con las opciones de compra que tienen
+ *        volatilidad implícita (sin outliers), en el orden de aparición.
+ *
+ * El subyacente y el forward de cada vencimiento son los de su primera fila.
+ */
+std::vector<SsviChain> buildSsviChains(const std::vector<OptionData>& dataframe,
+                                       const RateCurve& curva);
+
+#endif // BLACKSCHOLES_SSVI_HPP
@@ -0,0 +1,176 @@
+#include "ticks.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+const int64_t kMaximo = std::numeric_limits<int64_t>::max();
+
+/**
+ * @brief Lee un decimal sin signo como entero y cantidad de decimales.
+ *
+ * @param max_decimales Los decimales que siguen se ignoran.
+ * @param exacto Si todos los decimales ignorados son 0.
+ * @return false si no es un número o no entra en 64 bits.
+ */
+bool parseDecimal(const char* inicio, const char* fin, int max_decimales, int64_t& digitos,
+                  int& decimales, bool& exacto) {
+    digitos = 0;
+    decimales = -1;  // -1 hasta encontrar el separador
+    exacto = true;
+    bool hay_digitos = false;
+
+    for (const char* p = inicio; p < fin; p++) {
+        if (*p == '.' || *p == ',') {
+            if (decimales >= 0) {
+                return false;
+            }
+            decimales = 0;
+            continue;
+        }
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+
+        hay_digitos = true;
+        if (decimales >= max_decimales) {
+            exacto = exacto && *p == '0';
+            continue;
+        }
+        if (digitos > (kMaximo - 9) / 10) {
+            return false;
+        }
+        digitos = digitos * 10 + (*p - '0');
+        if (decimales >= 0) {
+            decimales++;
+        }
+    }
+
+    decimales = std::max(decimales, 0);
+    return hay_digitos;
+}
+
+/**
+ * @brief Saca los espacios de los extremos.
+ */
+std::string recortar(const std::string& texto) {
+    size_t inicio = texto.find_first_not_of(" \t\r");
+    if (inicio == std::string::npos) {
+        return std::string();
+    }
+    return texto.substr(inicio, texto.find_last_not_of(" \t\r") - inicio + 1);
+}
+
+}  // namespace
+
+bool parseTickSize(const std::string& texto, TickSize& tick) {
+    int64_t digitos;
+    int decimales;
+    bool exacto;
+    if (!parseDecimal(texto.data(), texto.data() + texto.size(), ticks::MAX_DECIMALES + 1,
+                      digitos, decimales, exacto) ||
+        !exacto || digitos <= 0) {
+        return false;
+    }
+
+    // 0,010 es el mismo tick que 0,01
+    while (decimales > 0 && digitos % 10 == 0) {
+        digitos /= 10;
+        decimales--;
+    }
+    if (decimales > ticks::MAX_DECIMALES) {
+        return false;
+    }
+
+    tick.paso = digitos;
+    tick.decimales = decimales;
+    return true;
+}
+
+bool readTickTable(std::istream& entrada, PriceTicks& ticks, size_t& linea) {
+    std::string texto;
+    linea = 0;
+    while (std::getline(entrada, texto)) {
+        linea++;
+        texto = recortar(texto);
+        if (texto.empty() || texto[0] == '#') {
+            continue;
+        }
+
+        std::stringstream campos(texto);
+        std::string opcion;
+        std::string subyacente;
+        InstrumentTicks instrumento;
+        std::getline(campos, instrumento.instrumento, ';');
+        std::getline(campos, opcion, ';');
+        instrumento.instrumento = recortar(instrumento.instrumento);
+        instrumento.subyacente = ticks.subyacente;
+        if (instrumento.instrumento.empty() ||
+            !parseTickSize(recortar(opcion), instrumento.opcion) ||
+            (std::getline(campos, subyacente, ';') &&
+             !parseTickSize(recortar(subyacente), instrumento.subyacente))) {
+            return false;
+        }
+        ticks.instrumentos.push_back(instrumento);
+    }
+    return true;
+}
+
+size_t findTickGrid(const PriceTicks& ticks, const std::string& descripcion) {
+    for (size_t i = 0; i < ticks.instrumentos.size(); i++) {
+        const std::string& patron = ticks.instrumentos[i].instrumento;
+        bool prefijo = !patron.empty() && patron.back() == '*';
+        if (prefijo ? descripcion.compare(0, patron.size() - 1, patron, 0, patron.size() - 1) == 0
+                    : descripcion == patron) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+bool parseTicks(const char* inicio, const char* fin, const TickSize& tick, int64_t& ticks,
+                bool& en_grilla) {
+    bool negativo = inicio < fin && *inicio == '-';
+    if (inicio < fin && (*inicio == '-' || *inicio == '+')) {
+        inicio++;
+    }
+
+    // Más allá de 9 decimales después de los del tick, el divisor es par y los
+    // dígitos que siguen no cambian el redondeo; si no son 0, el precio no
+    // está en la grilla
+    int64_t numerador;
+    int decimales;
+    bool exacto;
+    if (!parseDecimal(inicio, fin, tick.decimales + ticks::MAX_DECIMALES, numerador,
+                      decimales, exacto)) {
+        return false;
+    }
+
+    // numerador * 10^-decimales / (paso * 10^-tick.decimales)
+    int64_t divisor = tick.paso;
+    if (decimales < tick.decimales) {
+        int64_t escala = ticks::POTENCIAS[tick.decimales - decimales];
+        if (numerador > kMaximo / escala) {
+            return false;
+        }
+        numerador *= escala;
+    } else {
+        int64_t escala = ticks::POTENCIAS[decimales - tick.decimales];
+        if (divisor > kMaximo / escala) {
+            return false;
+        }
+        divisor *= escala;
+    }
+
+    int64_t cociente = numerador / divisor;
+    int64_t resto = numerador % divisor;
+    if (resto >= divisor - resto) {
+        cociente++;
+    }
+
+    ticks = negativo ? -cociente : cociente;
+    en_grilla = exacto && resto == 0;
+    return true;
+}
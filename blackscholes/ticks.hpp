@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief Precios en punto fijo: cantidad entera de ticks de cada instrumento.
+ *
+ * Los precios del mercado están en una grilla de ticks (por ejemplo 0,001 para
+ * las opciones y 0,01 para el subyacente). Leerlos directo de los dígitos a un
+ * entero de ticks evita las conversiones de texto y hace exactas las
+ * comparaciones: dos cotizaciones iguales tienen exactamente los mismos ticks.
+ * Recién al entrar al pricer se pasan a double.
+ */
+
+#ifndef BLACKSCHOLES_TICKS_HPP
+#define BLACKSCHOLES_TICKS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Tamaño del tick de un instrumento, como decimal exacto.
+ *
+ * El tick vale paso * 10^-decimales; 0,005 es paso 5 con 3 decimales.
+ */
+struct TickSize {
+    int64_t paso;
+    int decimales;
+};
+
+/**
+ * @brief Ticks de los instrumentos cuya Description coincide con un patrón.
+ *
+ * El patrón es una Description exacta o un prefijo terminado en '*'
+ * ("GFGC*" vale para todas las opciones de compra de GGAL).
+ */
+struct InstrumentTicks {
+    std::string instrumento;
+    TickSize opcion;
+    TickSize subyacente;
+};
+
+/**
+ * @brief Ticks de los precios de un archivo de cotizaciones.
+ *
+ * Cada instrumento usa la primera entrada de la tabla que coincide con su
+ * Description; los que no están en la tabla usan opcion y subyacente. Un
+ * precio fuera de la grilla de su instrumento no se redondea: se marca como
+ * inválido (ver parseQuotes).
+ */
+struct PriceTicks {
+    TickSize opcion;      // Bid y ask
+    TickSize subyacente;  // Under bid y under ask
+    std::vector<InstrumentTicks> instrumentos;
+};
+
+namespace ticks {
+
+const int MAX_DECIMALES = 9;
+
+/**
+ * @brief Potencias de 10 hasta 10^MAX_DECIMALES.
+ */
+const int64_t POTENCIAS[MAX_DECIMALES + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+}  // namespace ticks
+
+/**
+ * @brief Lee un tamaño de tick como 0.001 o 0,001.
+ *
+ * @return false si no es un decimal positivo con a lo sumo ticks::MAX_DECIMALES decimales.
+ */
+bool parseTickSize(const std::string& texto, TickSize& tick);
+
+/**
+ * @brief Lee una tabla de ticks por instrumento y agrega sus entradas a ticks.instrumentos.
+ *
+ * Cada línea es "patrón;tick de la opción[;tick del subyacente]", con el
+ * patrón como en InstrumentTicks; sin tick del subyacente se usa
+ * ticks.subyacente. Se ignoran las líneas vacías y las que empiezan con '#'.
+ *
+ * @param linea Número de la primera línea inválida, si la hay.
+ * @return false si alguna línea no tiene patrón o tiene un tick inválido.
+ */
+bool readTickTable(std::istream& entrada, PriceTicks& ticks, size_t& linea);
+
+/**
+ * @brief Grilla de ticks de un instrumento.
+ *
+ * @return 0 para los ticks por defecto, o 1 + la posición de la entrada de
+ *         ticks.instrumentos que le corresponde.
+ */
+size_t findTickGrid(const PriceTicks& ticks, const std::string& descripcion);
+
+/**
+ * @brief Convierte un precio en ticks leyendo los dígitos, sin pasar por double.
+ *
+ * Acepta signo y separador decimal . o , como las cotizaciones. Un precio que
+ * no cae en la grilla (por ejemplo, con más decimales que el tick) da el tick
+ * más cercano, alejándose de cero en los empates, y en_grilla en false.
+ *
+ * @param inicio Comienzo del texto.
+ * @param fin Fin del texto.
+ * @param ticks Resultado de la conversión.
+ * @param en_grilla Si el precio es exactamente una cantidad entera de ticks.
+ * @return false si el texto está vacío, no es un número o no entra en 64 bits.
+ */
+bool parseTicks(const char* inicio, const char* fin, const TickSize& tick, int64_t& ticks,
+                bool& en_grilla);
+
+inline bool parseTicks(const std::string& texto, const TickSize& tick, int64_t& ticks,
+                       bool& en_grilla) {
+    return parseTicks(texto.data(), texto.data() + texto.size(), tick, ticks, en_grilla);
+}
+
+/**
+ * @brief Valor de una cantidad de ticks.
+ *
+ * La división por una potencia de 10 exacta da el mismo double que leer el
+ * decimal con std::stod.
+ */
+inline double ticksToDouble(int64_t ticks, const TickSize& tick) {
+    return static_cast<double>(ticks * tick.paso) /
+           static_cast<double>(ticks::POTENCIAS[tick.decimales]);
+}
+
+/**
+ * @brief Promedio de dos cantidades de ticks, redondeado al tick más cercano
+ *        (alejándose de cero en los empates).
+ */
+inline int64_t midpointTicks(int64_t a, int64_t b) {
+    int64_t suma = a + b;
+    return (suma >= 0 ? suma + 1 : suma - 1) / 2;
+}
+
+#endif // BLACKSCHOLES_TICKS_HPP
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief Máscaras de validez: un bit por fila para indicar si el valor de una
+ *        columna existe.
+ *
+ * Reemplazan a los valores centinela (-1, cadenas vacías): un valor faltante
+ * queda con su bit en 0 y los cálculos combinan las máscaras de a 64 filas con
+ * operaciones de bits, sin preguntar fila por fila.
+ */
+
+#ifndef BLACKSCHOLES_VALIDITY_HPP
+#define BLACKSCHOLES_VALIDITY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Máscara de validez empaquetada de una columna.
+ *
+ * Cada palabra cubre 64 filas, así que varios hilos pueden escribir la misma
+ * máscara si se reparten rangos de filas que empiezan en múltiplos de
+ * ValidityMask::FILAS_POR_PALABRA.
+ */
+class ValidityMask {
+public:
+    static const size_t FILAS_POR_PALABRA = 64;
+
+    ValidityMask() : filas_(0) {}
+
+    explicit ValidityMask(size_t filas, bool validas = false) {
+        resize(filas, validas);
+    }
+
+    /**
+     * @brief Cambia la cantidad de filas; todas quedan con el valor indicado.
+     */
+    void resize(size_t filas, bool validas = false) {
+        filas_ = filas;
+        palabras_.assign(words(), validas ? ~uint64_t(0) : 0);
+        if (validas && filas % FILAS_POR_PALABRA != 0) {
+            // Los bits después de la última fila quedan siempre en 0
+            palabras_.back() = (uint64_t(1) << (filas % FILAS_POR_PALABRA)) - 1;
+        }
+    }
+
+    size_t size() const {
+        return filas_;
+    }
+
+    size_t words() const {
+        return (filas_ + FILAS_POR_PALABRA - 1) / FILAS_POR_PALABRA;
+    }
+
+    bool test(size_t fila) const {
+        return (palabras_[fila / FILAS_POR_PALABRA] >> (fila % FILAS_POR_PALABRA)) & 1;
+    }
+
+    /**
+     * @brief Marca una fila como válida o no, sin saltos.
+     */
+    void assign(size_t fila, bool valida) {
+        uint64_t bit = uint64_t(1) << (fila % FILAS_POR_PALABRA);
+        uint64_t& palabra = palabras_[fila / FILAS_POR_PALABRA];
+        palabra = (palabra & ~bit) | ((uint64_t(0) - uint64_t(valida)) & bit);
+    }
+
+    void set(size_t fila) {
+        palabras_[fila / FILAS_POR_PALABRA] |= uint64_t(1) << (fila % FILAS_POR_PALABRA);
+    }
+
+    void reset(size_t fila) {
+        palabras_[fila / FILAS_POR_PALABRA] &= ~(uint64_t(1) << (fila % FILAS_POR_PALABRA));
+    }
+
+    uint64_t word(size_t palabra) const {
+        return palabras_[palabra];
+    }
+
+    uint64_t& word(size_t palabra) {
+        return palabras_[palabra];
+    }
+
+    /**
+     * @brief Cantidad de filas válidas.
+     */
+    size_t count() const {
+        size_t cantidad = 0;
+        for (uint64_t palabra : palabras_) {
+            cantidad += static_cast<size_t>(__builtin_popcountll(palabra));
+        }
+        return cantidad;
+    }
+
+    /**
+     * @brief Llama a funcion(fila) para cada bit en 1 de una palabra.
+     *
+     * @param palabra Índice de la palabra (las filas 64 * palabra en adelante).
+     * @param bits Máscara ya combinada de esa palabra.
+     */
+    template <typename Funcion>
+    static void forEachSet(size_t palabra, uint64_t bits, Funcion funcion) {
+        while (bits != 0) {
+            size_t bit = static_cast<size_t>(__builtin_ctzll(bits));
+            funcion(palabra * FILAS_POR_PALABRA + bit);
+            bits &= bits - 1;
+        }
+    }
+
+private:
+    std::vector<uint64_t> palabras_;
+    size_t filas_;
+};
+
+#endif // BLACKSCHOLES_VALIDITY_HPP
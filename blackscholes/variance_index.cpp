@@ -0,0 +1,283 @@
+#include "variance_index.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+#include "parsing.hpp"
+
+VarianceIndexConfig defaultVarianceIndexConfig() {
+    VarianceIndexConfig config;
+    config.plazo = 30.0 / 365.0;
+    config.bids_nulos = 2;
+    return config;
+}
+
+VarianceIndexBuilder::VarianceIndexBuilder(const RateCurve& curva,
+                                           const VarianceIndexConfig& config)
+    : curva_(curva), config_(config), abierto_segundos_(0), tarde_(0) {}
+
+void VarianceIndexBuilder::add(const OptionData& fila) {
+    if (fila.created_at != abierto_) {
+        int64_t segundos;
+        if (!parseTimestamp(fila.created_at, segundos)) {
+            return;
+        }
+        if (!abierto_.empty() && segundos < abierto_segundos_) {
+            tarde_++;
+            return;
+        }
+        close();
+        abierto_ = fila.created_at;
+        abierto_segundos_ = segundos;
+    }
+
+    bool completa = isValid(fila, csv::BID) && isValid(fila, csv::ASK) &&
+                    isValid(fila, csv::STRIKE) && isValid(fila, csv::EXPIRATION);
+    bool call = fila.kind == "CALL";
+    if (!completa || !(call || fila.kind == "PUT") || !(fila.expiration > 0) ||
+        fila.strike <= 0 || fila.bid < 0 || fila.ask < fila.bid) {
+        return;
+    }
+
+    size_t vencimiento = 0;
+    while (vencimiento < vencimientos_.size() &&
+           vencimientos_[vencimiento] != fila.expiration_date) {
+        vencimiento++;
+    }
+    if (vencimiento == vencimientos_.size()) {
+        vencimientos_.push_back(fila.expiration_date);
+    }
+    cotizaciones_.push_back(Quote{vencimiento, fila.expiration, static_cast<double>(fila.strike),
+                                  0.5 * (fila.bid + fila.ask), fila.bid, call});
+}
+
+void VarianceIndexBuilder::flush() {
+    close();
+    abierto_.clear();
+}
+
+void VarianceIndexBuilder::close() {
+    if (cotizaciones_.empty()) {
+        vencimientos_.clear();
+        return;
+    }
+    // La cadena está completa desde ahora
+    auto inicio = std::chrono::steady_clock::now();
+
+    VarianceIndex resultado;
+    resultado.created_at = abierto_;
+    resultado.indice = -1.0;
+    resultado.varianza = 0.0;
+
+    // Vencimiento por plazo, y dentro de cada uno por strike. Estable: entre
+    // cotizaciones del mismo strike se mantiene el orden de llegada
+    std::stable_sort(cotizaciones_.begin(), cotizaciones_.end(),
+                     [](const Quote& a, const Quote& b) {
+                         if (a.T != b.T) {
+                             return a.T < b.T;
+                         }
+                         if (a.vencimiento != b.vencimiento) {
+                             return a.vencimiento < b.vencimiento;
+                         }
+                         return a.strike < b.strike;
+                     });
+    size_t desde = 0;
+    while (desde < cotizaciones_.size()) {
+        size_t hasta = desde + 1;
+        while (hasta < cotizaciones_.size() &&
+               cotizaciones_[hasta].vencimiento == cotizaciones_[desde].vencimiento) {
+            hasta++;
+        }
+        VarianceTerm plazo;
+        if (computeTerm(desde, hasta, plazo)) {
+            resultado.vencimientos.push_back(plazo);
+        }
+        desde = hasta;
+    }
+
+    // Varianza total lineal en el plazo entre los vencimientos que rodean al constante
+    const std::vector<VarianceTerm>& plazos = resultado.vencimientos;
+    if (!plazos.empty()) {
+        const double Tc = config_.plazo;
+        size_t siguiente = 0;
+        while (siguiente < plazos.size() && plazos[siguiente].T <= Tc) {
+            siguiente++;
+        }
+        if (siguiente == plazos.size()) {
+            resultado.varianza = plazos.back().varianza;
+        } else if (siguiente == 0) {
+            resultado.varianza = plazos.front().varianza;
+        } else {
+            const VarianceTerm& cercano = plazos[siguiente - 1];
+            const VarianceTerm& lejano = plazos[siguiente];
+            double peso = (Tc - cercano.T) / (lejano.T - cercano.T);
+            double total = (1.0 - peso) * cercano.T * cercano.varianza +
+                           peso * lejano.T * lejano.varianza;
+            resultado.varianza = total / Tc;
+        }
+        resultado.indice = 100.0 * std::sqrt(std::max(resultado.varianza, 0.0));
+    }
+
+    resultado.latencia =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    resultados_.push_back(std::move(resultado));
+    cotizaciones_.clear();
+    vencimientos_.clear();
+}
+
+bool VarianceIndexBuilder::computeTerm(size_t desde, size_t hasta, VarianceTerm& plazo) {
+    Strikes& s = strikes_;
+    s.K.clear();
+    s.call.clear();
+    s.put.clear();
+    s.bid_call.clear();
+    s.bid_put.clear();
+    s.seleccion_K.clear();
+    s.seleccion_Q.clear();
+
+    const double T = cotizaciones_[desde].T;
+    const double crecimiento = std::exp(curva_.continuous(T) * T);
+    // Una fila por strike; con dos cotizaciones del mismo contrato vale la última
+    for (size_t i = desde; i < hasta; i++) {
+        const Quote& q = cotizaciones_[i];
+        if (s.K.empty() || s.K.back() != q.strike) {
+            s.K.push_back(q.strike);
+            s.call.push_back(-1.0);
+            s.put.push_back(-1.0);
+            s.bid_call.push_back(-1.0);
+            s.bid_put.push_back(-1.0);
+        }
+        (q.call ? s.call : s.put).back() = q.medio;
+        (q.call ? s.bid_call : s.bid_put).back() = q.bid;
+    }
+    const size_t n = s.K.size();
+
+    // Forward por paridad en el strike con la menor diferencia entre compra y venta
+    size_t paridad = n;
+    double diferencia = 0.0;
+    for (size_t j = 0; j < n; j++) {
+        if (s.call[j] >= 0 && s.put[j] >= 0 &&
+            (paridad == n || std::fabs(s.call[j] - s.put[j]) < diferencia)) {
+            paridad = j;
+            diferencia = std::fabs(s.call[j] - s.put[j]);
+        }
+    }
+    if (paridad == n) {
+        return false;
+    }
+    const double F = s.K[paridad] + crecimiento * (s.call[paridad] - s.put[paridad]);
+    size_t k0 = static_cast<size_t>(std::upper_bound(s.K.begin(), s.K.end(), F) - s.K.begin());
+    if (k0 == 0) {
+        return false;
+    }
+    k0--;
+
+    // Opciones de venta por debajo de K0, de K0 hacia afuera
+    size_t nulos = 0;
+    for (size_t j = k0; j-- > 0;) {
+        if (s.bid_put[j] > 0) {
+            s.seleccion_K.push_back(s.K[j]);
+            s.seleccion_Q.push_back(s.put[j]);
+            nulos = 0;
+        } else if (++nulos >= config_.bids_nulos) {
+            break;
+        }
+    }
+    std::reverse(s.seleccion_K.begin(), s.seleccion_K.end());
+    std::reverse(s.seleccion_Q.begin(), s.seleccion_Q.end());
+    if (s.call[k0] >= 0 || s.put[k0] >= 0) {
+        double Q = s.call[k0] >= 0 && s.put[k0] >= 0 ? 0.5 * (s.call[k0] + s.put[k0])
+                                                     : std::max(s.call[k0], s.put[k0]);
+        s.seleccion_K.push_back(s.K[k0]);
+        s.seleccion_Q.push_back(Q);
+    }
+    nulos = 0;
+    for (size_t j = k0 + 1; j < n; j++) {
+        if (s.bid_call[j] > 0) {
+            s.seleccion_K.push_back(s.K[j]);
+            s.seleccion_Q.push_back(s.call[j]);
+            nulos = 0;
+        } else if (++nulos >= config_.bids_nulos) {
+            break;
+        }
+    }
+
+    const size_t m = s.seleccion_K.size();
+    if (m < 2) {
+        return false;
+    }
+    // Suma de dK / K^2 Q; los extremos usan la distancia a su único vecino
+    const double* K = s.seleccion_K.data();
+    const double* Q = s.seleccion_Q.data();
+    double suma = (K[1] - K[0]) / (K[0] * K[0]) * Q[0] +
+                  (K[m - 1] - K[m - 2]) / (K[m - 1] * K[m - 1]) * Q[m - 1];
+    for (size_t i = 1; i + 1 < m; i++) {
+        suma += 0.5 * (K[i + 1] - K[i - 1]) / (K[i] * K[i]) * Q[i];
+    }
+    const double desvio_K0 = F / s.K[k0] - 1.0;
+    const double varianza = (2.0 * crecimiento * suma - desvio_K0 * desvio_K0) / T;
+    if (!(varianza > 0) || !std::isfinite(varianza)) {
+        return false;
+    }
+
+    plazo.expiration_date = vencimientos_[cotizaciones_[desde].vencimiento];
+    plazo.T = T;
+    plazo.F = F;
+    plazo.K0 = s.K[k0];
+    plazo.varianza = varianza;
+    plazo.strikes = m;
+    return true;
+}
+
+std::vector<VarianceIndex> computeVarianceIndices(const std::vector<OptionData>& dataframe,
+                                                  const RateCurve& curva,
+                                                  const VarianceIndexConfig& config) {
+    // El archivo puede venir en cualquier orden (el pipeline agrupa por contrato
+    // por su cuenta); el constructor necesita las filas por fecha, y dentro de
+    // cada minuto se mantiene el orden del archivo
+    std::vector<std::pair<int64_t, size_t>> orden;
+    orden.reserve(dataframe.size());
+    for (size_t i = 0; i < dataframe.size(); i++) {
+        int64_t segundos;
+        if (parseTimestamp(dataframe[i].created_at, segundos)) {
+            orden.emplace_back(segundos, i);
+        }
+    }
+    std::sort(orden.begin(), orden.end());
+
+    VarianceIndexBuilder constructor(curva, config);
+    for (const auto& fila : orden) {
+        constructor.add(dataframe[fila.second]);
+    }
+    constructor.flush();
+    return constructor.results();
+}
+
+bool saveVarianceIndices(const std::vector<VarianceIndex>& indices, const std::string& archivo) {
+    std::ofstream salida(archivo);
+    if (!salida) {
+        return false;
+    }
+    salida << "Created At,Index,Variance,Latency (us),Expiration,Maturity,Forward,K0,"
+              "Term Variance,Strikes\n";
+    for (const VarianceIndex& indice : indices) {
+        // Una línea por vencimiento utilizable; sin ninguno, una con esas columnas vacías
+        size_t lineas = std::max<size_t>(indice.vencimientos.size(), 1);
+        for (size_t v = 0; v < lineas; v++) {
+            salida << indice.created_at << ',' << indice.indice << ',' << indice.varianza << ','
+                   << indice.latencia * 1e6;
+            if (v < indice.vencimientos.size()) {
+                const VarianceTerm& plazo = indice.vencimientos[v];
+                salida << ',' << plazo.expiration_date << ',' << plazo.T << ',' << plazo.F << ','
+                       << plazo.K0 << ',' << plazo.varianza << ',' << plazo.strikes;
+            } else {
+                salida << ",,,,,,";
+            }
+            salida << '\n';
+        }
+    }
+    return static_cast<bool>(salida);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * @brief Índice de varianza sin modelo (estilo VIX) de cada minuto.
+ *
+ * Para cada vencimiento de la cadena del minuto:
+ *
+ * - Forward por paridad: en el strike donde |C - P| es mínimo,
+ *   F = K + e^(rT) (C - P), con C y P los puntos medios de bid y ask.
+ * - K0 es el mayor strike que no supera F. Entran las opciones de venta con
+ *   strike menor que K0 y las de compra con strike mayor, alejándose de K0
+ *   hasta encontrar dos bids nulos seguidos; en K0 se promedian las dos.
+ * - Varianza: sigma^2 = 2/T sum(dK_i / K_i^2 e^(rT) Q_i) - 1/T (F / K0 - 1)^2,
+ *   con dK_i la mitad de la distancia entre los vecinos de K_i.
+ *
+ * La varianza total se interpola linealmente en el plazo entre los dos
+ * vencimientos que rodean el plazo constante (30 días por omisión); fuera de
+ * ese rango se usa la varianza anualizada del vencimiento más cercano. El
+ * índice es 100 sqrt(varianza anualizada).
+ *
+ * VarianceIndexBuilder recibe las cotizaciones en orden de fecha, como en un
+ * flujo en tiempo real: la primera de un minuto nuevo completa la cadena
+ * anterior, que se calcula en ese momento, y se guarda cuánto tardó cada
+ * minuto. main no lo alimenta desde el pipeline: recorre el archivo ya
+ * procesado con computeVarianceIndices, así que ahí la latencia mide solo el
+ * cálculo de cada minuto.
+ */
+
+#ifndef BLACKSCHOLES_VARIANCE_INDEX_HPP
+#define BLACKSCHOLES_VARIANCE_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+
+/**
+ * @brief Parámetros del índice.
+ */
+struct VarianceIndexConfig {
+    double plazo;               // Plazo constante en años
+    size_t bids_nulos;          // Bids nulos seguidos que cortan la selección de strikes
+};
+
+VarianceIndexConfig defaultVarianceIndexConfig();
+
+/**
+ * @brief Varianza de un vencimiento.
+ */
+struct VarianceTerm {
+    std::string expiration_date;
+    double T;
+    double F;         // Forward por paridad
+    double K0;
+    double varianza;  // Anualizada
+    size_t strikes;   // Strikes que entraron en la suma
+};
+
+/**
+ * @brief Índice de un minuto.
+ */
+struct VarianceIndex {
+    std::string created_at;
+    double indice;      // 100 sqrt(varianza), o -1 sin vencimientos utilizables
+    double varianza;    // Anualizada, al plazo constante
+    double latencia;    // Segundos desde que se completó la cadena hasta tener el índice
+    std::vector<VarianceTerm> vencimientos;  // Los utilizables, ordenados por plazo
+};
+
+/**
+ * @brief Calcula el índice de cada minuto a medida que se completan las cadenas.
+ *
+ * Las cotizaciones tienen que llegar en orden de fecha; dentro de un minuto,
+ * en orden de llegada. Solo entran las filas con fecha, bid, ask, strike y plazo.
+ */
+class VarianceIndexBuilder {
+public:
+    VarianceIndexBuilder(const RateCurve& curva, const VarianceIndexConfig& config);
+
+    /**
+     * @brief Agrega una cotización. Si es de otro minuto, primero calcula el abierto.
+     *
+     * Una cotización anterior al minuto abierto llega tarde: ese minuto ya se
+     * calculó, así que se descarta (ver late()).
+     */
+    void add(const OptionData& fila);
+
+    /**
+     * @brief Calcula el minuto abierto, si tiene cotizaciones.
+     */
+    void flush();
+
+    const std::vector<VarianceIndex>& results() const { return resultados_; }
+
+    /**
+     * @return Cotizaciones descartadas por llegar después de su minuto.
+     */
+    size_t late() const { return tarde_; }
+
+private:
+    struct Quote {
+        size_t vencimiento;  // Posición en vencimientos_
+        double T;
+        double strike;
+        double medio;
+        double bid;
+        bool call;
+    };
+
+    /**
+     * @brief Calls y puts de un vencimiento por strike; -1 donde no hay cotización.
+     */
+    struct Strikes {
+        std::vector<double> K;
+        std::vector<double> call;
+        std::vector<double> put;
+        std::vector<double> bid_call;
+        std::vector<double> bid_put;
+        std::vector<double> seleccion_K;  // Strikes fuera del dinero, ordenados
+        std::vector<double> seleccion_Q;
+    };
+
+    void close();
+    bool computeTerm(size_t desde, size_t hasta, VarianceTerm& plazo);
+
+    const RateCurve& curva_;
+    VarianceIndexConfig config_;
+    std::string abierto_;
+    int64_t abierto_segundos_;  // Fecha del minuto abierto
+    size_t tarde_;
+    std::vector<std::string> vencimientos_;  // Fechas del minuto abierto
+    std::vector<Quote> cotizaciones_;
+    Strikes strikes_;
+    std::vector<VarianceIndex> resultados_;
+};
+
+/**
+ * @brief Recorre el dataframe en orden de fecha y calcula el índice de cada minuto.
+ */
+std::vector<VarianceIndex> computeVarianceIndices(const std::vector<OptionData>& dataframe,
+                                                  const RateCurve& curva,
+                                                  const VarianceIndexConfig& config);
+
+/**
+ * @brief Escribe un CSV con el índice de cada minuto y los vencimientos que se usaron.
+ *
+ * @return false si no se pudo escribir el archivo.
+ */
+bool saveVarianceIndices(const std::vector<VarianceIndex>& indices, const std::string& archivo);
+
+#endif // BLACKSCHOLES_VARIANCE_INDEX_HPP
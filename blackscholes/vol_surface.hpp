@@ -0,0 +1,313 @@
+/**
+ * @file
+ * @brief Superficie de volatilidad implícita publicada sin locks para varios lectores.
+ */
+
+#ifndef BLACKSCHOLES_VOL_SURFACE_HPP
+#define BLACKSCHOLES_VOL_SURFACE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Grilla de volatilidades implícitas por tipo, vencimiento y strike.
+ *
+ * Tiene tamaño fijo y no usa memoria dinámica, así se puede copiar entera con
+ * memcpy al publicarla. Los ejes de vencimientos y strikes son comunes a los
+ * dos tipos; cada celda tiene un bit de validez, así que una celda sin
+ * cotización no tiene valor (ver valid).
+ */
+struct VolSurface {
+    static const size_t MAX_VENCIMIENTOS = 16;
+    static const size_t MAX_STRIKES = 128;
+    static const size_t TIPOS = 2;  // 0 = CALL, 1 = PUT
+    static const size_t PALABRAS_STRIKES = (MAX_STRIKES + 63) / 64;
+
+    uint64_t version;                           // Número de publicación
+    char created_at[24];                        // Última cotización incluida
+    size_t cantidad_vencimientos;
+    size_t cantidad_strikes;
+    int vencimientos[MAX_VENCIMIENTOS];         // YYYYMMDD, ordenados
+    double strikes[MAX_STRIKES];                // Ordenados
+    double iv[TIPOS][MAX_VENCIMIENTOS][MAX_STRIKES];
+    double expiration[TIPOS][MAX_VENCIMIENTOS][MAX_STRIKES];  // Años al momento de la cotización
+    uint64_t validas[TIPOS][MAX_VENCIMIENTOS][PALABRAS_STRIKES];  // Un bit por strike
+
+    /**
+     * @brief Índice del tipo ("CALL" o "PUT").
+     *
+     * @return false si el tipo no es ninguno de los dos.
+     */
+    static bool kindIndex(const std::string& kind, size_t& tipo) {
+        if (kind == "CALL") {
+            tipo = 0;
+        } else if (kind == "PUT") {
+            tipo = 1;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Deja la superficie vacía.
+     */
+    void clear() {
+        version = 0;
+        std::memset(created_at, 0, sizeof(created_at));
+        cantidad_vencimientos = 0;
+        cantidad_strikes = 0;
+        std::memset(validas, 0, sizeof(validas));
+    }
+
+    /**
+     * @brief Indica si la celda (fila de vencimiento, columna de strike) tiene cotización.
+     */
+    bool valid(size_t tipo, size_t fila, size_t columna) const {
+        return (validas[tipo][fila][columna / 64] >> (columna % 64)) & 1;
+    }
+
+    /**
+     * @brief Actualiza (o agrega) la celda de un tipo, un vencimiento y un strike.
+     *
+     * @return false si la grilla no tiene lugar para un vencimiento o strike nuevo.
+     */
+    bool set(size_t tipo, int vencimiento, double strike, double volatilidad, double T) {
+        size_t fila, columna;
+        if (!insertar(vencimientos, cantidad_vencimientos, MAX_VENCIMIENTOS, vencimiento, fila,
+                      true) ||
+            !insertar(strikes, cantidad_strikes, MAX_STRIKES, strike, columna, false)) {
+            return false;
+        }
+        iv[tipo][fila][columna] = volatilidad;
+        expiration[tipo][fila][columna] = T;
+        validas[tipo][fila][columna / 64] |= uint64_t(1) << (columna % 64);
+        return true;
+    }
+
+    /**
+     * @brief Volatilidad de una celda.
+     *
+     * @return false si la celda no tiene cotización.
+     */
+    bool volatility(size_t tipo, int vencimiento, double strike, double& volatilidad) const {
+        const int* v = std::lower_bound(vencimientos, vencimientos + cantidad_vencimientos,
+                                        vencimiento);
+        const double* k = std::lower_bound(strikes, strikes + cantidad_strikes, strike);
+        if (v == vencimientos + cantidad_vencimientos || *v != vencimiento ||
+            k == strikes + cantidad_strikes || *k != strike) {
+            return false;
+        }
+        size_t fila = static_cast<size_t>(v - vencimientos);
+        size_t columna = static_cast<size_t>(k - strikes);
+        if (!valid(tipo, fila, columna)) {
+            return false;
+        }
+        volatilidad = iv[tipo][fila][columna];
+        return true;
+    }
+
+private:
+    /**
+     * @brief Inserta un bit en 0 en la posición indicada, corriendo los siguientes.
+     */
+    static void insertarBit(uint64_t* palabras, size_t posicion) {
+        size_t w = posicion / 64;
+        for (size_t i = PALABRAS_STRIKES - 1; i > w; i--) {
+            palabras[i] = (palabras[i] << 1) | (palabras[i - 1] >> 63);
+        }
+        uint64_t bajos = (uint64_t(1) << (posicion % 64)) - 1;
+        palabras[w] = (palabras[w] & bajos) | ((palabras[w] & ~bajos) << 1);
+    }
+
+    /**
+     * @brief Busca un valor en un eje ordenado y, si no está, lo inserta
+     *        corriendo las filas (o columnas) de la grilla. La fila o columna
+     *        nueva queda sin cotizaciones.
+     */
+    template <typename T>
+    bool insertar(T* eje, size_t& cantidad, size_t maximo, T valor, size_t& posicion,
+                  bool es_fila) {
+        T* it = std::lower_bound(eje, eje + cantidad, valor);
+        posicion = static_cast<size_t>(it - eje);
+        if (it != eje + cantidad && *it == valor) {
+            return true;
+        }
+        if (cantidad == maximo) {
+            return false;
+        }
+
+        std::copy_backward(eje + posicion, eje + cantidad, eje + cantidad + 1);
+        eje[posicion] = valor;
+
+        for (size_t tipo = 0; tipo < TIPOS; tipo++) {
+            if (es_fila) {
+                for (size_t i = cantidad; i > posicion; i--) {
+                    std::copy(iv[tipo][i - 1], iv[tipo][i - 1] + MAX_STRIKES, iv[tipo][i]);
+                    std::copy(expiration[tipo][i - 1], expiration[tipo][i - 1] + MAX_STRIKES,
+                              expiration[tipo][i]);
+                    std::copy(validas[tipo][i - 1], validas[tipo][i - 1] + PALABRAS_STRIKES,
+                              validas[tipo][i]);
+                }
+                std::fill(validas[tipo][posicion], validas[tipo][posicion] + PALABRAS_STRIKES,
+                          uint64_t(0));
+            } else {
+                for (size_t i = 0; i < cantidad_vencimientos; i++) {
+                    std::copy_backward(iv[tipo][i] + posicion, iv[tipo][i] + cantidad,
+                                       iv[tipo][i] + cantidad + 1);
+                    std::copy_backward(expiration[tipo][i] + posicion,
+                                       expiration[tipo][i] + cantidad,
+                                       expiration[tipo][i] + cantidad + 1);
+                    insertarBit(validas[tipo][i], posicion);
+                }
+            }
+        }
+
+        cantidad++;
+        return true;
+    }
+};
+
+/**
+ * @brief Última superficie publicada, con doble buffer y seqlock.
+ *
+ * El escritor siempre escribe en el buffer que no es el vigente y después lo
+ * marca como vigente, así que nunca espera a los lectores. Un lector copia el
+ * buffer vigente y verifica con la secuencia del buffer que el escritor no lo
+ * haya empezado a reescribir mientras copiaba; solo reintenta si el escritor
+ * publicó dos veces durante una copia.
+ *
+ * Hay un único escritor; publish no se puede llamar desde dos hilos a la vez.
+ */
+class VolSurfaceSnapshot {
+public:
+    VolSurfaceSnapshot() : publicados_(0) {
+        for (Buffer& buffer : buffers_) {
+            buffer.secuencia.store(0, std::memory_order_relaxed);
+            buffer.superficie.clear();
+        }
+    }
+
+    /**
+     * @brief Publica una copia de la superficie.
+     *
+     * @return Versión asignada (empieza en 1).
+     */
+    uint64_t publish(const VolSurface& superficie) {
+        uint64_t n = publicados_.load(std::memory_order_relaxed);
+        Buffer& buffer = buffers_[n & 1];
+
+        // Secuencia impar: un lector atrasado que esté copiando este buffer reintenta
+        buffer.secuencia.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&buffer.superficie, &superficie, sizeof(VolSurface));
+        buffer.superficie.version = n + 1;
+
+        buffer.secuencia.store(2 * n + 2, std::memory_order_release);
+        publicados_.store(n + 1, std::memory_order_release);
+        return n + 1;
+    }
+
+    /**
+     * @brief Copia la última superficie publicada sin bloquear al escritor.
+     *
+     * @return Versión copiada, o 0 si todavía no se publicó ninguna.
+     */
+    uint64_t read(VolSurface& copia) const {
+        while (true) {
+            uint64_t n = publicados_.load(std::memory_order_acquire);
+            if (n == 0) {
+                copia.clear();
+                return 0;
+            }
+
+            const Buffer& buffer = buffers_[(n - 1) & 1];
+            uint64_t antes = buffer.secuencia.load(std::memory_order_acquire);
+            if (antes != 2 * n) {
+                continue;
+            }
+
+            std::memcpy(&copia, &buffer.superficie, sizeof(VolSurface));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (buffer.secuencia.load(std::memory_order_relaxed) == antes) {
+                return n;
+            }
+        }
+    }
+
+    /**
+     * @brief Versión de la última superficie publicada.
+     */
+    uint64_t version() const {
+        return publicados_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct alignas(64) Buffer {
+        std::atomic<uint64_t> secuencia;
+        VolSurface superficie;
+    };
+
+    Buffer buffers_[2];
+    alignas(64) std::atomic<uint64_t> publicados_;
+};
+
+/**
+ * @brief Mantiene la superficie de trabajo a partir de las cotizaciones y la publica.
+ *
+ * Varias etapas (por ejemplo un archivo por vencimiento en modo batch) pueden
+ * actualizarla a la vez: el mutex solo lo toman los escritores, nunca los lectores
+ * del snapshot.
+ */
+class VolSurfaceWriter {
+public:
+    explicit VolSurfaceWriter(VolSurfaceSnapshot& destino) : destino_(destino) {
+        trabajo_.clear();
+    }
+
+    /**
+     * @brief Actualiza la celda de una cotización.
+     *
+     * @param kind "CALL" o "PUT".
+     * @param vencimiento Fecha de vencimiento en formato dd/mm/YYYY.
+     * @return false si el tipo o la fecha son inválidos o la grilla está llena.
+     */
+    bool update(const std::string& kind, const std::string& vencimiento, double strike,
+                double volatilidad, double T, const std::string& created_at) {
+        size_t tipo;
+        int dia, mes, anio;
+        if (!VolSurface::kindIndex(kind, tipo) ||
+            std::sscanf(vencimiento.c_str(), "%d/%d/%d", &dia, &mes, &anio) != 3) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t largo = std::min(created_at.size(), sizeof(trabajo_.created_at) - 1);
+        std::memcpy(trabajo_.created_at, created_at.data(), largo);
+        trabajo_.created_at[largo] = '\0';
+        return trabajo_.set(tipo, anio * 10000 + mes * 100 + dia, strike, volatilidad, T);
+    }
+
+    /**
+     * @brief Publica el estado actual de la superficie de trabajo.
+     */
+    uint64_t publish() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return destino_.publish(trabajo_);
+    }
+
+private:
+    std::mutex mutex_;
+    VolSurface trabajo_;
+    VolSurfaceSnapshot& destino_;
+};
+
+#endif // BLACKSCHOLES_VOL_SURFACE_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @brief Ejemplo de consumidor del ring de resultados en memoria compartida.
+ *
+ * Se engancha en modo solo lectura al ring que publica `main --publish <nombre>`
+ * y muestra cada fila a medida que llega, con la latencia desde la publicación.
+ *
+ * Compilación:
+ *   g++ -std=c++17 -O2 -I. examples/ring_reader.cpp blackscholes/result_ring.cpp -o ring_reader
+ * Uso:
+ *   ./ring_reader /blackscholes
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "blackscholes/pipeline.hpp"
+#include "blackscholes/result_ring.hpp"
+
+int main(int argc, char* argv[]) {
+    std::string nombre = argc > 1 ? argv[1] : "/blackscholes";
+
+    // Espera a que el productor cree el segmento
+    std::unique_ptr<ResultRingReader> lector;
+    while (true) {
+        lector.reset(new ResultRingReader(nombre));
+        if (lector->ok()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    uint64_t siguiente = lector->oldest();
+    ResultRecord registro;
+
+    while (true) {
+        ResultRingReader::Estado estado = lector->read(siguiente, registro);
+
+        if (estado == ResultRingReader::PENDIENTE) {
+            // Espera activa: es lo que da latencias de microsegundos
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (estado == ResultRingReader::PERDIDO) {
+            uint64_t viejo = lector->oldest();
+            std::cerr << "Se perdieron " << viejo - siguiente << " registros" << std::endl;
+            siguiente = viejo;
+            continue;
+        }
+
+        int64_t latencia = monotonicNanos() - registro.publicado_ns;
+        std::cout << siguiente << " " << registro.created_at << " " << registro.description
+                  << " IV=";
+        if ((registro.validez >> csv::IMPLIED_VOLATILITY) & 1) {
+            std::cout << registro.implied_volatility;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << (registro.iv_outlier ? " (outlier)" : "")
+                  << " latencia=" << latencia << "ns\n";
+        siguiente++;
+    }
+}
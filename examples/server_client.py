@@ -0,0 +1,78 @@
+"""Cliente de ejemplo para `main --server`.
+
+Manda pedidos de volatilidad implícita desde varios hilos y muestra la
+latencia vista por el cliente.
+
+    python3 examples/server_client.py /tmp/blackscholes.sock
+"""
+
+import math
+import socket
+import struct
+import sys
+import threading
+import time
+
+REQUEST = struct.Struct('=IHHII')
+RESPONSE = struct.Struct('=IHHII')
+REQUEST_MAGIC = 0x51525342
+RESPONSE_MAGIC = 0x50525342
+OP_IMPLIED_VOL = 1
+OP_CALL_PRICE = 2
+
+
+def connect(direccion):
+    if ':' in direccion and '/' not in direccion:
+        host, puerto = direccion.rsplit(':', 1)
+        return socket.create_connection((host or '127.0.0.1', int(puerto)))
+    s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    s.connect(direccion)
+    return s
+
+
+def read_exact(s, n):
+    datos = b''
+    while len(datos) < n:
+        parte = s.recv(n - len(datos))
+        if not parte:
+            raise ConnectionError('conexión cerrada')
+        datos += parte
+    return datos
+
+
+def request(s, operacion, registros, id_pedido=0):
+    """registros: lista de tuplas (S, K, T, r, x). Devuelve (status, resultados)."""
+    cuerpo = b''.join(struct.pack('=5d', *r) for r in registros)
+    s.sendall(REQUEST.pack(REQUEST_MAGIC, 1, operacion, id_pedido, len(registros)) + cuerpo)
+    magic, _, status, _, count = RESPONSE.unpack(read_exact(s, RESPONSE.size))
+    assert magic == RESPONSE_MAGIC
+    return status, struct.unpack('=%dd' % count, read_exact(s, 8 * count))
+
+
+def worker(direccion, pedidos, latencias):
+    s = connect(direccion)
+    r = math.log(2)
+    for i in range(pedidos):
+        registros = [(1180.0 + j, 1033.0, 0.004, r, 190.0 + j) for j in range(4)]
+        inicio = time.perf_counter()
+        status, _ = request(s, OP_IMPLIED_VOL, registros, i)
+        latencias.append((time.perf_counter() - inicio) * 1e6)
+        assert status == 0, status
+    s.close()
+
+
+if __name__ == '__main__':
+    direccion = sys.argv[1] if len(sys.argv) > 1 else '/tmp/blackscholes.sock'
+    s = connect(direccion)
+    print(request(s, OP_IMPLIED_VOL, [(1182.28, 1033.0, 0.00422374, math.log(2), 193.631)]))
+    s.close()
+
+    latencias = []
+    hilos = [threading.Thread(target=worker, args=(direccion, 500, latencias)) for _ in range(8)]
+    for h in hilos:
+        h.start()
+    for h in hilos:
+        h.join()
+    latencias.sort()
+    print('p50=%.1fus p99=%.1fus' % (latencias[len(latencias) // 2],
+                                     latencias[int(len(latencias) * 0.99)]))
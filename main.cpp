@@ -5,680 +5,393 @@
  * Este programa lee datos de opciones financieras de un archivo CSV, realiza interpolación
  * para manejar valores faltantes y calcula la volatilidad implícita para cada opción.
  * Los resultados se guardan en un nuevo archivo CSV.
+ *
+ * Los cálculos viven en la biblioteca de blackscholes/; este archivo solo
+ * interpreta los argumentos y arma el pipeline.
  */
 
 #include <iostream>
-#include <iomanip>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <regex>
 #include <string>
-#include <cmath>
-#include <ctime>
-#include <chrono>
-#include <filesystem>
-
-/**
- * @brief Función de distribución acumulativa normal estándar (CDF).
- * 
- * @param x Valor para el cual se calcula la CDF.
- * @return Valor de la CDF en x.
- */
-double cdf(double x) {
-    return 0.5 * (1 + std::erf(x / std::sqrt(2)));
-}
-
-double calculate_d1(double S, double K, double T, double r, double sigma){
-    return (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
-}
-
-/**
- * @brief Calcula el precio de una opción de compra utilizando el modelo Black-Scholes.
- * 
- * @param S Precio del activo subyacente.
- * @param K Precio de ejercicio de la opción.
- * @param T Tiempo hasta la expiración de la opción.
- * @param r Tasa de interés libre de riesgo continua.
- * @param sigma Volatilidad del activo subyacente.
- * @return Precio de la opción de compra.
- */
-double blackScholesCall(double S, double K, double T, double r, double sigma) {
-
-    double d1 = calculate_d1(S, K, T, r, sigma);
-
-    double d2 = d1 - sigma * std::sqrt(T);
-
-    return S * cdf(d1) - K * std::exp(-r * T) * cdf(d2);
-}
-
-
-/**
- * @brief Encuentra la volatilidad implícita utilizando el método de bisección.
- * 
- *
- * Este método define los dos extremos (a y b) y calcula el punto en el medio (p).
- * En base a este punto medio, se calcula el precio de la opción y se evalúa si
- * hay que ir a la derecha o izquierda de p, achicando el intervalo.
- * 
- * @param S Precio del activo subyacente.
- * @param K Precio de ejercicio de la opción.
- * @param T Tiempo hasta la expiración de la opción.
- * @param r Tasa de interés libre de riesgo continua.
- * @param optionPrice Precio de la opción de compra.
- * @param a Extremo izquierdo del intervalo de búsqueda.
- * @param b Extremo derecho del intervalo de búsqueda.
- * @param tolerance Tolerancia para la convergencia.
- * @param maxIterations Número máximo de iteraciones.
- * @return Volatilidad implícita encontrada o -1 si no converge.
- */
-double findImpliedVolatility(double S, double K, double T, double r, double optionPrice,
-                              double a, double b, double tolerance, int maxIterations) {
-    double p, precio_teorico;
-    
-    for (int i = 0; i < maxIterations; ++i) {
-        p = (a+b)/2;
-
-        precio_teorico = blackScholesCall(S, K, T, r, p);
-        
-        if( fabs(precio_teorico-optionPrice) < tolerance) {
-            return p;
-        }
-
-        if (optionPrice > precio_teorico) {
-            a = p;
-        } else {
-            b = p;
-        }
-    }
-    return -1.0;
-}
-
-/**
- * @brief Estructura para representar los datos de una opción en el DataFrame.
- */
-struct OptionData {
-    std::string description;
-    int strike;
-    std::string kind;
-    double bid;
-    double ask;
-    double under_bid;
-    double under_ask;
-    std::string created_at;
-    std::string expiration_date;
-    double price;
-    double intrinsic_value;
-    double extrinsic_value;
-    double under_price;
-    double implied_volatility;
-    double under_volatility;
-    double expiration;
-};
-
-/**
- * @brief Función de validación para la conversión de cadena a double.
- * 
- * @param str Cadena a validar y convertir.
- * @param result Variable donde se almacenará el resultado de la conversión.
- * @return true si la conversión es exitosa, false en caso contrario.
- */
-bool isValidDouble(const std::string& str, double& result) {
-    std::string strWithDot = str;
-    
-    // Reemplazar comas por puntos en la cadena
-    size_t pos = 0;
-
-    // std::string::npos es una constante especial de la clase std::string en C++. 
-    // Representa un valor que indica una posición no encontrada o inválida dentro 
-    // de la cadena.
-    // pos busca la posición en la que se encuentra la , en la cadena de texto.
-    while ((pos = strWithDot.find(',', pos)) != std::string::npos) {
-        strWithDot.replace(pos, 1, ".");
-    }
-
-    try {
-        size_t pos;
-        result = std::stod(strWithDot, &pos); // Se intenta convertir a double
-        // Verifica si se consumieron todos los caracteres de la cadena
-        return pos == strWithDot.length();
-    // Si no se consumieron, hubo algun error.
-    } catch (const std::invalid_argument&) {
-        return false; // Error de conversión
-    } catch (const std::out_of_range&) {
-        return false; // Valor fuera de rango
-    }
-}
-
-/**
- * @brief Función de validación para el formato de fecha.
- * 
- * @param date Cadena que representa una fecha.
- * @return true si el formato es válido, false en caso contrario.
- */
-bool isValidFormatDate(const std::string& date) {
-    // Expresión regular para el formato de fecha
-    std::regex date_regex("^(0?[1-9]|1[0-2])/(0?[1-9]|1[0-9]|2[0-9]|3[0-1])/(20[0-9][0-9]) (0?[0-9]|1[0-9]|2[0-3]):([0-5][0-9])$");
-    /*
-    (0?[1-9]|1[0-2]): Representa el mes, permitiendo un dígito opcional para los 
-    meses del 1 al 9.
-    (0?[1-9]|1[0-9]|2[0-9]|3[0-1]): Representa el día, permitiendo un dígito opcional 
-    para los días del 1 al 9 y dos dígitos para los días del 10 al 31.
-    (20[0-9][0-9]): Representa el año, asegurándose de que sea un año válido del 
-    siglo XXI.
-    (0?[0-9]|1[0-9]|2[0-3]): Representa la hora en formato de 24 horas,
-     permitiendo un dígito opcional para las horas del 0 al 9 y dos dígitos para 
-     las horas del 10 al 23.
-    ([0-5][0-9]): Representa los minutos, asegurándose de que estén en el rango 
-    de 00 a 59.
-    */
-
-    // Verificar si la cadena cumple con el formato
-    if (std::regex_match(date, date_regex)) {
-        return true;
-    } else {
-        std::cout << "Formato de fecha invalida: " << date  << "\n";
-        return false;
-    }
-}
-
-/**
- * @brief Función de validación para el formato de fecha de vencimiento.
- * 
- * @param date Cadena que representa una fecha de vencimiento.
- * @return true si el formato es válido, false en caso contrario.
- */
-bool isValidFormatExpirationDate(const std::string& date) {
-    // Expresión regular para el formato de fecha
-    std::regex date_regex("\\d{2}/\\d{2}/\\d{4}");
-
-    // Verificar si la cadena cumple con el formato
-    if (std::regex_match(date, date_regex)) {
-        return true;
-    } else {
-        std::cout << "Formato de fecha de vencimiento invalida" << "\n";
-        return false;
-    }
-}
-
-/**
- * @brief Obtiene la diferencia en años entre dos fechas.
- * 
- * @param fecha1_str Cadena que representa la primera fecha.
- * @param fecha2_str Cadena que representa la segunda fecha.
- * @return Diferencia en años entre las fechas o -1 si hay un error.
- */
-double obtenerDiferenciaEnAnios(const std::string& fecha1_str, const std::string& fecha2_str) {
-    // Convertir cadenas a tipos de fecha y hora
-    std::tm tm1 = {};
-    std::tm tm2 = {};
-
-    // The std::istringstream is a string class object which is used to stream 
-    // the string into different variables and similarly files can be stream into 
-    // strings
-    std::istringstream ss1(fecha1_str);
-    std::istringstream ss2(fecha2_str);
-
-    if (!isValidFormatDate(fecha1_str)) {
-        return -1;
-    }
-
-    if (!isValidFormatExpirationDate(fecha2_str)) {
-        return -1;
-    }
-
-    // Formato de fecha y hora para la primer cadena
-    ss1 >> std::get_time(&tm1, "%m/%d/%Y");
-    // Ignorar el espacio entre la fecha y la hora
-    ss1.ignore(1);
-    ss1 >> std::get_time(&tm1, "%H:%M:%S");
-
-    // Formato de fecha para la segunda cadena
-    ss2 >> std::get_time(&tm2, "%d/%m/%Y %H:%M:%S");
-
-    // Convertir a tipos de duración
-    std::time_t time1 = std::mktime(&tm1);
-    std::time_t time2 = std::mktime(&tm2);
-
-    if (time2 < time1) {
-        std::cout << "Error en la fecha de expiracion"
-                  << "no puede ser menor a la fecha de valuacion de la opcion";
-
-        return -1.0;
-    }
-
-    // Primero calcula la diferencia en segundos y despues la pasa a años
-    auto duracion = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::seconds(time2 - time1));
-    double diferencia_en_anios = duracion.count() / (365 * 24 * 60 * 60); // Dividir por segundos en un año
-
-    return diferencia_en_anios;
-}
-
-/**
- * @brief Guarda los datos en un archivo CSV.
- * 
- * @param dataframe Vector que contiene los datos del DataFrame.
- */
-void saveFile(const std::vector<OptionData>& dataframe) {
-
-    // Nombre del archivo
-    std::filesystem::path archivoPath = "output.csv";
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <fstream>
 
-    // Abrir un archivo para escritura
-    std::ofstream archivoSalida(archivoPath);
+#include "blackscholes/arbitrage.hpp"
+#include "blackscholes/archive.hpp"
+#include "blackscholes/density.hpp"
+#include "blackscholes/diagnostics.hpp"
+#include "blackscholes/heston.hpp"
+#include "blackscholes/local_vol.hpp"
+#include "blackscholes/parsing.hpp"
+#include "blackscholes/pipeline.hpp"
+#include "blackscholes/query.hpp"
+#include "blackscholes/result_ring.hpp"
+#include "blackscholes/sabr.hpp"
+#include "blackscholes/scheduler.hpp"
+#include "blackscholes/server.hpp"
+#include "blackscholes/variance_index.hpp"
+
+int main(int argc, char* argv[]) {
 
-    // Encabezados
-    archivoSalida << "Description,Strike,Kind,Bid,Ask,Under Bid,Under Ask,Created At,Price,Valor intrinsico,Valor extrinsico,Under Price,Implied volatility,Under volatility,Years to expiration\n";
+    // Tasa libre de riesgo constante = 100%
+    // TNA
+    int rf = 1;
+    RateCurve curva(rf);
 
-    // Verificar si el archivo se abrió correctamente
-    if (!archivoSalida.is_open()) {
-        std::cerr << "No se pudo abrir el archivo de salida." << std::endl;
-        return; // Salir sin escribir si hay un error
-    }
+    // Las opciones expiran el tercer viernes de cada mes.
+    // En el caso de GFGC1033OC, expira el 20/10.
+    // El formato siempre es dd/mm/YYYY
+    std::string fecha_vencimiento = "20/10/2023";
 
-    // Escribir en el archivo en lugar de imprimir en la consola
-    for (const auto& row : dataframe) {
-        archivoSalida << row.description << ","
-                      << row.strike << ","
-                      << row.kind << ","
-                      << row.bid << ","
-                      << row.ask << ","
-                      << row.under_bid << ","
-                      << row.under_ask << ","
-                      << row.created_at << ","
-                      << row.price << ","
-                      << row.intrinsic_value << ","
-                      << row.extrinsic_value << ","
-                      << row.under_price << ","
-                      << row.implied_volatility << ","
-                      << row.under_volatility << ","
-                      << row.expiration << "\n";
+    if (!isValidFormatExpirationDate(fecha_vencimiento)) {
+        std::cerr << "Formato de fecha de vencimiento invalida: " << fecha_vencimiento
+                  << std::endl;
+        return 0;
     }
 
-    // Cerrar el archivo después de escribir
-    archivoSalida.close();
-
-    std::cout << "Datos guardados correctamente" << std::endl;
-}
-
-/**
- * @brief Estructura para representar los datos de una opción antes de la interpolación.
- */
-struct Data {
-    std::string description;
-    std::string strike;
-    std::string kind;
-    std::string bid;
-    std::string ask;
-    std::string underBid;
-    std::string underAsk;
-    std::string created_at;
-};
-
-/**
- * @brief Reemplaza los valores faltantes en los datos utilizando interpolación.
- * 
- * @param data Vector que contiene los datos antes de la interpolación.
- */
-void replaceMissingValues(std::vector<Data>& data){
-    double bid, ask, underBid, underAsk;
-
-    // Primera iteracion
-    if(!isValidDouble(data[0].ask, ask)) {
-        for (size_t i = 1; i < data.size(); i++) {
-            if(isValidDouble(data[i].ask, ask)) {
-                data[0].ask = data[i].ask;
-                break;
-            }
-        } 
-    }
+    PipelineConfig config;
 
-    if(!isValidDouble(data[0].bid, bid)) {
-        for (size_t i = 1; i < data.size(); i++) {
-            if(isValidDouble(data[i].bid, bid)) {
-                data[0].bid = data[i].bid;
-                break;
+    // Para hacer la interpolacion
+    config.tolerance = 0.00001; // Tolerancia
+    config.max_iterations = 500;  // Número máximo de iteraciones
+
+    // Filtro de outliers (Hampel) sobre la serie de cada contrato
+    config.ventana_outliers = 30;
+    config.umbral_outliers = 3.0;
+    config.reemplazar_outliers = false;
+    config.publicador = nullptr;
+    // La superficie de volatilidad solo se usa desde la biblioteca: sus lectores
+    // viven en el mismo proceso, así que el programa no la publica
+    config.superficie = nullptr;
+    config.extension_salida = ".csv";
+    config.filtro = acceptAllRows();
+    config.ticks = nullptr;
+    // Relleno de precios faltantes: [--gap-fill midpoint|linear|forward] [--max-gap <minutos>]
+    config.relleno = defaultGapFill();
+
+    // Las filas con errores se cuentan por motivo; el resumen se escribe en
+    // stderr a lo sumo una vez por segundo y al terminar
+    Diagnostics diagnostico(std::cerr, std::chrono::seconds(1));
+    config.diagnostico = &diagnostico;
+
+    // Modo batch: main --batch <directorio|patrón> [--merge]
+    // Scheduler: [--threads N] [--pin] [--metrics]
+    std::string entrada_batch;
+    bool merge = false;
+    size_t cantidad_hilos = std::max(1u, std::thread::hardware_concurrency());
+    bool fijar_nucleos = false;
+    bool mostrar_metricas = false;
+
+    // Modo servidor: main --server <socket|127.0.0.1:puerto> [--threads N]
+    std::string direccion_servidor;
+
+    // Publicación en memoria compartida: [--publish <nombre>] [--ring-size N]
+    std::string nombre_ring;
+    size_t capacidad_ring = 65536;
+
+    // Formato columnar: [--format csv|bsc] para escribir, --decode <archivo.bsc> para volver a CSV
+    std::string archivo_decodificar;
+
+    // Consulta por fechas: --query <output.csv|archivo.bsc> [--from "mm/dd/YYYY HH:MM"]
+    //                      [--to "mm/dd/YYYY HH:MM"] [--columns Strike,Price,...]
+    // Sin --query, --from, --to y --columns (junto con --strikes 1033,1100 y
+    // --kind CALL|PUT) filtran lo que se lee y se calcula
+    std::string archivo_consulta;
+    TimeQuery consulta;
+    consulta.desde = std::numeric_limits<int64_t>::min();
+    consulta.hasta = std::numeric_limits<int64_t>::max();
+
+    // Precios en punto fijo: [--tick-size <opción>[:<subyacente>]], por ejemplo 0.001:0.01,
+    // y [--tick-table <archivo>] con el tick de cada instrumento que tenga otra grilla
+    // (líneas "Description;opción[;subyacente]", ver readTickTable)
+    PriceTicks ticks;
+    std::string archivo_ticks;
+
+    // Calibración de Heston por minuto: [--heston <archivo.csv>]
+    std::string archivo_heston;
+
+    // Calibración de SABR por vencimiento y minuto: [--sabr <archivo.csv>] [--sabr-beta b]
+    std::string archivo_sabr;
+    SabrCalibrationConfig config_sabr = defaultSabrCalibration();
+
+    // Volatilidad local de Dupire por minuto (ajuste SSVI): [--local-vol <archivo.csv>]
+    std::string archivo_volatilidad_local;
+
+    // Chequeo de arbitraje estático (mariposa y calendario): [--arbitrage <archivo.csv>]
+    std::string archivo_arbitraje;
+
+    // Densidad neutral al riesgo por minuto y vencimiento (ajuste SSVI):
+    // [--density <resumen.csv>] [--density-grid <grilla.csv>]
+    std::string archivo_densidad;
+    std::string archivo_grilla_densidad;
+
+    // Índice de varianza estilo VIX por minuto: [--variance-index <archivo.csv>]
+    // [--variance-index-days <días del plazo constante>]
+    std::string archivo_indice_varianza;
+    VarianceIndexConfig config_indice_varianza = defaultVarianceIndexConfig();
+
+    for (int i = 1; i < argc; i++) {
+        std::string argumento = argv[i];
+
+        if (argumento == "--batch" && i + 1 < argc) {
+            entrada_batch = argv[++i];
+        } else if (argumento == "--merge") {
+            merge = true;
+        } else if (argumento == "--threads" && i + 1 < argc) {
+            cantidad_hilos = std::max(1, std::atoi(argv[++i]));
+        } else if (argumento == "--pin") {
+            fijar_nucleos = true;
+        } else if (argumento == "--metrics") {
+            mostrar_metricas = true;
+        } else if (argumento == "--server" && i + 1 < argc) {
+            direccion_servidor = argv[++i];
+        } else if (argumento == "--publish" && i + 1 < argc) {
+            nombre_ring = argv[++i];
+        } else if (argumento == "--ring-size" && i + 1 < argc) {
+            capacidad_ring = std::max(1, std::atoi(argv[++i]));
+        } else if (argumento == "--format" && i + 1 < argc) {
+            std::string formato = argv[++i];
+            if (formato != "csv" && formato != "bsc") {
+                std::cerr << "Formato desconocido: " << formato << std::endl;
+                return 1;
             }
-        } 
-    }
-
-    if(!isValidDouble(data[0].underBid, underBid)) {
-        for (size_t i = 1; i < data.size(); i++) {
-            if(isValidDouble(data[i].underBid, underBid)) {
-                data[0].underBid = data[i].underBid;
-                break;
+            config.extension_salida = "." + formato;
+        } else if (argumento == "--decode" && i + 1 < argc) {
+            archivo_decodificar = argv[++i];
+        } else if (argumento == "--query" && i + 1 < argc) {
+            archivo_consulta = argv[++i];
+        } else if ((argumento == "--from" || argumento == "--to") && i + 1 < argc) {
+            std::string fecha = argv[++i];
+            int64_t& limite = argumento == "--from" ? consulta.desde : consulta.hasta;
+            if (!parseTimestamp(fecha, limite)) {
+                std::cerr << "Fecha inválida: " << fecha << " (formato mm/dd/YYYY HH:MM)"
+                          << std::endl;
+                return 1;
             }
-        } 
-    }
-
-    if(!isValidDouble(data[0].underAsk, underAsk)) {
-        for (size_t i = 1; i < data.size(); i++) {
-            if(isValidDouble(data[i].underAsk, underAsk)) {
-                data[0].underAsk = data[i].underAsk;
-                break;
+        } else if (argumento == "--columns" && i + 1 < argc) {
+            std::stringstream columnas(argv[++i]);
+            std::string columna;
+            while (std::getline(columnas, columna, ',')) {
+                consulta.columnas.push_back(columna);
             }
-        } 
-    }
-
-    // De la segunda iteracion a la anteultima
-
-    for (size_t i = 1; i < data.size() - 1; i++) {
-        if(!isValidDouble(data[i].ask, ask)) {
-            double punta_inferior = -1;
-            double punta_superior = -1;
-
-            for (size_t j = i; j >= 0; j--) {
-                if(isValidDouble(data[j].ask, ask)) {
-                    punta_inferior = ask;
-                    break;
-                }
+        } else if (argumento == "--strikes" && i + 1 < argc) {
+            std::stringstream strikes(argv[++i]);
+            std::string strike;
+            while (std::getline(strikes, strike, ',')) {
+                config.filtro.strikes.push_back(std::atoi(strike.c_str()));
             }
-
-            for (size_t z = i; z < data.size(); z++) {
-                if(isValidDouble(data[z].ask, ask)) {
-                    punta_superior = ask;
-                    break;
-                }
+            std::sort(config.filtro.strikes.begin(), config.filtro.strikes.end());
+        } else if (argumento == "--kind" && i + 1 < argc) {
+            config.filtro.kind = argv[++i];
+        } else if (argumento == "--tick-size" && i + 1 < argc) {
+            std::string texto = argv[++i];
+            size_t separador = texto.find(':');
+            std::string opcion = texto.substr(0, separador);
+            std::string subyacente =
+                separador == std::string::npos ? opcion : texto.substr(separador + 1);
+            if (!parseTickSize(opcion, ticks.opcion) ||
+                !parseTickSize(subyacente, ticks.subyacente)) {
+                std::cerr << "Tick inválido: " << texto << std::endl;
+                return 1;
             }
-
-            if (punta_inferior != -1 && punta_superior != -1) {
-                data[i].ask = std::to_string((punta_inferior + punta_superior) / 2);
+            config.ticks = &ticks;
+        } else if (argumento == "--tick-table" && i + 1 < argc) {
+            archivo_ticks = argv[++i];
+        } else if (argumento == "--gap-fill" && i + 1 < argc) {
+            std::string metodo = argv[++i];
+            if (!parseGapFill(metodo, config.relleno.metodo)) {
+                std::cerr << "Relleno desconocido: " << metodo << std::endl;
+                return 1;
             }
-
-
+        } else if (argumento == "--max-gap" && i + 1 < argc) {
+            config.relleno.max_hueco = std::max(0, std::atoi(argv[++i])) * int64_t(60);
+        } else if (argumento == "--heston" && i + 1 < argc) {
+            archivo_heston = argv[++i];
+        } else if (argumento == "--sabr" && i + 1 < argc) {
+            archivo_sabr = argv[++i];
+        } else if (argumento == "--sabr-beta" && i + 1 < argc) {
+            config_sabr.beta = std::min(1.0, std::max(0.0, std::atof(argv[++i])));
+        } else if (argumento == "--local-vol" && i + 1 < argc) {
+            archivo_volatilidad_local = argv[++i];
+        } else if (argumento == "--arbitrage" && i + 1 < argc) {
+            archivo_arbitraje = argv[++i];
+        } else if (argumento == "--density" && i + 1 < argc) {
+            archivo_densidad = argv[++i];
+        } else if (argumento == "--density-grid" && i + 1 < argc) {
+            archivo_grilla_densidad = argv[++i];
+        } else if (argumento == "--variance-index" && i + 1 < argc) {
+            archivo_indice_varianza = argv[++i];
+        } else if (argumento == "--variance-index-days" && i + 1 < argc) {
+            config_indice_varianza.plazo = std::max(1.0, std::atof(argv[++i])) / 365.0;
+        } else {
+            std::cerr << "Argumento desconocido: " << argumento << std::endl;
+            return 1;
         }
     }
 
-    for (size_t i = 1; i < data.size() - 1; i++) {
-        if(!isValidDouble(data[i].bid, bid)) {
-            double punta_inferior = -1;
-            double punta_superior = -1;
-
-            for (size_t j = i; j >= 0; j--) {
-                if(isValidDouble(data[j].bid, bid)) {
-                    punta_inferior = bid;
-                    break;
-                }
-            }
-
-            for (size_t z = i; z < data.size(); z++) {
-                if(isValidDouble(data[z].bid, bid)) {
-                    punta_superior = bid;
-                    break;
-                }
-            }
-
-            if (punta_inferior != -1 && punta_superior != -1) {
-                data[i].bid = std::to_string((punta_inferior + punta_superior) / 2);
-            }
-
-
+    // La tabla se lee después de --tick-size, que da el tick de los
+    // instrumentos que no están en ella
+    if (!archivo_ticks.empty()) {
+        if (config.ticks == nullptr) {
+            std::cerr << "--tick-table necesita --tick-size para los instrumentos que no están "
+                         "en la tabla" << std::endl;
+            return 1;
         }
-    }
-
-    for (size_t i = 1; i < data.size() - 1; i++) {
-        if(!isValidDouble(data[i].underBid, underBid)) {
-            double punta_inferior = -1;
-            double punta_superior = -1;
-
-            for (size_t j = i; j >= 0; j--) {
-                if(isValidDouble(data[j].underBid, underBid)) {
-                    punta_inferior = underBid;
-                    break;
-                }
-            }
-
-            for (size_t z = i; z < data.size(); z++) {
-                if(isValidDouble(data[z].underBid, underBid)) {
-                    punta_superior = underBid;
-                    break;
-                }
-            }
-
-            if (punta_inferior != -1 && punta_superior != -1) {
-                data[i].underBid = std::to_string((punta_inferior + punta_superior) / 2);
-            }
-
-
+        std::ifstream tabla(archivo_ticks);
+        size_t linea = 0;
+        if (!tabla) {
+            std::cerr << "No se pudo abrir " << archivo_ticks << std::endl;
+            return 1;
         }
-    }
-
-    for (size_t i = 1; i < data.size() - 1; i++) {
-        if(!isValidDouble(data[i].underAsk, underAsk)) {
-            double punta_inferior = -1;
-            double punta_superior = -1;
-
-            for (size_t j = i; j >= 0; j--) {
-                if(isValidDouble(data[j].underAsk, underAsk)) {
-                    punta_inferior = underAsk;
-                    break;
-                }
-            }
-
-            for (size_t z = i; z < data.size(); z++) {
-                if(isValidDouble(data[z].underAsk, underAsk)) {
-                    punta_superior = underAsk;
-                    break;
-                }
-            }
-
-            if (punta_inferior != -1 && punta_superior != -1) {
-                data[i].underAsk = std::to_string((punta_inferior + punta_superior) / 2);
-            }
-
-
+        if (!readTickTable(tabla, ticks, linea)) {
+            std::cerr << "Tick inválido en " << archivo_ticks << ":" << linea << std::endl;
+            return 1;
         }
-    } 
-
-    // ultima iteracion
-
-    if(!isValidDouble(data[data.size()].ask, ask)) {
-        for (size_t i = data.size(); i >= 0; i--) {
-            if(isValidDouble(data[i].ask, ask)) {
-                data[data.size()].ask = data[i].ask;
-                break;
-            }
-        } 
     }
 
-    if(!isValidDouble(data[data.size()].bid, bid)) {
-        for (size_t i = data.size(); i >= 0; i--) {
-            if(isValidDouble(data[i].bid, bid)) {
-                data[data.size()].bid = data[i].bid;
-                break;
-            }
-        } 
+    if (archivo_consulta.empty()) {
+        config.filtro.desde = consulta.desde;
+        config.filtro.hasta = consulta.hasta;
+        if (!resolveCsvColumns(consulta.columnas, config.columnas)) {
+            return 1;
+        }
     }
 
-    if(!isValidDouble(data[data.size()].underAsk, underAsk)) {
-        for (size_t i = data.size(); i >= 0; i--) {
-            if(isValidDouble(data[i].underAsk, underAsk)) {
-                data[data.size()].underAsk = data[i].underAsk;
-                break;
-            }
-        } 
+    // Los análisis leen el DataFrame entero: con --columns se calcula igual lo
+    // que necesitan (precios, subyacente, plazo y volatilidad implícita)
+    bool con_analisis = !archivo_heston.empty() || !archivo_sabr.empty() ||
+                        !archivo_volatilidad_local.empty() || !archivo_arbitraje.empty() ||
+                        !archivo_densidad.empty() || !archivo_grilla_densidad.empty() ||
+                        !archivo_indice_varianza.empty();
+    if (con_analisis) {
+        config.calculadas = {csv::BID, csv::ASK, csv::PRICE, csv::UNDER_BID, csv::UNDER_ASK,
+                             csv::UNDER_PRICE, csv::EXPIRATION, csv::IMPLIED_VOLATILITY,
+                             csv::IV_OUTLIER};
     }
 
-    if(!isValidDouble(data[data.size()].underBid, underBid)) {
-        for (size_t i = data.size(); i >= 0; i--) {
-            if(isValidDouble(data[i].underBid, underBid)) {
-                data[data.size()].underBid = data[i].underBid;
-                break;
-            }
-        } 
+    if (!direccion_servidor.empty()) {
+        ServerConfig config_servidor = defaultServerConfig(direccion_servidor);
+        config_servidor.hilos_pricer = static_cast<uint32_t>(cantidad_hilos);
+        return runServer(config_servidor);
     }
 
-
-    return;
-}
-
-/**
- * @brief Calcula la volatilidad del activo subyacente.
- * 
- * @param bid Precio de la oferta.
- * @param ask Precio de la demanda.
- * @param expiration Tiempo hasta la expiración de la opción.
- * @return Volatilidad del activo subyacente.
- */
-double calculateUnderVolatility(const double& bid, const double& ask, const double& expiration) {
-    double logDifference = std::log(bid) - std::log(ask);
-    double term1 = 0.5 * std::pow(logDifference, 2);
-    double term2 = (2 * std::log(2) - 1) * std::pow(logDifference, 2);
-
-    // 6 horas y media de ruedas diaria. 6.5 x 60 = 390
-    // 256 son los dias que se pueden operar (aproximadamente) en un año
-    return std::sqrt(term1 - term2) * std::sqrt(256 * 390) ;
-}
-
-int main() {
-
-    // Vector para almacenar filas del DataFrame
-    std::vector<OptionData> dataframe;
-
-    // Tasa libre de riesgo constante = 100%
-    // TNA
-    int rf = 1;
-    double rf_continua = std::log(1 + rf);
-
-    // Strike price constante 1033
-    int strike = 1033;
-
-    // Las opciones expiran el tercer viernes de cada mes.
-    // En el caso de GFGC1033OC, expira el 20/10.
-    // El formato siempre es dd/mm/YYYY
-    std::string fecha_vencimiento = "20/10/2023";
-
-    if (!isValidFormatExpirationDate(fecha_vencimiento)) {
-        return 0;
+    // El ring vive hasta el final de main para que los lectores alcancen a leer
+    std::unique_ptr<ResultRingWriter> ring;
+    if (!nombre_ring.empty()) {
+        ring.reset(new ResultRingWriter(nombre_ring, capacidad_ring));
+        if (!ring->ok()) {
+            std::cerr << "No se pudo crear el ring " << nombre_ring << std::endl;
+            return 1;
+        }
+        config.publicador = ring.get();
     }
 
-    // Para hacer la interpolacion
-    double tolerance = 0.00001; // Tolerancia
-    int max_iterations = 500;  // Número máximo de iteraciones
-
-    // Nombre del archivo CSV que deseas abrir
-    std::string nombreArchivo = "Exp_Octubre.csv";
-
-    // Crear un objeto ifstream e intentar abrir el archivo
-    std::ifstream archivo(nombreArchivo);
-
-    std::vector<Data> datos;
-
-    // Verifica si la apertura fue exitosa
-    if (archivo.is_open()) {
-        std::string linea;
+    // Un único scheduler para todas las etapas, asi no se crean más hilos que núcleos
+    Scheduler scheduler(cantidad_hilos, fijar_nucleos);
+    int resultado = 0;
+
+    if (!archivo_consulta.empty()) {
+        resultado = runQuery(archivo_consulta, consulta, scheduler, std::cout);
+    } else if (!archivo_decodificar.empty()) {
+        ArchiveReader archivo(archivo_decodificar);
+        std::vector<OptionData> dataframe;
+        if (!archivo.ok() || !archivo.read(dataframe, scheduler)) {
+            std::cerr << "No se pudo leer " << archivo_decodificar << std::endl;
+            return 1;
+        }
+        saveFile(dataframe, "output.csv", &scheduler);
+    } else if (!entrada_batch.empty()) {
+        ExpirationCalendar calendario;
+        resultado = runBatch(entrada_batch, merge, scheduler, curva, calendario, config);
+    } else {
+        // Nombre del archivo CSV que deseas abrir
+        std::string nombreArchivo = "Exp_Octubre.csv";
 
-        // Vector para almacenar elementos de cada línea
-        std::vector<std::string> elementos;
+        std::vector<Data> datos;
 
-        // Leer la primera línea (encabezados)
-        std::getline(archivo, linea);
+        if (!readFile(nombreArchivo, datos, scheduler, &config.filtro, config.diagnostico)) {
+            std::cerr << "Error al abrir el archivo." << std::endl;
+            return 0;
+        }
 
-        // Lee cada línea del archivo
-        while (std::getline(archivo, linea)) {
-            // Esta clase te permite tratar una cadena de caracteres como si 
-            // fuera una secuencia, Ejemplo:
-            // GFGC1033OC;1033;CALL;130;178,999;1180,5;1184,85;10/18/2023 12:18
-            // Me permite trabajar con cada elemento por separado 
-            std::istringstream streamLinea(linea);
-            std::string valor;
+        std::vector<OptionData> dataframe = processData(datos, fecha_vencimiento, curva,
+                                                        config, scheduler);
 
-            // Vector para almacenar elementos de la línea actual
-            std::vector<std::string> elementos;
+        saveFile(dataframe, "output" + config.extension_salida, &scheduler, config.columnas);
 
-            // Lee y almacena cada elemento separado por ;
-            while (std::getline(streamLinea, valor, ';')) {
-                elementos.push_back(valor);
+        if (!archivo_heston.empty()) {
+            std::vector<HestonChain> cadenas = buildHestonChains(dataframe, curva);
+            std::vector<HestonFit> ajustes =
+                calibrateChains(cadenas, defaultHestonCalibration(), scheduler);
+            if (!saveHestonFits(cadenas, ajustes, archivo_heston)) {
+                std::cerr << "No se pudo escribir " << archivo_heston << std::endl;
+                resultado = 1;
             }
+        }
 
-            // Verifica si hay suficientes elementos para construir una fila
-            if (elementos.size() >= 8) {
-                Data dato;
-
-                dato.description = elementos[0];
-                dato.strike = elementos[1];
-                dato.kind = elementos[2];
-                dato.bid = elementos[3];
-                dato.ask = elementos[4];
-                dato.underBid = elementos[5];
-                dato.underAsk = elementos[6];
-                dato.created_at = elementos[7];
-
-                datos.push_back(dato);
+        if (!archivo_sabr.empty()) {
+            std::vector<SabrSlice> sonrisas = buildSabrSlices(dataframe, curva);
+            std::vector<SabrFit> ajustes = calibrateSabrSlices(sonrisas, config_sabr, scheduler);
+            if (!saveSabrFits(sonrisas, ajustes, archivo_sabr)) {
+                std::cerr << "No se pudo escribir " << archivo_sabr << std::endl;
+                resultado = 1;
             }
         }
-    } else {
-        std::cerr << "Error al abrir el archivo." << std::endl;
-        return 0;
-    }
 
-    // Cierra el archivo después de usarlo
-    archivo.close();
-
-    replaceMissingValues(datos);
-
-        
-    // Verifica si hay suficientes elementos para construir una fila
-    for (size_t i = 0; i < datos.size(); i++) {
-        // Construye una estructura OptionData y agrega al DataFrame
-        OptionData opcion;
-        double bid = -1.0;
-        double ask = -1.0;
-        double under_bid = -1.0;
-        double under_ask = -1.0;
-
-        // Valida si los elementos no estan vacios y son del tipo double
-        // La funcion isValidDouble devuelve true o false, pero modifica
-        // el segundo parametro que se le pasa entonces lo puedo usar
-        // ya transformado al tipo double.
-
-        // Valido con una expresion regular que la fecha tenga siempre
-        // el mismo formato.
-        if (!datos[i].created_at.empty()) {
-            opcion.expiration = obtenerDiferenciaEnAnios(datos[i].created_at, 
-                                                         fecha_vencimiento);
+        if (!archivo_volatilidad_local.empty()) {
+            std::vector<SsviChain> cadenas = buildSsviChains(dataframe, curva);
+            std::vector<LocalVolGrid> grillas =
+                buildLocalVolSurfaces(cadenas, defaultLocalVolConfig(), scheduler);
+            if (!saveLocalVolSurfaces(cadenas, grillas, archivo_volatilidad_local)) {
+                std::cerr << "No se pudo escribir " << archivo_volatilidad_local << std::endl;
+                resultado = 1;
+            }
         }
 
-        if (isValidDouble(datos[i].bid, bid) &&
-            isValidDouble(datos[i].ask, ask)) {
-                opcion.price = (bid + ask) / 2;
+        if (!archivo_arbitraje.empty()) {
+            std::vector<ArbitrageCheck> chequeos =
+                checkStaticArbitrage(dataframe, curva, defaultArbitrageConfig(), scheduler);
+            if (!saveArbitrageChecks(dataframe, chequeos, archivo_arbitraje)) {
+                std::cerr << "No se pudo escribir " << archivo_arbitraje << std::endl;
+                resultado = 1;
+            }
         }
 
-        if (isValidDouble(datos[i].underBid, under_bid) &&
-            isValidDouble(datos[i].underAsk, under_ask)) {
-                opcion.under_price = (under_ask + under_bid) / 2;
-                opcion.under_volatility = calculateUnderVolatility(under_bid, under_ask, opcion.expiration);
+        if (!archivo_densidad.empty() || !archivo_grilla_densidad.empty()) {
+            std::vector<SsviChain> cadenas = buildSsviChains(dataframe, curva);
+            std::vector<ImpliedDensity> densidades =
+                computeDensities(cadenas, defaultDensityConfig(), scheduler);
+            if (!archivo_densidad.empty() && !saveDensitySummaries(densidades, archivo_densidad)) {
+                std::cerr << "No se pudo escribir " << archivo_densidad << std::endl;
+                resultado = 1;
+            }
+            if (!archivo_grilla_densidad.empty() &&
+                !saveDensityGrids(densidades, archivo_grilla_densidad)) {
+                std::cerr << "No se pudo escribir " << archivo_grilla_densidad << std::endl;
+                resultado = 1;
+            }
         }
 
-        opcion.implied_volatility = -1;
-
-        // Si todas las validaciones fueron correctas calcula la
-        // volatilidad implicita
-        if (opcion.expiration > 0 && 
-            opcion.price > 0 && 
-            opcion.under_price > 0) {
-
-            opcion.implied_volatility = findImpliedVolatility(opcion.under_price, 
-            strike, opcion.expiration, rf_continua, opcion.price, 0.00001, 5, 
-            tolerance, max_iterations);
+        // Con el archivo ya procesado: el cálculo incremental a medida que llegan
+        // las filas (VarianceIndexBuilder) es solo de la biblioteca
+        if (!archivo_indice_varianza.empty()) {
+            std::vector<VarianceIndex> indices =
+                computeVarianceIndices(dataframe, curva, config_indice_varianza);
+            if (!saveVarianceIndices(indices, archivo_indice_varianza)) {
+                std::cerr << "No se pudo escribir " << archivo_indice_varianza << std::endl;
+                resultado = 1;
+            }
         }
-
-        opcion.description = "GFGC1033OC";
-        opcion.strike = 1033;
-        opcion.kind = "CALL";
-        opcion.bid = bid;
-        opcion.ask = ask;
-        opcion.under_ask = under_ask;
-        opcion.under_bid = under_bid;
-        opcion.created_at = datos[i].created_at;
-        opcion.expiration_date = fecha_vencimiento;
-        opcion.intrinsic_value = opcion.under_price - opcion.strike;
-        opcion.extrinsic_value = opcion.price - opcion.intrinsic_value;
-
-        dataframe.push_back(opcion);
     }
 
-    saveFile(dataframe);
+    if (mostrar_metricas) {
+        scheduler.printMetrics(std::cerr);
+    }
 
-    return 0;
+    return resultado;
 }
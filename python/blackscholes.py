@@ -0,0 +1,59 @@
+"""Pricing Black-Scholes sobre arrays de NumPy, dentro del proceso de Python.
+
+Envuelve el módulo compilado ``_blackscholes``. Las columnas float64
+contiguas se pasan tal cual (sin copiar) y el resultado se escribe en un
+array de NumPy nuevo o en ``out``.
+"""
+
+import numpy as np
+
+import _blackscholes
+
+
+def _columna(x):
+    # No copia si x ya es un array float64 contiguo
+    return np.ascontiguousarray(x, dtype=np.float64)
+
+
+def _salida(out, *columnas):
+    if out is not None:
+        return out
+    largo = max(np.size(c) for c in columnas)
+    return np.empty(largo, dtype=np.float64)
+
+
+def black_scholes_call(S, K, T, r, sigma, out=None, threads=1):
+    """Precio de opciones de compra. Los argumentos pueden ser arrays o escalares."""
+    columnas = [_columna(x) for x in (S, K, T, r, sigma)]
+    out = _salida(out, *columnas)
+    _blackscholes.black_scholes_call(*columnas, out=out, threads=threads)
+    return out
+
+
+def implied_volatility(S, K, T, r, price, out=None, threads=1, low=0.00001, high=5,
+                       tolerance=0.00001, max_iterations=500):
+    """Volatilidad implícita por bisección; -1 donde no converge o faltan datos."""
+    columnas = [_columna(x) for x in (S, K, T, r, price)]
+    out = _salida(out, *columnas)
+    _blackscholes.implied_volatility(*columnas, out=out, threads=threads, low=low, high=high,
+                                     tolerance=tolerance, max_iterations=max_iterations)
+    return out
+
+
+def under_volatility(bid, ask, out=None):
+    """Volatilidad anualizada del subyacente a partir de bid y ask."""
+    columnas = [_columna(x) for x in (bid, ask)]
+    out = _salida(out, *columnas)
+    _blackscholes.under_volatility(*columnas, out=out)
+    return out
+
+
+def implied_volatility_frame(df, rate, threads=1):
+    """Volatilidad implícita de cada fila de un DataFrame con las columnas de output.csv.
+
+    Usa 'Under Price', 'Strike', 'Years to expiration' y 'Price'; ``rate`` es la
+    tasa continua (escalar o columna).
+    """
+    return implied_volatility(df['Under Price'].to_numpy(), df['Strike'].to_numpy(),
+                              df['Years to expiration'].to_numpy(), rate,
+                              df['Price'].to_numpy(), threads=threads)
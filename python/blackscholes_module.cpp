@@ -0,0 +1,316 @@
+/**
+ * @file
+ * @brief Módulo de Python (_blackscholes) sobre la biblioteca de pricing.
+ *
+ * Las columnas se reciben por el buffer protocol (arrays de NumPy float64,
+ * array.array('d'), memoryview...) y se leen en el lugar, sin copiarlas.
+ * El resultado se escribe en el buffer `out` si se pasa uno; si no, en un
+ * bytearray nuevo que se devuelve como memoryview de doubles, que NumPy
+ * puede envolver con np.frombuffer sin copiar.
+ *
+ * Los cálculos se hacen sin el GIL y se pueden repartir en varios hilos.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../blackscholes/pricing.hpp"
+
+/**
+ * @brief Columna de entrada: un buffer de doubles o un escalar que se repite.
+ */
+struct Columna {
+    Py_buffer vista;
+    bool tiene_vista = false;
+    const double* datos = nullptr;
+    double escalar = 0;
+    Py_ssize_t largo = -1;  // -1 si es un escalar
+
+    ~Columna() {
+        if (tiene_vista) {
+            PyBuffer_Release(&vista);
+        }
+    }
+
+    double operator[](Py_ssize_t i) const {
+        return largo < 0 ? escalar : datos[i];
+    }
+};
+
+/**
+ * @brief Obtiene una columna de un objeto de Python sin copiarla.
+ *
+ * @return false con la excepción de Python cargada si el objeto no sirve.
+ */
+static bool leerColumna(PyObject* objeto, const char* nombre, Columna& columna) {
+    if (PyFloat_Check(objeto) || PyLong_Check(objeto)) {
+        columna.escalar = PyFloat_AsDouble(objeto);
+        return !PyErr_Occurred();
+    }
+
+    if (PyObject_GetBuffer(objeto, &columna.vista, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        return false;
+    }
+    columna.tiene_vista = true;
+
+    if (columna.vista.itemsize != sizeof(double) || columna.vista.format == nullptr ||
+        std::string(columna.vista.format) != "d") {
+        PyErr_Format(PyExc_TypeError, "%s debe ser un buffer de float64", nombre);
+        return false;
+    }
+
+    columna.datos = static_cast<const double*>(columna.vista.buf);
+    if (columna.vista.ndim == 0) {
+        columna.escalar = columna.datos[0];
+    } else {
+        columna.largo = columna.vista.len / columna.vista.itemsize;
+    }
+    return true;
+}
+
+/**
+ * @brief Verifica que todas las columnas tengan el mismo largo.
+ *
+ * @return Largo común, o -1 con la excepción cargada.
+ */
+static Py_ssize_t largoComun(const std::vector<const Columna*>& columnas) {
+    Py_ssize_t largo = -1;
+    for (const Columna* columna : columnas) {
+        if (columna->largo < 0) {
+            continue;
+        }
+        if (largo >= 0 && columna->largo != largo) {
+            PyErr_SetString(PyExc_ValueError, "las columnas tienen distinto largo");
+            return -1;
+        }
+        largo = columna->largo;
+    }
+    return largo < 0 ? 1 : largo;
+}
+
+/**
+ * @brief Prepara el buffer de salida: el que pasó el usuario o uno nuevo.
+ *
+ * @param out Objeto pasado por el usuario o nullptr.
+ * @param largo Cantidad de doubles a escribir.
+ * @param vista Vista de escritura sobre la salida.
+ * @return Objeto a devolver (nueva referencia) o nullptr con la excepción cargada.
+ */
+static PyObject* prepararSalida(PyObject* out, Py_ssize_t largo, Py_buffer& vista) {
+    PyObject* resultado;
+
+    if (out == nullptr || out == Py_None) {
+        PyObject* bytes = PyByteArray_FromStringAndSize(nullptr, largo * sizeof(double));
+        if (bytes == nullptr) {
+            return nullptr;
+        }
+        PyObject* memoria = PyMemoryView_FromObject(bytes);
+        Py_DECREF(bytes);
+        if (memoria == nullptr) {
+            return nullptr;
+        }
+        resultado = PyObject_CallMethod(memoria, "cast", "s", "d");
+        Py_DECREF(memoria);
+        if (resultado == nullptr) {
+            return nullptr;
+        }
+    } else {
+        Py_INCREF(out);
+        resultado = out;
+    }
+
+    if (PyObject_GetBuffer(resultado, &vista,
+                           PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0) {
+        Py_DECREF(resultado);
+        return nullptr;
+    }
+
+    if (vista.itemsize != sizeof(double) || std::string(vista.format) != "d" ||
+        vista.len / vista.itemsize != largo) {
+        PyBuffer_Release(&vista);
+        Py_DECREF(resultado);
+        PyErr_SetString(PyExc_ValueError, "out debe ser un buffer de float64 del largo de las columnas");
+        return nullptr;
+    }
+
+    return resultado;
+}
+
+/**
+ * @brief Aplica funcion(desde, hasta) repartiendo [0, n) en varios hilos.
+ */
+template <typename Funcion>
+static void repartir(Py_ssize_t n, int cantidad_hilos, Funcion funcion) {
+    cantidad_hilos = std::max(1, std::min<int>(cantidad_hilos, static_cast<int>(n)));
+    if (cantidad_hilos == 1) {
+        funcion(0, n);
+        return;
+    }
+
+    std::vector<std::thread> hilos;
+    Py_ssize_t bloque = (n + cantidad_hilos - 1) / cantidad_hilos;
+    for (Py_ssize_t desde = 0; desde < n; desde += bloque) {
+        hilos.emplace_back(funcion, desde, std::min(n, desde + bloque));
+    }
+    for (auto& hilo : hilos) {
+        hilo.join();
+    }
+}
+
+static PyObject* black_scholes_call(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* claves[] = {"S", "K", "T", "r", "sigma", "out", "threads", nullptr};
+    PyObject *oS, *oK, *oT, *oR, *oSigma, *out = nullptr;
+    int hilos = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOO|Oi", const_cast<char**>(claves),
+                                     &oS, &oK, &oT, &oR, &oSigma, &out, &hilos)) {
+        return nullptr;
+    }
+
+    Columna S, K, T, r, sigma;
+    if (!leerColumna(oS, "S", S) || !leerColumna(oK, "K", K) || !leerColumna(oT, "T", T) ||
+        !leerColumna(oR, "r", r) || !leerColumna(oSigma, "sigma", sigma)) {
+        return nullptr;
+    }
+
+    Py_ssize_t n = largoComun({&S, &K, &T, &r, &sigma});
+    if (n < 0) {
+        return nullptr;
+    }
+
+    Py_buffer vista;
+    PyObject* resultado = prepararSalida(out, n, vista);
+    if (resultado == nullptr) {
+        return nullptr;
+    }
+    double* precios = static_cast<double*>(vista.buf);
+
+    Py_BEGIN_ALLOW_THREADS
+    repartir(n, hilos, [&](Py_ssize_t desde, Py_ssize_t hasta) {
+        for (Py_ssize_t i = desde; i < hasta; i++) {
+            precios[i] = blackScholesCall(S[i], K[i], T[i], r[i], sigma[i]);
+        }
+    });
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&vista);
+    return resultado;
+}
+
+static PyObject* implied_volatility(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* claves[] = {"S", "K", "T", "r", "price", "out", "threads", "low", "high",
+                                   "tolerance", "max_iterations", nullptr};
+    PyObject *oS, *oK, *oT, *oR, *oPrecio, *out = nullptr;
+    int hilos = 1;
+    double a = 0.00001, b = 5, tolerance = 0.00001;
+    int max_iterations = 500;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOO|Oidddi", const_cast<char**>(claves),
+                                     &oS, &oK, &oT, &oR, &oPrecio, &out, &hilos,
+                                     &a, &b, &tolerance, &max_iterations)) {
+        return nullptr;
+    }
+
+    Columna S, K, T, r, precio;
+    if (!leerColumna(oS, "S", S) || !leerColumna(oK, "K", K) || !leerColumna(oT, "T", T) ||
+        !leerColumna(oR, "r", r) || !leerColumna(oPrecio, "price", precio)) {
+        return nullptr;
+    }
+
+    Py_ssize_t n = largoComun({&S, &K, &T, &r, &precio});
+    if (n < 0) {
+        return nullptr;
+    }
+
+    Py_buffer vista;
+    PyObject* resultado = prepararSalida(out, n, vista);
+    if (resultado == nullptr) {
+        return nullptr;
+    }
+    double* volatilidades = static_cast<double*>(vista.buf);
+
+    Py_BEGIN_ALLOW_THREADS
+    repartir(n, hilos, [&](Py_ssize_t desde, Py_ssize_t hasta) {
+        for (Py_ssize_t i = desde; i < hasta; i++) {
+            // Mismas validaciones que el pipeline: sin datos validos no hay IV
+            if (T[i] > 0 && precio[i] > 0 && S[i] > 0 && K[i] > 0) {
+                volatilidades[i] = findImpliedVolatility(S[i], K[i], T[i], r[i], precio[i],
+                                                         a, b, tolerance, max_iterations);
+            } else {
+                volatilidades[i] = -1;
+            }
+        }
+    });
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&vista);
+    return resultado;
+}
+
+static PyObject* under_volatility(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* claves[] = {"bid", "ask", "out", nullptr};
+    PyObject *oBid, *oAsk, *out = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", const_cast<char**>(claves),
+                                     &oBid, &oAsk, &out)) {
+        return nullptr;
+    }
+
+    Columna bid, ask;
+    if (!leerColumna(oBid, "bid", bid) || !leerColumna(oAsk, "ask", ask)) {
+        return nullptr;
+    }
+
+    Py_ssize_t n = largoComun({&bid, &ask});
+    if (n < 0) {
+        return nullptr;
+    }
+
+    Py_buffer vista;
+    PyObject* resultado = prepararSalida(out, n, vista);
+    if (resultado == nullptr) {
+        return nullptr;
+    }
+    double* volatilidades = static_cast<double*>(vista.buf);
+
+    Py_BEGIN_ALLOW_THREADS
+    for (Py_ssize_t i = 0; i < n; i++) {
+        volatilidades[i] = calculateUnderVolatility(bid[i], ask[i], 0);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&vista);
+    return resultado;
+}
+
+static PyMethodDef metodos[] = {
+    {"black_scholes_call",
+     reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(black_scholes_call)),
+     METH_VARARGS | METH_KEYWORDS,
+     "black_scholes_call(S, K, T, r, sigma, out=None, threads=1)\n\n"
+     "Precio Black-Scholes de opciones de compra."},
+    {"implied_volatility",
+     reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(implied_volatility)),
+     METH_VARARGS | METH_KEYWORDS,
+     "implied_volatility(S, K, T, r, price, out=None, threads=1, low=1e-5, high=5,\n"
+     "                   tolerance=1e-5, max_iterations=500)\n\n"
+     "Volatilidad implícita por bisección; -1 si no converge o faltan datos."},
+    {"under_volatility",
+     reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(under_volatility)),
+     METH_VARARGS | METH_KEYWORDS,
+     "under_volatility(bid, ask, out=None)\n\n"
+     "Volatilidad anualizada del subyacente a partir de bid y ask."},
+    {nullptr, nullptr, 0, nullptr}};
+
+static PyModuleDef modulo = {PyModuleDef_HEAD_INIT, "_blackscholes",
+                             "Pricing Black-Scholes sobre columnas sin copiar.", -1, metodos,
+                             nullptr, nullptr, nullptr, nullptr};
+
+PyMODINIT_FUNC PyInit__blackscholes(void) {
+    return PyModule_Create(&modulo);
+}